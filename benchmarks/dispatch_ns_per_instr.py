@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Interpreter dispatch microbenchmark: nanoseconds per executed bytecode instruction.
+
+Runs int_sum_loop.py and range_iterate.py under protopy with PROTO_INSTR_STATS=1 and
+divides wall time by the instruction count protopy reports at exit. The cost of
+interpreter startup (measured with an empty `-c pass` run) is subtracted from both.
+
+Compare dispatch strategies by building protoPython twice, e.g. with
+-DPROTOPY_COMPUTED_GOTO=OFF (switch) and the default (computed goto):
+
+    PROTOPY_BIN=build/src/runtime/protopy \\
+    PROTOPY_BASELINE_BIN=build-switch/src/runtime/protopy \\
+        python3 benchmarks/dispatch_ns_per_instr.py
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+
+from run_benchmarks import PATH_ARG, PROJECT_ROOT, SCRIPT_DIR, _script_paths, median
+
+WORKLOADS = ["int_sum_loop.py", "range_iterate.py"]
+STATS_RE = re.compile(r"\[proto-stats\] instructions=(\d+)")
+
+
+def run_once(cmd, timeout):
+    """Return (elapsed_ns, instructions) for one protopy run, or None on failure."""
+    env = {**os.environ, "PROTO_INSTR_STATS": "1"}
+    start = time.perf_counter_ns()
+    try:
+        p = subprocess.run(cmd, cwd=PROJECT_ROOT, env=env, text=True,
+                           stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    elapsed = time.perf_counter_ns() - start
+    m = STATS_RE.search(p.stderr or "")
+    if p.returncode != 0 or not m:
+        return None
+    return elapsed, int(m.group(1))
+
+
+def measure(cmd, runs, timeout):
+    samples = [s for s in (run_once(cmd, timeout) for _ in range(runs)) if s]
+    if not samples:
+        return None
+    return median([s[0] for s in samples]), median([s[1] for s in samples])
+
+
+def ns_per_instr(protopy_bin, runs, timeout):
+    base = measure([protopy_bin, "-c", "pass"], runs, timeout)
+    if not base:
+        return {}
+    results = {}
+    for name in WORKLOADS:
+        script, _ = _script_paths(SCRIPT_DIR / name)
+        m = measure([protopy_bin, "--path", PATH_ARG, "--script", script], runs, timeout)
+        if not m:
+            results[name] = None
+            continue
+        instrs = m[1] - base[1]
+        results[name] = ((m[0] - base[0]) / instrs if instrs > 0 else None, instrs)
+    return results
+
+
+def fmt(entry):
+    if not entry or entry[0] is None:
+        return "n/a"
+    return f"{entry[0]:.2f}"
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--timeout", type=int, default=120)
+    args = parser.parse_args()
+
+    protopy_bin = os.environ.get("PROTOPY_BIN")
+    if not protopy_bin:
+        print("Set PROTOPY_BIN environment variable.")
+        return 1
+    baseline_bin = os.environ.get("PROTOPY_BASELINE_BIN")
+
+    after = ns_per_instr(protopy_bin, args.runs, args.timeout)
+    before = ns_per_instr(baseline_bin, args.runs, args.timeout) if baseline_bin else {}
+
+    print(f"{'Workload':<20} {'Instructions':>14} {'Before ns/op':>14} {'After ns/op':>14}")
+    for name in WORKLOADS:
+        a = after.get(name)
+        instrs = a[1] if a else 0
+        print(f"{name:<20} {instrs:>14} {fmt(before.get(name)):>14} {fmt(a):>14}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
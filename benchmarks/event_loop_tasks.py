@@ -0,0 +1,54 @@
+# event_loop_tasks.py - Benchmark: spawn N tasks that sleep and are joined by one coroutine.
+#
+# Stresses task creation, the ready queue and the timer heap. Under protopy the native
+# _eventloop module is used; elsewhere it falls back to asyncio so CPython can run it too.
+# Usage:
+#     protopy --script benchmarks/event_loop_tasks.py [n_tasks]
+
+N_TASKS = 20000
+
+try:
+    import _eventloop as loop
+
+    def run(coro):
+        return loop.run(coro)
+
+    create_task = loop.create_task
+    sleep = loop.sleep
+except ImportError:
+    import asyncio
+
+    def run(coro):
+        return asyncio.run(coro)
+
+    def create_task(coro):
+        return asyncio.get_running_loop().create_task(coro)
+
+    sleep = asyncio.sleep
+
+
+async def worker(i):
+    await sleep(0.001 * (i % 10))
+    return i
+
+
+async def main(n):
+    tasks = [create_task(worker(i)) for i in range(n)]
+    total = 0
+    for t in tasks:
+        total += await t
+    return total
+
+
+def main_entry():
+    import sys
+    n = N_TASKS
+    if len(sys.argv) > 1:
+        n = int(sys.argv[1])
+    total = run(main(n))
+    if total != n * (n - 1) // 2:
+        raise SystemExit("event_loop_tasks: wrong total")
+
+
+if __name__ == "__main__":
+    main_entry()
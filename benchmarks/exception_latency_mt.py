@@ -0,0 +1,43 @@
+# exception_latency_mt.py - Benchmark: exception_latency.py's raise/catch loop on N threads.
+#
+# Each thread raises and catches n // 2 ValueErrors. With the pending exception kept in a
+# per-thread GC root, raising and clearing touch no shared state, so wall time should stay
+# roughly flat as threads are added (same work per thread). Usage:
+#     BENCH_N=50000 BENCH_THREADS=4 protopy --script benchmarks/exception_latency_mt.py
+#     python3 benchmarks/exception_latency_mt.py [n_per_thread] [n_threads]
+# exception_latency_scaling.py runs it for 1..N threads and prints a before/after table.
+
+import os
+
+from exception_latency import run_bench
+
+N_PER_THREAD = 50000
+N_THREADS = 4
+
+
+def main():
+    import sys
+    n = int(os.environ.get("BENCH_N", N_PER_THREAD))
+    n_threads = int(os.environ.get("BENCH_THREADS", N_THREADS))
+    if len(sys.argv) > 1:
+        n = int(sys.argv[1])
+    if len(sys.argv) > 2:
+        n_threads = int(sys.argv[2])
+    try:
+        import threading
+        has_thread = getattr(threading, "_has_thread", True)
+    except ImportError:
+        has_thread = False
+    if not has_thread:
+        for _ in range(n_threads):
+            run_bench(n)
+        return
+    threads = [threading.Thread(target=run_bench, args=(n,)) for _ in range(n_threads)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+Exception latency scaling: wall time of exception_latency_mt.py for 1..N threads.
+
+Every thread does the same raise/catch work, so with no shared state on the raise path
+the time stays close to the 1-thread time as threads are added. The table shows ms and
+the ratio to the 1-thread run for each binary that is set:
+
+    PROTOPY_BIN            protoPython under test ("after")
+    PROTOPY_BASELINE_BIN   protoPython to compare against ("before"), e.g. a build of the
+                           parent commit
+    CPYTHON_BIN            optional CPython reference (GIL: ratio grows with threads)
+
+    PROTOPY_BIN=build/src/runtime/protopy \\
+    PROTOPY_BASELINE_BIN=build-before/src/runtime/protopy \\
+        python3 benchmarks/exception_latency_scaling.py --max-threads 8
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+from run_benchmarks import PATH_ARG, PROJECT_ROOT, SCRIPT_DIR, _script_paths, median
+
+SCRIPT = "exception_latency_mt.py"
+
+
+def wall_ms(cmd, threads, n, runs, timeout):
+    """Median wall time in ms of cmd with BENCH_THREADS=threads, or None on failure."""
+    env = {**os.environ, "BENCH_N": str(n), "BENCH_THREADS": str(threads)}
+    samples = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        try:
+            p = subprocess.run(cmd, cwd=PROJECT_ROOT, env=env, stdout=subprocess.DEVNULL,
+                               stderr=subprocess.DEVNULL, timeout=timeout)
+        except subprocess.TimeoutExpired:
+            continue
+        if p.returncode == 0:
+            samples.append((time.perf_counter() - start) * 1000)
+    return median(samples) if samples else None
+
+
+def sweep(cmd, max_threads, n, runs, timeout):
+    return {t: wall_ms(cmd, t, n, runs, timeout) for t in range(1, max_threads + 1)}
+
+
+def fmt(times, t):
+    ms, one = times.get(t), times.get(1)
+    if ms is None:
+        return "n/a"
+    return f"{ms:.1f} ({ms / one:.2f}x)" if one else f"{ms:.1f}"
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--max-threads", type=int, default=4)
+    parser.add_argument("--n", type=int, default=50000, help="raise/catch iterations per thread")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--timeout", type=int, default=120)
+    args = parser.parse_args()
+
+    script_protopy, script_cpy = _script_paths(SCRIPT_DIR / SCRIPT)
+    columns = []
+    for label, var in (("before", "PROTOPY_BASELINE_BIN"), ("after", "PROTOPY_BIN")):
+        if os.environ.get(var):
+            columns.append((label, [os.environ[var], "--path", PATH_ARG, "--script", script_protopy]))
+    if os.environ.get("CPYTHON_BIN"):
+        columns.append(("cpython", [os.environ["CPYTHON_BIN"], script_cpy]))
+    if not columns:
+        print("Set PROTOPY_BIN (and optionally PROTOPY_BASELINE_BIN, CPYTHON_BIN).")
+        return 1
+
+    results = [(label, sweep(cmd, args.max_threads, args.n, args.runs, args.timeout)) for label, cmd in columns]
+    print(f"{'Threads':>7} " + " ".join(f"{label + ' ms':>18}" for label, _ in results))
+    for t in range(1, args.max_threads + 1):
+        print(f"{t:>7} " + " ".join(f"{fmt(times, t):>18}" for _, times in results))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
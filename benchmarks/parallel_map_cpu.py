@@ -0,0 +1,44 @@
+# parallel_map_cpu.py - Benchmark: CPU-bound map over many small items on the worker pool.
+#
+# Stresses chunking, job submission and in-order result collection. Under protopy the
+# native _futures.parallel_map is used; elsewhere it falls back to
+# concurrent.futures.ThreadPoolExecutor.map so CPython can run it too.
+# Usage:
+#     protopy --script benchmarks/parallel_map_cpu.py [n_items]
+
+N_ITEMS = 20000
+
+
+def work(x):
+    total = 0
+    for i in range(200):
+        total += (x * i) % 7
+    return total
+
+
+try:
+    import _futures
+
+    def pmap(fn, items):
+        return _futures.parallel_map(fn, items)
+except ImportError:
+    from concurrent.futures import ThreadPoolExecutor
+
+    def pmap(fn, items):
+        with ThreadPoolExecutor() as ex:
+            return list(ex.map(fn, items, chunksize=64))
+
+
+def main_entry():
+    import sys
+    n = N_ITEMS
+    if len(sys.argv) > 1:
+        n = int(sys.argv[1])
+    items = list(range(n))
+    results = pmap(work, items)
+    if len(results) != n or results[n - 1] != work(n - 1):
+        raise SystemExit("parallel_map_cpu: wrong results")
+
+
+if __name__ == "__main__":
+    main_entry()
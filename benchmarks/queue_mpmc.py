@@ -0,0 +1,71 @@
+# queue_mpmc.py - Benchmark: multi-producer / multi-consumer throughput through queue.Queue.
+#
+# Producers push batches of ints and consumers drain them, on a bounded queue so both sides
+# block. Under protopy the native _queue put_many/get_many are used; elsewhere (CPython) each
+# item goes through put()/get() one at a time.
+# Usage:
+#     protopy --script benchmarks/queue_mpmc.py [n_items] [n_producers] [n_consumers]
+
+import queue
+import threading
+
+N_ITEMS = 200000
+N_PRODUCERS = 4
+N_CONSUMERS = 4
+BATCH = 64
+MAXSIZE = 1024
+
+
+def producer(q, start, stop):
+    if hasattr(q, "put_many"):
+        for base in range(start, stop, BATCH):
+            q.put_many(list(range(base, min(base + BATCH, stop))))
+    else:
+        for i in range(start, stop):
+            q.put(i)
+
+
+def consumer(q, totals):
+    total = 0
+    count = 0
+    batched = hasattr(q, "get_many")
+    while True:
+        items = q.get_many(BATCH) if batched else [q.get()]
+        for k, item in enumerate(items):
+            if item is None:
+                # Sentinels come after all data; hand back any others this batch took.
+                if k + 1 < len(items):
+                    q.put_many(items[k + 1:])
+                totals.append((count, total))
+                return
+            total += item
+            count += 1
+
+
+def main_entry():
+    import sys
+    n = int(sys.argv[1]) if len(sys.argv) > 1 else N_ITEMS
+    producers = int(sys.argv[2]) if len(sys.argv) > 2 else N_PRODUCERS
+    consumers = int(sys.argv[3]) if len(sys.argv) > 3 else N_CONSUMERS
+    q = queue.Queue(MAXSIZE)
+    totals = []
+    step = (n + producers - 1) // producers
+    ps = [threading.Thread(target=producer, args=(q, p * step, min((p + 1) * step, n)))
+          for p in range(producers)]
+    cs = [threading.Thread(target=consumer, args=(q, totals)) for _ in range(consumers)]
+    for t in cs + ps:
+        t.start()
+    for t in ps:
+        t.join()
+    for _ in range(consumers):
+        q.put(None)
+    for t in cs:
+        t.join()
+    count = sum(c for c, _ in totals)
+    total = sum(s for _, s in totals)
+    if count != n or total != n * (n - 1) // 2:
+        raise SystemExit("queue_mpmc: lost or duplicated items")
+
+
+if __name__ == "__main__":
+    main_entry()
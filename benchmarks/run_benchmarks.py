@@ -178,11 +178,16 @@ def main():
         ("int_sum_loop", "int_sum_loop.py", False),
         ("list_append_loop", "list_append_loop.py", False),
         ("str_concat_loop", "str_concat_loop.py", False),
+        ("str_log_scan", "str_log_scan.py", False),
         ("range_iterate", "range_iterate.py", False),
         ("multithread_cpu", "multithreaded_cpu.py", False),
+        ("exception_latency_mt", "exception_latency_mt.py", False),
         ("attr_lookup", "attr_lookup.py", False),
         ("call_recursion", "call_recursion.py", False),
         ("memory_pressure", "memory_pressure.py", False),
+        ("event_loop_tasks", "event_loop_tasks.py", False),
+        ("parallel_map_cpu", "parallel_map_cpu.py", False),
+        ("queue_mpmc", "queue_mpmc.py", False),
     ]
 
     results = {}
@@ -1,7 +1,7 @@
 # str_concat_loop.py - Benchmark: s = ""; s = s + "x" for i in range(N)
-# N kept moderate so protoPython completes within timeout (loop is O(N^2) per concat).
+# Long results extend the thread's rope chain, so the loop is linear overall.
 import os
-N = int(os.environ.get("BENCH_N", "2000"))
+N = int(os.environ.get("BENCH_N", "100000"))
 
 def main():
     s = ""
@@ -0,0 +1,32 @@
+# str_log_scan.py - Benchmark: find/count/split/splitlines/replace/upper over a multi-MB log, as str and bytes
+# The scans run in the SSE2/AVX2 string kernels; BENCH_N is the number of log lines (about 70 bytes each).
+import os
+N = int(os.environ.get("BENCH_N", "60000"))
+
+def make_log(n):
+    rows = []
+    for i in range(n):
+        level = "ERROR" if i % 997 == 0 else "INFO "
+        rows.append(f"2024-05-01 12:00:{i % 60 + 10} {level} worker-{i % 16} GET /api/items?id={i} 200 {i % 50}.{i % 10}ms")
+    return "\n".join(rows) + "\n"
+
+def main():
+    log = make_log(N)
+    total = 0
+    for _ in range(5):
+        total += log.count("ERROR")
+        total += log.find(f"id={N - 1} ")
+        total += len(log.split())
+        total += len(log.splitlines())
+        total += len(log.replace("INFO ", "WARN "))
+        total += len(log.upper())
+    data = log.encode()
+    for _ in range(5):
+        total += data.count("ERROR".encode())
+        total += data.find(f"id={N - 1} ".encode())
+        total += len(data.split("\n".encode()))
+        total += len(data.replace("GET".encode(), "PUT".encode()))
+    return total
+
+if __name__ == "__main__":
+    main()
@@ -36,6 +36,13 @@ std::vector<BlockBoundary> getBasicBlockBoundaries(
     proto::ProtoContext* ctx,
     const proto::ProtoList* bytecode);
 
+/**
+ * Same as above, over a code object's pre-decoded instruction stream (see getDecodedCode).
+ * A superinstruction is read as one instruction spanning those it covers, so
+ * COMPARE_OP_POP_JUMP_IF_FALSE ends a block at its covered POP_JUMP_IF_FALSE.
+ */
+std::vector<BlockBoundary> getBasicBlockBoundaries(const DecodedCode& code);
+
 } // namespace protoPython
 
 #endif
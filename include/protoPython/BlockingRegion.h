@@ -0,0 +1,47 @@
+/*
+ * BlockingRegion.h
+ *
+ * GC-safe blocking. A thread about to block in native code (lock wait, sleep,
+ * join, waitpid, reading stdin, polling) enters a blocking region: it counts
+ * in the space's parkedThreads, so a stop-the-world collection proceeds
+ * without waiting for it to wake up. Leaving the region waits out a
+ * collection in progress before the thread touches proto objects again.
+ *
+ * Inside a region only native state may be used: no allocation, attribute
+ * access or Python calls. Regions nest per thread; only the outermost parks.
+ */
+
+#ifndef PROTOPYTHON_BLOCKINGREGION_H
+#define PROTOPYTHON_BLOCKINGREGION_H
+
+#include <protoCore.h>
+
+namespace protoPython {
+
+/** Mark the calling thread parked for stop-the-world GC. nullptr is a no-op. */
+void enterBlockingRegion(proto::ProtoSpace* space);
+
+/** Undo enterBlockingRegion; the outermost leave waits while a collection is running. */
+void leaveBlockingRegion(proto::ProtoSpace* space);
+
+/** RAII enterBlockingRegion / leaveBlockingRegion. */
+class BlockingRegion {
+public:
+    explicit BlockingRegion(proto::ProtoSpace* space) : space_(space) { enterBlockingRegion(space_); }
+    ~BlockingRegion() { leaveBlockingRegion(space_); }
+    BlockingRegion(const BlockingRegion&) = delete;
+    BlockingRegion& operator=(const BlockingRegion&) = delete;
+
+private:
+    proto::ProtoSpace* space_;
+};
+
+/**
+ * Safepoint: if a stop-the-world is pending in ctx's space, park until it is over.
+ * No-op on the collector's own thread.
+ */
+void gcSafepoint(proto::ProtoContext* ctx);
+
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * CompactDict.h
+ *
+ * Native storage for dict: a compact ordered hash table in the CPython 3.6
+ * layout, an open-addressed index of int32 slots pointing into a dense,
+ * insertion-ordered entry array. Lookups are one probe sequence over native
+ * memory instead of walking a persistent sparse list; deletion leaves a
+ * dummy index slot and a hole in the entries, both dropped on the next
+ * resize. Keys with equal hashes are told apart by identity, native
+ * comparison of str/int/float, and otherwise by __eq__, called with the
+ * table released and the probe restarted if the table changed meanwhile.
+ *
+ * The table is guarded by an OwnerBias: the creating thread (the usual case
+ * for dicts built by BUILD_MAP, comprehensions, json or dict()) mutates it
+ * without atomics; once another thread touches it, every write locks.
+ *
+ * The collector does not see native memory: every kChunkEntries entries are
+ * mirrored as [k, v, ...] (PROTO_NONE pairs for holes) in a persistent chunk
+ * list held by a mutable holder object (under __data__), and the holders are
+ * listed under the dict's __dict_entries__, so the entries are reachable only
+ * through the dict and a self-referencing dict is collected like any cycle.
+ * A write updates one chunk of at most 2 * kChunkEntries items; the chunks
+ * are rebuilt only when a resize drops holes. The persistent views (the
+ * entries list handed out for iteration, keys() and hashData()) are built
+ * on first use and cached, rooted by one more holder in that list, until the
+ * next write. Once the dict is shared, writes also keep a persistent hash
+ * index of its entries current, and get() on any thread reads that index
+ * without taking the lock.
+ *
+ * Objects with the older layout (a __keys__ ProtoList plus a __data__
+ * ProtoSparseList keyed by hash, e.g. OrderedDict and defaultdict
+ * instances) have no table; the dict* helpers below handle both layouts.
+ */
+
+#ifndef PROTOPYTHON_COMPACTDICT_H
+#define PROTOPYTHON_COMPACTDICT_H
+
+#include <protoCore.h>
+#include <protoPython/FutexSync.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace protoPython {
+
+class DictTable {
+public:
+    static constexpr size_t kChunkEntries = 32;
+
+    DictTable(const proto::ProtoObject* dict, size_t capacity);
+    ~DictTable();
+    DictTable(const DictTable&) = delete;
+    DictTable& operator=(const DictTable&) = delete;
+
+    /** Value for key; nullptr when absent or when __eq__ raised (check the pending exception). */
+    const proto::ProtoObject* get(proto::ProtoContext* ctx, const proto::ProtoObject* key);
+    /** Insert or overwrite; false when __eq__ raised. */
+    bool set(proto::ProtoContext* ctx, const proto::ProtoObject* key, const proto::ProtoObject* value);
+    /** Remove key and return its value; nullptr when absent or when __eq__ raised. */
+    const proto::ProtoObject* pop(proto::ProtoContext* ctx, const proto::ProtoObject* key);
+    /** Remove the last entry (popitem); false when empty. */
+    bool popLast(proto::ProtoContext* ctx, const proto::ProtoObject** key, const proto::ProtoObject** value);
+    void clear(proto::ProtoContext* ctx);
+    unsigned long size(proto::ProtoContext* ctx);
+
+    /** The live entries as [k0, v0, k1, v1, ...] in insertion order; never mutated afterwards. */
+    const proto::ProtoList* entries(proto::ProtoContext* ctx);
+    /** Keys in insertion order; never mutated afterwards. */
+    const proto::ProtoList* keys(proto::ProtoContext* ctx);
+    /** The older hash-keyed layout of the entries, for callers taking a ProtoSparseList (kwargs). */
+    const proto::ProtoSparseList* hashData(proto::ProtoContext* ctx);
+
+    const proto::ProtoObject* object() const { return dict_; }
+
+    /** Tables not yet finalized, for tests and diagnostics. */
+    static size_t liveCount();
+
+private:
+    struct Entry {
+        unsigned long hash;
+        const proto::ProtoObject* key;     ///< nullptr: deleted.
+        const proto::ProtoObject* value;
+    };
+    enum class Match { Found, Missing, Ask };
+    struct Probe {
+        Match match;
+        size_t slot;       ///< Index slot of the entry (Found, Ask) or where to insert (Missing).
+        int32_t entry;     ///< Entry index (Found, Ask).
+    };
+
+    static constexpr int32_t kEmpty = -1;
+    static constexpr int32_t kDummy = -2;
+    /** Positions in viewRoots_: the cached views and the shared index. */
+    enum Root { kEntriesRoot, kKeysRoot, kHashDataRoot, kSharedIndexRoot, kRootCount };
+
+    Probe probe(proto::ProtoContext* ctx, const proto::ProtoObject* key, unsigned long hash,
+                const proto::ProtoObject* equalKey, const std::vector<const proto::ProtoObject*>& unequal) const;
+    /** Probe, asking __eq__ outside the guard where needed; false when __eq__ raised. */
+    bool locate(proto::ProtoContext* ctx, OwnerBiasGuard& guard, const proto::ProtoObject* key,
+                unsigned long hash, Probe& out);
+    size_t freeSlot(unsigned long hash) const;
+    void rebuild(proto::ProtoContext* ctx, size_t indexSize);
+    void removeAt(proto::ProtoContext* ctx, const Probe& p);
+    /** Mirror entry j into its chunk, adding the chunk if j starts a new one. */
+    void storeEntry(proto::ProtoContext* ctx, size_t j);
+    /** Rebuild every chunk from entries_ (after holes were dropped, or when emptied). */
+    void rechunk(proto::ProtoContext* ctx);
+    void publishRoots(proto::ProtoContext* ctx);
+    /** Drop the cached views after a write (keys() survives an overwrite). */
+    void invalidate(proto::ProtoContext* ctx, bool keysChanged);
+    enum class Write { Insert, Overwrite, Remove };
+    /** Keep the shared index current after a write; builds it the first time the dict is seen shared. */
+    void indexWrite(proto::ProtoContext* ctx, Write write, unsigned long hash, const proto::ProtoObject* key,
+                    const proto::ProtoObject* value);
+    void buildSharedIndex(proto::ProtoContext* ctx);
+    /** get() from the shared index: true when it decided (value or nullptr in out). */
+    bool sharedGet(proto::ProtoContext* ctx, const proto::ProtoObject* key, unsigned long hash,
+                   const proto::ProtoObject*& out) const;
+    template<typename T>
+    void cache(std::atomic<const T*>& view, Root root, const T* value, proto::ProtoContext* ctx);
+
+    OwnerBias bias_;
+    const proto::ProtoObject* dict_;
+    std::vector<const proto::ProtoList*> chunks_;     ///< chunks_[c] mirrors entries [c*kChunkEntries, (c+1)*kChunkEntries).
+    std::vector<const proto::ProtoObject*> holders_;  ///< holders_[c] holds chunks_[c] for the collector.
+    const proto::ProtoObject* viewsHolder_{nullptr};  ///< Holds viewRoots_; created by the first cached view.
+    const proto::ProtoList* viewRoots_{nullptr};      ///< Indexed by Root; PROTO_NONE when not cached.
+    const proto::ProtoList* roots_{nullptr};          ///< viewsHolder_ and holders_, published under __dict_entries__.
+    std::atomic<const proto::ProtoList*> entriesView_{nullptr};
+    std::atomic<const proto::ProtoList*> keysView_{nullptr};
+    std::atomic<const proto::ProtoSparseList*> hashDataView_{nullptr};
+    /** Shared dicts: hash -> [key, value], or PROTO_NONE when several keys share the hash. */
+    std::atomic<const proto::ProtoSparseList*> sharedIndex_{nullptr};
+    std::vector<Entry> entries_;
+    std::vector<int32_t> index_;           ///< Power-of-two size; kEmpty, kDummy or an entry index.
+    unsigned long live_{0};
+    uint64_t version_{0};                  ///< Bumped whenever entry indices move or entries come and go.
+};
+
+/** An empty dict with a compact table. parent defaults to the dict prototype. */
+const proto::ProtoObject* newDict(proto::ProtoContext* ctx, const proto::ProtoObject* parent = nullptr, size_t capacity = 0);
+
+/** obj's compact table, or nullptr (not a dict, or a dict with the older layout). */
+DictTable* dictTable(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/** True when obj has a compact table or the older __keys__/__data__ layout. */
+bool isDictLike(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/*
+ * Layout-independent access. Missing keys yield nullptr; for the older
+ * layout keys match by hash alone, as they always have.
+ */
+const proto::ProtoObject* dictGet(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key);
+bool dictSet(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key, const proto::ProtoObject* value);
+const proto::ProtoObject* dictPop(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key);
+unsigned long dictSize(proto::ProtoContext* ctx, const proto::ProtoObject* dict);
+void dictClear(proto::ProtoContext* ctx, const proto::ProtoObject* dict);
+/** Keys in insertion order; an empty list when dict has no entries. */
+const proto::ProtoList* dictKeys(proto::ProtoContext* ctx, const proto::ProtoObject* dict);
+/** Entries as [k0, v0, k1, v1, ...] in insertion order. */
+const proto::ProtoList* dictEntries(proto::ProtoContext* ctx, const proto::ProtoObject* dict);
+/** Hash-keyed view of the entries; nullptr when dict is not dict-like. */
+const proto::ProtoSparseList* dictHashData(proto::ProtoContext* ctx, const proto::ProtoObject* dict);
+
+} // namespace protoPython
+
+#endif
@@ -31,6 +31,8 @@ public:
     const proto::ProtoList* getConstants();
     const proto::ProtoList* getNames();
     const proto::ProtoList* getBytecode();
+    /** co_exceptiontable: start, end, handler, depth per ExceptionTableEntry, innermost first. */
+    const proto::ProtoList* getExceptionTable();
 
 private:
     proto::ProtoContext* ctx_ = nullptr;
@@ -47,6 +49,7 @@ private:
     const proto::ProtoList* constants_ = nullptr;
     const proto::ProtoList* names_ = nullptr;
     const proto::ProtoList* bytecode_ = nullptr;
+    const proto::ProtoList* exceptionTable_ = nullptr;
 
     int addConstant(const proto::ProtoObject* obj);
     int addName(const std::string& name);
@@ -134,10 +137,16 @@ private:
         std::vector<int> breakPatches;
     };
     std::vector<LoopInfo> loopStack_;
+    /** Values enclosing statements keep on the value stack (for iterators, with __exit__). */
+    int stackDepth_ = 0;
+    std::vector<ExceptionTableEntry> exceptionEntries_;
+    /** Protect the instructions after the SETUP at setupOffset up to and including the POP_BLOCK at popBlockOffset. */
+    void addExceptionHandler(int setupOffset, int popBlockOffset, int handler, int depth);
 };
 
 /** Build a code object (ProtoObject with co_consts, co_names, co_code) from compiler output.
- * Optional: co_varnames (slot-ordered names), co_nparams, co_automatic_count for fast local slots. */
+ * Optional: co_varnames (slot-ordered names), co_nparams, co_automatic_count for fast local slots,
+ * and co_exceptiontable (Compiler::getExceptionTable) for table-driven exception dispatch. */
 const proto::ProtoObject* makeCodeObject(proto::ProtoContext* ctx,
     const proto::ProtoList* constants,
     const proto::ProtoList* names,
@@ -149,7 +158,8 @@ const proto::ProtoObject* makeCodeObject(proto::ProtoContext* ctx,
     int automatic_count = 0,
     int flags = 0,
     bool isGenerator = false,
-    const proto::ProtoString* co_name = nullptr);
+    const proto::ProtoString* co_name = nullptr,
+    const proto::ProtoList* exceptionTable = nullptr);
 
 /** Run a code object with the given frame. Returns execution result. */
 const proto::ProtoObject* runCodeObject(proto::ProtoContext* ctx,
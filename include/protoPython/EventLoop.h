@@ -0,0 +1,173 @@
+/*
+ * EventLoop.h
+ *
+ * Native event loop behind PythonEnvironment::runUntilComplete and the
+ * _eventloop module. Coroutines run as tasks; a task that yields a loop
+ * request (sleep, fd readiness, another task) is parked until it is satisfied
+ * and any other yielded value reschedules it at the back of the ready queue.
+ *
+ * - Ready queue: power-of-two ring buffer, O(1) push/pop.
+ * - Timers: binary min-heap keyed on a monotonic deadline.
+ * - I/O: epoll on Linux, poll() on other POSIX systems. The loop blocks there
+ *   (0% CPU) whenever nothing is ready, until the next timer, fd event or post().
+ *
+ * Task objects own their LoopTask (external pointer); the loop keeps the task
+ * objects of unfinished tasks reachable through a registry rooted in the
+ * ProtoSpace for the loop's lifetime.
+ */
+
+#ifndef PROTOPYTHON_EVENTLOOP_H
+#define PROTOPYTHON_EVENTLOOP_H
+
+#include <protoCore.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace protoPython {
+
+class PythonEnvironment;
+class EventLoop;
+
+/** FIFO queue over a power-of-two ring buffer; grows by doubling, never shrinks. */
+template<typename T>
+class RingQueue {
+public:
+    bool empty() const { return head_ == tail_; }
+    size_t size() const { return tail_ - head_; }
+
+    void push(const T& value) {
+        if (size() == slots_.size()) grow();
+        slots_[tail_++ & (slots_.size() - 1)] = value;
+    }
+
+    T pop() { return slots_[head_++ & (slots_.size() - 1)]; }
+
+private:
+    void grow() {
+        std::vector<T> next(slots_.empty() ? 64 : slots_.size() * 2);
+        const size_t n = size();
+        for (size_t i = 0; i < n; ++i) next[i] = slots_[(head_ + i) & (slots_.size() - 1)];
+        slots_.swap(next);
+        head_ = 0;
+        tail_ = n;
+    }
+
+    std::vector<T> slots_;
+    size_t head_{0};
+    size_t tail_{0};
+};
+
+/** Native state of one task; owned by its Python task object (external pointer under _handle). */
+struct LoopTask {
+    EventLoop* loop{nullptr};
+    uint64_t id{0};
+    const proto::ProtoObject* coro{nullptr};
+    const proto::ProtoObject* send{nullptr};      ///< coro.send, resolved once.
+    const proto::ProtoObject* handle{nullptr};    ///< Python task object.
+    const proto::ProtoObject* result{nullptr};
+    const proto::ProtoObject* exception{nullptr};
+    bool done{false};
+    std::vector<LoopTask*> waiters;               ///< Tasks awaiting this one.
+    std::string loopError;                        ///< RuntimeError message step() raises into the task.
+};
+
+class EventLoop {
+public:
+    EventLoop(PythonEnvironment* env, proto::ProtoContext* ctx);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /** Loop running on the calling thread, or nullptr. */
+    static EventLoop* current();
+
+    /**
+     * Run coro as a task until it finishes; returns its result. If it raises,
+     * the exception is left pending and nullptr is returned.
+     */
+    const proto::ProtoObject* runUntilComplete(const proto::ProtoObject* coro);
+
+    /** Schedule coro as a new task; returns its task object (None if coro has no send). */
+    const proto::ProtoObject* createTask(proto::ProtoContext* ctx, const proto::ProtoObject* coro);
+
+    /**
+     * Run fn on the loop thread at its next iteration. Thread-safe; wakes the loop.
+     * A post that answers an earlier holdForPost() passes releasesHold = true.
+     */
+    void post(std::function<void(proto::ProtoContext*)> fn, bool releasesHold = false);
+    /** Keep the loop waiting (instead of reporting a stall) until a matching post arrives. */
+    void holdForPost();
+
+    /** Monotonic loop clock in nanoseconds. */
+    static int64_t now();
+
+    /** Queued counts, for tests and diagnostics. */
+    size_t readyCount() const { return ready_.size(); }
+    size_t timerCount() const { return timers_.size(); }
+
+private:
+    struct ReadyEntry {
+        LoopTask* task{nullptr};
+        const proto::ProtoObject* value{nullptr};
+        bool raise{false};    ///< Throw value (null: a RuntimeError of task->loopError) into the task.
+    };
+    struct Timer {
+        int64_t deadline;
+        uint64_t seq;         ///< Insertion order; keeps equal deadlines FIFO.
+        LoopTask* task;
+        const proto::ProtoObject* value;
+    };
+    struct FdWaiters {
+        LoopTask* reader{nullptr};
+        LoopTask* writer{nullptr};
+        uint32_t registered{0};
+    };
+    struct Poller;
+
+    void step(proto::ProtoContext* ctx, const ReadyEntry& entry);
+    void park(proto::ProtoContext* ctx, LoopTask* task, const proto::ProtoObject* yielded);
+    void finish(proto::ProtoContext* ctx, LoopTask* task, const proto::ProtoObject* result, const proto::ProtoObject* exception);
+    void addTimer(LoopTask* task, int64_t deadline, const proto::ProtoObject* value);
+    void waitFd(LoopTask* task, int fd, bool write);
+    void fdReady(int fd, bool readable, bool writable, bool failed);
+    void runPosted(proto::ProtoContext* ctx);
+    void wait(int64_t timeoutNs);
+    void trackLive(proto::ProtoContext* ctx, LoopTask* task, bool live);
+    void failTask(LoopTask* task, std::string message);
+
+    PythonEnvironment* env_;
+    proto::ProtoContext* ctx_;
+    EventLoop* previous_;
+    RingQueue<ReadyEntry> ready_;
+    std::vector<Timer> timers_;
+    uint64_t timerSeq_{0};
+    std::unordered_map<int, FdWaiters> fds_;
+    size_t fdWaiterCount_{0};
+    std::unique_ptr<Poller> poller_;
+    uint64_t nextTaskId_{1};
+    const proto::ProtoObject* registry_{nullptr};
+    const proto::ProtoSparseList* live_{nullptr};
+
+    std::mutex postMutex_;
+    std::vector<std::function<void(proto::ProtoContext*)>> posted_;
+    std::atomic<bool> hasPosted_{false};
+    std::atomic<int> holds_{0};
+};
+
+namespace event_loop_module {
+
+/** Initialize the _eventloop module (run, create_task, sleep, wait_readable, wait_writable, time). */
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx);
+
+} // namespace event_loop_module
+
+} // namespace protoPython
+
+#endif
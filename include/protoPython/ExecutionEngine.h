@@ -2,6 +2,10 @@
 #define PROTOPYTHON_EXECUTIONENGINE_H
 
 #include <protoCore.h>
+#include <protoPython/InlineCache.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace protoPython {
 
@@ -203,6 +207,47 @@ constexpr int OP_POP_EXCEPT = 202;
 /** Pop module, copy all attributes to current frame (globals/locals). */
 constexpr int OP_IMPORT_STAR = 203;
 
+/*
+ * Specialized (quickened) opcodes. The interpreter writes them over a generic
+ * instruction of a DecodedCode after it has seen the same operand types for a few
+ * executions; each one guards its operand types and restores the generic opcode
+ * when the guard fails. The compiler never emits them and co_code never holds them.
+ */
+/** BINARY_ADD / INPLACE_ADD on two embedded ints. */
+constexpr int OP_BINARY_ADD_INT = 220;
+/** BINARY_ADD on two doubles. */
+constexpr int OP_BINARY_ADD_FLOAT = 221;
+/** BINARY_SUBTRACT / INPLACE_SUBTRACT on two embedded ints. */
+constexpr int OP_BINARY_SUBTRACT_INT = 222;
+/** COMPARE_OP (arg 0..5) on two embedded ints. */
+constexpr int OP_COMPARE_OP_INT = 223;
+/** BINARY_SUBSCR of an exact list by an int. */
+constexpr int OP_BINARY_SUBSCR_LIST_INT = 224;
+/** BINARY_SUBSCR of an exact dict. */
+constexpr int OP_BINARY_SUBSCR_DICT = 225;
+constexpr int OP_FIRST_SPECIALIZED = OP_BINARY_ADD_INT;
+constexpr int OP_SPECIALIZED_COUNT = 6;
+
+/*
+ * Superinstructions. decodeBytecode writes one over the first instruction of a common
+ * sequence; the instructions it covers stay in the stream unchanged (their args are
+ * the superinstruction's operands, and a jump into the middle still runs them one by
+ * one). A sequence is never fused across a jump target. Like the specialized opcodes
+ * they exist only in DecodedCode.
+ */
+/** LOAD_FAST a; LOAD_FAST b. */
+constexpr int OP_LOAD_FAST_LOAD_FAST = 226;
+/** LOAD_FAST a; LOAD_CONST c; BINARY_ADD or INPLACE_ADD; STORE_FAST d. */
+constexpr int OP_LOAD_FAST_ADD_CONST_STORE_FAST = 227;
+/** COMPARE_OP op; POP_JUMP_IF_FALSE target. The bool result is never boxed onto the stack. */
+constexpr int OP_COMPARE_OP_POP_JUMP_IF_FALSE = 228;
+
+/** Number of instructions a superinstruction covers (1 for any other opcode). */
+constexpr int superinstructionLength(int op) {
+    return op == OP_LOAD_FAST_ADD_CONST_STORE_FAST ? 4
+        : (op == OP_LOAD_FAST_LOAD_FAST || op == OP_COMPARE_OP_POP_JUMP_IF_FALSE) ? 2 : 1;
+}
+
 /**
  * @brief Executes a range of bytecode (one basic block). No per-instruction
  *        scheduler dispatch; runs until pc exits [pcStart, pcEnd] or RETURN_VALUE.
@@ -213,6 +258,20 @@ struct Block {
     size_t stackDepth;
 };
 
+/**
+ * One protected range of a code object's exception table (co_exceptiontable, emitted by
+ * the Compiler for every SETUP_FINALLY/SETUP_WITH ... POP_BLOCK pair). start and end are
+ * the bytecode list indices of the first and last protected instruction (end is the
+ * POP_BLOCK); depth is the value stack size the handler starts from. Entries are stored
+ * innermost first, so the first entry covering a pc is its handler.
+ */
+struct ExceptionTableEntry {
+    unsigned long start;
+    unsigned long end;
+    unsigned long handler;
+    size_t depth;
+};
+
 const proto::ProtoObject* executeBytecodeRange(
     proto::ProtoContext* ctx,
     const proto::ProtoList* constants,
@@ -227,6 +286,155 @@ const proto::ProtoObject* executeBytecodeRange(
     bool* yielded = nullptr,
     std::vector<Block>* externalBlockStack = nullptr);
 
+/** Decoded opcode for bytecode slots that do not hold an integer; skipped by the interpreter. */
+constexpr int OP_DECODED_SKIP = -1;
+
+/**
+ * One pre-decoded instruction: unboxed opcode and argument. op starts as the
+ * superinstruction when one was fused here, and may be rewritten to a specialized
+ * opcode while the code runs (relaxed atomic accesses); generic keeps the compiled
+ * opcode and is what analyses should read, together with fused.
+ */
+struct DecodedInstr {
+    int op;
+    int arg;
+    int cache{-1};    ///< Inline cache site index (attr or global site by opcode), -1 if none.
+    int generic{0};   ///< Decoded opcode; target of de-optimization.
+    int counter{0};   ///< Quickening warmup count; -1 once specialization is given up.
+    int deopts{0};    ///< Guard failures so far.
+    int fused{0};     ///< Superinstruction that starts here (0 if none); fixed at decode time.
+};
+
+/**
+ * Call metadata of a function code object, read once when it is decoded so that
+ * runUserFunctionCall does not look up co_* attributes per call. Empty (valid == false)
+ * for bare bytecode decoded without a code object.
+ */
+struct CodeCallInfo {
+    bool valid{false};
+    int flags{0};                  ///< co_flags.
+    int nparams{0};                ///< co_nparams.
+    int kwonly{0};                 ///< co_kwonlyargcount.
+    int automaticCount{0};         ///< co_automatic_count (slots incl. stack buffer).
+    bool isGenerator{false};       ///< co_is_generator.
+    /**
+     * Body needs its frame object: not CO_OPTIMIZED, a generator, or contains a name store/delete,
+     * *_DEREF, BUILD_FUNCTION, BUILD_CLASS or IMPORT_STAR. LOAD_NAME/LOAD_GLOBAL work without one.
+     */
+    bool needsFrame{true};
+    std::vector<const proto::ProtoObject*> varnames;  ///< co_varnames (kept alive by the code object).
+    std::unordered_map<unsigned long, int> paramSlots; ///< Name hash -> slot of each positional or keyword-only parameter.
+    /** ContextScope inputs; pinned on the code object under __co_call_names__. */
+    const proto::ProtoList* parameterNames{nullptr};
+    const proto::ProtoList* localNames{nullptr};
+};
+
+/**
+ * @brief Immutable native form of a code object's co_code, co_consts and co_names.
+ *        Instruction at bytecode list index i is instrs[i >> 1] (every instruction
+ *        occupies two list words). co_code remains the introspectable form.
+ */
+struct DecodedCode {
+    std::vector<DecodedInstr> instrs;
+    std::vector<const proto::ProtoObject*> consts;
+    std::vector<const proto::ProtoObject*> names;
+    unsigned long codeSize{0};
+    unsigned int attrCacheSites{0};    ///< LOAD_ATTR/STORE_ATTR sites.
+    unsigned int globalCacheSites{0};  ///< LOAD_NAME/LOAD_GLOBAL sites.
+    /** Inline caches; only present once attached to a code object that can pin guards. */
+    std::unique_ptr<InlineCacheTable> caches;
+    CodeCallInfo call;
+    /**
+     * True if the code object carries co_exceptiontable: SETUP_FINALLY/POP_BLOCK are then
+     * skipped and a pending exception is dispatched through exceptionTable. Otherwise
+     * (hand-built bytecode) handlers are tracked with the runtime Block stack.
+     */
+    bool staticHandlers{false};
+    std::vector<ExceptionTableEntry> exceptionTable;
+};
+
+/**
+ * Native frame of a running user function whose body never touches its frame object
+ * (see CodeCallInfo::needsFrame). The frame object is only built by materializeFrame
+ * when something observes it: sys._getframe, locals(), globals(), tracebacks.
+ */
+struct LazyFrame {
+    proto::ProtoContext* ctx{nullptr};
+    const proto::ProtoObject* code{nullptr};
+    const proto::ProtoObject* globals{nullptr};
+    const proto::ProtoObject* closure{nullptr};  ///< Function's __closure__ (nullptr if none).
+    proto::ProtoObject* frame{nullptr};          ///< Materialized frame object, once built.
+};
+
+/** Build (once) and return the frame object of lazy: frame prototype, closure, f_code, f_globals, f_locals. */
+proto::ProtoObject* materializeFrame(LazyFrame* lazy);
+
+/**
+ * Native state of a bytecode generator or coroutine, owned by the generator object
+ * (an external pointer under __gi_state__). A resume copies locals into the callee
+ * context and runs executeDecodedRange directly on stack and blocks; nothing is read
+ * from or rebuilt into attributes. gi_code, gi_frame, gi_running, gi_pc, gi_stack,
+ * gi_blocks, gi_locals and gi_yieldfrom are computed from it by descriptors on the
+ * generator prototype. While suspended, the objects it refers to are kept alive through
+ * the generator object: pins, published as __gi_pins__, holds code, frame, globals and
+ * localNames, then the saved locals (followed by the value stack for code without sized
+ * locals). A yield replaces only the entries that changed, and finishing drops all but
+ * the first four, so a suspended generator is collected with whatever refers to it.
+ */
+struct GeneratorState {
+    static constexpr size_t kFixedPins = 4;       ///< pins entries before the saved locals.
+
+    const proto::ProtoObject* code{nullptr};
+    const DecodedCode* decoded{nullptr};
+    proto::ProtoObject* frame{nullptr};
+    const proto::ProtoObject* globals{nullptr};
+    const proto::ProtoList* localNames{nullptr};  ///< Callee ContextScope local names.
+    unsigned long stackOffset{0};                 ///< First automatic slot of the value stack.
+    unsigned long pc{0};                          ///< Resume index; >= decoded->codeSize once finished.
+    bool running{false};
+    const proto::ProtoList* pins{nullptr};        ///< Current __gi_pins__ list; see above.
+    std::vector<const proto::ProtoObject*> locals; ///< Callee slots (locals, then the value stack) at the last yield.
+    std::vector<const proto::ProtoObject*> stack; ///< Value stack at the last yield.
+    std::vector<Block> blocks;
+
+    bool finished() const { return !decoded || pc >= decoded->codeSize; }
+};
+
+/** GeneratorState of a bytecode generator, or nullptr (native-callback generators, other objects). */
+GeneratorState* getGeneratorState(proto::ProtoContext* ctx, const proto::ProtoObject* gen);
+
+/** Decode bytecode/constants/names lists into a new DecodedCode (caller owns it). */
+DecodedCode* decodeBytecode(
+    proto::ProtoContext* ctx,
+    const proto::ProtoList* constants,
+    const proto::ProtoList* bytecode,
+    const proto::ProtoList* names);
+
+/**
+ * Decode a code object's co_code and attach the result to it (see makeCodeObject).
+ * Returns the attached DecodedCode: another thread's, if it attached one first.
+ */
+const DecodedCode* attachDecodedCode(proto::ProtoContext* ctx, const proto::ProtoObject* codeObj);
+
+/** Return the DecodedCode attached to codeObj, decoding and attaching it on first use. */
+const DecodedCode* getDecodedCode(proto::ProtoContext* ctx, const proto::ProtoObject* codeObj);
+
+/**
+ * @brief Same as executeBytecodeRange but runs a pre-decoded instruction stream.
+ *        pcStart/pcEnd/outPc are bytecode list indices, as in executeBytecodeRange.
+ */
+const proto::ProtoObject* executeDecodedRange(
+    proto::ProtoContext* ctx,
+    const DecodedCode* code,
+    proto::ProtoObject*& frame,
+    unsigned long pcStart,
+    unsigned long pcEnd,
+    unsigned long stackOffset = 0,
+    std::vector<const proto::ProtoObject*>* externalStack = nullptr,
+    unsigned long* outPc = nullptr,
+    bool* yielded = nullptr,
+    std::vector<Block>* externalBlockStack = nullptr);
+
 /**
  * @brief Python-compatible generator methods.
  */
@@ -237,6 +445,19 @@ const proto::ProtoObject* py_generator_send(proto::ProtoContext* ctx, const prot
 const proto::ProtoObject* py_generator_throw(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
 const proto::ProtoObject* py_generator_close(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
 
+/**
+ * @brief __get__ of the generator prototype's gi_* descriptors; args are (generator, type).
+ *        Each returns None for objects without a GeneratorState.
+ */
+const proto::ProtoObject* py_generator_gi_code(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_frame(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_running(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_pc(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_stack(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_blocks(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_locals(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+const proto::ProtoObject* py_generator_gi_yieldfrom(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+
 /**
  * @brief Executes bytecode: LOAD_CONST, RETURN_VALUE, LOAD_NAME, STORE_NAME,
  *        BINARY_ADD, BINARY_SUBTRACT, CALL_FUNCTION.
@@ -254,6 +475,42 @@ const proto::ProtoObject* executeMinimalBytecode(
     const proto::ProtoList* names,
     proto::ProtoObject*& frame);
 
+/** Total instructions dispatched so far; only accumulated when PROTO_INSTR_STATS is set. */
+unsigned long long getExecutedInstructionCount();
+
+/** Quickening counters of one specialized opcode. */
+struct SpecializationStats {
+    const char* name;
+    unsigned long long hits;      ///< Specialized executions (only accumulated when PROTO_INSTR_STATS is set).
+    unsigned long long quickens;  ///< Generic instructions rewritten to this opcode.
+    unsigned long long deopts;    ///< Guard failures that restored the generic opcode.
+};
+
+/** Counters for every specialized opcode, in opcode order. */
+std::vector<SpecializationStats> getSpecializationStats();
+
+/** Signature of native methods wrapped by ctx->fromMethod. */
+using NativeMethod = const proto::ProtoObject* (*)(proto::ProtoContext*, const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*);
+
+/**
+ * Vectorcall form of a native method: the positional arguments as a pointer + length
+ * view (CALL_FUNCTION passes the caller's value stack), no keyword arguments. The view
+ * is only valid for the duration of the call.
+ */
+using VectorcallMethod = const proto::ProtoObject* (*)(proto::ProtoContext*, const proto::ProtoObject* self,
+    const proto::ProtoObject* const* args, size_t nargs);
+
+/**
+ * Let calls that reach method (as a callable's method cell or its __call__) skip building
+ * an args ProtoList. Thread-safe; the table holds a few hundred entries and ignores
+ * registrations once full.
+ */
+void registerVectorcall(NativeMethod method, VectorcallMethod vectorcall);
+
+/** Vectorcall form registered for method, or nullptr. Lock-free. */
+VectorcallMethod findVectorcall(NativeMethod method);
+
 /** Invoke a Python callable with the given args list. Used by _thread bootstrap. */
 const proto::ProtoObject* invokePythonCallable(
     proto::ProtoContext* ctx,
@@ -0,0 +1,61 @@
+/*
+ * FlatString.h
+ *
+ * Contiguous UTF-8 text of protoCore strings, computed on demand and cached.
+ * A ProtoString is a rope of tuples: reading it as text means a
+ * toUTF8String walk into a fresh std::string, and indexing walks the rope.
+ * A FlatText holds that UTF-8 once, together with the text's kind: ASCII,
+ * where character and byte offsets coincide, or UTF-8 with a stride index
+ * (the byte offset of every kStride-th character), so turning a character
+ * index into a byte offset scans at most kStride - 1 characters.
+ *
+ * Each thread keeps a direct-mapped cache of the flat text of strings of at
+ * least kCacheMin characters, keyed by the ProtoString. A cached string is
+ * rooted by a per-thread holder in moduleRoots, so its address cannot be
+ * reused by another string while the entry exists. The cache holds at most
+ * kCacheBytes of text (a single longer text is cached alone) and is dropped
+ * when the thread exits (releaseFlatStrings). A FlatTextRef stays valid after
+ * its entry is evicted.
+ */
+
+#ifndef PROTOPYTHON_FLATSTRING_H
+#define PROTOPYTHON_FLATSTRING_H
+
+#include <protoCore.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace protoPython {
+
+struct FlatText {
+    /** Characters between stride index entries. */
+    static constexpr unsigned long kStride = 64;
+
+    std::string utf8;
+    unsigned long length{0};     ///< Characters.
+    bool ascii{true};
+    std::vector<size_t> stride;  ///< Byte offset of characters 0, kStride, 2*kStride, ... (non-ASCII only).
+
+    /** Byte offset of character index (length and beyond: utf8.size()). */
+    size_t offsetOf(unsigned long index) const;
+    /** Character index of the character starting at byte offset. */
+    unsigned long indexOf(size_t offset) const;
+    /** Byte length of the character starting at byte offset. */
+    size_t charBytes(size_t offset) const;
+
+    static std::shared_ptr<const FlatText> fromUTF8(std::string utf8);
+};
+
+using FlatTextRef = std::shared_ptr<const FlatText>;
+
+/** s's flat text, from the calling thread's cache when s is long enough to be cached. */
+FlatTextRef flatText(proto::ProtoContext* ctx, const proto::ProtoString* s);
+
+/** Drop the calling thread's flat text cache in space; called when a thread or worker exits. */
+void releaseFlatStrings(proto::ProtoSpace* space);
+
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * FutexSync.h
+ *
+ * Futex-based synchronization primitives behind _thread's Lock, RLock,
+ * Condition, Semaphore, BoundedSemaphore, Event and Barrier. Each primitive
+ * is a few 32-bit atomic words: the uncontended path is a single CAS (or one
+ * atomic read-modify-write) and never enters the kernel. Contended waits
+ * sleep on the word with FUTEX_WAIT (a short sleep-poll outside Linux) inside
+ * a BlockingRegion, so stop-the-world GC does not wait for blocked threads.
+ *
+ * Timeouts are in nanoseconds; a negative timeout waits forever. Calls that
+ * take a timeout return false when it expires. The space argument is the one
+ * to park in while sleeping (nullptr: do not park).
+ */
+
+#ifndef PROTOPYTHON_FUTEXSYNC_H
+#define PROTOPYTHON_FUTEXSYNC_H
+
+#include <protoCore.h>
+#include <atomic>
+#include <cstdint>
+
+namespace protoPython {
+
+/** Sleep while word == expected, for at most timeoutNs. May return early or spuriously. */
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs);
+
+/** Wake up to count threads sleeping on word. */
+void futexWake(std::atomic<uint32_t>& word, int count);
+
+/** Wake every thread sleeping on word. */
+void futexWakeAll(std::atomic<uint32_t>& word);
+
+/** Monotonic clock in nanoseconds, for deadlines. */
+int64_t monotonicNs();
+
+/** Non-recursive lock; any thread may unlock it (Python Lock semantics). */
+class FutexMutex {
+public:
+    bool tryLock() {
+        uint32_t expected = 0;
+        return state_.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    bool lock(proto::ProtoSpace* space, int64_t timeoutNs = -1) {
+        return tryLock() || lockSlow(space, timeoutNs);
+    }
+    /** False if it was not locked. */
+    bool unlock() {
+        const uint32_t previous = state_.exchange(0, std::memory_order_release);
+        if (previous == 2) futexWake(state_, 1);
+        return previous != 0;
+    }
+    bool isLocked() const { return state_.load(std::memory_order_relaxed) != 0; }
+
+private:
+    bool lockSlow(proto::ProtoSpace* space, int64_t timeoutNs);
+
+    std::atomic<uint32_t> state_{0};   ///< 0 free, 1 locked, 2 locked and a thread may be sleeping.
+};
+
+/** Token identifying the calling thread for recursive-lock ownership; never 0. */
+uintptr_t currentThreadToken();
+
+/** Reentrant lock owned by the thread that acquired it. */
+class FutexRecursiveMutex {
+public:
+    bool tryLock();
+    bool lock(proto::ProtoSpace* space, int64_t timeoutNs = -1);
+    /** False if the calling thread does not own it. */
+    bool unlock();
+    bool isOwned() const { return owner_.load(std::memory_order_relaxed) == currentThreadToken(); }
+    bool isLocked() const { return mutex_.isLocked(); }
+    /** Release every level held by the calling thread; returns the depth, 0 if not owned. */
+    uint32_t releaseAll();
+    /** Reacquire after releaseAll() with the saved depth. */
+    bool restore(proto::ProtoSpace* space, uint32_t depth, int64_t timeoutNs = -1);
+
+private:
+    FutexMutex mutex_;
+    std::atomic<uintptr_t> owner_{0};
+    uint32_t depth_{0};                ///< Only touched by the owner.
+};
+
+/**
+ * True when heavyBarrier() is a process-wide membarrier (Linux), so the fast
+ * side of an asymmetric Dekker handshake needs only a compiler fence.
+ */
+extern const bool g_asymmetricFences;
+
+/** Full fence on every running thread of the process (a seq_cst fence without membarrier). */
+void heavyBarrier();
+
+/** The cheap side of heavyBarrier(). */
+inline void lightBarrier() {
+    if (g_asymmetricFences) std::atomic_signal_fence(std::memory_order_seq_cst);
+    else std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/**
+ * Biased lock for native state that is usually touched by one thread. The
+ * creating thread brackets its operations with enter()/leave(): two plain
+ * stores and a compiler fence, no read-modify-write. The first lock() from
+ * another thread revokes the bias (one heavyBarrier(), then it waits out the
+ * owner's operation in flight); from then on every thread, owner included,
+ * takes the mutex. Code between enter/lock and leave/unlock must not call
+ * back into Python.
+ */
+class OwnerBias {
+public:
+    OwnerBias() : owner_(currentThreadToken()) {}
+
+    /** True: the caller owns the state until leave(). False: use lock()/unlock() instead. */
+    bool enter() {
+        const uintptr_t me = currentThreadToken();
+        if (owner_.load(std::memory_order_relaxed) != me) return false;
+        busy_.store(1, std::memory_order_relaxed);
+        lightBarrier();
+        if (owner_.load(std::memory_order_relaxed) == me) return true;
+        busy_.store(0, std::memory_order_release);
+        return false;
+    }
+    void leave() { busy_.store(0, std::memory_order_release); }
+
+    void lock(proto::ProtoSpace* space) {
+        mutex_.lock(space);
+        if (owner_.load(std::memory_order_relaxed) != 0) revoke(space);
+    }
+    void unlock() { mutex_.unlock(); }
+
+    /** True once the bias has been revoked. */
+    bool isShared() const { return owner_.load(std::memory_order_relaxed) == 0; }
+
+private:
+    void revoke(proto::ProtoSpace* space);
+
+    std::atomic<uintptr_t> owner_;     ///< Owning thread token; 0 once shared.
+    std::atomic<uint32_t> busy_{0};    ///< 1 while the owner is inside enter()/leave().
+    FutexMutex mutex_;
+};
+
+/** RAII OwnerBias access: the owner's fast path, else the lock. */
+class OwnerBiasGuard {
+public:
+    OwnerBiasGuard(OwnerBias& bias, proto::ProtoSpace* space) : bias_(bias), space_(space) { acquire(); }
+    ~OwnerBiasGuard() { release(); }
+    OwnerBiasGuard(const OwnerBiasGuard&) = delete;
+    OwnerBiasGuard& operator=(const OwnerBiasGuard&) = delete;
+
+    void acquire() {
+        owned_ = bias_.enter();
+        if (!owned_) bias_.lock(space_);
+        held_ = true;
+    }
+    /** Drop access early, e.g. to call __eq__; acquire() again before touching the state. */
+    void release() {
+        if (!held_) return;
+        if (owned_) bias_.leave();
+        else bias_.unlock();
+        held_ = false;
+    }
+
+private:
+    OwnerBias& bias_;
+    proto::ProtoSpace* space_;
+    bool owned_{false};
+    bool held_{false};
+};
+
+/** Counting semaphore; release may be capped (BoundedSemaphore). */
+class FutexSemaphore {
+public:
+    explicit FutexSemaphore(uint32_t value) : value_(value) {}
+
+    bool tryAcquire() {
+        uint32_t v = value_.load(std::memory_order_relaxed);
+        while (v > 0) {
+            if (value_.compare_exchange_weak(v, v - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+    bool acquire(proto::ProtoSpace* space, int64_t timeoutNs = -1) {
+        return tryAcquire() || acquireSlow(space, timeoutNs);
+    }
+    /** Add n permits; false (and nothing added) if that would exceed limit. */
+    bool release(uint32_t n, uint32_t limit = UINT32_MAX);
+    uint32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    bool acquireSlow(proto::ProtoSpace* space, int64_t timeoutNs);
+
+    std::atomic<uint32_t> value_;
+    std::atomic<uint32_t> waiters_{0};
+};
+
+/** Manual-reset event. */
+class FutexEvent {
+public:
+    bool isSet() const { return state_.load(std::memory_order_acquire) != 0; }
+    void set();
+    void clear() { state_.store(0, std::memory_order_release); }
+    bool wait(proto::ProtoSpace* space, int64_t timeoutNs = -1);
+
+private:
+    std::atomic<uint32_t> state_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+/**
+ * Condition variable as a sequence word. The caller holds its lock, calls
+ * prepareWait(), releases the lock, calls waitFrom() and reacquires the lock.
+ * A notify between prepareWait() and waitFrom() is not lost. A notify(n) may
+ * wake more than n waiters that were about to sleep; callers recheck their
+ * predicate, as with any condition variable.
+ */
+class FutexCondition {
+public:
+    uint32_t prepareWait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        return seq_.load(std::memory_order_seq_cst);
+    }
+    /** False on timeout. Always pairs with one prepareWait(). */
+    bool waitFrom(proto::ProtoSpace* space, uint32_t seen, int64_t timeoutNs = -1);
+    void notify(int n);
+    void notifyAll();
+
+private:
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+/**
+ * Cyclic barrier (Python threading.Barrier). The last thread to arrive gets
+ * Last from arrive(), runs the action, and calls complete() to let the
+ * others through. A timeout, abort() or failed action breaks the barrier
+ * until reset().
+ */
+class FutexBarrier {
+public:
+    enum class Result { Passed, Last, Broken };
+
+    explicit FutexBarrier(uint32_t parties) : parties_(parties) {}
+
+    /** index receives the arrival order (0 for the first thread). */
+    Result arrive(proto::ProtoSpace* space, int64_t timeoutNs, uint32_t& index);
+    /** Called by the Last thread after its action; false if the barrier broke meanwhile. */
+    bool complete(bool actionSucceeded);
+    void reset();
+    void abort();
+
+    uint32_t parties() const { return parties_; }
+    uint32_t waiting();
+    bool broken();
+
+private:
+    void breakLocked();
+
+    FutexMutex lock_;
+    const uint32_t parties_;
+    uint32_t count_{0};                ///< Arrivals this phase; guarded by lock_.
+    uint32_t lastPhase_{0};            ///< Phase the Last thread arrived in; guarded by lock_.
+    bool broken_{false};               ///< Guarded by lock_.
+    uint32_t brokenPhase_{UINT32_MAX}; ///< Phase whose waiters must report Broken; guarded by lock_.
+    std::atomic<uint32_t> phase_{0};   ///< Bumped on every pass or break; waiters sleep on it.
+};
+
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * FuturesModule.h
+ *
+ * Native _futures module: ThreadPoolExecutor, Future and parallel_map on the
+ * environment's WorkStealingScheduler. Submitting a call queues one job on the
+ * fixed worker pool; no thread is created per task.
+ */
+
+#ifndef PROTOPYTHON_FUTURESMODULE_H
+#define PROTOPYTHON_FUTURESMODULE_H
+
+#include <protoCore.h>
+
+namespace protoPython {
+namespace futures_module {
+
+/** Initialize the _futures module (ThreadPoolExecutor, Future, parallel_map). */
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx);
+
+} // namespace futures_module
+} // namespace protoPython
+
+#endif
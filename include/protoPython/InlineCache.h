@@ -0,0 +1,147 @@
+/*
+ * InlineCache.h
+ *
+ * Per-instruction inline caches for the bytecode interpreter. Each LOAD_ATTR /
+ * STORE_ATTR instruction of a decoded code object owns one AttrCacheSite. A site
+ * remembers, per receiver prototype, how the attribute resolved last time so that
+ * later executions skip PythonEnvironment::getAttribute/setAttribute. Each
+ * LOAD_NAME / LOAD_GLOBAL instruction owns one GlobalCacheSite holding the
+ * builtins binding it resolved to, guarded by the builtins module's version.
+ *
+ * Guards rely on protoCore's copy-on-write attribute storage: a mutation of an
+ * object's attributes or parents replaces the corresponding ProtoSparseList /
+ * ProtoList, so comparing those pointers detects any change to a prototype.
+ * Guarded objects are pinned on the owning code object so that a pointer can
+ * never be recycled while an entry refers to it.
+ */
+
+#ifndef PROTOPYTHON_INLINECACHE_H
+#define PROTOPYTHON_INLINECACHE_H
+
+#include <protoCore.h>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace protoPython {
+
+class PythonEnvironment;
+
+/** Snapshot of a single-inheritance prototype chain, starting at (and including) one object. */
+struct ProtoChainGuard {
+    static constexpr int kMaxDepth = 6;
+    int depth{0};
+    const proto::ProtoObject* objects[kMaxDepth]{};
+    const proto::ProtoList* parents[kMaxDepth]{};
+    const proto::ProtoSparseList* attrs[kMaxDepth]{};
+
+    /** Record the chain from first upward. False if it branches or is deeper than kMaxDepth. */
+    bool capture(proto::ProtoContext* ctx, const proto::ProtoObject* first);
+    /** True if first is the recorded head and no level changed its attributes or parents. */
+    bool matches(proto::ProtoContext* ctx, const proto::ProtoObject* first) const;
+    /** Resolve key against the recorded levels, in lookup order. */
+    const proto::ProtoObject* lookup(proto::ProtoContext* ctx, unsigned long key, bool& found) const;
+};
+
+/** How a cached attribute site resolves for one receiver prototype. */
+enum class AttrCacheKind {
+    Own,         ///< LOAD: attribute lives on the receiver itself (value read live).
+    Plain,       ///< LOAD: inherited value returned as is.
+    Method,      ///< LOAD: inherited native method, bound to the receiver.
+    Descriptor,  ///< LOAD: inherited value whose __get__ is called.
+    Store        ///< STORE: no data descriptor on the chain; plain setAttribute.
+};
+
+struct AttrCacheEntry {
+    const proto::ProtoObject* type{nullptr};       ///< Receiver's single parent (nullptr: none).
+    ProtoChainGuard typeChain;                     ///< Chain from type upward.
+    AttrCacheKind kind{AttrCacheKind::Plain};
+    const proto::ProtoObject* value{nullptr};      ///< Inherited value (Plain/Method/Descriptor).
+    ProtoChainGuard valueChain;                    ///< Value's own chain (cell Plain/Descriptor).
+    const proto::ProtoObject* getter{nullptr};     ///< __get__ of value (Descriptor).
+    const proto::ProtoObject* classValue{nullptr}; ///< Inherited __class__ (Descriptor).
+};
+
+/** Entries kept per site before it goes megamorphic. */
+constexpr int kAttrCachePolymorphic = 4;
+/** Fills (misses that rebuilt the site) allowed before a site goes megamorphic (attr and global sites). */
+constexpr int kAttrCacheMaxFills = 8;
+
+/** Immutable published state of a site; replaced wholesale on every fill. */
+struct AttrCacheState {
+    int count{0};
+    int fills{0};
+    bool megamorphic{false};
+    AttrCacheEntry entries[kAttrCachePolymorphic];
+};
+
+struct AttrCacheSite {
+    std::atomic<const AttrCacheState*> state{nullptr};
+};
+
+/**
+ * Published state of a LOAD_NAME / LOAD_GLOBAL site. Names bound in the current
+ * globals are always read live, so only the builtins fallback is cached; its
+ * version is the builtins module's attribute list (see ProtoChainGuard).
+ */
+struct GlobalCacheState {
+    int fills{0};
+    bool megamorphic{false};
+    bool valid{false};
+    ProtoChainGuard builtins;
+    const proto::ProtoObject* value{nullptr};
+};
+
+struct GlobalCacheSite {
+    std::atomic<const GlobalCacheState*> state{nullptr};
+};
+
+/**
+ * Inline cache storage of one code object. Lookups are lock-free; fills take
+ * fillMutex, publish a new AttrCacheState and retire the old one until the
+ * table is destroyed (at most kAttrCacheMaxFills per site).
+ */
+class InlineCacheTable {
+public:
+    InlineCacheTable(const proto::ProtoObject* owner, size_t attrSites, size_t globalSites);
+    ~InlineCacheTable();
+    InlineCacheTable(const InlineCacheTable&) = delete;
+    InlineCacheTable& operator=(const InlineCacheTable&) = delete;
+
+    /** LOAD_ATTR fast path. False if the generic lookup must run (out untouched). */
+    bool loadAttr(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+        const proto::ProtoObject* obj, const proto::ProtoString* name, const proto::ProtoObject*& out);
+    /** STORE_ATTR fast path. False if the generic store must run. */
+    bool storeAttr(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+        const proto::ProtoObject* obj, const proto::ProtoString* name, const proto::ProtoObject* value);
+    /**
+     * LOAD_NAME / LOAD_GLOBAL fast path for the globals-then-builtins steps of
+     * PythonEnvironment::resolve. False if resolve must run (out untouched).
+     */
+    bool loadGlobal(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+        const proto::ProtoString* name, const proto::ProtoObject*& out);
+
+private:
+    void fill(proto::ProtoContext* ctx, PythonEnvironment* env, int site, bool isStore,
+        const proto::ProtoObject* obj, const proto::ProtoString* name);
+    void fillGlobal(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+        const proto::ProtoObject* builtins, const proto::ProtoString* name);
+    void pin(proto::ProtoContext* ctx, PythonEnvironment* env,
+        std::initializer_list<const ProtoChainGuard*> guards, std::initializer_list<const proto::ProtoObject*> objects);
+
+    const proto::ProtoObject* owner_;
+    std::unique_ptr<AttrCacheSite[]> attrSites_;
+    size_t attrSiteCount_;
+    std::unique_ptr<GlobalCacheSite[]> globalSites_;
+    size_t globalSiteCount_;
+    std::mutex fillMutex_;
+    std::vector<const AttrCacheState*> retired_;
+    std::vector<const GlobalCacheState*> retiredGlobals_;
+};
+
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * ListBuffer.h
+ *
+ * Contiguous storage for lists that stay on one thread. A list normally keeps
+ * its items in a persistent ProtoList under __data__, which makes append,
+ * indexing and iteration O(log n) with node allocation on every append. Once
+ * its owner has appended enough to it, a list hands its items over to a
+ * ListBuffer: a native vector with amortized O(1) append and O(1) indexing.
+ * While it does, the list has no __data__.
+ *
+ * The buffer is guarded by an OwnerBias. The first access from another thread
+ * revokes the bias and promotes the list back to its persistent form for
+ * good, as does any reader that needs a ProtoList (a snapshot): __data__ is
+ * rebuilt from the vector and the buffer is retired. Promotion is one-way, so
+ * a list alternating appends with snapshot reads never converts back and
+ * forth.
+ *
+ * The collector does not see native memory: every kChunk items are mirrored
+ * in a persistent chunk list held by a mutable holder object (under its
+ * __data__), and the holders are listed under the list's __list_chunks__.
+ * An append updates one chunk of at most kChunk items, so its cost does not
+ * grow with the list.
+ *
+ * Code reading __data__ (or calling asList() on an object, which protoCore
+ * resolves through __data__) goes through dataAttribute() / asListData(),
+ * which promote a buffered list first.
+ */
+
+#ifndef PROTOPYTHON_LISTBUFFER_H
+#define PROTOPYTHON_LISTBUFFER_H
+
+#include <protoCore.h>
+#include <protoPython/FutexSync.h>
+#include <atomic>
+#include <vector>
+
+namespace protoPython {
+
+class ListBuffer {
+public:
+    /** Items of a chunk (one holder object) of the collector mirror. */
+    static constexpr unsigned long kChunk = 64;
+    /** Appends to lists shorter than this stay on the persistent list. */
+    static constexpr unsigned long kThawSize = 8;
+
+    explicit ListBuffer(const proto::ProtoObject* list);
+
+    /*
+     * Every operation returns false when the list has been promoted meanwhile
+     * (or is promoted now because another thread is asking): the caller then
+     * falls back to the persistent __data__.
+     */
+    bool append(proto::ProtoContext* ctx, const proto::ProtoObject* value);
+    bool extend(proto::ProtoContext* ctx, const std::vector<const proto::ProtoObject*>& values);
+    bool size(proto::ProtoContext* ctx, unsigned long* out);
+    /** *out is nullptr when index (negative counts from the end) is out of range. */
+    bool getAt(proto::ProtoContext* ctx, long index, const proto::ProtoObject** out);
+    /** *inRange is false (and nothing stored) when index is out of range. */
+    bool setAt(proto::ProtoContext* ctx, long index, const proto::ProtoObject* value, bool* inRange);
+    /** *out is nullptr when the list is empty. */
+    bool popLast(proto::ProtoContext* ctx, const proto::ProtoObject** out);
+    bool clear(proto::ProtoContext* ctx);
+    /** Append the items to out. */
+    bool copyItems(proto::ProtoContext* ctx, std::vector<const proto::ProtoObject*>* out);
+
+    /** Rebuild __data__ from the buffer and retire it; returns __data__. */
+    const proto::ProtoList* promote(proto::ProtoContext* ctx);
+    /** Retire the buffer without rebuilding __data__ (the caller is replacing it). */
+    void discard(proto::ProtoContext* ctx);
+
+    bool promoted() const { return promoted_.load(std::memory_order_acquire); }
+    const proto::ProtoObject* object() const { return list_; }
+
+    /**
+     * Hand items over to a new buffer owned by the calling thread and drop
+     * list's __data__; nullptr when the list has had a buffer before.
+     */
+    static ListBuffer* attach(proto::ProtoContext* ctx, const proto::ProtoObject* list,
+                              std::vector<const proto::ProtoObject*> items);
+
+private:
+    /** Under the guard: false when promoted, promoting first if the bias has been revoked. */
+    bool usable(proto::ProtoContext* ctx);
+    void appendLocked(proto::ProtoContext* ctx, const proto::ProtoObject* value);
+    void storeChunk(proto::ProtoContext* ctx, size_t chunk);
+    const proto::ProtoList* promoteLocked(proto::ProtoContext* ctx);
+    void retireLocked(proto::ProtoContext* ctx);
+    void publishRoots(proto::ProtoContext* ctx);
+
+    OwnerBias bias_;
+    std::atomic<bool> promoted_{false};
+    const proto::ProtoObject* list_;
+    std::vector<const proto::ProtoObject*> items_;
+    std::vector<const proto::ProtoList*> chunks_;     ///< chunks_[c] mirrors items [c*kChunk, (c+1)*kChunk).
+    std::vector<const proto::ProtoObject*> holders_;  ///< holders_[c] holds chunks_[c] for the collector.
+    const proto::ProtoList* roots_{nullptr};           ///< holders_, published under __list_chunks__.
+};
+
+/** obj's live buffer (obj has handed its __data__ over), or nullptr. */
+ListBuffer* listBuffer(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/** obj's __data__; a buffered list is promoted to its persistent form first. */
+const proto::ProtoObject* dataAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/** obj->asList(ctx), else the ProtoList under obj's __data__ (promoting a buffered list first). */
+const proto::ProtoList* asListData(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/** Replace obj's __data__, retiring a live buffer (its items are superseded). */
+void setDataAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const proto::ProtoObject* data);
+
+/*
+ * List operations that use the buffer when there is one. listAppend hands a
+ * list over to a buffer owned by the calling thread once it reaches
+ * ListBuffer::kThawSize items. All return false when obj holds no list.
+ */
+bool listAppend(proto::ProtoContext* ctx, const proto::ProtoObject* list, const proto::ProtoObject* value);
+bool listExtend(proto::ProtoContext* ctx, const proto::ProtoObject* list, const std::vector<const proto::ProtoObject*>& values);
+bool listSize(proto::ProtoContext* ctx, const proto::ProtoObject* list, unsigned long* out);
+/** *out is nullptr when index (negative counts from the end) is out of range. */
+bool listGetAt(proto::ProtoContext* ctx, const proto::ProtoObject* list, long index, const proto::ProtoObject** out);
+/** Append list's items to out, without promoting it. */
+bool listItems(proto::ProtoContext* ctx, const proto::ProtoObject* list, std::vector<const proto::ProtoObject*>* out);
+
+/** A new list object over items; buffered from the start when it is long enough to thaw. */
+const proto::ProtoObject* newListObject(proto::ProtoContext* ctx, std::vector<const proto::ProtoObject*> items);
+
+} // namespace protoPython
+
+#endif
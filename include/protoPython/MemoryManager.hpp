@@ -11,6 +11,8 @@
 #include <protoCore.h>
 #include <new>
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace protoPython {
 
@@ -22,11 +24,70 @@ inline void promote(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
         const_cast<proto::ProtoContext*>(ctx)->returnValue = obj;
 }
 
+/**
+ * Per-thread LIFO pool of fixed-size blocks. Blocks are handed out in strict stack order
+ * (RAII scopes on the C++ stack, including during unwinding), so the block at depth n is
+ * reused by every later scope at that depth instead of going through operator new/delete.
+ * Chunks are only added, never moved or freed, while the thread lives.
+ */
+template <typename Block, size_t ChunkBlocks>
+class LifoArena {
+public:
+    static LifoArena& forThread() {
+        static thread_local LifoArena arena;
+        return arena;
+    }
+
+    Block* acquire() {
+        const size_t chunk = depth_ / ChunkBlocks;
+        if (chunk == chunks_.size()) chunks_.push_back(std::make_unique<Chunk>());
+        return &chunks_[chunk]->blocks[depth_++ % ChunkBlocks];
+    }
+    /** Return the most recently acquired block. */
+    void release() { --depth_; }
+    size_t depth() const { return depth_; }
+    size_t capacity() const { return chunks_.size() * ChunkBlocks; }
+
+private:
+    struct Chunk { Block blocks[ChunkBlocks]; };
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    size_t depth_{0};
+};
+
+/** Uninitialized storage for one ProtoContext; ContextScope constructs it in place. */
+struct ContextStorage {
+    alignas(proto::ProtoContext) unsigned char bytes[sizeof(proto::ProtoContext)];
+};
+using ContextArena = LifoArena<ContextStorage, 64>;
+
+/** Value stack for code run in a context without automatic-local slots (module and class bodies). */
+struct ValueStackBlock {
+    static constexpr size_t kCapacity = 1024;
+    proto::ProtoObject* slots[kCapacity];
+};
+using ValueStackArena = LifoArena<ValueStackBlock, 8>;
+
+/** RAII lease of the calling thread's next ValueStackArena block. */
+class ValueStackLease {
+public:
+    ValueStackLease() : block_(ValueStackArena::forThread().acquire()) {}
+    ~ValueStackLease() { ValueStackArena::forThread().release(); }
+    ValueStackLease(const ValueStackLease&) = delete;
+    ValueStackLease& operator=(const ValueStackLease&) = delete;
+
+    proto::ProtoObject** data() const { return block_->slots; }
+    static constexpr size_t size() { return ValueStackBlock::kCapacity; }
+
+private:
+    ValueStackBlock* block_;
+};
+
 /**
  * RAII scope for a callee ProtoContext. On construction, pushes a new context
  * (parent = caller); on destruction, restores the thread's current context to parent
  * and destroys the callee context (GC and promotion run in ~ProtoContext).
- * Use stack-allocated storage for the context so the destructor always runs.
+ * The ProtoContext object itself lives in the thread's ContextArena, so nested calls
+ * reuse storage LIFO instead of allocating one context per call.
  */
 class ContextScope {
 public:
@@ -37,15 +98,23 @@ public:
                  const proto::ProtoList* args,
                  const proto::ProtoSparseList* kwargs)
         : parent_(parent ? parent : PythonEnvironment::getCurrentContext()) {
-        ctx_ = new proto::ProtoContext(space, parent_, parameterNames, localNames, args, kwargs);
+        ContextArena& arena = ContextArena::forThread();
+        void* storage = arena.acquire()->bytes;
+        try {
+            ctx_ = new (storage) proto::ProtoContext(space, parent_, parameterNames, localNames, args, kwargs);
+        } catch (...) {
+            arena.release();
+            throw;
+        }
         PythonEnvironment::setCurrentContext(ctx_);
     }
 
     ~ContextScope() {
         if (ctx_) {
             PythonEnvironment::setCurrentContext(parent_);
-            delete ctx_;
+            ctx_->~ProtoContext();
             ctx_ = nullptr;
+            ContextArena::forThread().release();
         }
     }
 
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -14,6 +15,9 @@
 
 namespace protoPython {
 
+struct LazyFrame;
+class WorkStealingScheduler;
+
 class PythonEnvironment {
 public:
     /**
@@ -117,18 +121,34 @@ public:
      */
     const proto::ProtoObject* resolve(const std::string& name, proto::ProtoContext* ctx = nullptr);
     const proto::ProtoObject* resolve(const proto::ProtoString* name, proto::ProtoContext* ctx = nullptr);
+    /**
+     * @brief Looks name up in the current globals, then builtins (first steps of resolve).
+     * @return True if either namespace has the name; its value (possibly null) is stored in out.
+     */
+    bool lookupNamespaces(const proto::ProtoString* name, proto::ProtoContext* ctx, const proto::ProtoObject*& out) const;
     bool isResolved(const std::string& name, proto::ProtoContext* ctx = nullptr);
     
     /**
-     * @brief Runs the event loop until the given coroutine is complete.
+     * @brief Runs a native EventLoop until the given coroutine is complete.
+     * @return The coroutine's result; None with the exception pending if it raised.
      */
     const proto::ProtoObject* runUntilComplete(const proto::ProtoObject* coro);
 
     /**
-     * @brief Schedules a coroutine task to be run by the event loop.
+     * @brief Schedules a coroutine task on this thread's running EventLoop, or on the
+     *        next runUntilComplete if none is running.
      */
     void addTask(const proto::ProtoObject* coro);
 
+    /**
+     * @brief This environment's work-stealing scheduler, started on first use with
+     *        getWorkerCount() workers in ctx's space. nullptr when the worker count is 0.
+     */
+    WorkStealingScheduler* getScheduler(proto::ProtoContext* ctx);
+
+    /** @brief Number of scheduler worker threads running (counted in ProtoSpace::runningThreads). */
+    size_t getSchedulerThreadCount() const;
+
     /**
      * @brief Accessors for frequently used dunder strings (performance).
      */
@@ -174,6 +194,8 @@ public:
     const proto::ProtoString* getGetDunderString() const { return getDunderString; }
     const proto::ProtoString* getSetDunderString() const { return setDunderString; }
     const proto::ProtoString* getDelDunderString() const { return delDunderString; }
+    const proto::ProtoString* getFileDunderString() const { return fileDunderString; }
+    const proto::ProtoString* getPathDunderString() const { return pathDunderString; }
     const proto::ProtoString* getEqString() const { return py_eq_s; }
     const proto::ProtoString* getNeString() const { return py_ne_s; }
     const proto::ProtoString* getLtString() const { return py_lt_s; }
@@ -249,6 +271,12 @@ public:
     const proto::ProtoString* getCoNameString() const { return co_name; }
     const proto::ProtoString* getCoNamesString() const { return co_names; }
     const proto::ProtoString* getCoCodeString() const { return co_code; }
+    const proto::ProtoString* getCoDecodedString() const { return co_decoded; }
+    const proto::ProtoString* getCoIcPinsString() const { return co_ic_pins; }
+    const proto::ProtoString* getCoCallNamesString() const { return co_call_names; }
+    const proto::ProtoString* getCoExceptionTableString() const { return co_exceptiontable; }
+    const proto::ProtoString* getGiStateString() const { return gi_state; }
+    const proto::ProtoString* getGiPinsString() const { return gi_pins; }
     const proto::ProtoString* getSendString() const { return sendString; }
     const proto::ProtoString* getThrowString() const { return throwString; }
     const proto::ProtoString* getCloseString() const { return closeString; }
@@ -319,6 +347,10 @@ public:
 
     const proto::ProtoString* getDataString() const { return dataString; }
     const proto::ProtoString* getKeysString() const { return keysString; }
+    const proto::ProtoString* getDictTableString() const { return dictTableString; }
+    const proto::ProtoString* getDictEntriesString() const { return dictEntriesString; }
+    const proto::ProtoString* getListBufferString() const { return listBufferString; }
+    const proto::ProtoString* getListChunksString() const { return listChunksString; }
     const proto::ProtoString* getInitString() const { return initString; }
 
     const proto::ProtoString* getStartString() const { return startString; }
@@ -342,6 +374,8 @@ public:
 
     /**
      * @brief Invalidates the import resolution cache (e.g. after module reload).
+     *        Stores to globals do not need it: cached entries only hold literal and
+     *        module results, and globals/builtins are re-checked on every lookup.
      */
     static PythonEnvironment* getCurrentEnvironment();
     void invalidateResolveCache();
@@ -456,10 +490,18 @@ public:
     static void setCurrentFrame(const proto::ProtoObject* frame);
 
     /**
-     * @brief Gets the current execution frame for the current thread.
+     * @brief Gets the current execution frame for the current thread, materializing
+     *        the running function's LazyFrame if it has not been built yet.
      */
     static const proto::ProtoObject* getCurrentFrame();
 
+    /** Current frame without materializing a LazyFrame (nullptr while one is pending). */
+    static const proto::ProtoObject* peekCurrentFrame() { return s_currentFrame; }
+
+    /** Sets the native frame getCurrentFrame materializes while no frame object is current. */
+    static void setCurrentLazyFrame(LazyFrame* frame) { s_currentLazyFrame = frame; }
+    static LazyFrame* getCurrentLazyFrame() { return s_currentLazyFrame; }
+
     /**
      * @brief Sets the current globals for the current thread.
      */
@@ -490,9 +532,41 @@ public:
     static thread_local int s_recursionDepth;
     static thread_local bool s_inRecursionError;
     static thread_local const proto::ProtoObject* s_currentFrame;
+    static thread_local LazyFrame* s_currentLazyFrame;
     static thread_local const proto::ProtoObject* s_currentGlobals;
     static thread_local const proto::ProtoObject* s_currentCodeObject;
 
+    /**
+     * @brief Address of the current thread's pending-exception slot. The interpreter reads
+     *        it once per executed range and then polls it without a per-instruction TLS lookup.
+     *        The address changes only when a PendingExceptionRoot is created or destroyed.
+     */
+    static const proto::ProtoObject* const* pendingExceptionSlot();
+
+    /**
+     * GC root of a thread's pending exception: a child context of parent with one automatic
+     * local, which becomes the thread's pending-exception slot. The collector scans it like
+     * any local, so raising and clearing are plain stores instead of moduleRoots updates.
+     * Roots nest per thread; an exception still pending on destruction moves to the
+     * enclosing root. Run code in context() so the root stays on the thread's context chain.
+     */
+    class PendingExceptionRoot {
+    public:
+        explicit PendingExceptionRoot(proto::ProtoContext* parent);
+        ~PendingExceptionRoot();
+        PendingExceptionRoot(const PendingExceptionRoot&) = delete;
+        PendingExceptionRoot& operator=(const PendingExceptionRoot&) = delete;
+
+        proto::ProtoContext* context() const { return ctx_; }
+        /** True if the current thread already has a PendingExceptionRoot. */
+        static bool active();
+
+    private:
+        proto::ProtoContext* ctx_;
+        const proto::ProtoObject** slot_;
+        PendingExceptionRoot* prev_;
+    };
+
     /**
      * @brief Returns true if there is a pending exception.
      */
@@ -599,7 +673,10 @@ private:
     bool isCompleteBlock(const std::string& code);
 
     proto::ProtoSpace* space_;
-    proto::ProtoContext* rootContext_;
+    proto::ProtoContext* baseContext_;
+    /** Main thread's pending-exception root; rootContext_ is its context. */
+    std::unique_ptr<PendingExceptionRoot> exceptionRoot_;
+    proto::ProtoContext* rootContext_{nullptr};
     const proto::ProtoObject* rangeIteratorProto{nullptr};
 
     const proto::ProtoObject* objectPrototype;
@@ -648,6 +725,8 @@ private:
     const proto::ProtoObject* systemErrorType{nullptr};
     const proto::ProtoObject* stopAsyncIterationType{nullptr};
     const proto::ProtoList* taskQueue{nullptr};
+    std::atomic<WorkStealingScheduler*> scheduler_{nullptr};
+    std::once_flag schedulerOnce_;
     const proto::ProtoString* iterString{nullptr};
     const proto::ProtoString* nextString{nullptr};
     const proto::ProtoList* emptyList{nullptr};
@@ -710,6 +789,8 @@ private:
     std::vector<const proto::ProtoTuple*> kwNamesStack;
     const proto::ProtoString* getDunderString{nullptr};
     const proto::ProtoString* setDunderString{nullptr};
+    const proto::ProtoString* fileDunderString{nullptr};
+    const proto::ProtoString* pathDunderString{nullptr};
     const proto::ProtoString* delDunderString{nullptr};
     const proto::ProtoString* __closure__{nullptr};
     const proto::ProtoString* __defaults__{nullptr};
@@ -736,6 +817,12 @@ private:
     const proto::ProtoString* co_name{nullptr};
     const proto::ProtoString* co_names{nullptr};
     const proto::ProtoString* co_code{nullptr};
+    const proto::ProtoString* co_decoded{nullptr};
+    const proto::ProtoString* co_ic_pins{nullptr};
+    const proto::ProtoString* co_call_names{nullptr};
+    const proto::ProtoString* co_exceptiontable{nullptr};
+    const proto::ProtoString* gi_state{nullptr};
+    const proto::ProtoString* gi_pins{nullptr};
     const proto::ProtoString* giNativeCallbackString{nullptr};
     const proto::ProtoString* sendString{nullptr};
     const proto::ProtoString* throwString{nullptr};
@@ -787,6 +874,10 @@ private:
     const proto::ProtoString* delItemString{nullptr};
     const proto::ProtoString* dataString{nullptr};
     const proto::ProtoString* keysString{nullptr};
+    const proto::ProtoString* dictTableString{nullptr};
+    const proto::ProtoString* dictEntriesString{nullptr};
+    const proto::ProtoString* listBufferString{nullptr};
+    const proto::ProtoString* listChunksString{nullptr};
     const proto::ProtoString* initString{nullptr};
     const proto::ProtoString* executedString{nullptr};
 
@@ -832,21 +923,28 @@ public:
     static std::thread::id s_mainThreadId;
     mutable std::recursive_mutex importLock_;
 
-    /** RAII scope for managing thread-local Python environment and context registration. */
+    /**
+     * RAII scope for managing thread-local Python environment and context registration.
+     * On a thread without a PendingExceptionRoot (a new worker) it pushes one as a child of
+     * ctx; run the thread's code in context().
+     */
     class ContextScope {
     public:
         ContextScope(PythonEnvironment* env, proto::ProtoContext* ctx) : ctx_(ctx) {
             prevEnv_ = PythonEnvironment::s_threadEnv;
             prevCtx_ = PythonEnvironment::s_threadContext;
-            PythonEnvironment::registerContext(ctx, env);
+            if (ctx && !PendingExceptionRoot::active()) exceptionRoot_ = std::make_unique<PendingExceptionRoot>(ctx);
+            PythonEnvironment::registerContext(context(), env);
         }
         ~ContextScope() {
             if (std::getenv("PROTO_THREAD_DIAG")) std::cerr << "[proto-thread] ContextScope destruction ctx=" << ctx_ << " tid=" << std::this_thread::get_id() << "\n" << std::flush;
             PythonEnvironment::s_threadEnv = prevEnv_;
             PythonEnvironment::s_threadContext = prevCtx_;
         }
+        proto::ProtoContext* context() const { return exceptionRoot_ ? exceptionRoot_->context() : ctx_; }
     private:
         proto::ProtoContext* ctx_;
+        std::unique_ptr<PendingExceptionRoot> exceptionRoot_;
         PythonEnvironment* prevEnv_;
         proto::ProtoContext* prevCtx_;
     };
@@ -860,6 +958,17 @@ public:
         PythonEnvironment* env_;
         proto::ProtoContext* ctx_;
     };
+
+    /** RAII scope that makes code the current code object and restores the previous one. */
+    class CodeObjectScope {
+    public:
+        explicit CodeObjectScope(const proto::ProtoObject* code) : oldCode_(getCurrentCodeObject()) {
+            setCurrentCodeObject(code);
+        }
+        ~CodeObjectScope() { setCurrentCodeObject(oldCode_); }
+    private:
+        const proto::ProtoObject* oldCode_;
+    };
 };
 
 } // namespace protoPython
@@ -0,0 +1,25 @@
+/*
+ * QueueModule.h
+ *
+ * Native _queue module: SimpleQueue, Queue, LifoQueue and PriorityQueue.
+ * FIFO queues are a lock-free MPMC ring buffer (grown by doubling when it
+ * fills); LIFO and priority queues keep a stack or heap under a futex lock.
+ * Blocking put/get wait on futex-backed permit counters in a BlockingRegion.
+ * Every queue also has put_many/get_many, which move a batch per call.
+ */
+
+#ifndef PROTOPYTHON_QUEUEMODULE_H
+#define PROTOPYTHON_QUEUEMODULE_H
+
+#include <protoCore.h>
+
+namespace protoPython {
+namespace queue_module {
+
+/** Initialize the _queue module (SimpleQueue, Queue, LifoQueue, PriorityQueue, Empty). */
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx);
+
+} // namespace queue_module
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * StringBuilder.h
+ *
+ * Building strings out of pieces without re-encoding the whole result for
+ * every piece. protoCore strings are ropes: ProtoString::appendLast links two
+ * strings under a new node in O(1). A StringBuilder links pieces of at least
+ * kLeaf characters as they are and packs shorter ones into UTF-8 leaves of
+ * about kLeaf characters, so the rope neither copies long pieces nor grows a
+ * node per short piece. Linked parts sit on a stack merged like a binary
+ * counter (a part is folded into the one below while that one is less than
+ * twice its size), which keeps the rope's depth logarithmic in its length.
+ *
+ * concatStrings() is str + str. Short results are built flat; longer ones
+ * continue a per-thread chain: when the left operand is the calling thread's
+ * previous concatenation result, the right operand goes into that chain's
+ * builder, so `s = s + x` in a loop costs about len(x) plus one leaf of at
+ * most kLeaf characters per iteration instead of a copy of s. The latest
+ * result is rooted by a per-thread holder in moduleRoots (the builder's parts
+ * are all reachable from it), dropped when the thread exits
+ * (releaseStringChain).
+ */
+
+#ifndef PROTOPYTHON_STRINGBUILDER_H
+#define PROTOPYTHON_STRINGBUILDER_H
+
+#include <protoCore.h>
+#include <string>
+#include <vector>
+
+namespace protoPython {
+
+class StringBuilder {
+public:
+    /** Pieces shorter than this (in characters) are packed into leaves of about this size. */
+    static constexpr unsigned long kLeaf = 512;
+
+    void append(proto::ProtoContext* ctx, const proto::ProtoString* piece);
+    /** Append UTF-8 text of chars characters (ASCII text: chars == utf8.size()). */
+    void appendUTF8(proto::ProtoContext* ctx, const std::string& utf8, unsigned long chars);
+    void appendAscii(proto::ProtoContext* ctx, const std::string& ascii) { appendUTF8(ctx, ascii, ascii.size()); }
+
+    /** The string built so far; the builder can keep appending afterwards. */
+    const proto::ProtoString* build(proto::ProtoContext* ctx);
+    /** Length in characters. */
+    unsigned long size() const { return size_; }
+
+private:
+    struct Part {
+        const proto::ProtoString* str;
+        unsigned long chars;
+    };
+
+    void flush(proto::ProtoContext* ctx);
+    void push(proto::ProtoContext* ctx, const proto::ProtoString* str, unsigned long chars);
+
+    std::vector<Part> parts_;
+    const proto::ProtoString* folded_{nullptr};  ///< parts_ linked into one rope; nullptr when stale.
+    std::string pending_;                        ///< UTF-8 of short pieces not yet in a leaf.
+    unsigned long pendingChars_{0};
+    unsigned long size_{0};
+    std::string scratch_;
+};
+
+/** a + b for two strings; continues the calling thread's chain when a is its last result. */
+const proto::ProtoObject* concatStrings(proto::ProtoContext* ctx, const proto::ProtoString* a, const proto::ProtoString* b);
+
+/** Drop the calling thread's concatenation chain in space; called when a thread or worker exits. */
+void releaseStringChain(proto::ProtoSpace* space);
+
+} // namespace protoPython
+
+#endif
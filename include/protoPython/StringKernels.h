@@ -0,0 +1,72 @@
+/*
+ * StringKernels.h
+ *
+ * Byte-level scanning kernels behind the str and bytes search, split,
+ * replace, count and case-mapping methods. They work on raw bytes (UTF-8
+ * for str): every byte they look for is ASCII, so a match never lands inside
+ * a multi-byte character.
+ *
+ * Single-byte search is memchr (memrchr backwards). The other kernels have
+ * SSE2 and AVX2 bodies chosen once at startup from the CPU (x86-64 only;
+ * elsewhere, or when built with PROTO_NO_SIMD_STRINGS, the scalar body is
+ * used). Substring search compares the needle's first and last bytes against
+ * a whole vector of candidate positions and only memcmps the positions where
+ * both match; the reverse search walks the vectors from the end.
+ *
+ * Positions are byte offsets from the start of the buffer; searches return
+ * kNotFound when there is no match.
+ */
+
+#ifndef PROTOPYTHON_STRINGKERNELS_H
+#define PROTOPYTHON_STRINGKERNELS_H
+
+#include <cstddef>
+
+namespace protoPython {
+
+constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+enum class StringKernelLevel { Scalar, SSE2, AVX2 };
+
+/** The kernel bodies in use. */
+StringKernelLevel stringKernelLevel();
+
+/** Use level, or the best one the CPU supports below it; returns the level in use. For tests and benchmarks. */
+StringKernelLevel setStringKernelLevel(StringKernelLevel level);
+
+/** First c in s[0, n). */
+size_t findChar(const char* s, size_t n, char c);
+
+/** Last c in s[0, n). */
+size_t findLastChar(const char* s, size_t n, char c);
+
+/** First needle[0, m) in s[0, n); 0 for an empty needle. */
+size_t findSubstring(const char* s, size_t n, const char* needle, size_t m);
+
+/** Last needle[0, m) in s[0, n); n for an empty needle. */
+size_t findLastSubstring(const char* s, size_t n, const char* needle, size_t m);
+
+/** Non-overlapping occurrences of needle[0, m) in s[0, n); m must be at least 1. */
+size_t countSubstring(const char* s, size_t n, const char* needle, size_t m);
+
+/** First ASCII whitespace byte (space, \t, \n, \v, \f, \r) in s[0, n). */
+size_t findWhitespace(const char* s, size_t n);
+
+/** First byte in s[0, n) that is not ASCII whitespace. */
+size_t skipWhitespace(const char* s, size_t n);
+
+/** First \n or \r in s[0, n). */
+size_t findLineBreak(const char* s, size_t n);
+
+/** Length of the leading run of ASCII (< 0x80) bytes of s[0, n). */
+size_t asciiPrefix(const char* s, size_t n);
+
+/** Map a-z to A-Z in place; other bytes are unchanged. */
+void asciiUpper(char* s, size_t n);
+
+/** Map A-Z to a-z in place; other bytes are unchanged. */
+void asciiLower(char* s, size_t n);
+
+} // namespace protoPython
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * ThreadLocal.h
+ *
+ * Native _thread._local. Each _local instance owns a slot index; each thread
+ * keeps a table of per-slot storage objects in native TLS, so reaching the
+ * calling thread's attributes is an array index instead of a dict lookup
+ * keyed by thread. Instances carry an extra, empty marker parent: the
+ * attribute inline caches skip receivers with two parents, and
+ * PythonEnvironment::getAttribute/setAttribute send their lookups and stores
+ * to the calling thread's storage object.
+ *
+ * A thread's storage objects are rooted by one holder object in moduleRoots,
+ * dropped when the thread exits (releaseThreadLocals).
+ */
+
+#ifndef PROTOPYTHON_THREADLOCAL_H
+#define PROTOPYTHON_THREADLOCAL_H
+
+#include <protoCore.h>
+
+namespace protoPython {
+
+/** The _thread._local type for ctx's space (built once per space). */
+const proto::ProtoObject* threadLocalType(proto::ProtoContext* ctx);
+
+/** True when obj is a _local instance (one null check until the first _local type is built). */
+bool isThreadLocal(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/**
+ * obj itself, or for a _local instance the calling thread's storage object.
+ * A thread's first access creates it and reruns a subclass __init__ with the
+ * constructor's arguments, as CPython does.
+ */
+const proto::ProtoObject* threadLocalStorage(proto::ProtoContext* ctx, const proto::ProtoObject* obj);
+
+/** A class built by BUILD_CLASS: if it derives from _local, construct its instances as _local instances. */
+const proto::ProtoObject* bindThreadLocalClass(proto::ProtoContext* ctx, const proto::ProtoObject* cls);
+
+/** Drop the calling thread's storage objects in space; called when a thread or worker exits. */
+void releaseThreadLocals(proto::ProtoSpace* space);
+
+} // namespace protoPython
+
+#endif
@@ -1,10 +1,20 @@
 /*
  * ThreadingStrategy.h
  *
- * Re-architecture: no mutexes in the task dispatch path. This module defines
- * the interface for bulk task submission to be backed by protoCore's native
- * Work-Stealing Scheduler once available. Until then, tasks run inline on the
- * calling thread (zero contention, no locks).
+ * Re-architecture: no mutexes in the task dispatch path. Bulk task submission
+ * is backed by a work-stealing scheduler owned by each PythonEnvironment:
+ *
+ * - One Chase–Lev deque per worker. A worker pushes and pops at the bottom of
+ *   its own deque; idle workers steal from the top of the others.
+ * - Threads that are not workers submit through a lock-free injection list
+ *   (CAS push, drained whole by whichever worker runs dry first).
+ * - Idle workers spin briefly and then park on a futex-backed epoch. A parked
+ *   worker is in a BlockingRegion, so stop-the-world GC does not wait for it.
+ * - Each worker is a ProtoSpace thread with its own registered ProtoContext.
+ *   Every job runs in a fresh child context of it.
+ *
+ * Worker count: setWorkerCount() (protopy --workers N), else PROTO_WORKERS,
+ * else std::thread::hardware_concurrency(). 0 runs every task inline.
  *
  * See docs/REARCHITECTURE_PROTOCORE.md.
  */
@@ -13,13 +23,27 @@
 #define PROTOPYTHON_THREADINGSTRATEGY_H
 
 #include <protoCore.h>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace protoPython {
 
-/** Opaque task handle for bulk bytecode execution. Fits in a single cache line when possible. */
-struct alignas(64) ExecutionTask {
+class PythonEnvironment;
+
+/**
+ * Unit of work for WorkStealingScheduler. Intrusive: callers embed or derive from it,
+ * so submitting allocates nothing. run receives a context private to this execution.
+ */
+struct SchedulerJob {
+    void (*run)(proto::ProtoContext* ctx, SchedulerJob* job){nullptr};
+    SchedulerJob* next{nullptr};      ///< Link in the scheduler's injection list.
+};
+
+/** Opaque task handle for bulk bytecode execution. Aligned so tasks never share a cache line. */
+struct alignas(64) ExecutionTask : SchedulerJob {
     proto::ProtoContext* ctx{nullptr};
     const proto::ProtoList* constants{nullptr};
     const proto::ProtoList* bytecode{nullptr};
@@ -27,27 +51,119 @@ struct alignas(64) ExecutionTask {
     proto::ProtoObject* frame{nullptr};
     uint64_t pcStart{0};
     uint64_t pcEnd{0};
-    /* Reserved for future: stack snapshot, result slot, dependency id. */
-    char padding[64 - (5 * sizeof(void*) + 2 * sizeof(uint64_t))];
+    const proto::ProtoObject* result{nullptr};   ///< Set before done; nullptr if the range raised.
+    std::atomic<uint32_t> done{0};               ///< 1 once result is published; see waitTask().
 };
 
 /**
- * Run a single task inline on the current thread. No mutex, no queue.
- * Intended to be replaced by protoCore Work-Stealing Scheduler: the scheduler
- * will pull tasks from a lock-free queue and run them on worker threads, each
- * with its own LocalHeap.
+ * Chase–Lev work-stealing deque of jobs; the ring doubles when full. push/pop
+ * are owner-only; steal may be called from any thread.
+ */
+class WorkDeque {
+public:
+    WorkDeque();
+    ~WorkDeque();
+    WorkDeque(const WorkDeque&) = delete;
+    WorkDeque& operator=(const WorkDeque&) = delete;
+
+    void push(SchedulerJob* job);
+    SchedulerJob* pop();
+    SchedulerJob* steal();
+    /** Racy size estimate; exact when only the owner is active. */
+    bool empty() const;
+
+private:
+    struct Ring;
+    Ring* grow(Ring* ring, int64_t top, int64_t bottom);
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*> ring_;
+    std::vector<std::unique_ptr<Ring>> rings_;    ///< Every ring ever used; thieves may still read old ones.
+};
+
+class WorkStealingScheduler {
+public:
+    /** Starts workerCount ProtoSpace threads in ctx's space. */
+    WorkStealingScheduler(PythonEnvironment* env, proto::ProtoContext* ctx, int workerCount);
+    /** Lets workers drain queued jobs, then joins them (in a BlockingRegion while joining). */
+    ~WorkStealingScheduler();
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    /** Queue job. Lock-free; from a worker of this scheduler it goes to that worker's own deque. */
+    void submit(SchedulerJob* job);
+
+    /** Run queued jobs on the calling worker thread while keepHelping() is true; false if not a worker. */
+    template<typename Pred>
+    bool helpWhile(Pred keepHelping) {
+        WorkerSlot* self = currentWorker();
+        if (!self) return false;
+        while (keepHelping()) {
+            SchedulerJob* job = findJob(self);
+            if (!job) return true;
+            runJob(self, job);
+        }
+        return true;
+    }
+
+    size_t workerCount() const { return workers_.size(); }
+
+    /** The scheduler whose worker is the calling thread, or nullptr. */
+    static WorkStealingScheduler* current();
+
+private:
+    struct alignas(64) WorkerSlot {
+        WorkStealingScheduler* owner{nullptr};
+        size_t index{0};
+        WorkDeque deque;
+        proto::ProtoContext* ctx{nullptr};
+        const proto::ProtoThread* thread{nullptr};
+        uint64_t stealSeed{0};
+    };
+
+    static const proto::ProtoObject* workerMain(
+        proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink* parentLink,
+        const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+    void workerLoop(WorkerSlot* self);
+    WorkerSlot* currentWorker() const;
+    SchedulerJob* findJob(WorkerSlot* self);
+    SchedulerJob* takeInjected(WorkerSlot* self);
+    bool hasWork() const;
+    void runJob(WorkerSlot* self, SchedulerJob* job);
+    void park(WorkerSlot* self);
+
+    PythonEnvironment* env_;
+    proto::ProtoContext* ctx_;
+    std::vector<std::unique_ptr<WorkerSlot>> workers_;
+    alignas(64) std::atomic<SchedulerJob*> injected_{nullptr};
+    alignas(64) std::atomic<uint32_t> wakeEpoch_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> stopping_{false};
+};
+
+/**
+ * Run a single task inline on the current thread. No mutex, no queue. Sets
+ * task->result and task->done as well as *resultOut.
  */
 void runTaskInline(ExecutionTask* task, const proto::ProtoObject** resultOut);
 
 /**
- * Submit a task for execution. Current implementation: runs inline (runTaskInline).
- * Future: push to protoCore's work-stealing queue; no mutex in submit path.
+ * Submit a task for execution. With a PythonEnvironment on this thread and a
+ * nonzero worker count, it is queued on that environment's WorkStealingScheduler
+ * and runs in a worker's context; otherwise it runs inline. Either way wait with waitTask().
  */
 void submitTask(ExecutionTask* task);
 
-/** Number of worker threads to use when protoCore scheduler is integrated. 0 = inline only. */
+/** Block until task is done (a worker helps run queued jobs instead); returns task->result. */
+const proto::ProtoObject* waitTask(ExecutionTask* task);
+
+/** Configured worker count (--workers, PROTO_WORKERS, else hardware threads). 0 = inline only. */
 int getWorkerCount();
 
+/** Override the worker count for schedulers created afterwards; negative restores the default. */
+void setWorkerCount(int count);
+
 } // namespace protoPython
 
 #endif
@@ -382,3 +382,22 @@ class _PySimpleQueue:
 
 if SimpleQueue is None:
     SimpleQueue = _PySimpleQueue
+
+# The native queues take no lock on the FIFO path and add put_many()/get_many().
+# Subclasses that override _put()/_get()/_qsize() need the pure-Python classes,
+# which stay available as _PyQueue, _PyLifoQueue and _PyPriorityQueue.
+_PyQueue = Queue
+_PyLifoQueue = LifoQueue
+_PyPriorityQueue = PriorityQueue
+try:
+    from _queue import Queue as _CQueue, LifoQueue as _CLifoQueue, PriorityQueue as _CPriorityQueue
+except ImportError:
+    pass
+else:
+    Queue = _CQueue
+    LifoQueue = _CLifoQueue
+    PriorityQueue = _CPriorityQueue
+    for _cls in (SimpleQueue, Queue, LifoQueue, PriorityQueue):
+        _cls._full_error = Full
+        _cls._shutdown_error = ShutDown
+    del _cls
@@ -847,6 +847,22 @@ class Barrier:
 class BrokenBarrierError(RuntimeError):
     pass
 
+# protoPython: the runtime's _thread provides futex-based Condition,
+# Semaphore, BoundedSemaphore, Event and Barrier; prefer them to the
+# pure-Python versions above, which stay available as _Py*.
+try:
+    from _thread import (Condition as _CCondition, Semaphore as _CSemaphore,
+                         BoundedSemaphore as _CBoundedSemaphore,
+                         Event as _CEvent, Barrier as _CBarrier)
+except ImportError:
+    pass
+else:
+    _PyCondition, _PySemaphore, _PyBoundedSemaphore = Condition, Semaphore, BoundedSemaphore
+    _PyEvent, _PyBarrier = Event, Barrier
+    Condition, Semaphore, BoundedSemaphore = _CCondition, _CSemaphore, _CBoundedSemaphore
+    Event, Barrier = _CEvent, _CBarrier
+    Barrier._broken_error = BrokenBarrierError
+
 
 # Helper to generate new thread names
 _counter = _count(1).__next__
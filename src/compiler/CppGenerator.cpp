@@ -35,6 +35,7 @@ bool CppGenerator::generate(ModuleNode* module, const std::string& filename) {
     finalOut_ << "#include <thread>\n";
     finalOut_ << "#include <protoCore.h>\n";
     finalOut_ << "#include <protoPython/PythonEnvironment.h>\n";
+    finalOut_ << "#include <protoPython/CompactDict.h>\n";
     finalOut_ << "#include <protoPython/Tokenizer.h>\n";
     finalOut_ << "#include <algorithm>\n\n";
     
@@ -230,9 +231,9 @@ bool CppGenerator::generateCall(CallNode* n) {
         for (auto& kw : n->keywords) {
             *out_ << "        __hasKw = true;\n";
             if (kw.first.empty()) {
-                *out_ << "        __kmap = ctx->dictUpdate(ctx, __kmap, (const proto::ProtoSparseList*)env->getAttr(";
+                *out_ << "        __kmap = ctx->dictUpdate(ctx, __kmap, protoPython::dictHashData(ctx, ";
                 if (!generateNode(kw.second.get())) return false;
-                *out_ << ", env->getDataString()));\n";
+                *out_ << "));\n";
             } else {
                 *out_ << "        __kmap = __kmap->setAt(ctx, ctx->fromUTF8String(\"" << kw.first << "\")->getHash(ctx), ";
                 if (!generateNode(kw.second.get())) return false;
@@ -742,9 +743,7 @@ bool CppGenerator::generateListLiteral(ListLiteralNode* n) {
 
 bool CppGenerator::generateDictLiteral(DictLiteralNode* n) {
     *out_ << "([&]() {\n";
-    *out_ << "        auto* mapObj = static_cast<const proto::ProtoObject*>(ctx->newObject(true));\n";
-    *out_ << "        auto* data = ctx->newSparseList();\n";
-    *out_ << "        auto* keys = ctx->newList();\n";
+    *out_ << "        auto* mapObj = protoPython::newDict(ctx, nullptr, " << n->keys.size() << ");\n";
     for (size_t i = 0; i < n->keys.size(); ++i) {
         if (n->keys[i] == nullptr) {
             // Unpacking: **v
@@ -761,23 +760,18 @@ bool CppGenerator::generateDictLiteral(DictLiteralNode* n) {
             *out_ << "                auto* k = env->next(i);\n";
             *out_ << "                if (!k || k == PROTO_NONE) break;\n";
             *out_ << "                auto* v = env->getItem(unpacked, k);\n";
-            *out_ << "                data = data->setAt(ctx, k->getHash(ctx), v);\n";
-            *out_ << "                keys = keys->appendLast(ctx, k);\n";
+            *out_ << "                protoPython::dictSet(ctx, mapObj, k, v);\n";
             *out_ << "            }\n";
             *out_ << "        }\n";
         } else {
             *out_ << "        {\n";
             *out_ << "            auto* k = "; if (!generateNode(n->keys[i].get())) return false; *out_ << ";\n";
             *out_ << "            auto* v = "; if (!generateNode(n->values[i].get())) return false; *out_ << ";\n";
-            *out_ << "            data = data->setAt(ctx, k->getHash(ctx), v);\n";
-            *out_ << "            keys = keys->appendLast(ctx, k);\n";
+            *out_ << "            protoPython::dictSet(ctx, mapObj, k, v);\n";
             *out_ << "        }\n";
         }
     }
-    *out_ << "        mapObj->setAttribute(ctx, env->getDataString(), (const proto::ProtoObject*)data);\n";
-    *out_ << "        mapObj->setAttribute(ctx, env->getKeysString(), (const proto::ProtoObject*)keys);\n";
-    *out_ << "        if (env->getDictPrototype()) mapObj->addParent(ctx, env->getDictPrototype());\n";
-    *out_ << "        return (const proto::ProtoObject*)mapObj;\n";
+    *out_ << "        return mapObj;\n";
     *out_ << "    })()";
     return true;
 }
@@ -7,57 +7,46 @@
 
 #include <protoPython/BasicBlockAnalysis.h>
 #include <algorithm>
+#include <memory>
 #include <unordered_set>
 
 namespace protoPython {
 
-static bool opHasArg(int op) {
-    return (op == OP_LOAD_CONST || op == OP_LOAD_NAME || op == OP_STORE_NAME ||
-            op == OP_LOAD_FAST || op == OP_STORE_FAST ||
-            op == OP_CALL_FUNCTION || op == OP_LOAD_ATTR || op == OP_STORE_ATTR ||
-            op == OP_BUILD_LIST || op == OP_BUILD_MAP || op == OP_BUILD_TUPLE ||
-            op == OP_UNPACK_SEQUENCE || op == OP_LOAD_GLOBAL || op == OP_STORE_GLOBAL ||
-            op == OP_BUILD_SLICE || op == OP_FOR_ITER || op == OP_POP_JUMP_IF_FALSE ||
-            op == OP_JUMP_ABSOLUTE || op == OP_COMPARE_OP || op == OP_BINARY_SUBSCR ||
-            op == OP_STORE_SUBSCR);
-}
-
 static bool opIsBlockEnd(int op) {
     return op == OP_RETURN_VALUE || op == OP_JUMP_ABSOLUTE ||
-           op == OP_POP_JUMP_IF_FALSE || op == OP_FOR_ITER;
+           op == OP_POP_JUMP_IF_FALSE || op == OP_FOR_ITER ||
+           op == OP_COMPARE_OP_POP_JUMP_IF_FALSE;
 }
 
-static int getOpAt(proto::ProtoContext* ctx, const proto::ProtoList* bytecode, unsigned long pc) {
-    const proto::ProtoObject* obj = bytecode->getAt(ctx, static_cast<int>(pc));
-    return (obj && obj->isInteger(ctx)) ? static_cast<int>(obj->asLong(ctx)) : -1;
+/** Opcode of the (possibly fused) instruction at instrs[k]; a superinstruction's operands follow it. */
+static int blockOp(const DecodedCode& code, unsigned long k) {
+    const DecodedInstr& instr = code.instrs[k];
+    return instr.fused ? instr.fused : instr.generic;
 }
 
-static long getArgAt(proto::ProtoContext* ctx, const proto::ProtoList* bytecode, unsigned long pc) {
-    if (pc + 1 >= bytecode->getSize(ctx)) return -1;
-    const proto::ProtoObject* obj = bytecode->getAt(ctx, static_cast<int>(pc + 1));
-    return (obj && obj->isInteger(ctx)) ? static_cast<long>(obj->asLong(ctx)) : -1;
+/** Jump target of a block-ending instruction at instrs[k]. */
+static int blockJumpTarget(const DecodedCode& code, unsigned long k) {
+    // COMPARE_OP_POP_JUMP_IF_FALSE keeps its target in the covered POP_JUMP_IF_FALSE.
+    if (code.instrs[k].fused == OP_COMPARE_OP_POP_JUMP_IF_FALSE) return code.instrs[k + 1].arg;
+    return code.instrs[k].arg;
 }
 
-std::vector<BlockBoundary> getBasicBlockBoundaries(
-    proto::ProtoContext* ctx,
-    const proto::ProtoList* bytecode) {
+std::vector<BlockBoundary> getBasicBlockBoundaries(const DecodedCode& code) {
     std::vector<BlockBoundary> out;
-    if (!ctx || !bytecode) return out;
-    unsigned long n = bytecode->getSize(ctx);
+    unsigned long n = code.codeSize;
     if (n == 0) return out;
 
+    // Every instruction is two list words (Compiler::emit), matching the interpreter's stride.
     std::unordered_set<unsigned long> blockStarts;
     blockStarts.insert(0);
 
-    for (unsigned long pc = 0; pc < n; ) {
-        int op = getOpAt(ctx, bytecode, pc);
-        if (op < 0) break;
-        if (opIsBlockEnd(op)) {
-            long arg = getArgAt(ctx, bytecode, pc);
-            if (op != OP_RETURN_VALUE && arg >= 0 && static_cast<unsigned long>(arg) < n)
-                blockStarts.insert(static_cast<unsigned long>(arg));
-        }
-        pc += opHasArg(op) ? 2 : 1;
+    for (unsigned long pc = 0; pc < n; pc += 2) {
+        int op = blockOp(code, pc >> 1);
+        if (op == OP_DECODED_SKIP) break;
+        int target = opIsBlockEnd(op) && op != OP_RETURN_VALUE ? blockJumpTarget(code, pc >> 1) : -1;
+        if (target >= 0 && static_cast<unsigned long>(target) < n)
+            blockStarts.insert(static_cast<unsigned long>(target));
+        pc += 2 * (superinstructionLength(op) - 1);
     }
 
     std::vector<unsigned long> starts(blockStarts.begin(), blockStarts.end());
@@ -66,18 +55,25 @@ std::vector<BlockBoundary> getBasicBlockBoundaries(
     for (size_t i = 0; i < starts.size(); ++i) {
         unsigned long pcStart = starts[i];
         unsigned long pcEnd = pcStart;
-        unsigned long pc = pcStart;
-        while (pc < n) {
-            int op = getOpAt(ctx, bytecode, pc);
-            if (op < 0) break;
+        for (unsigned long pc = pcStart; pc < n; pc += 2) {
+            int op = blockOp(code, pc >> 1);
+            if (op == OP_DECODED_SKIP) break;
+            // A superinstruction's block ends at the last instruction it covers.
+            pc += 2 * (superinstructionLength(op) - 1);
             pcEnd = pc;
             if (opIsBlockEnd(op)) break;
-            pc += opHasArg(op) ? 2 : 1;
         }
-        if (pcEnd >= pcStart)
-            out.push_back({pcStart, pcEnd});
+        out.push_back({pcStart, pcEnd});
     }
     return out;
 }
 
+std::vector<BlockBoundary> getBasicBlockBoundaries(
+    proto::ProtoContext* ctx,
+    const proto::ProtoList* bytecode) {
+    if (!ctx || !bytecode) return {};
+    std::unique_ptr<DecodedCode> code(decodeBytecode(ctx, nullptr, bytecode, nullptr));
+    return getBasicBlockBoundaries(*code);
+}
+
 } // namespace protoPython
@@ -0,0 +1,36 @@
+#include <protoPython/BlockingRegion.h>
+#include <protoCore.h>
+#include <proto_internal.h>
+#include <mutex>
+#include <thread>
+
+namespace protoPython {
+
+namespace {
+
+thread_local int s_blockingDepth = 0;
+
+} // anonymous namespace
+
+void enterBlockingRegion(proto::ProtoSpace* space) {
+    if (!space || s_blockingDepth++ > 0) return;
+    std::lock_guard<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
+    space->parkedThreads++;
+    space->gcCV.notify_all();
+}
+
+void leaveBlockingRegion(proto::ProtoSpace* space) {
+    if (!space || --s_blockingDepth > 0) return;
+    std::unique_lock<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
+    if (space->stwFlag.load()) space->stopTheWorldCV.wait(lock, [space] { return !space->stwFlag.load(); });
+    space->parkedThreads--;
+}
+
+void gcSafepoint(proto::ProtoContext* ctx) {
+    proto::ProtoSpace* space = ctx ? ctx->space : nullptr;
+    if (!space || !space->stwFlag.load()) return;
+    if (space->gcThread && std::this_thread::get_id() == space->gcThread->get_id()) return;
+    BlockingRegion blocking(space);
+}
+
+} // namespace protoPython
@@ -1,5 +1,9 @@
 #include <protoPython/BuiltinsModule.h>
+#include <protoPython/BlockingRegion.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadLocal.h>
+#include <protoPython/CompactDict.h>
+#include <protoPython/ListBuffer.h>
 #include <protoPython/ExecutionEngine.h>
 #include <protoPython/Parser.h>
 #include <protoPython/Compiler.h>
@@ -26,13 +30,9 @@ namespace {
 struct GlobalsScope {
     GlobalsScope(const proto::ProtoObject* g) : old(PythonEnvironment::getCurrentGlobals()) {
         PythonEnvironment::setCurrentGlobals(g);
-        PythonEnvironment* env = PythonEnvironment::getCurrentEnvironment();
-        if (env) env->invalidateResolveCache();
     }
     ~GlobalsScope() {
         PythonEnvironment::setCurrentGlobals(old);
-        PythonEnvironment* env = PythonEnvironment::getCurrentEnvironment();
-        if (env) env->invalidateResolveCache();
     }
     const proto::ProtoObject* old;
 };
@@ -136,8 +136,9 @@ static const proto::ProtoObject* py_complete(
         // If it's a dictionary-like object (like globals()), it might have a __keys__ list.
         const proto::ProtoString* keysName = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(context, "__keys__");
         const proto::ProtoObject* keysObj = obj->getAttribute(context, keysName);
-        if (keysObj && keysObj->asList(context)) {
-            const proto::ProtoList* keysList = keysObj->asList(context);
+        const proto::ProtoList* keysList = dictTable(context, obj) ? dictKeys(context, obj)
+            : (keysObj ? keysObj->asList(context) : nullptr);
+        if (keysList) {
             const proto::ProtoListIterator* it = keysList->getIterator(context);
             while (it && it->hasNext(context)) {
                 const proto::ProtoObject* keyObj = it->next(context);
@@ -206,19 +207,15 @@ static const proto::ProtoObject* py_locals(
     const proto::ProtoSparseList* keywordParameters);
 
 
-static const proto::ProtoObject* py_len(
-    proto::ProtoContext* context,
-    const proto::ProtoObject* self,
-    const proto::ParentLink* parentLink,
-    const proto::ProtoList* positionalParameters,
-    const proto::ProtoSparseList* keywordParameters) {
-    if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoObject* obj = positionalParameters->getAt(context, 0);
-    
+static const proto::ProtoObject* len_of(proto::ProtoContext* context, const proto::ProtoObject* obj) {
     if (obj->asList(context)) return context->fromInteger(obj->asList(context)->getSize(context));
+    unsigned long bufferedSize = 0;
+    if (listBuffer(context, obj) && listSize(context, obj, &bufferedSize))
+        return context->fromInteger(static_cast<long long>(bufferedSize));
     if (obj->asTuple(context)) return context->fromInteger(obj->asTuple(context)->getSize(context));
     if (obj->asSparseList(context)) return context->fromInteger(obj->asSparseList(context)->getSize(context));
     if (obj->isString(context)) return context->fromInteger(obj->asString(context)->getSize(context));
+    if (isDictLike(context, obj)) return context->fromInteger(static_cast<long long>(dictSize(context, obj)));
     
     // Fallback: count attributes (for objects acting as dicts)
     const proto::ProtoSparseList* attrs = obj->getAttributes(context);
@@ -230,6 +227,22 @@ static const proto::ProtoObject* py_len(
     return context->fromInteger(0);
 }
 
+static const proto::ProtoObject* py_len(
+    proto::ProtoContext* context,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* positionalParameters,
+    const proto::ProtoSparseList* keywordParameters) {
+    if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
+    return len_of(context, positionalParameters->getAt(context, 0));
+}
+
+static const proto::ProtoObject* py_len_vectorcall(proto::ProtoContext* context,
+    const proto::ProtoObject* self, const proto::ProtoObject* const* args, size_t nargs) {
+    if (nargs < 1) return PROTO_NONE;
+    return len_of(context, args[0]);
+}
+
 
 static const proto::ProtoObject* py_print(
     proto::ProtoContext* context,
@@ -934,7 +947,12 @@ static const proto::ProtoObject* py_input(
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
     std::istream* in = env ? env->getStdin() : &std::cin;
     std::string line;
-    if (in && std::getline(*in, line))
+    bool gotLine = false;
+    if (in) {
+        BlockingRegion reading(context->space);
+        gotLine = static_cast<bool>(std::getline(*in, line));
+    }
+    if (gotLine)
         return context->fromUTF8String(line.c_str());
     
     if (in && in->eof()) {
@@ -1007,7 +1025,7 @@ static const proto::ProtoObject* py_compile(
         std::unique_ptr<ModuleNode> mod = parser.parseModule();
         if (!mod || mod->body.empty() || !compiler.compileModule(mod.get())) return PROTO_NONE;
     }
-    return makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, false);
+    return makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
 }
 
 /** eval(expr, globals=None, locals=None): compile and run expression. */
@@ -1051,7 +1069,7 @@ static const proto::ProtoObject* py_eval(
     }
     Compiler compiler(context, "<string>");
     if (!compiler.compileExpression(expr.get())) return PROTO_NONE;
-    const proto::ProtoObject* codeObj = makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, false);
+    const proto::ProtoObject* codeObj = makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
     if (!codeObj) return PROTO_NONE;
     proto::ProtoObject* globals = nullptr;
     proto::ProtoObject* locals = nullptr;
@@ -1242,7 +1260,7 @@ static const proto::ProtoObject* py_exec(
     if (!compiler.compileModule(mod.get())) {
         return PROTO_NONE;
     }
-    const proto::ProtoObject* codeObj = makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, false);
+    const proto::ProtoObject* codeObj = makeCodeObject(context, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
     if (!codeObj) {
         return PROTO_NONE;
     }
@@ -1329,25 +1347,17 @@ static const proto::ProtoObject* py_locals(
         const proto::ProtoList* co_varnames = co_varnames_obj ? co_varnames_obj->asList(context) : nullptr;
         
         if (co_varnames) {
-            proto::ProtoObject* dict = const_cast<proto::ProtoObject*>(env && env->getDictPrototype() ? env->getDictPrototype()->newChild(context, true) : context->newObject(true));
             const proto::ProtoObject** slots = context->getAutomaticLocals();
             unsigned int nSlots = context->getAutomaticLocalsCount();
             unsigned long nNames = co_varnames->getSize(context);
             unsigned long count = (nNames < nSlots) ? nNames : nSlots;
-            
-            const proto::ProtoSparseList* data = context->newSparseList();
-            const proto::ProtoList* keys = context->newList();
+            const proto::ProtoObject* dict = newDict(context, nullptr, count);
 
             for (unsigned long i = 0; i < count; ++i) {
                 const proto::ProtoObject* name = co_varnames->getAt(context, static_cast<int>(i));
                 const proto::ProtoObject* val = slots[i];
-                if (val && name->isString(context)) {
-                    data = data->setAt(context, name->getHash(context), val);
-                    keys = keys->appendLast(context, name);
-                }
+                if (val && name->isString(context)) dictSet(context, dict, name, val);
             }
-            dict->setAttribute(context, env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__"), data->asObject(context));
-            dict->setAttribute(context, env ? env->getKeysString() : proto::ProtoString::fromUTF8String(context, "__keys__"), keys->asObject(context));
             if (env && env->getDictPrototype()) {
                 dict->setAttribute(context, env->getClassString(), env->getDictPrototype());
             }
@@ -1501,7 +1511,7 @@ static const proto::ProtoObject* py_delattr(
     const proto::ProtoObject* obj = positionalParameters->getAt(context, 0);
     const proto::ProtoObject* nameObj = positionalParameters->getAt(context, 1);
     if (!nameObj->isString(context)) return PROTO_NONE;
-    obj->setAttribute(context, nameObj->asString(context), PROTO_NONE);
+    threadLocalStorage(context, obj)->setAttribute(context, nameObj->asString(context), PROTO_NONE);
     return PROTO_NONE;
 }
 
@@ -1572,21 +1582,12 @@ static const proto::ProtoObject* py_type(
         targetClass = const_cast<proto::ProtoObject*>(targetClass->setAttribute(context, py_name, name));
 
         // Copy dictionary attributes
-        const proto::ProtoString* dataS = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-        const proto::ProtoString* keysS = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(context, "__keys__");
-        
-        const proto::ProtoObject* dataObj = dict->getAttribute(context, dataS);
-        const proto::ProtoObject* keysObj = dict->getAttribute(context, keysS);
-        
-        if (dataObj && keysObj && dataObj->asSparseList(context) && keysObj->asList(context)) {
-            const proto::ProtoSparseList* data = dataObj->asSparseList(context);
-            const proto::ProtoList* keys = keysObj->asList(context);
-            for (size_t i = 0; i < keys->getSize(context); ++i) {
-                const proto::ProtoObject* key = keys->getAt(context, i);
-                if (key->isString(context)) {
-                    const proto::ProtoObject* val = data->getAt(context, key->getHash(context));
-                    targetClass = const_cast<proto::ProtoObject*>(targetClass->setAttribute(context, key->asString(context), val));
-                }
+        const proto::ProtoList* entries = dictEntries(context, dict);
+        for (unsigned long i = 0; i + 1 < entries->getSize(context); i += 2) {
+            const proto::ProtoObject* key = entries->getAt(context, static_cast<int>(i));
+            if (key->isString(context)) {
+                targetClass = const_cast<proto::ProtoObject*>(targetClass->setAttribute(context, key->asString(context),
+                    entries->getAt(context, static_cast<int>(i + 1))));
             }
         }
 
@@ -1637,17 +1638,9 @@ static bool checkInterfaceInstanceOf(proto::ProtoContext* context, const proto::
     return obj->isInstanceOf(context, cls) == PROTO_TRUE;
 }
 
-static const proto::ProtoObject* py_isinstance(
-    proto::ProtoContext* context,
-    const proto::ProtoObject* self,
-    const proto::ParentLink* parentLink,
-    const proto::ProtoList* positionalParameters,
-    const proto::ProtoSparseList* keywordParameters) {
+static const proto::ProtoObject* isinstance_of(proto::ProtoContext* context,
+    const proto::ProtoObject* self, const proto::ProtoObject* obj, const proto::ProtoObject* cls) {
     protoPython::PythonEnvironment* env = protoPython::PythonEnvironment::fromContext(context);
-    if (positionalParameters->getSize(context) < 2) return PROTO_FALSE;
-    const proto::ProtoObject* obj = positionalParameters->getAt(context, 0);
-    const proto::ProtoObject* cls = positionalParameters->getAt(context, 1);
-    
     if (obj == PROTO_TRUE || obj == PROTO_FALSE) {
         const proto::ProtoObject* boolType = self->getAttribute(context, env ? env->getBoolTypeNameString() : proto::ProtoString::fromUTF8String(context, "bool"));
         const proto::ProtoObject* intType = self->getAttribute(context, env ? env->getIntTypeNameString() : proto::ProtoString::fromUTF8String(context, "int"));
@@ -1658,6 +1651,22 @@ static const proto::ProtoObject* py_isinstance(
     return checkInterfaceInstanceOf(context, obj, cls) ? PROTO_TRUE : PROTO_FALSE;
 }
 
+static const proto::ProtoObject* py_isinstance(
+    proto::ProtoContext* context,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* positionalParameters,
+    const proto::ProtoSparseList* keywordParameters) {
+    if (positionalParameters->getSize(context) < 2) return PROTO_FALSE;
+    return isinstance_of(context, self, positionalParameters->getAt(context, 0), positionalParameters->getAt(context, 1));
+}
+
+static const proto::ProtoObject* py_isinstance_vectorcall(proto::ProtoContext* context,
+    const proto::ProtoObject* self, const proto::ProtoObject* const* args, size_t nargs) {
+    if (nargs < 2) return PROTO_FALSE;
+    return isinstance_of(context, self, args[0], args[1]);
+}
+
 static const proto::ProtoObject* py_issubclass(
     proto::ProtoContext* context,
     const proto::ProtoObject* self,
@@ -2524,6 +2533,8 @@ const proto::ProtoObject* initialize(proto::ProtoContext* ctx, const proto::Prot
     builtins = builtins->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "in"), ctx->fromMethod(const_cast<proto::ProtoObject*>(builtins), py_contains));
     builtins = builtins->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "isinstance"), ctx->fromMethod(const_cast<proto::ProtoObject*>(builtins), py_isinstance));
     builtins = builtins->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "issubclass"), ctx->fromMethod(const_cast<proto::ProtoObject*>(builtins), py_issubclass));
+    registerVectorcall(py_len, py_len_vectorcall);
+    registerVectorcall(py_isinstance, py_isinstance_vectorcall);
     PythonEnvironment* pEnv = PythonEnvironment::fromContext(ctx);
     builtins = builtins->setAttribute(ctx, pEnv ? pEnv->getRangeString() : proto::ProtoString::fromUTF8String(ctx, "range"), ctx->fromMethod(const_cast<proto::ProtoObject*>(builtins), py_range));
     builtins = builtins->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "enumerate"), ctx->fromMethod(const_cast<proto::ProtoObject*>(builtins), py_enumerate));
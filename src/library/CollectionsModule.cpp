@@ -1,5 +1,6 @@
 #include <protoPython/CollectionsModule.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/CompactDict.h>
 #include <deque>
 #include <mutex>
 
@@ -275,15 +276,14 @@ static const proto::ProtoObject* py_deque_reverse_iterator_next(
 static const proto::ProtoObject* py_defaultdict_getitem(
     proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink*,
     const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(ctx, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(ctx, dataName);
-    if (!data || !data->asSparseList(ctx)) return PROTO_NONE;
+    if (!isDictLike(ctx, self)) return PROTO_NONE;
     if (posArgs->getSize(ctx) < 1) return PROTO_NONE;
 
     const proto::ProtoObject* key = posArgs->getAt(ctx, 0);
-    unsigned long hash = key->getHash(ctx);
-    const proto::ProtoObject* value = data->asSparseList(ctx)->getAt(ctx, hash);
+    const proto::ProtoObject* value = dictGet(ctx, self, key);
     if (value) return value;
+    protoPython::PythonEnvironment* pending = protoPython::PythonEnvironment::fromContext(ctx);
+    if (pending && pending->hasPendingException()) return PROTO_NONE;
 
     const proto::ProtoObject* factory = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "default_factory"));
     if (!factory || factory == PROTO_NONE) {
@@ -301,13 +301,7 @@ static const proto::ProtoObject* py_defaultdict_getitem(
     value = callAttr->asMethod(ctx)(ctx, factory, nullptr, empty, nullptr);
     if (!value) return PROTO_NONE;
 
-    const proto::ProtoSparseList* newSparse = data->asSparseList(ctx)->setAt(ctx, hash, value);
-    self->setAttribute(ctx, dataName, newSparse->asObject(ctx));
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(ctx, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(ctx, keysName);
-    const proto::ProtoList* keysList = keysObj && keysObj->asList(ctx) ? keysObj->asList(ctx) : ctx->newList();
-    keysList = keysList->appendLast(ctx, key);
-    self->setAttribute(ctx, keysName, keysList->asObject(ctx));
+    if (!dictSet(ctx, self, key, value)) return PROTO_NONE;
     return value;
 }
 
@@ -317,9 +311,7 @@ static const proto::ProtoObject* py_defaultdict_new(
     const proto::ProtoObject* proto = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__defaultdict_prototype__"));
     if (!proto) return PROTO_NONE;
 
-    const proto::ProtoObject* d = proto->newChild(ctx, true);
-    d = d->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"), ctx->newSparseList()->asObject(ctx));
-    d = d->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"), ctx->newList()->asObject(ctx));
+    const proto::ProtoObject* d = newDict(ctx, proto);
     const proto::ProtoObject* factory = posArgs->getSize(ctx) > 0 ? posArgs->getAt(ctx, 0) : PROTO_NONE;
     d = d->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "default_factory"), factory ? factory : PROTO_NONE);
     return d;
@@ -327,11 +319,8 @@ static const proto::ProtoObject* py_defaultdict_new(
 
 static const proto::ProtoObject* py_ordereddict_new(
     proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ParentLink*,
-    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
-    const proto::ProtoObject* d = ctx->newObject(true);
-    d = d->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"), ctx->newSparseList()->asObject(ctx));
-    d = d->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"), ctx->newList()->asObject(ctx));
-    return d;
+    const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return newDict(ctx);
 }
 
 static const proto::ProtoObject* py_deque_new(
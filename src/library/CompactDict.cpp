@@ -0,0 +1,556 @@
+#include <protoPython/CompactDict.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <atomic>
+
+namespace protoPython {
+
+namespace {
+
+enum class Eq { Equal, Unequal, Unknown };
+
+bool isNumeric(proto::ProtoContext* ctx, const proto::ProtoObject* o) {
+    return o->isInteger(ctx) || o->isDouble(ctx) || o->isBoolean(ctx);
+}
+
+double numericValue(proto::ProtoContext* ctx, const proto::ProtoObject* o) {
+    if (o->isDouble(ctx)) return o->asDouble(ctx);
+    if (o->isBoolean(ctx)) return o->asBoolean(ctx) ? 1.0 : 0.0;
+    return static_cast<double>(o->asLong(ctx));
+}
+
+/** Equality without running Python code; Unknown when __eq__ has to decide. */
+Eq nativeEqual(proto::ProtoContext* ctx, const proto::ProtoObject* a, const proto::ProtoObject* b) {
+    if (a == b) return Eq::Equal;
+    const bool aNum = isNumeric(ctx, a), bNum = isNumeric(ctx, b);
+    const bool aStr = a->isString(ctx), bStr = b->isString(ctx);
+    if (aNum && bNum) {
+        if (a->isInteger(ctx) && b->isInteger(ctx)) return a->asLong(ctx) == b->asLong(ctx) ? Eq::Equal : Eq::Unequal;
+        return numericValue(ctx, a) == numericValue(ctx, b) ? Eq::Equal : Eq::Unequal;
+    }
+    if (aStr && bStr) return a->compare(ctx, b) == 0 ? Eq::Equal : Eq::Unequal;
+    const bool aPlain = aNum || aStr || a->isNone(ctx);
+    const bool bPlain = bNum || bStr || b->isNone(ctx);
+    return aPlain && bPlain ? Eq::Unequal : Eq::Unknown;
+}
+
+/** Smallest power-of-two index (at least 8) whose two-thirds load holds n entries. */
+size_t indexSizeFor(size_t n) {
+    size_t size = 8;
+    while (size * 2 / 3 < n) size <<= 1;
+    return size;
+}
+
+void dict_table_finalizer(void* ptr) {
+    delete static_cast<DictTable*>(ptr);
+}
+
+const proto::ProtoString* tableName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getDictTableString() : proto::ProtoString::fromUTF8String(ctx, "__dict_table__");
+}
+
+const proto::ProtoString* entriesName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getDictEntriesString() : proto::ProtoString::fromUTF8String(ctx, "__dict_entries__");
+}
+
+std::atomic<size_t> s_liveTables{0};
+
+// --- Older layout: __keys__ ProtoList + __data__ ProtoSparseList keyed by hash ---
+
+const proto::ProtoString* dataName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
+}
+
+const proto::ProtoString* keysName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getKeysString() : proto::ProtoString::fromUTF8String(ctx, "__keys__");
+}
+
+const proto::ProtoSparseList* legacyData(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* dict) {
+    const proto::ProtoObject* data = dict->getAttribute(ctx, dataName(ctx, env));
+    return data && data != PROTO_NONE ? data->asSparseList(ctx) : nullptr;
+}
+
+const proto::ProtoList* legacyKeys(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* dict) {
+    const proto::ProtoObject* keys = dict->getAttribute(ctx, keysName(ctx, env));
+    const proto::ProtoList* list = keys && keys != PROTO_NONE ? keys->asList(ctx) : nullptr;
+    return list ? list : ctx->newList();
+}
+
+/** keys without the entry whose hash is hash. */
+const proto::ProtoList* withoutHash(proto::ProtoContext* ctx, const proto::ProtoList* keys, unsigned long hash) {
+    const unsigned long n = keys->getSize(ctx);
+    for (unsigned long i = 0; i < n; ++i) {
+        if (keys->getAt(ctx, static_cast<int>(i))->getHash(ctx) == hash)
+            return keys->removeAt(ctx, static_cast<int>(i));
+    }
+    return keys;
+}
+
+} // anonymous namespace
+
+// --- DictTable ---
+
+DictTable::DictTable(const proto::ProtoObject* dict, size_t capacity)
+    : dict_(dict), index_(indexSizeFor(capacity), kEmpty) {
+    entries_.reserve(capacity);
+    s_liveTables.fetch_add(1, std::memory_order_relaxed);
+}
+
+DictTable::~DictTable() {
+    s_liveTables.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t DictTable::liveCount() {
+    return s_liveTables.load(std::memory_order_relaxed);
+}
+
+void DictTable::storeEntry(proto::ProtoContext* ctx, size_t j) {
+    const size_t c = j / kChunkEntries;
+    const int at = static_cast<int>(2 * (j % kChunkEntries));
+    if (c == chunks_.size()) {
+        chunks_.push_back(ctx->newList());
+        holders_.push_back(ctx->newObject(true));
+        roots_ = (roots_ ? roots_ : ctx->newList())->appendLast(ctx, holders_.back());
+        publishRoots(ctx);
+    }
+    const Entry& e = entries_[j];
+    const proto::ProtoObject* key = e.key ? e.key : PROTO_NONE;
+    const proto::ProtoObject* value = e.key ? e.value : PROTO_NONE;
+    const proto::ProtoList* chunk = chunks_[c];
+    chunks_[c] = static_cast<unsigned long>(at) < chunk->getSize(ctx)
+        ? chunk->setAt(ctx, at, key)->setAt(ctx, at + 1, value)
+        : chunk->appendLast(ctx, key)->appendLast(ctx, value);
+    holders_[c]->setAttribute(ctx, dataName(ctx, PythonEnvironment::fromContext(ctx)), chunks_[c]->asObject(ctx));
+}
+
+void DictTable::rechunk(proto::ProtoContext* ctx) {
+    const proto::ProtoString* data = dataName(ctx, PythonEnvironment::fromContext(ctx));
+    chunks_.clear();
+    holders_.clear();
+    roots_ = viewsHolder_ ? ctx->newList()->appendLast(ctx, viewsHolder_) : nullptr;
+    for (size_t j = 0; j < entries_.size(); j += kChunkEntries) {
+        const proto::ProtoList* chunk = ctx->newList();
+        for (size_t k = j; k < std::min(entries_.size(), j + kChunkEntries); ++k) {
+            const Entry& e = entries_[k];
+            chunk = chunk->appendLast(ctx, e.key ? e.key : PROTO_NONE)->appendLast(ctx, e.key ? e.value : PROTO_NONE);
+        }
+        const proto::ProtoObject* holder = ctx->newObject(true);
+        holder->setAttribute(ctx, data, chunk->asObject(ctx));
+        chunks_.push_back(chunk);
+        holders_.push_back(holder);
+        roots_ = (roots_ ? roots_ : ctx->newList())->appendLast(ctx, holder);
+    }
+    publishRoots(ctx);
+}
+
+void DictTable::publishRoots(proto::ProtoContext* ctx) {
+    dict_->setAttribute(ctx, entriesName(ctx, PythonEnvironment::fromContext(ctx)), roots_ ? roots_->asObject(ctx) : nullptr);
+}
+
+template<typename T>
+void DictTable::cache(std::atomic<const T*>& view, Root root, const T* value, proto::ProtoContext* ctx) {
+    if (!viewsHolder_) {
+        viewsHolder_ = ctx->newObject(true);
+        viewRoots_ = ctx->newList();
+        for (int r = 0; r < kRootCount; ++r) viewRoots_ = viewRoots_->appendLast(ctx, PROTO_NONE);
+        roots_ = (roots_ ? roots_ : ctx->newList())->appendLast(ctx, viewsHolder_);
+        publishRoots(ctx);
+    }
+    viewRoots_ = viewRoots_->setAt(ctx, root, value ? value->asObject(ctx) : PROTO_NONE);
+    viewsHolder_->setAttribute(ctx, dataName(ctx, PythonEnvironment::fromContext(ctx)), viewRoots_->asObject(ctx));
+    view.store(value, std::memory_order_release);
+}
+
+void DictTable::invalidate(proto::ProtoContext* ctx, bool keysChanged) {
+    // Only views that were cached have a root to drop.
+    if (entriesView_.load(std::memory_order_relaxed)) cache<proto::ProtoList>(entriesView_, kEntriesRoot, nullptr, ctx);
+    if (hashDataView_.load(std::memory_order_relaxed)) cache<proto::ProtoSparseList>(hashDataView_, kHashDataRoot, nullptr, ctx);
+    if (keysChanged && keysView_.load(std::memory_order_relaxed)) cache<proto::ProtoList>(keysView_, kKeysRoot, nullptr, ctx);
+}
+
+void DictTable::buildSharedIndex(proto::ProtoContext* ctx) {
+    const proto::ProtoSparseList* index = ctx->newSparseList();
+    for (const Entry& e : entries_) {
+        if (!e.key) continue;
+        index = index->has(ctx, e.hash) ? index->setAt(ctx, e.hash, PROTO_NONE)
+            : index->setAt(ctx, e.hash, ctx->newList()->appendLast(ctx, e.key)->appendLast(ctx, e.value)->asObject(ctx));
+    }
+    cache(sharedIndex_, kSharedIndexRoot, index, ctx);
+}
+
+void DictTable::indexWrite(proto::ProtoContext* ctx, Write write, unsigned long hash,
+                           const proto::ProtoObject* key, const proto::ProtoObject* value) {
+    const proto::ProtoSparseList* index = sharedIndex_.load(std::memory_order_relaxed);
+    if (!index) {
+        if (bias_.isShared()) buildSharedIndex(ctx);
+        return;
+    }
+    const proto::ProtoObject* current = index->has(ctx, hash) ? index->getAt(ctx, hash) : nullptr;
+    switch (write) {
+    case Write::Insert:
+        index = current ? index->setAt(ctx, hash, PROTO_NONE)
+            : index->setAt(ctx, hash, ctx->newList()->appendLast(ctx, key)->appendLast(ctx, value)->asObject(ctx));
+        break;
+    case Write::Overwrite:
+        if (current == PROTO_NONE) return;
+        index = index->setAt(ctx, hash, ctx->newList()->appendLast(ctx, key)->appendLast(ctx, value)->asObject(ctx));
+        break;
+    case Write::Remove:
+        if (current != PROTO_NONE) {
+            index = index->removeAt(ctx, hash);
+            break;
+        }
+        {
+            // The hash was shared: keep the marker unless one key is left.
+            const Entry* only = nullptr;
+            size_t left = 0;
+            for (const Entry& e : entries_) {
+                if (e.key && e.hash == hash) {
+                    only = &e;
+                    ++left;
+                }
+            }
+            if (left > 1) return;
+            index = only ? index->setAt(ctx, hash, ctx->newList()->appendLast(ctx, only->key)->appendLast(ctx, only->value)->asObject(ctx))
+                : index->removeAt(ctx, hash);
+        }
+        break;
+    }
+    cache(sharedIndex_, kSharedIndexRoot, index, ctx);
+}
+
+bool DictTable::sharedGet(proto::ProtoContext* ctx, const proto::ProtoObject* key, unsigned long hash,
+                          const proto::ProtoObject*& out) const {
+    const proto::ProtoSparseList* index = sharedIndex_.load(std::memory_order_acquire);
+    if (!index) return false;
+    if (!index->has(ctx, hash)) {
+        out = nullptr;
+        return true;
+    }
+    const proto::ProtoObject* found = index->getAt(ctx, hash);
+    if (found == PROTO_NONE) return false;  // Several keys share the hash.
+    const proto::ProtoList* pair = found->asList(ctx);
+    const proto::ProtoObject* candidate = pair->getAt(ctx, 0);
+    const Eq eq = nativeEqual(ctx, candidate, key);
+    if (eq == Eq::Unknown) return false;    // __eq__ has to decide: take the locked path.
+    out = eq == Eq::Equal ? pair->getAt(ctx, 1) : nullptr;
+    return true;
+}
+
+DictTable::Probe DictTable::probe(proto::ProtoContext* ctx, const proto::ProtoObject* key, unsigned long hash,
+                                  const proto::ProtoObject* equalKey,
+                                  const std::vector<const proto::ProtoObject*>& unequal) const {
+    const size_t mask = index_.size() - 1;
+    size_t i = hash & mask;
+    size_t perturb = hash;
+    size_t firstDummy = SIZE_MAX;
+    for (;;) {
+        const int32_t ix = index_[i];
+        if (ix == kEmpty) return {Match::Missing, firstDummy != SIZE_MAX ? firstDummy : i, kEmpty};
+        if (ix == kDummy) {
+            if (firstDummy == SIZE_MAX) firstDummy = i;
+        } else {
+            const Entry& e = entries_[ix];
+            if (e.key == key || (equalKey && e.key == equalKey)) return {Match::Found, i, ix};
+            if (e.hash == hash) {
+                const Eq eq = nativeEqual(ctx, e.key, key);
+                if (eq == Eq::Equal) return {Match::Found, i, ix};
+                if (eq == Eq::Unknown && std::find(unequal.begin(), unequal.end(), e.key) == unequal.end())
+                    return {Match::Ask, i, ix};
+            }
+        }
+        perturb >>= 5;
+        i = (i * 5 + perturb + 1) & mask;
+    }
+}
+
+bool DictTable::locate(proto::ProtoContext* ctx, OwnerBiasGuard& guard, const proto::ProtoObject* key,
+                       unsigned long hash, Probe& out) {
+    const proto::ProtoObject* equalKey = nullptr;
+    std::vector<const proto::ProtoObject*> unequal;
+    for (;;) {
+        out = probe(ctx, key, hash, equalKey, unequal);
+        if (out.match != Match::Ask) return true;
+
+        // __eq__ may run Python code, which may touch this dict: call it with the table
+        // released and start over if the entries moved meanwhile.
+        const proto::ProtoObject* candidate = entries_[out.entry].key;
+        const uint64_t seen = version_;
+        guard.release();
+        PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+        const bool wasPending = env && env->hasPendingException();
+        const bool equal = env ? env->objectsEqual(ctx, candidate, key) : candidate->compare(ctx, key) == 0;
+        const bool raised = env && !wasPending && env->hasPendingException();
+        guard.acquire();
+        if (raised) return false;
+        if (version_ != seen) {
+            equalKey = nullptr;
+            unequal.clear();
+        } else if (equal) {
+            equalKey = candidate;
+        } else {
+            unequal.push_back(candidate);
+        }
+    }
+}
+
+size_t DictTable::freeSlot(unsigned long hash) const {
+    const size_t mask = index_.size() - 1;
+    size_t i = hash & mask;
+    size_t perturb = hash;
+    while (index_[i] != kEmpty) {
+        perturb >>= 5;
+        i = (i * 5 + perturb + 1) & mask;
+    }
+    return i;
+}
+
+void DictTable::rebuild(proto::ProtoContext* ctx, size_t indexSize) {
+    const size_t before = entries_.size();
+    if (live_ != before)
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& e) { return !e.key; }),
+                       entries_.end());
+    index_.assign(indexSize, kEmpty);
+    for (size_t j = 0; j < entries_.size(); ++j) index_[freeSlot(entries_[j].hash)] = static_cast<int32_t>(j);
+    entries_.reserve(indexSize * 2 / 3);
+    // Entries only move when holes were dropped; otherwise the chunks still match.
+    if (entries_.size() != before) rechunk(ctx);
+    ++version_;
+}
+
+void DictTable::removeAt(proto::ProtoContext* ctx, const Probe& p) {
+    const Entry removed = entries_[p.entry];
+    --live_;
+    ++version_;
+    if (live_ == 0) {
+        // Emptied: start over rather than keep a table of holes (queue-like use).
+        entries_.clear();
+        std::fill(index_.begin(), index_.end(), kEmpty);
+        rechunk(ctx);
+    } else {
+        index_[p.slot] = kDummy;
+        entries_[p.entry] = {0, nullptr, nullptr};
+        storeEntry(ctx, p.entry);
+    }
+    invalidate(ctx, true);
+    indexWrite(ctx, Write::Remove, removed.hash, removed.key, nullptr);
+}
+
+const proto::ProtoObject* DictTable::get(proto::ProtoContext* ctx, const proto::ProtoObject* key) {
+    const unsigned long hash = key->getHash(ctx);
+    const proto::ProtoObject* value = nullptr;
+    if (bias_.isShared() && sharedGet(ctx, key, hash, value)) return value;
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (bias_.isShared() && !sharedIndex_.load(std::memory_order_relaxed)) buildSharedIndex(ctx);
+    Probe p;
+    if (!locate(ctx, guard, key, hash, p) || p.match != Match::Found) return nullptr;
+    return entries_[p.entry].value;
+}
+
+bool DictTable::set(proto::ProtoContext* ctx, const proto::ProtoObject* key, const proto::ProtoObject* value) {
+    const unsigned long hash = key->getHash(ctx);
+    OwnerBiasGuard guard(bias_, ctx->space);
+    Probe p;
+    if (!locate(ctx, guard, key, hash, p)) return false;
+    if (p.match == Match::Found) {
+        entries_[p.entry].value = value;
+        storeEntry(ctx, p.entry);
+        invalidate(ctx, false);
+        indexWrite(ctx, Write::Overwrite, hash, entries_[p.entry].key, value);
+        return true;
+    }
+    size_t slot = p.slot;
+    if (entries_.size() >= index_.size() * 2 / 3) {
+        rebuild(ctx, indexSizeFor(2 * (live_ + 1)));
+        slot = freeSlot(hash);
+    }
+    index_[slot] = static_cast<int32_t>(entries_.size());
+    entries_.push_back({hash, key, value});
+    storeEntry(ctx, entries_.size() - 1);
+    ++live_;
+    ++version_;
+    invalidate(ctx, true);
+    indexWrite(ctx, Write::Insert, hash, key, value);
+    return true;
+}
+
+const proto::ProtoObject* DictTable::pop(proto::ProtoContext* ctx, const proto::ProtoObject* key) {
+    const unsigned long hash = key->getHash(ctx);
+    OwnerBiasGuard guard(bias_, ctx->space);
+    Probe p;
+    if (!locate(ctx, guard, key, hash, p) || p.match != Match::Found) return nullptr;
+    const proto::ProtoObject* value = entries_[p.entry].value;
+    removeAt(ctx, p);
+    return value;
+}
+
+bool DictTable::popLast(proto::ProtoContext* ctx, const proto::ProtoObject** key, const proto::ProtoObject** value) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (live_ == 0) return false;
+    size_t j = entries_.size();
+    while (!entries_[j - 1].key) --j;
+    const Entry last = entries_[j - 1];
+    const Probe p = probe(ctx, last.key, last.hash, last.key, {});
+    *key = last.key;
+    *value = last.value;
+    removeAt(ctx, p);
+    return true;
+}
+
+void DictTable::clear(proto::ProtoContext* ctx) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    entries_.clear();
+    index_.assign(indexSizeFor(0), kEmpty);
+    rechunk(ctx);
+    live_ = 0;
+    ++version_;
+    invalidate(ctx, true);
+    if (sharedIndex_.load(std::memory_order_relaxed) || bias_.isShared())
+        cache(sharedIndex_, kSharedIndexRoot, ctx->newSparseList(), ctx);
+}
+
+unsigned long DictTable::size(proto::ProtoContext* ctx) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    return live_;
+}
+
+const proto::ProtoList* DictTable::entries(proto::ProtoContext* ctx) {
+    if (const proto::ProtoList* view = entriesView_.load(std::memory_order_acquire)) return view;
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (const proto::ProtoList* view = entriesView_.load(std::memory_order_relaxed)) return view;
+    const proto::ProtoList* list = ctx->newList();
+    for (const Entry& e : entries_) {
+        if (e.key) list = list->appendLast(ctx, e.key)->appendLast(ctx, e.value);
+    }
+    cache(entriesView_, kEntriesRoot, list, ctx);
+    return list;
+}
+
+const proto::ProtoList* DictTable::keys(proto::ProtoContext* ctx) {
+    if (const proto::ProtoList* view = keysView_.load(std::memory_order_acquire)) return view;
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (const proto::ProtoList* view = keysView_.load(std::memory_order_relaxed)) return view;
+    const proto::ProtoList* keys = ctx->newList();
+    for (const Entry& e : entries_) {
+        if (e.key) keys = keys->appendLast(ctx, e.key);
+    }
+    cache(keysView_, kKeysRoot, keys, ctx);
+    return keys;
+}
+
+const proto::ProtoSparseList* DictTable::hashData(proto::ProtoContext* ctx) {
+    if (const proto::ProtoSparseList* view = hashDataView_.load(std::memory_order_acquire)) return view;
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (const proto::ProtoSparseList* view = hashDataView_.load(std::memory_order_relaxed)) return view;
+    const proto::ProtoSparseList* data = ctx->newSparseList();
+    for (const Entry& e : entries_) {
+        if (e.key) data = data->setAt(ctx, e.hash, e.value);
+    }
+    cache(hashDataView_, kHashDataRoot, data, ctx);
+    return data;
+}
+
+// --- Free functions ---
+
+const proto::ProtoObject* newDict(proto::ProtoContext* ctx, const proto::ProtoObject* parent, size_t capacity) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!parent && env) parent = env->getDictPrototype();
+    const proto::ProtoObject* dict = ctx->newObject(true);
+    if (parent) dict = dict->addParent(ctx, parent);
+    DictTable* table = new DictTable(dict, capacity);
+    dict = dict->setAttribute(ctx, tableName(ctx, env), ctx->fromExternalPointer(table, dict_table_finalizer));
+    return dict;
+}
+
+DictTable* dictTable(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!obj || obj == PROTO_NONE) return nullptr;
+    const proto::ProtoObject* handle = obj->getAttribute(ctx, tableName(ctx, PythonEnvironment::fromContext(ctx)));
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    DictTable* table = ext ? static_cast<DictTable*>(ext->getPointer(ctx)) : nullptr;
+    // A child of a dict object inherits the attribute but not the table.
+    return table && table->object() == obj ? table : nullptr;
+}
+
+bool isDictLike(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (dictTable(ctx, obj)) return true;
+    return obj && obj != PROTO_NONE && legacyData(ctx, PythonEnvironment::fromContext(ctx), obj);
+}
+
+const proto::ProtoObject* dictGet(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->get(ctx, key);
+    const proto::ProtoSparseList* data = legacyData(ctx, PythonEnvironment::fromContext(ctx), dict);
+    const unsigned long hash = key->getHash(ctx);
+    return data && data->has(ctx, hash) ? data->getAt(ctx, hash) : nullptr;
+}
+
+bool dictSet(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key, const proto::ProtoObject* value) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->set(ctx, key, value);
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoSparseList* data = legacyData(ctx, env, dict);
+    if (!data) return true;
+    const unsigned long hash = key->getHash(ctx);
+    const bool hadKey = data->has(ctx, hash);
+    dict->setAttribute(ctx, dataName(ctx, env), data->setAt(ctx, hash, value)->asObject(ctx));
+    if (!hadKey)
+        dict->setAttribute(ctx, keysName(ctx, env), legacyKeys(ctx, env, dict)->appendLast(ctx, key)->asObject(ctx));
+    return true;
+}
+
+const proto::ProtoObject* dictPop(proto::ProtoContext* ctx, const proto::ProtoObject* dict, const proto::ProtoObject* key) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->pop(ctx, key);
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoSparseList* data = legacyData(ctx, env, dict);
+    const unsigned long hash = key->getHash(ctx);
+    if (!data || !data->has(ctx, hash)) return nullptr;
+    const proto::ProtoObject* value = data->getAt(ctx, hash);
+    dict->setAttribute(ctx, dataName(ctx, env), data->removeAt(ctx, hash)->asObject(ctx));
+    dict->setAttribute(ctx, keysName(ctx, env), withoutHash(ctx, legacyKeys(ctx, env, dict), hash)->asObject(ctx));
+    return value;
+}
+
+unsigned long dictSize(proto::ProtoContext* ctx, const proto::ProtoObject* dict) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->size(ctx);
+    const proto::ProtoSparseList* data = legacyData(ctx, PythonEnvironment::fromContext(ctx), dict);
+    return data ? data->getSize(ctx) : 0;
+}
+
+void dictClear(proto::ProtoContext* ctx, const proto::ProtoObject* dict) {
+    if (DictTable* table = dictTable(ctx, dict)) {
+        table->clear(ctx);
+        return;
+    }
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    dict->setAttribute(ctx, keysName(ctx, env), ctx->newList()->asObject(ctx));
+    dict->setAttribute(ctx, dataName(ctx, env), ctx->newSparseList()->asObject(ctx));
+}
+
+const proto::ProtoList* dictKeys(proto::ProtoContext* ctx, const proto::ProtoObject* dict) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->keys(ctx);
+    return legacyKeys(ctx, PythonEnvironment::fromContext(ctx), dict);
+}
+
+const proto::ProtoList* dictEntries(proto::ProtoContext* ctx, const proto::ProtoObject* dict) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->entries(ctx);
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoList* out = ctx->newList();
+    const proto::ProtoSparseList* data = legacyData(ctx, env, dict);
+    if (!data) return out;
+    const proto::ProtoList* keys = legacyKeys(ctx, env, dict);
+    const unsigned long n = keys->getSize(ctx);
+    for (unsigned long i = 0; i < n; ++i) {
+        const proto::ProtoObject* key = keys->getAt(ctx, static_cast<int>(i));
+        const proto::ProtoObject* value = data->getAt(ctx, key->getHash(ctx));
+        out = out->appendLast(ctx, key)->appendLast(ctx, value ? value : PROTO_NONE);
+    }
+    return out;
+}
+
+const proto::ProtoSparseList* dictHashData(proto::ProtoContext* ctx, const proto::ProtoObject* dict) {
+    if (DictTable* table = dictTable(ctx, dict)) return table->hashData(ctx);
+    if (!dict || dict == PROTO_NONE) return nullptr;
+    return legacyData(ctx, PythonEnvironment::fromContext(ctx), dict);
+}
+
+} // namespace protoPython
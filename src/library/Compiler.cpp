@@ -142,6 +142,26 @@ const proto::ProtoList* Compiler::getBytecode() {
     return bytecode_;
 }
 
+const proto::ProtoList* Compiler::getExceptionTable() {
+    if (!exceptionTable_) {
+        exceptionTable_ = ctx_->newList();
+        for (const ExceptionTableEntry& e : exceptionEntries_) {
+            exceptionTable_ = exceptionTable_
+                ->appendLast(ctx_, ctx_->fromInteger(static_cast<long long>(e.start)))
+                ->appendLast(ctx_, ctx_->fromInteger(static_cast<long long>(e.end)))
+                ->appendLast(ctx_, ctx_->fromInteger(static_cast<long long>(e.handler)))
+                ->appendLast(ctx_, ctx_->fromInteger(static_cast<long long>(e.depth)));
+        }
+    }
+    return exceptionTable_;
+}
+
+void Compiler::addExceptionHandler(int setupOffset, int popBlockOffset, int handler, int depth) {
+    exceptionEntries_.push_back({static_cast<unsigned long>(setupOffset + 2),
+        static_cast<unsigned long>(popBlockOffset), static_cast<unsigned long>(handler),
+        static_cast<size_t>(depth)});
+}
+
 bool Compiler::compileConstant(ConstantNode* n) {
     if (!n) return false;
     const proto::ProtoObject* obj = nullptr;
@@ -683,8 +703,10 @@ bool Compiler::compileFor(ForNode* n) {
     
     emit(OP_FOR_ITER, 0);
     int argSlot = bytecodeOffset() - 1;
+    ++stackDepth_;  // The iterator stays on the stack while the body runs.
     if (!compileTarget(n->target.get(), TargetCtx::Store)) return false;
     if (!compileNode(n->body.get())) return false;
+    --stackDepth_;
     emit(OP_JUMP_ABSOLUTE, loopStart);
     int afterLoop = bytecodeOffset();
     addPatch(argSlot, afterLoop);
@@ -1184,18 +1206,21 @@ bool Compiler::compileTry(TryNode* n) {
     if (!n || !n->body) return false;
     
     // Setup exception handler
+    int setupOffset = bytecodeOffset();
     emit(OP_SETUP_FINALLY, 0);
     int setupFinallySlot = bytecodeOffset() - 1;
     
     if (!compileNode(n->body.get())) return false;
     
     // No exception: pop the block and jump over handlers
+    int popBlockOffset = bytecodeOffset();
     emit(OP_POP_BLOCK, 0);
     emit(OP_JUMP_ABSOLUTE, 0); 
     int jumpToPostHandlersSlot = bytecodeOffset() - 1;
     
     // Exception handler starts here
     addPatch(setupFinallySlot, bytecodeOffset());
+    addExceptionHandler(setupOffset, popBlockOffset, bytecodeOffset(), stackDepth_);
     
     if (!n->handlers.empty()) {
         std::vector<int> jumpToEndLocations;
@@ -1271,8 +1296,10 @@ bool Compiler::compileWithItems(const std::vector<WithItem>& items, size_t index
     const auto& item = items[index];
     if (!compileNode(item.context_expr.get())) return false;
     
+    int setupOffset = bytecodeOffset();
     emit(OP_SETUP_WITH, 0); // Handler to be patched
     int setupSlot = bytecodeOffset() - 1;
+    ++stackDepth_;  // __exit__ stays on the stack until WITH_CLEANUP.
     
     if (item.optional_vars) {
         if (!compileTarget(item.optional_vars.get(), TargetCtx::Store)) return false;
@@ -1283,6 +1310,7 @@ bool Compiler::compileWithItems(const std::vector<WithItem>& items, size_t index
     if (!compileWithItems(items, index + 1, body)) return false;
     
     // Normal exit
+    int popBlockOffset = bytecodeOffset();
     emit(OP_POP_BLOCK);
     int noneIdx = addConstant(PROTO_NONE);
     emit(OP_LOAD_CONST, noneIdx);
@@ -1295,6 +1323,8 @@ bool Compiler::compileWithItems(const std::vector<WithItem>& items, size_t index
     // Cleanup/Exception exit handler
     int cleanupLabel = bytecodeOffset();
     addPatch(setupSlot, cleanupLabel);
+    addExceptionHandler(setupOffset, popBlockOffset, cleanupLabel, stackDepth_);
+    --stackDepth_;
     emit(OP_WITH_CLEANUP);
     emit(OP_POP_JUMP_IF_TRUE, 0); // if suppressed, jump to done
     int suppressedJumpSlot = bytecodeOffset() - 1;
@@ -2043,7 +2073,7 @@ bool Compiler::compileFunctionDef(FunctionDefNode* n) {
     for (const auto& name : varnamesOrdered)
         co_varnames_list = co_varnames_list->appendLast(ctx_, ctx_->fromUTF8String(name.c_str()));
 
-    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames_list, nparams, kwonlyargcount, automatic_count, co_flags, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_));
+    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames_list, nparams, kwonlyargcount, automatic_count, co_flags, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_), bodyCompiler.getExceptionTable());
     if (!codeObj) return false;
     int idx = addConstant(codeObj);
     emit(OP_LOAD_CONST, idx);
@@ -2163,7 +2193,7 @@ bool Compiler::compileLambda(LambdaNode* n) {
     if (!forceMapped) co_flags |= CO_OPTIMIZED;
     if (!captured.empty()) co_flags |= CO_NESTED;
 
-    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames, nparams, kwonlyargcount, automatic_count, co_flags, false, ctx_->fromUTF8String("<lambda>")->asString(ctx_));
+    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames, nparams, kwonlyargcount, automatic_count, co_flags, false, ctx_->fromUTF8String("<lambda>")->asString(ctx_), bodyCompiler.getExceptionTable());
     if (!codeObj) return false;
     int idx = addConstant(codeObj);
     emit(OP_LOAD_CONST, idx);
@@ -2292,7 +2322,7 @@ bool Compiler::compileAsyncFunctionDef(AsyncFunctionDefNode* n) {
     if (!n->kwarg.empty()) co_flags |= CO_VARKEYWORDS;
     if (bodyCompiler.isGenerator_) co_flags |= 0x20; // CO_GENERATOR
 
-    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames, nparams, kwonlyargcount, automatic_count, co_flags, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_));
+    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), co_varnames, nparams, kwonlyargcount, automatic_count, co_flags, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_), bodyCompiler.getExceptionTable());
     if (!codeObj) return false;
     int idx = addConstant(codeObj);
     emit(OP_LOAD_CONST, idx);
@@ -2354,6 +2384,7 @@ bool Compiler::compileAsyncFor(AsyncForNode* n) {
     // 2. SETUP_FINALLY to catch StopAsyncIteration
     int setupFinallySlot = bytecodeOffset();
     emit(OP_SETUP_FINALLY, 0);
+    ++stackDepth_;  // The async iterator stays on the stack while the loop runs.
 
     // 3. val = await anext(iter)
     emit(OP_GET_ANEXT);
@@ -2362,6 +2393,7 @@ bool Compiler::compileAsyncFor(AsyncForNode* n) {
     emit(OP_YIELD_FROM);
 
     // 4. Success: pop block and store
+    int popBlockOffset = bytecodeOffset();
     emit(OP_POP_BLOCK);
     if (!compileTarget(n->target.get(), TargetCtx::Store)) return false;
 
@@ -2372,6 +2404,8 @@ bool Compiler::compileAsyncFor(AsyncForNode* n) {
     // 6. Handler (StopAsyncIteration)
     int handlerTarget = bytecodeOffset();
     addPatch(setupFinallySlot + 1, handlerTarget);
+    addExceptionHandler(setupFinallySlot, popBlockOffset, handlerTarget, stackDepth_);
+    --stackDepth_;
 
     int idx = addName("StopAsyncIteration");
     emit(OP_LOAD_GLOBAL, idx);
@@ -2429,6 +2463,8 @@ bool Compiler::compileAsyncWith(AsyncWithNode* n) {
     // 4. SETUP_FINALLY to catch exceptions in body
     int setupFinallySlot = bytecodeOffset();
     emit(OP_SETUP_FINALLY, 0);
+    const int setupDepth = stackDepth_ + 2;  // [..., exit, enter_res]
+    ++stackDepth_;  // exit stays on the stack while the body runs.
 
     // 5. Store enter_res in target
     if (item.optional_vars) {
@@ -2439,8 +2475,10 @@ bool Compiler::compileAsyncWith(AsyncWithNode* n) {
     
     // 6. Body
     if (!compileNode(n->body.get())) return false;
+    --stackDepth_;
     
     // 7. Success: POP_BLOCK and call exit(None, None, None)
+    int popBlockOffset = bytecodeOffset();
     emit(OP_POP_BLOCK);
     
     emit(OP_LOAD_CONST, addConstant(PROTO_NONE));
@@ -2458,6 +2496,7 @@ bool Compiler::compileAsyncWith(AsyncWithNode* n) {
     // 8. Handler: call exit(type, exc, None) and reraise
     int handlerTarget = bytecodeOffset();
     addPatch(setupFinallySlot + 1, handlerTarget);
+    addExceptionHandler(setupFinallySlot, popBlockOffset, handlerTarget, setupDepth);
     
     // [..., exit, exc]
     emit(OP_DUP_TOP); // exc
@@ -2516,7 +2555,7 @@ bool Compiler::compileClassDef(ClassDefNode* n) {
     bodyCompiler.emit(OP_RETURN_VALUE);
     bodyCompiler.applyPatches();
     
-    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), nullptr, 0, 0, 0, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_));
+    const proto::ProtoObject* codeObj = makeCodeObject(ctx_, bodyCompiler.getConstants(), bodyCompiler.getNames(), bodyCompiler.getBytecode(), ctx_->fromUTF8String(filename_.c_str())->asString(ctx_), nullptr, 0, 0, 0, 0, bodyCompiler.isGenerator_, ctx_->fromUTF8String(n->name.c_str())->asString(ctx_), bodyCompiler.getExceptionTable());
     int coIdx = addConstant(codeObj);
     emit(OP_LOAD_CONST, coIdx);
     emit(OP_BUILD_FUNCTION, 0);
@@ -2647,7 +2686,8 @@ const proto::ProtoObject* makeCodeObject(proto::ProtoContext* ctx,
     int automatic_count,
     int flags,
     bool isGenerator,
-    const proto::ProtoString* co_name) {
+    const proto::ProtoString* co_name,
+    const proto::ProtoList* exceptionTable) {
     if (!ctx) return PROTO_NONE;
     const proto::ProtoObject* code = ctx->newObject(true);
     // Optional: add a 'code_proto' if we want to share methods like .exec()
@@ -2663,21 +2703,13 @@ const proto::ProtoObject* makeCodeObject(proto::ProtoContext* ctx,
     bool isGenOrCoro = isGenerator || (flags & 0x80);
     code = code->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "co_is_generator"), ctx->fromBoolean(isGenOrCoro));
     code = code->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "co_name"), co_name ? reinterpret_cast<const proto::ProtoObject*>(co_name) : reinterpret_cast<const proto::ProtoObject*>(ctx->fromUTF8String("<module>")));
+    if (exceptionTable)
+        code = code->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "co_exceptiontable"), reinterpret_cast<const proto::ProtoObject*>(exceptionTable));
+    // Decode once here, before the code object is shared, so the interpreter never walks co_code.
+    attachDecodedCode(ctx, code);
     return code;
 }
 
-namespace {
-struct CodeObjectScope {
-    CodeObjectScope(const proto::ProtoObject* code) : oldCode(PythonEnvironment::getCurrentCodeObject()) {
-        PythonEnvironment::setCurrentCodeObject(code);
-    }
-    ~CodeObjectScope() {
-        PythonEnvironment::setCurrentCodeObject(oldCode);
-    }
-    const proto::ProtoObject* oldCode;
-};
-}
-
 const proto::ProtoObject* runCodeObject(proto::ProtoContext* ctx,
     const proto::ProtoObject* codeObj,
     proto::ProtoObject*& frame) {
@@ -2715,7 +2747,7 @@ const proto::ProtoObject* runCodeObject(proto::ProtoContext* ctx,
         }
     }
     
-    CodeObjectScope cscope(codeObj);
+    PythonEnvironment::CodeObjectScope cscope(codeObj);
 
     const proto::ProtoObject* co_consts = codeObj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "co_consts"));
     const proto::ProtoObject* co_names = codeObj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "co_names"));
@@ -2761,9 +2793,12 @@ const proto::ProtoObject* runCodeObject(proto::ProtoContext* ctx,
 
     unsigned long stackOffset = (co_varnames && co_varnames->asList(execCtx)) ? co_varnames->asList(execCtx)->getSize(execCtx) : 0;
 
-    const proto::ProtoObject* result = executeBytecodeRange(execCtx, co_consts->asList(execCtx), co_code->asList(execCtx),
-        co_names ? co_names->asList(execCtx) : nullptr, frame, 0, co_code->asList(execCtx)->getSize(execCtx),
-        stackOffset);
+    const DecodedCode* decoded = getDecodedCode(execCtx, codeObj);
+    const proto::ProtoObject* result = decoded
+        ? executeDecodedRange(execCtx, decoded, frame, 0, decoded->codeSize, stackOffset)
+        : executeBytecodeRange(execCtx, co_consts->asList(execCtx), co_code->asList(execCtx),
+            co_names ? co_names->asList(execCtx) : nullptr, frame, 0, co_code->asList(execCtx)->getSize(execCtx),
+            stackOffset);
 
     if (subCtx) {
         PythonEnvironment::setCurrentContext(oldCtx);
@@ -0,0 +1,691 @@
+#include <protoPython/EventLoop.h>
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace protoPython {
+
+namespace {
+
+constexpr uint32_t kWantRead = 1;
+constexpr uint32_t kWantWrite = 2;
+
+thread_local EventLoop* s_currentLoop = nullptr;
+
+/** Heap order for timers: earliest deadline on top, FIFO among equal deadlines. */
+constexpr auto timerLater = [](const auto& a, const auto& b) {
+    return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+};
+
+const proto::ProtoObject* taskProt = nullptr;
+const proto::ProtoObject* requestProt = nullptr;
+/** "_live", created and rooted with the prototypes, so tracking a task allocates no string. */
+const proto::ProtoString* s_liveName = nullptr;
+const proto::ProtoSpace* protoSpace = nullptr;  ///< Space the prototypes were built (and rooted) in.
+std::mutex s_protoMutex;
+
+/** What an awaited _eventloop object asks the loop for. */
+struct LoopRequest {
+    enum class Kind { Sleep, Readable, Writable, Join };
+    Kind kind{Kind::Sleep};
+    int64_t delayNs{0};
+    int fd{-1};
+    LoopTask* target{nullptr};
+    bool yielded{false};
+};
+
+void loop_task_finalizer(void* ptr) {
+    delete static_cast<LoopTask*>(ptr);
+}
+
+void loop_request_finalizer(void* ptr) {
+    delete static_cast<LoopRequest*>(ptr);
+}
+
+template<typename T>
+T* handleOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const char* attr) {
+    if (!obj || obj == PROTO_NONE) return nullptr;
+    const proto::ProtoObject* handle = obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, attr));
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<T*>(ext->getPointer(ctx)) : nullptr;
+}
+
+LoopTask* taskOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    return handleOf<LoopTask>(ctx, obj, "_handle");
+}
+
+LoopRequest* requestOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    return handleOf<LoopRequest>(ctx, obj, "_request");
+}
+
+/** Raise msg as a RuntimeError and return the exception object (cleared from the thread). */
+const proto::ProtoObject* makeRuntimeError(PythonEnvironment* env, proto::ProtoContext* ctx, const std::string& msg) {
+    env->raiseRuntimeError(ctx, msg);
+    return env->takePendingException();
+}
+
+const proto::ProtoObject* newRequest(proto::ProtoContext* ctx, LoopRequest* req) {
+    proto::ProtoObject* obj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    if (requestProt) obj = const_cast<proto::ProtoObject*>(obj->addParent(ctx, requestProt));
+    obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_request"),
+        ctx->fromExternalPointer(req, loop_request_finalizer));
+    return obj;
+}
+
+// --- Request objects: awaitable and their own one-shot iterator ---
+
+const proto::ProtoObject* py_request_await(
+    proto::ProtoContext*, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return self;
+}
+
+/** First resume yields the request to the loop; the next one returns what the loop sent back. */
+const proto::ProtoObject* py_request_send(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    LoopRequest* req = requestOf(ctx, self);
+    if (!env || !req) return PROTO_NONE;
+    if (!req->yielded && req->kind == LoopRequest::Kind::Join && req->target && req->target->done) {
+        // Awaiting a finished task needs no trip through the loop.
+        req->yielded = true;
+        if (req->target->exception) env->setPendingException(req->target->exception);
+        else env->raiseStopIteration(ctx, req->target->result);
+        return PROTO_NONE;
+    }
+    if (!req->yielded) {
+        req->yielded = true;
+        return self;
+    }
+    const proto::ProtoObject* value = (posArgs && posArgs->getSize(ctx) > 0) ? posArgs->getAt(ctx, 0) : PROTO_NONE;
+    env->raiseStopIteration(ctx, value);
+    return PROTO_NONE;
+}
+
+const proto::ProtoObject* py_request_next(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink, const proto::ProtoList*, const proto::ProtoSparseList* kwargs) {
+    return py_request_send(ctx, self, parentLink, ctx->newList(), kwargs);
+}
+
+// --- Task objects ---
+
+const proto::ProtoObject* py_task_done(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    LoopTask* task = taskOf(ctx, self);
+    return task && task->done ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_task_result(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    LoopTask* task = taskOf(ctx, self);
+    if (!env || !task) return PROTO_NONE;
+    if (!task->done) {
+        env->raiseRuntimeError(ctx, "Result is not set.");
+        return PROTO_NONE;
+    }
+    if (task->exception) {
+        env->setPendingException(task->exception);
+        return PROTO_NONE;
+    }
+    return task->result;
+}
+
+const proto::ProtoObject* py_task_exception(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    LoopTask* task = taskOf(ctx, self);
+    return task && task->exception ? task->exception : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_task_await(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    LoopTask* task = taskOf(ctx, self);
+    if (!task) return PROTO_NONE;
+    LoopRequest* req = new LoopRequest();
+    req->kind = LoopRequest::Kind::Join;
+    req->target = task;
+    const proto::ProtoObject* obj = newRequest(ctx, req);
+    obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_target"), self);  // Keeps the task alive.
+    return obj;
+}
+
+void ensurePrototypes(proto::ProtoContext* ctx) {
+    std::lock_guard<std::mutex> guard(s_protoMutex);
+    if (protoSpace == ctx->space) return;
+    const proto::ProtoObject* t = ctx->newObject(true);
+    t = t->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "done"), ctx->fromMethod(nullptr, py_task_done));
+    t = t->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "result"), ctx->fromMethod(nullptr, py_task_result));
+    t = t->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "exception"), ctx->fromMethod(nullptr, py_task_exception));
+    t = t->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__await__"), ctx->fromMethod(nullptr, py_task_await));
+
+    const proto::ProtoObject* r = ctx->newObject(true);
+    r = r->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__await__"), ctx->fromMethod(nullptr, py_request_await));
+    r = r->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__iter__"), ctx->fromMethod(nullptr, py_request_await));
+    r = r->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__next__"), ctx->fromMethod(nullptr, py_request_next));
+    r = r->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "send"), ctx->fromMethod(nullptr, py_request_send));
+
+    taskProt = t;
+    requestProt = r;
+    s_liveName = proto::ProtoString::fromUTF8String(ctx, "_live");
+    protoSpace = ctx->space;
+    std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+    ctx->space->moduleRoots.push_back(taskProt);
+    ctx->space->moduleRoots.push_back(requestProt);
+    ctx->space->moduleRoots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_liveName));
+}
+
+} // anonymous namespace
+
+// --- Poller: blocks the loop thread until an fd event, a wake() or the timeout ---
+
+#if defined(__linux__)
+
+struct EventLoop::Poller {
+    int epfd{-1};
+    int wakefd{-1};
+
+    Poller() {
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epfd >= 0 && wakefd >= 0) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = wakefd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+        }
+    }
+    ~Poller() {
+        if (wakefd >= 0) close(wakefd);
+        if (epfd >= 0) close(epfd);
+    }
+
+    /** Change fd's interest set; 0 on success, else errno. */
+    int update(int fd, uint32_t from, uint32_t to) {
+        epoll_event ev{};
+        ev.events = ((to & kWantRead) ? EPOLLIN : 0) | ((to & kWantWrite) ? EPOLLOUT : 0);
+        ev.data.fd = fd;
+        const int op = to == 0 ? EPOLL_CTL_DEL : (from == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+        return epoll_ctl(epfd, op, fd, &ev) == 0 ? 0 : errno;
+    }
+
+    template<typename F>
+    void wait(int timeoutMs, const std::unordered_map<int, FdWaiters>&, F&& onEvent) {
+        epoll_event events[256];
+        const int n = epoll_wait(epfd, events, 256, timeoutMs);
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakefd) {
+                uint64_t count;
+                while (read(wakefd, &count, sizeof(count)) > 0) {}
+                continue;
+            }
+            const uint32_t e = events[i].events;
+            onEvent(fd, (e & (EPOLLIN | EPOLLHUP)) != 0, (e & EPOLLOUT) != 0, (e & EPOLLERR) != 0);
+        }
+    }
+
+    void wake() {
+        const uint64_t one = 1;
+        ssize_t r = write(wakefd, &one, sizeof(one));
+        (void)r;
+    }
+};
+
+#else
+
+struct EventLoop::Poller {
+    int wakePipe[2]{-1, -1};
+    std::vector<pollfd> scratch;
+
+    Poller() {
+        if (pipe(wakePipe) == 0) {
+            for (int fd : wakePipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+    }
+    ~Poller() {
+        for (int fd : wakePipe)
+            if (fd >= 0) close(fd);
+    }
+
+    int update(int, uint32_t, uint32_t) { return 0; }  // Interest is rebuilt from fds_ on every wait.
+
+    template<typename F>
+    void wait(int timeoutMs, const std::unordered_map<int, FdWaiters>& fds, F&& onEvent) {
+        scratch.clear();
+        scratch.push_back({wakePipe[0], POLLIN, 0});
+        for (const auto& entry : fds) {
+            if (!entry.second.registered) continue;
+            short events = 0;
+            if (entry.second.registered & kWantRead) events |= POLLIN;
+            if (entry.second.registered & kWantWrite) events |= POLLOUT;
+            scratch.push_back({entry.first, events, 0});
+        }
+        if (poll(scratch.data(), scratch.size(), timeoutMs) <= 0) return;
+        if (scratch[0].revents) {
+            char buf[64];
+            while (read(wakePipe[0], buf, sizeof(buf)) > 0) {}
+        }
+        for (size_t i = 1; i < scratch.size(); ++i) {
+            const short e = scratch[i].revents;
+            if (!e) continue;
+            onEvent(scratch[i].fd, (e & (POLLIN | POLLHUP)) != 0, (e & POLLOUT) != 0, (e & (POLLERR | POLLNVAL)) != 0);
+        }
+    }
+
+    void wake() {
+        const char one = 1;
+        ssize_t r = write(wakePipe[1], &one, 1);
+        (void)r;
+    }
+};
+
+#endif
+
+// --- EventLoop ---
+
+EventLoop::EventLoop(PythonEnvironment* env, proto::ProtoContext* ctx)
+    : env_(env), ctx_(ctx), previous_(s_currentLoop), poller_(new Poller()) {
+    ensurePrototypes(ctx);
+    registry_ = ctx->newObject(true);
+    live_ = ctx->newSparseList();
+    {
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        ctx->space->moduleRoots.push_back(registry_);
+    }
+    s_currentLoop = this;
+}
+
+EventLoop::~EventLoop() {
+    s_currentLoop = previous_;
+    std::lock_guard<std::mutex> lock(ctx_->space->moduleRootsMutex);
+    auto& roots = ctx_->space->moduleRoots;
+    roots.erase(std::remove(roots.begin(), roots.end(), registry_), roots.end());
+}
+
+EventLoop* EventLoop::current() {
+    return s_currentLoop;
+}
+
+int64_t EventLoop::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void EventLoop::trackLive(proto::ProtoContext* ctx, LoopTask* task, bool live) {
+    live_ = live ? live_->setAt(ctx, task->id, task->handle) : live_->removeAt(ctx, task->id);
+    registry_->setAttribute(ctx, s_liveName, live_->asObject(ctx));
+}
+
+void EventLoop::failTask(LoopTask* task, std::string message) {
+    // The exception is only created in step(), where it is rooted by the call that throws it.
+    task->loopError = std::move(message);
+    ready_.push({task, nullptr, true});
+}
+
+const proto::ProtoObject* EventLoop::createTask(proto::ProtoContext* ctx, const proto::ProtoObject* coro) {
+    const proto::ProtoObject* send = coro ? env_->getAttribute(ctx, coro, env_->getSendString()) : nullptr;
+    if (!send || send == PROTO_NONE) return PROTO_NONE;
+
+    LoopTask* task = new LoopTask();
+    task->loop = this;
+    task->id = nextTaskId_++;
+    task->coro = coro;
+    task->send = send;
+    proto::ProtoObject* handle = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    if (taskProt) handle = const_cast<proto::ProtoObject*>(handle->addParent(ctx, taskProt));
+    handle->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"),
+        ctx->fromExternalPointer(task, loop_task_finalizer));
+    handle->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_coro"), coro);
+    handle->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_send"), send);
+    task->handle = handle;
+
+    trackLive(ctx, task, true);
+    ready_.push({task, PROTO_NONE, false});
+    return handle;
+}
+
+void EventLoop::step(proto::ProtoContext* ctx, const ReadyEntry& entry) {
+    LoopTask* task = entry.task;
+    const proto::ProtoObject* yielded = nullptr;
+    try {
+        const proto::ProtoObject* value = entry.value;
+        if (entry.raise && !value) {
+            value = makeRuntimeError(env_, ctx, task->loopError);
+            task->loopError.clear();
+        }
+        const proto::ProtoObject* method = entry.raise ? env_->getAttribute(ctx, task->coro, env_->getThrowString()) : task->send;
+        const proto::ProtoList* args = ctx->newList()->appendLast(ctx, value ? value : PROTO_NONE);
+        yielded = invokePythonCallable(ctx, method, args, nullptr);
+    } catch (const proto::ProtoObject* exc) {
+        env_->setPendingException(exc);
+    }
+    if (env_->hasPendingException()) {
+        const proto::ProtoObject* exc = env_->takePendingException();
+        if (env_->isStopIteration(ctx, exc)) finish(ctx, task, env_->getStopIterationValue(ctx, exc), nullptr);
+        else finish(ctx, task, nullptr, exc);
+        return;
+    }
+    park(ctx, task, yielded);
+}
+
+void EventLoop::park(proto::ProtoContext* ctx, LoopTask* task, const proto::ProtoObject* yielded) {
+    LoopRequest* req = requestOf(ctx, yielded);
+    if (!req) {
+        // A bare yield (or any foreign value) just gives other tasks a turn.
+        ready_.push({task, PROTO_NONE, false});
+        return;
+    }
+    switch (req->kind) {
+    case LoopRequest::Kind::Sleep: {
+        const proto::ProtoObject* value = yielded->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_value"));
+        if (!value) value = PROTO_NONE;
+        if (req->delayNs <= 0) ready_.push({task, value, false});
+        else addTimer(task, now() + req->delayNs, value);
+        break;
+    }
+    case LoopRequest::Kind::Readable:
+    case LoopRequest::Kind::Writable:
+        waitFd(task, req->fd, req->kind == LoopRequest::Kind::Writable);
+        break;
+    case LoopRequest::Kind::Join: {
+        LoopTask* target = req->target;
+        if (!target || target->loop != this) {
+            failTask(task, "task belongs to a different event loop");
+        } else if (target == task) {
+            failTask(task, "a task cannot await itself");
+        } else if (target->done) {
+            ready_.push({task, target->exception ? target->exception : target->result, target->exception != nullptr});
+        } else {
+            target->waiters.push_back(task);
+        }
+        break;
+    }
+    }
+}
+
+void EventLoop::finish(proto::ProtoContext* ctx, LoopTask* task,
+    const proto::ProtoObject* result, const proto::ProtoObject* exception) {
+    task->done = true;
+    task->result = result ? result : PROTO_NONE;
+    task->exception = exception;
+    proto::ProtoObject* handle = const_cast<proto::ProtoObject*>(task->handle);
+    if (exception) handle->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_exception"), exception);
+    else handle->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_result"), task->result);
+    for (LoopTask* waiter : task->waiters)
+        ready_.push({waiter, exception ? exception : task->result, exception != nullptr});
+    task->waiters.clear();
+    trackLive(ctx, task, false);
+}
+
+void EventLoop::addTimer(LoopTask* task, int64_t deadline, const proto::ProtoObject* value) {
+    timers_.push_back({deadline, timerSeq_++, task, value});
+    std::push_heap(timers_.begin(), timers_.end(), timerLater);
+}
+
+void EventLoop::waitFd(LoopTask* task, int fd, bool write) {
+    FdWaiters& w = fds_[fd];
+    LoopTask*& slot = write ? w.writer : w.reader;
+    if (slot) {
+        failTask(task, "fd " + std::to_string(fd) + " already has a " + (write ? "writer" : "reader") + " waiting");
+        return;
+    }
+    const uint32_t want = w.registered | (write ? kWantWrite : kWantRead);
+    if (int err = poller_->update(fd, w.registered, want)) {
+        if (!w.reader && !w.writer) fds_.erase(fd);
+        failTask(task, "cannot wait on fd " + std::to_string(fd) + ": " + std::strerror(err));
+        return;
+    }
+    w.registered = want;
+    slot = task;
+    ++fdWaiterCount_;
+}
+
+void EventLoop::fdReady(int fd, bool readable, bool writable, bool failed) {
+    auto it = fds_.find(fd);
+    if (it == fds_.end()) return;
+    FdWaiters& w = it->second;
+    // An error wakes both sides; the next read/write reports it.
+    if (w.reader && (readable || failed)) {
+        ready_.push({w.reader, PROTO_NONE, false});
+        w.reader = nullptr;
+        --fdWaiterCount_;
+    }
+    if (w.writer && (writable || failed)) {
+        ready_.push({w.writer, PROTO_NONE, false});
+        w.writer = nullptr;
+        --fdWaiterCount_;
+    }
+    const uint32_t want = (w.reader ? kWantRead : 0) | (w.writer ? kWantWrite : 0);
+    if (want != w.registered) {
+        poller_->update(fd, w.registered, want);
+        w.registered = want;
+    }
+    if (!want) fds_.erase(it);
+}
+
+void EventLoop::post(std::function<void(proto::ProtoContext*)> fn, bool releasesHold) {
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        posted_.push_back(std::move(fn));
+        hasPosted_.store(true, std::memory_order_release);
+    }
+    if (releasesHold) holds_.fetch_sub(1, std::memory_order_acq_rel);
+    poller_->wake();
+}
+
+void EventLoop::holdForPost() {
+    holds_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void EventLoop::runPosted(proto::ProtoContext* ctx) {
+    std::vector<std::function<void(proto::ProtoContext*)>> batch;
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        batch.swap(posted_);
+        hasPosted_.store(false, std::memory_order_release);
+    }
+    for (auto& fn : batch) fn(ctx);
+}
+
+void EventLoop::wait(int64_t timeoutNs) {
+    // Round up so a timer is never polled for just before it is due.
+    const int timeoutMs = timeoutNs < 0 ? -1
+        : static_cast<int>(std::min<int64_t>((timeoutNs + 999999) / 1000000, 1 << 30));
+    const auto onEvent = [this](int fd, bool readable, bool writable, bool failed) {
+        fdReady(fd, readable, writable, failed);
+    };
+    if (timeoutMs == 0) {
+        poller_->wait(0, fds_, onEvent);
+        return;
+    }
+    // fdReady only touches native state, so the whole blocking wait is GC-safe.
+    BlockingRegion blocking(ctx_->space);
+    poller_->wait(timeoutMs, fds_, onEvent);
+}
+
+const proto::ProtoObject* EventLoop::runUntilComplete(const proto::ProtoObject* coro) {
+    proto::ProtoContext* ctx = ctx_;
+    const proto::ProtoObject* mainHandle = createTask(ctx, coro);
+    LoopTask* main = taskOf(ctx, mainHandle);
+    if (!main) {
+        env_->raiseTypeError(ctx, "a coroutine was expected");
+        return nullptr;
+    }
+
+    const auto fireTimers = [&]() {
+        if (timers_.empty()) return;
+        const int64_t t = now();
+        while (!timers_.empty() && timers_.front().deadline <= t) {
+            std::pop_heap(timers_.begin(), timers_.end(), timerLater);
+            const Timer timer = timers_.back();
+            timers_.pop_back();
+            ready_.push({timer.task, timer.value, false});
+        }
+    };
+
+    while (!main->done) {
+        if (hasPosted_.load(std::memory_order_acquire)) runPosted(ctx);
+
+        // Run what is ready now; tasks rescheduled by this batch wait for the next tick.
+        for (size_t n = ready_.size(); n > 0; --n) step(ctx, ready_.pop());
+        if (main->done) break;
+
+        fireTimers();
+        if (!ready_.empty()) {
+            if (fdWaiterCount_) wait(0);
+            continue;
+        }
+
+        int64_t timeout = -1;
+        if (!timers_.empty()) {
+            timeout = std::max<int64_t>(0, timers_.front().deadline - now());
+        } else if (fdWaiterCount_ == 0 && holds_.load(std::memory_order_acquire) == 0 &&
+                   !hasPosted_.load(std::memory_order_acquire)) {
+            env_->raiseRuntimeError(ctx, "event loop stalled: no task can make progress");
+            return nullptr;
+        }
+        wait(timeout);
+        fireTimers();
+    }
+
+    if (main->exception) {
+        env_->setPendingException(main->exception);
+        return nullptr;
+    }
+    return main->result;
+}
+
+// --- _eventloop module ---
+
+namespace event_loop_module {
+
+static int64_t toNanoseconds(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (obj->isDouble(ctx)) return static_cast<int64_t>(obj->asDouble(ctx) * 1e9);
+    if (obj->isInteger(ctx)) return static_cast<int64_t>(obj->asLong(ctx)) * 1000000000LL;
+    return 0;
+}
+
+static const proto::ProtoObject* py_run(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env || !posArgs || posArgs->getSize(ctx) < 1) return PROTO_NONE;
+    EventLoop loop(env, ctx);
+    const proto::ProtoObject* result = loop.runUntilComplete(posArgs->getAt(ctx, 0));
+    return result ? result : PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_create_task(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env || !posArgs || posArgs->getSize(ctx) < 1) return PROTO_NONE;
+    EventLoop* loop = EventLoop::current();
+    if (!loop) {
+        env->raiseRuntimeError(ctx, "no running event loop");
+        return PROTO_NONE;
+    }
+    const proto::ProtoObject* task = loop->createTask(ctx, posArgs->getAt(ctx, 0));
+    if (task == PROTO_NONE) env->raiseTypeError(ctx, "a coroutine was expected");
+    return task;
+}
+
+static const proto::ProtoObject* py_sleep(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    LoopRequest* req = new LoopRequest();
+    req->kind = LoopRequest::Kind::Sleep;
+    if (posArgs && posArgs->getSize(ctx) >= 1) req->delayNs = toNanoseconds(ctx, posArgs->getAt(ctx, 0));
+    const proto::ProtoObject* obj = newRequest(ctx, req);
+    if (posArgs && posArgs->getSize(ctx) >= 2)
+        obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_value"), posArgs->getAt(ctx, 1));
+    return obj;
+}
+
+static const proto::ProtoObject* fdRequest(
+    proto::ProtoContext* ctx, const proto::ProtoList* posArgs, LoopRequest::Kind kind) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* fdObj = (posArgs && posArgs->getSize(ctx) >= 1) ? posArgs->getAt(ctx, 0) : nullptr;
+    if (!fdObj || !fdObj->isInteger(ctx) || fdObj->asLong(ctx) < 0) {
+        if (env) env->raiseTypeError(ctx, "fd must be a non-negative integer");
+        return PROTO_NONE;
+    }
+    LoopRequest* req = new LoopRequest();
+    req->kind = kind;
+    req->fd = static_cast<int>(fdObj->asLong(ctx));
+    return newRequest(ctx, req);
+}
+
+static const proto::ProtoObject* py_wait_readable(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    return fdRequest(ctx, posArgs, LoopRequest::Kind::Readable);
+}
+
+static const proto::ProtoObject* py_wait_writable(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    return fdRequest(ctx, posArgs, LoopRequest::Kind::Writable);
+}
+
+static const proto::ProtoObject* py_time(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return ctx->fromDouble(static_cast<double>(EventLoop::now()) / 1e9);
+}
+
+static const proto::ProtoObject* py_is_running(
+    proto::ProtoContext*, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return EventLoop::current() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx) {
+    ensurePrototypes(ctx);
+    const proto::ProtoObject* mod = ctx->newObject(true);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "run"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_run));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "create_task"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_create_task));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "sleep"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_sleep));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "wait_readable"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_wait_readable));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "wait_writable"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_wait_writable));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "time"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_time));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "is_running"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_is_running));
+    return mod;
+}
+
+} // namespace event_loop_module
+
+} // namespace protoPython
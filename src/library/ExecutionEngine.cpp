@@ -1,13 +1,22 @@
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/BlockingRegion.h>
 #include <protoPython/Compiler.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadLocal.h>
+#include <protoPython/CompactDict.h>
+#include <protoPython/FutexSync.h>
+#include <protoPython/ListBuffer.h>
+#include <protoPython/StringBuilder.h>
 #include <protoPython/MemoryManager.hpp>
 #include <protoCore.h>
 #include <proto_internal.h>
 #include <cmath>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -17,47 +26,115 @@ static bool get_env_diag();
 
 
 namespace {
+/** Switches the thread's current frame. A null frame keeps the pending LazyFrame unless one is given. */
 struct FrameScope {
-    FrameScope(const proto::ProtoObject* frame) : oldFrame(PythonEnvironment::getCurrentFrame()) {
+    FrameScope(const proto::ProtoObject* frame, LazyFrame* lazy = nullptr)
+        : oldFrame(PythonEnvironment::peekCurrentFrame()), oldLazy(PythonEnvironment::getCurrentLazyFrame()) {
         PythonEnvironment::setCurrentFrame(frame);
+        if (frame || lazy) PythonEnvironment::setCurrentLazyFrame(frame ? nullptr : lazy);
     }
     ~FrameScope() {
         PythonEnvironment::setCurrentFrame(oldFrame);
+        PythonEnvironment::setCurrentLazyFrame(oldLazy);
     }
     const proto::ProtoObject* oldFrame;
+    LazyFrame* oldLazy;
 };
 
+/** Switches the thread's current globals; resolve() reads them live, so no cache is invalidated. */
 struct GlobalsScope {
     GlobalsScope(const proto::ProtoObject* globals) : oldGlobals(PythonEnvironment::getCurrentGlobals()) {
-        if (globals != oldGlobals) {
-            PythonEnvironment::setCurrentGlobals(globals);
-            PythonEnvironment* env = PythonEnvironment::getCurrentEnvironment();
-            if (env) env->invalidateResolveCache();
-        }
+        if (globals != oldGlobals) PythonEnvironment::setCurrentGlobals(globals);
     }
     ~GlobalsScope() {
-        if (oldGlobals != PythonEnvironment::getCurrentGlobals()) {
-            PythonEnvironment::setCurrentGlobals(oldGlobals);
-            PythonEnvironment* env = PythonEnvironment::getCurrentEnvironment();
-            if (env) env->invalidateResolveCache();
-        }
+        if (oldGlobals != PythonEnvironment::getCurrentGlobals()) PythonEnvironment::setCurrentGlobals(oldGlobals);
     }
     const proto::ProtoObject* oldGlobals;
 };
 
+/** Marks a GeneratorState as running for one resume (also on unwinding). */
+struct GeneratorRunScope {
+    explicit GeneratorRunScope(GeneratorState& s) : state(s) { state.running = true; }
+    ~GeneratorRunScope() { state.running = false; }
+    GeneratorState& state;
+};
+
+void generator_state_finalizer(void* ptr) {
+    delete static_cast<GeneratorState*>(ptr);
+}
+
+const proto::ProtoString* giPinsName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getGiPinsString() : proto::ProtoString::fromUTF8String(ctx, "__gi_pins__");
+}
+
+/** Build state's pin list (see GeneratorState) from its fixed references and locals and publish it on gen. */
+void initGeneratorPins(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* gen,
+    GeneratorState& state) {
+    const proto::ProtoList* pins = ctx->newList()
+        ->appendLast(ctx, state.code)
+        ->appendLast(ctx, state.frame ? state.frame : PROTO_NONE)
+        ->appendLast(ctx, state.globals ? state.globals : PROTO_NONE)
+        ->appendLast(ctx, state.localNames ? state.localNames->asObject(ctx) : PROTO_NONE);
+    for (const proto::ProtoObject* v : state.locals)
+        pins = pins->appendLast(ctx, v ? v : PROTO_NONE);
+    state.pins = pins;
+    gen->setAttribute(ctx, giPinsName(ctx, env), pins->asObject(ctx));
+}
+
+/**
+ * After a yield: save slots[0, nSlots) into state.locals, replacing only the pins that
+ * changed. A stack that ran on the fallback lease (code without sized locals) is not in
+ * the slots and follows the locals instead. gen is only written if the list changed.
+ */
+void saveGeneratorSlots(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* gen,
+    GeneratorState& state, proto::ProtoObject* const* slots, size_t nSlots) {
+    const proto::ProtoList* pins = state.pins;
+    for (size_t i = 0; i < nSlots; ++i) {
+        if (state.locals[i] == slots[i]) continue;
+        state.locals[i] = slots[i];
+        pins = pins->setAt(ctx, static_cast<int>(GeneratorState::kFixedPins + i), slots[i] ? slots[i] : PROTO_NONE);
+    }
+    const unsigned long savedPins = GeneratorState::kFixedPins + state.locals.size();
+    if (nSlots <= state.stackOffset && (!state.stack.empty() || pins->getSize(ctx) > savedPins)) {
+        while (pins->getSize(ctx) > savedPins) pins = pins->removeLast(ctx);
+        for (const proto::ProtoObject* v : state.stack)
+            if (v) pins = pins->appendLast(ctx, v);
+    }
+    if (pins == state.pins) return;
+    state.pins = pins;
+    gen->setAttribute(ctx, giPinsName(ctx, env), pins->asObject(ctx));
+}
+
+/** Finished: drop the saved locals and stack, keeping the fixed references gi_code and gi_frame read. */
+void releaseGeneratorSlots(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* gen,
+    GeneratorState& state) {
+    state.locals.clear();
+    state.stack.clear();
+    state.blocks.clear();
+    if (!state.pins || state.pins->getSize(ctx) <= GeneratorState::kFixedPins) return;
+    const proto::ProtoList* pins = ctx->newList();
+    for (size_t i = 0; i < GeneratorState::kFixedPins; ++i)
+        pins = pins->appendLast(ctx, state.pins->getAt(ctx, static_cast<int>(i)));
+    state.pins = pins;
+    gen->setAttribute(ctx, giPinsName(ctx, env), pins->asObject(ctx));
+}
+
 /** __call__ for user-defined functions: push context (RAII), build frame, run __code__, promote return value.
- * Reads co_varnames, co_nparams, co_automatic_count from code object to size automatic slots and bind args. */
+ * Sizes automatic slots and binds args from the code object's CodeCallInfo (see getDecodedCode). */
 static const proto::ProtoObject* invokeCallable(proto::ProtoContext* ctx,
     const proto::ProtoObject* callable, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs);
+static const proto::ProtoObject* vectorcallObject(proto::ProtoContext* ctx,
+    const proto::ProtoObject* callable, const proto::ProtoObject* const* args, size_t nargs);
 
 
 
-static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
+/** Positional args are a view (argCount entries); a ProtoList is only built for *args. */
+static const proto::ProtoObject* runUserFunction(proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
-    const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* args,
+    const proto::ProtoObject* const* argv,
+    unsigned long argCount,
     const proto::ProtoSparseList* kwargs) {
-    if (!ctx || !self || !args) return PROTO_NONE;
+    if (!ctx || !self) return PROTO_NONE;
     PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
     const proto::ProtoString* code_name = env ? env->getCodeString() : proto::ProtoString::fromUTF8String(ctx, "__code__");
     const proto::ProtoObject* codeObj = self->getAttribute(ctx, code_name);
@@ -67,66 +144,35 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
     const proto::ProtoObject* globalsObj = self->getAttribute(ctx, globals_name);
     if (!globalsObj || globalsObj == PROTO_NONE) return PROTO_NONE;
 
-    const proto::ProtoString* co_flags_name = env ? env->getCoFlagsString() : proto::ProtoString::fromUTF8String(ctx, "co_flags");
-    const proto::ProtoObject* co_flags_obj = codeObj->getAttribute(ctx, co_flags_name);
-    int co_flags = (co_flags_obj && co_flags_obj->isInteger(ctx)) ? static_cast<int>(co_flags_obj->asLong(ctx)) : 0;
+    // Call metadata is read from the code object once, when it is decoded.
+    const DecodedCode* decoded = getDecodedCode(ctx, codeObj);
+    if (!decoded || !decoded->call.valid) return PROTO_NONE;
+    const CodeCallInfo& call = decoded->call;
+    const int co_flags = call.flags;
+    const int nparams_count = call.nparams;
+    const int kwonly_count = call.kwonly;
+    const int varnames_count = static_cast<int>(call.varnames.size());
 
-    if (std::getenv("PROTO_ENV_DIAG")) {
+    if (get_env_diag()) {
         std::cerr << "[proto-diag] runUserFunctionCall: co_flags=" << co_flags << " isOptimized=" << ((co_flags & 0x0001) ? "yes" : "no") << "\n";
     }
 
-    const proto::ProtoString* co_varnames_name = env ? env->getCoVarnamesString() : proto::ProtoString::fromUTF8String(ctx, "co_varnames");
-    const proto::ProtoString* co_nparams_name = env ? env->getCoNparamsString() : proto::ProtoString::fromUTF8String(ctx, "co_nparams");
-    const proto::ProtoString* co_automatic_name = env ? env->getCoAutomaticCountString() : proto::ProtoString::fromUTF8String(ctx, "co_automatic_count");
-
-    const proto::ProtoObject* co_varnames_obj = codeObj->getAttribute(ctx, co_varnames_name);
-    const proto::ProtoObject* co_nparams_obj = codeObj->getAttribute(ctx, co_nparams_name);
-    const proto::ProtoString* co_kwonly_name = env ? env->getCoKwonlyargcountString() : proto::ProtoString::fromUTF8String(ctx, "co_kwonlyargcount");
-    const proto::ProtoObject* co_kwonly_obj = codeObj->getAttribute(ctx, co_kwonly_name);
-    const proto::ProtoObject* co_automatic_obj = codeObj->getAttribute(ctx, co_automatic_name);
-
-    const proto::ProtoList* co_varnames = co_varnames_obj && co_varnames_obj->asList(ctx) ? co_varnames_obj->asList(ctx) : nullptr;
-    int nparams_count = (co_nparams_obj && co_nparams_obj->isInteger(ctx)) ? static_cast<int>(co_nparams_obj->asLong(ctx)) : 0;
-    int kwonly_count = (co_kwonly_obj && co_kwonly_obj->isInteger(ctx)) ? static_cast<int>(co_kwonly_obj->asLong(ctx)) : 0;
-    int automatic_count = (co_automatic_obj && co_automatic_obj->isInteger(ctx)) ? static_cast<int>(co_automatic_obj->asLong(ctx)) : 0;
-
-
-    const proto::ProtoList* parameterNames = nullptr;
-    const proto::ProtoList* localNames = nullptr;
-    if (co_varnames) {
-        int co_varnames_size = static_cast<int>(co_varnames->getSize(ctx));
-        if (nparams_count > 0 && nparams_count <= co_varnames_size) {
-            parameterNames = ctx->newList();
-            for (int i = 0; i < nparams_count; ++i)
-                parameterNames = parameterNames->appendLast(ctx, co_varnames->getAt(ctx, i));
-        }
-        if (automatic_count > 0) {
-            localNames = ctx->newList();
-            for (int i = 0; i < automatic_count; ++i) {
-                const proto::ProtoObject* name = (i < co_varnames_size) ? co_varnames->getAt(ctx, i) : PROTO_NONE;
-                localNames = localNames->appendLast(ctx, name);
-            }
-        }
-    }
-
     // We pass nullptr for args and kwargs to skip ProtoContext's internal binding,
     // as we handle it manually below to support Python-specific semantics like *args and **kwargs.
-    ContextScope scope(ctx->space, ctx, parameterNames, localNames, nullptr, nullptr);
+    ContextScope scope(ctx->space, ctx, call.parameterNames, call.localNames, nullptr, nullptr);
     proto::ProtoContext* calleeCtx = scope.context();
-    unsigned long argCount = args->getSize(calleeCtx);
 
-    // 5. Build Execution Frame (for locals()/sys._getframe)
-    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(calleeCtx->newObject(true));
+    // 5. Execution frame (for locals()/sys._getframe). Bodies that never touch it get a
+    // LazyFrame; the frame object is then only built if something asks for it.
+    LazyFrame lazy;
+    lazy.ctx = calleeCtx;
+    lazy.code = codeObj;
+    lazy.globals = globalsObj;
     if (env) {
-        frame = const_cast<proto::ProtoObject*>(frame->addParent(calleeCtx, env->getFramePrototype()));
         const proto::ProtoObject* closure = self->getAttribute(calleeCtx, env->getClosureString());
-        if (closure && closure != PROTO_NONE) {
-            frame = const_cast<proto::ProtoObject*>(frame->addParent(calleeCtx, closure));
-        }
-        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(calleeCtx, env->getFCodeString(), codeObj));
-        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(calleeCtx, env->getFGlobalsString(), globalsObj));
-        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(calleeCtx, env->getFLocalsString(), frame));
+        if (closure && closure != PROTO_NONE) lazy.closure = closure;
     }
+    proto::ProtoObject* frame = (call.needsFrame || lazy.closure) ? materializeFrame(&lazy) : nullptr;
 
     // Bind parameters
     unsigned int nSlots = calleeCtx->getAutomaticLocalsCount();
@@ -135,11 +181,11 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
     auto bindVar = [&](int idx, const proto::ProtoObject* val) {
         if ((co_flags & CO_OPTIMIZED) && slots && idx < (int)nSlots) {
             slots[idx] = const_cast<proto::ProtoObject*>(val);
-        } else if (frame && co_varnames && idx < (int)co_varnames->getSize(calleeCtx)) {
-            const proto::ProtoObject* nameObj = co_varnames->getAt(calleeCtx, idx);
+        } else if (frame && idx < varnames_count) {
+            const proto::ProtoObject* nameObj = call.varnames[idx];
             if (nameObj && nameObj->isString(calleeCtx)) {
                 const proto::ProtoString* nameS = nameObj->asString(calleeCtx);
-                if (std::getenv("PROTO_ENV_DIAG")) {
+                if (get_env_diag()) {
                     std::string n;
                     nameS->toUTF8String(calleeCtx, n);
                     std::cerr << "[proto-diag] bindVar(frame): idx=" << idx << " name='" << n << "' val=" << val << "\n";
@@ -151,7 +197,7 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
 
     // 1. Positional arguments
     for (unsigned long i = 0; i < (unsigned long)nparams_count && i < argCount; ++i) {
-        bindVar(static_cast<int>(i), args->getAt(calleeCtx, static_cast<int>(i)));
+        bindVar(static_cast<int>(i), argv[i]);
     }
 
     // 2. Apply positional defaults if missing
@@ -162,43 +208,38 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
             const proto::ProtoTuple* defaults = defaultsObj->asTuple(calleeCtx);
             int num_defaults = (int)defaults->getSize(calleeCtx);
             int defaults_start_at = nparams_count - num_defaults;
-            if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] Applying positional defaults: num=" << num_defaults << " start=" << defaults_start_at << "\n";
+            if (get_env_diag()) std::cerr << "[proto-diag] Applying positional defaults: num=" << num_defaults << " start=" << defaults_start_at << "\n";
             for (int i = std::max((int)argCount, defaults_start_at); i < nparams_count; ++i) {
                 const proto::ProtoObject* val = defaults->getAt(calleeCtx, i - defaults_start_at);
-                if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] Bind positional default: idx=" << i << " val=" << val << "\n";
+                if (get_env_diag()) std::cerr << "[proto-diag] Bind positional default: idx=" << i << " val=" << val << "\n";
                 bindVar(i, val);
             }
         }
     }
 
-    if (std::getenv("PROTO_ENV_DIAG")) {
-        std::cerr << "[proto-diag] runUserFunctionCall: " << nparams_count << " pos, " << kwonly_count << " kwonly, " << (co_varnames ? co_varnames->getSize(calleeCtx) : 0) << " total varnames\n";
+    if (get_env_diag()) {
+        std::cerr << "[proto-diag] runUserFunctionCall: " << nparams_count << " pos, " << kwonly_count << " kwonly, " << varnames_count << " total varnames\n";
     }
 
     // 3. Keyword-only arguments
     const proto::ProtoString* kwdefaults_name = env ? env->getKwdefaultsString() : proto::ProtoString::fromUTF8String(calleeCtx, "__kwdefaults__");
-    const proto::ProtoObject* kwDefaultsObj = self->getAttribute(calleeCtx, kwdefaults_name);
+    const proto::ProtoObject* kwDefaultsObj = kwonly_count > 0 ? self->getAttribute(calleeCtx, kwdefaults_name) : nullptr;
     
-    if (std::getenv("PROTO_ENV_DIAG") && kwDefaultsObj && kwDefaultsObj != PROTO_NONE) {
-        const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(calleeCtx, "__data__");
-        const proto::ProtoObject* data = kwDefaultsObj->getAttribute(calleeCtx, dataName);
-        if (data && data->asSparseList(calleeCtx)) {
-            const proto::ProtoSparseList* sl = data->asSparseList(calleeCtx);
-            std::cerr << "[proto-diag] kwDefaults map has " << sl->getSize(calleeCtx) << " entries\n";
-        }
+    if (get_env_diag() && kwDefaultsObj && kwDefaultsObj != PROTO_NONE && isDictLike(calleeCtx, kwDefaultsObj)) {
+        std::cerr << "[proto-diag] kwDefaults map has " << dictSize(calleeCtx, kwDefaultsObj) << " entries\n";
     }
 
     for (int i = 0; i < kwonly_count; ++i) {
         int slotIdx = nparams_count + i;
-        if (co_varnames && slotIdx < (int)co_varnames->getSize(calleeCtx)) {
-            const proto::ProtoObject* paramName = co_varnames->getAt(calleeCtx, slotIdx);
+        if (slotIdx < varnames_count) {
+            const proto::ProtoObject* paramName = call.varnames[slotIdx];
             if (!paramName) continue;
             
             unsigned long key = paramName->getHash(calleeCtx);
             const proto::ProtoObject* val = (kwargs && kwargs->has(calleeCtx, key)) ? kwargs->getAt(calleeCtx, key) : nullptr;
             
             if (val) {
-                if (std::getenv("PROTO_ENV_DIAG")) {
+                if (get_env_diag()) {
                     std::string n;
                     if (paramName->isString(calleeCtx)) paramName->asString(calleeCtx)->toUTF8String(calleeCtx, n);
                     std::cerr << "[proto-diag] Bind kwarg from kwargs: slot=" << slotIdx << " name='" << n << "' val=" << val << "\n";
@@ -206,25 +247,18 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
                 bindVar(slotIdx, val);
             } else if (kwDefaultsObj && kwDefaultsObj != PROTO_NONE) {
                 // Check kw-defaults
-                const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(calleeCtx, "__data__");
-                const proto::ProtoObject* data = kwDefaultsObj->getAttribute(calleeCtx, dataName);
-                if (data && data->asSparseList(calleeCtx)) {
-                    const proto::ProtoSparseList* sl = data->asSparseList(calleeCtx);
-                    if (sl->has(calleeCtx, key)) {
-                        val = sl->getAt(calleeCtx, key);
-                        if (val) {
-                            if (std::getenv("PROTO_ENV_DIAG")) {
-                                std::string n;
-                                if (paramName->isString(calleeCtx)) paramName->asString(calleeCtx)->toUTF8String(calleeCtx, n);
-                                std::cerr << "[proto-diag] Bind kw-default: slot=" << slotIdx << " name='" << n << "' val=" << val << "\n";
-                            }
-                            bindVar(slotIdx, val);
-                        }
-                    } else if (std::getenv("PROTO_ENV_DIAG")) {
+                val = dictGet(calleeCtx, kwDefaultsObj, paramName);
+                if (val) {
+                    if (get_env_diag()) {
                         std::string n;
                         if (paramName->isString(calleeCtx)) paramName->asString(calleeCtx)->toUTF8String(calleeCtx, n);
-                        std::cerr << "[proto-diag] Kw-default NOT FOUND in dict: name='" << n << "'\n";
+                        std::cerr << "[proto-diag] Bind kw-default: slot=" << slotIdx << " name='" << n << "' val=" << val << "\n";
                     }
+                    bindVar(slotIdx, val);
+                } else if (get_env_diag()) {
+                    std::string n;
+                    if (paramName->isString(calleeCtx)) paramName->asString(calleeCtx)->toUTF8String(calleeCtx, n);
+                    std::cerr << "[proto-diag] Kw-default NOT FOUND in dict: name='" << n << "'\n";
                 }
             }
         }
@@ -236,7 +270,7 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
         const proto::ProtoList* starArgs = calleeCtx->newList();
         if (argCount > (unsigned long)nparams_count) {
             for (unsigned long i = nparams_count; i < argCount; ++i) {
-                starArgs = starArgs->appendLast(calleeCtx, args->getAt(calleeCtx, static_cast<int>(i)));
+                starArgs = starArgs->appendLast(calleeCtx, argv[i]);
             }
         }
         const proto::ProtoObject* tup = calleeCtx->newTupleFromList(starArgs)->asObject(calleeCtx);
@@ -260,15 +294,7 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
                 const proto::ProtoObject* val = it->nextValue(calleeCtx);
                 
                 // Only add if not already bound to a positional or kwonly param
-                bool alreadyBound = false;
-                for (unsigned long i = 0; i < (unsigned long)(nparams_count + kwonly_count); ++i) {
-                     const proto::ProtoObject* paramName = co_varnames->getAt(calleeCtx, i);
-                     if (paramName && paramName->getHash(calleeCtx) == key) {
-                         alreadyBound = true;
-                         break;
-                     }
-                }
-                if (!alreadyBound) {
+                if (call.paramSlots.find(key) == call.paramSlots.end()) {
                     data = data->setAt(calleeCtx, key, val);
                 }
                 it = const_cast<proto::ProtoSparseListIterator*>(it)->advance(calleeCtx);
@@ -278,29 +304,24 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
         bindVar(kwargIdx, kwDict);
     }
 
-    const proto::ProtoObject* isGenObj = codeObj->getAttribute(calleeCtx, env ? env->getCoIsGeneratorString() : proto::ProtoString::fromUTF8String(calleeCtx, "co_is_generator"));
-    bool isGenerator = isGenObj && isGenObj->isBoolean(calleeCtx) && isGenObj->asBoolean(calleeCtx);
-
-    if (isGenerator) {
+    if (call.isGenerator) {
         proto::ProtoObject* gen = const_cast<proto::ProtoObject*>(calleeCtx->newObject(true));
         if (env && env->getGeneratorPrototype()) {
             gen = const_cast<proto::ProtoObject*>(gen->addParent(calleeCtx, env->getGeneratorPrototype()));
             gen->setAttribute(calleeCtx, env->getClassString(), env->getGeneratorPrototype());
         }
-        gen->setAttribute(calleeCtx, env ? env->getGiCodeString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_code"), codeObj);
-        gen->setAttribute(calleeCtx, env ? env->getGiFrameString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_frame"), frame);
-        gen->setAttribute(calleeCtx, env ? env->getGiRunningString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_running"), PROTO_FALSE);
-        gen->setAttribute(calleeCtx, env ? env->getGiPCString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_pc"), calleeCtx->fromInteger(0));
-        
-        const proto::ProtoList* emptyStack = calleeCtx->newList();
-        gen->setAttribute(calleeCtx, env ? env->getGiStackString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_stack"), emptyStack->asObject(calleeCtx));
-        
-        const proto::ProtoList* localList = calleeCtx->newList();
-        for (unsigned int i = 0; i < nSlots; ++i) {
-            localList = localList->appendLast(calleeCtx, slots[i]);
-        }
-        gen->setAttribute(calleeCtx, env ? env->getGiLocalsString() : proto::ProtoString::fromUTF8String(calleeCtx, "gi_locals"), localList->asObject(calleeCtx));
-        
+        GeneratorState* state = new GeneratorState();
+        state->code = codeObj;
+        state->decoded = decoded;
+        state->frame = frame;
+        state->globals = globalsObj;
+        state->localNames = call.localNames;
+        state->stackOffset = call.varnames.size();
+        if (slots) state->locals.assign(slots, slots + nSlots);
+        gen->setAttribute(calleeCtx, env ? env->getGiStateString() : proto::ProtoString::fromUTF8String(calleeCtx, "__gi_state__"),
+            calleeCtx->fromExternalPointer(state, generator_state_finalizer));
+        initGeneratorPins(calleeCtx, env, gen, *state);
+
         promote(calleeCtx, gen);
         return gen;
     }
@@ -308,12 +329,37 @@ static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
     const proto::ProtoObject* result = nullptr;
     {
         GlobalsScope gscope(globalsObj);
-        result = runCodeObject(calleeCtx, codeObj, frame);
+        if (nSlots >= static_cast<unsigned int>(call.automaticCount)) {
+            PythonEnvironment::CodeObjectScope cscope(codeObj);
+            FrameScope fscope(frame, &lazy);
+            result = executeDecodedRange(calleeCtx, decoded, frame, 0, decoded->codeSize, call.varnames.size());
+        } else {
+            if (!frame) frame = materializeFrame(&lazy);
+            result = runCodeObject(calleeCtx, codeObj, frame);
+        }
     }
     promote(calleeCtx, result);
     return result;
 }
 
+static const proto::ProtoObject* runUserFunctionCall(proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* args,
+    const proto::ProtoSparseList* kwargs) {
+    if (!ctx || !self || !args) return PROTO_NONE;
+    std::vector<const proto::ProtoObject*> argv;
+    argv.reserve(args->getSize(ctx));
+    for (unsigned long i = 0; i < args->getSize(ctx); ++i)
+        argv.push_back(args->getAt(ctx, static_cast<int>(i)));
+    return runUserFunction(ctx, self, argv.data(), argv.size(), kwargs);
+}
+
+static const proto::ProtoObject* runUserFunctionVectorcall(proto::ProtoContext* ctx,
+    const proto::ProtoObject* self, const proto::ProtoObject* const* args, size_t nargs) {
+    return runUserFunction(ctx, self, args, nargs, nullptr);
+}
+
 static const proto::ProtoObject* runBoundMethodCall(proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
@@ -338,6 +384,30 @@ static const proto::ProtoObject* runBoundMethodCall(proto::ProtoContext* ctx,
     return invokePythonCallable(ctx, im_func, newArgs, kwargs);
 }
 
+static const proto::ProtoObject* runBoundMethodVectorcall(proto::ProtoContext* ctx,
+    const proto::ProtoObject* self, const proto::ProtoObject* const* args, size_t nargs) {
+    if (!ctx || !self) return PROTO_NONE;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env) return PROTO_NONE;
+
+    const proto::ProtoObject* im_self = self->getAttribute(ctx, env->getSelfDunderString());
+    const proto::ProtoObject* im_func = self->getAttribute(ctx, env->getFuncDunderString());
+    if (!im_self || !im_func) return PROTO_NONE;
+
+    // Prepend im_self; short calls stay on the C++ stack.
+    constexpr size_t kInlineArgs = 8;
+    const proto::ProtoObject* inlineArgs[kInlineArgs];
+    std::vector<const proto::ProtoObject*> heapArgs;
+    const proto::ProtoObject** withSelf = inlineArgs;
+    if (nargs + 1 > kInlineArgs) {
+        heapArgs.resize(nargs + 1);
+        withSelf = heapArgs.data();
+    }
+    withSelf[0] = im_self;
+    for (size_t i = 0; i < nargs; ++i) withSelf[i + 1] = args[i];
+    return vectorcallObject(ctx, im_func, withSelf, nargs + 1);
+}
+
 static const proto::ProtoObject* py_function_get(proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
@@ -429,7 +499,7 @@ static bool isEmbeddedValue(const proto::ProtoObject* obj) {
 
 static const proto::ProtoObject* binaryAdd(proto::ProtoContext* ctx,
     const proto::ProtoObject* a, const proto::ProtoObject* b) {
-    if (std::getenv("PROTO_ENV_DIAG")) {
+    if (get_env_diag()) {
         std::cerr << "[proto-diag] binaryAdd: a=" << a << " b=" << b
                   << " aL=" << (a->asList(ctx) ? "y" : "n") << " bL=" << (b->asList(ctx) ? "y" : "n")
                   << "\n";
@@ -440,30 +510,13 @@ static const proto::ProtoObject* binaryAdd(proto::ProtoContext* ctx,
         if ((a->isDouble(ctx) || a->isInteger(ctx)) && (b->isDouble(ctx) || b->isInteger(ctx)))
              return ctx->fromDouble(a->asDouble(ctx) + b->asDouble(ctx));
     }
-    if (a->isString(ctx) && b->isString(ctx)) {
-        std::string s1, s2;
-        a->asString(ctx)->toUTF8String(ctx, s1);
-        b->asString(ctx)->toUTF8String(ctx, s2);
-        return ctx->fromUTF8String((s1 + s2).c_str());
-    }
+    if (a->isString(ctx) && b->isString(ctx))
+        return concatStrings(ctx, a->asString(ctx), b->asString(ctx));
 
-    if (a->asList(ctx) && b->asList(ctx)) {
-        PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
-        const proto::ProtoList* l1 = a->asList(ctx);
-        const proto::ProtoList* l2 = b->asList(ctx);
-        proto::ProtoList* resL = const_cast<proto::ProtoList*>(ctx->newList());
-        unsigned long n1 = l1->getSize(ctx);
-        unsigned long n2 = l2->getSize(ctx);
-        for (unsigned long i = 0; i < n1; ++i) resL = const_cast<proto::ProtoList*>(resL->appendLast(ctx, l1->getAt(ctx, i)));
-        for (unsigned long i = 0; i < n2; ++i) resL = const_cast<proto::ProtoList*>(resL->appendLast(ctx, l2->getAt(ctx, i)));
-        
-        proto::ProtoObject* resObj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
-        resObj->setAttribute(ctx, env->getDataString(), resL->asObject(ctx));
-        if (env->getListPrototype()) {
-            resObj = const_cast<proto::ProtoObject*>(resObj->addParent(ctx, env->getListPrototype()));
-            resObj->setAttribute(ctx, env->getClassString(), env->getListPrototype());
-        }
-        return resObj;
+    if ((a->asList(ctx) || listBuffer(ctx, a)) && (b->asList(ctx) || listBuffer(ctx, b))) {
+        std::vector<const proto::ProtoObject*> items;
+        if (listItems(ctx, a, &items) && listItems(ctx, b, &items))
+            return newListObject(ctx, std::move(items));
     }
     if (a->asTuple(ctx) && b->asTuple(ctx)) {
         PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
@@ -671,6 +724,10 @@ static const proto::ProtoObject* compareOp(proto::ProtoContext* ctx,
     if (op == 6 || op == 7) { // in, not in
         bool found = false;
         const proto::ProtoList* lst = b->asList(ctx);
+        if (!lst && isDictLike(ctx, b)) {
+            found = dictGet(ctx, b, a) != nullptr;
+            return ((op == 6) ? found : !found) ? PROTO_TRUE : PROTO_FALSE;
+        }
         if (!lst) {
             // Try dictionary keys
             PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
@@ -807,6 +864,41 @@ static const proto::ProtoObject* invokeCallable(proto::ProtoContext* ctx,
     return result;
 }
 
+/**
+ * CALL_FUNCTION path. args usually points into the caller's value stack; it is only
+ * copied into a ProtoList when the callee's native method has no vectorcall form.
+ */
+static const proto::ProtoObject* vectorcallObject(proto::ProtoContext* ctx,
+    const proto::ProtoObject* callable, const proto::ProtoObject* const* args, size_t nargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    NativeMethod method = nullptr;
+    const proto::ProtoObject* self = nullptr;
+    if (callable && callable->isMethod(ctx)) {
+        const auto* cell = proto::toImpl<const proto::ProtoMethodCell>(callable);
+        method = cell->method;
+        self = cell->self;
+    } else if (callable) {
+        // invokeCallable calls __call__ with the callable as self; a method cell found by
+        // the plain lookup is what PythonEnvironment::getAttribute would bind.
+        const proto::ProtoObject* callAttr = callable->getAttribute(ctx,
+            env ? env->getCallString() : proto::ProtoString::fromUTF8String(ctx, "__call__"));
+        if (callAttr && callAttr != PROTO_NONE && callAttr->isMethod(ctx)) {
+            method = callAttr->asMethod(ctx);
+            self = callable;
+        }
+    }
+    VectorcallMethod vectorcall = method ? findVectorcall(method) : nullptr;
+    if (!vectorcall) {
+        const proto::ProtoList* argList = ctx->newList();
+        for (size_t i = 0; i < nargs; ++i)
+            argList = argList->appendLast(ctx, args[i]);
+        return invokeCallable(ctx, callable, argList);
+    }
+    RecursionScope recScope(env, ctx);
+    if (recScope.overflowed()) return nullptr;
+    return vectorcall(ctx, self, args, nargs);
+}
+
 } // anonymous namespace
 
 const proto::ProtoObject* py_generator_send_impl(
@@ -826,16 +918,21 @@ const proto::ProtoObject* py_generator_send_impl(
         return nullptr;
     }
 
-    // 1. Check if running
-    const proto::ProtoObject* runningAttr = self->getAttribute(ctx, env->getGiRunningString());
-    if (runningAttr == PROTO_TRUE) {
+    // 1. Bytecode generators keep their state natively
+    GeneratorState* state = getGeneratorState(ctx, self);
+    if (state && state->running) {
         env->raiseValueError(ctx, ctx->fromUTF8String("generator already executing"));
         return PROTO_NONE;
     }
 
     // 2. Check for native callback
-    const proto::ProtoObject* nativeCb = self->getAttribute(ctx, env->getGiNativeCallbackString());
+    const proto::ProtoObject* nativeCb = state ? nullptr : self->getAttribute(ctx, env->getGiNativeCallbackString());
     if (nativeCb && nativeCb != PROTO_NONE) {
+        const proto::ProtoObject* runningAttr = self->getAttribute(ctx, env->getGiRunningString());
+        if (runningAttr == PROTO_TRUE) {
+            env->raiseValueError(ctx, ctx->fromUTF8String("generator already executing"));
+            return PROTO_NONE;
+        }
         // Native generators use a C++ callback that handles state.
         // We pass self (the generator) and sendVal (the value being sent).
         // The callback is responsible for updating gi_pc and gi_locals/stack on self.
@@ -852,153 +949,63 @@ const proto::ProtoObject* py_generator_send_impl(
             throw exc;
         }
     }
+    if (!state) return PROTO_NONE;
 
-    // 3. Get bytecode state
-    const proto::ProtoObject* codeObj = self->getAttribute(ctx, env->getGiCodeString());
-    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(self->getAttribute(ctx, env->getGiFrameString()));
-    const proto::ProtoObject* pcObj = self->getAttribute(ctx, env->getGiPCString());
-    const proto::ProtoObject* stackObj = self->getAttribute(ctx, env->getGiStackString());
-    const proto::ProtoObject* blocksObj = self->getAttribute(ctx, env->getGiBlocksString());
-
-    if (!codeObj || !frame || !pcObj || !stackObj) return PROTO_NONE;
-
-    // Restore blockStack
-    std::vector<Block> blockStack;
-    const proto::ProtoList* blist = blocksObj ? blocksObj->asList(ctx) : nullptr;
-    if (blist) {
-        unsigned long size = blist->getSize(ctx);
-        for (unsigned long i = 0; i < size; ++i) {
-            const proto::ProtoObject* item = blist->getAt(ctx, static_cast<int>(i));
-            if (item && item->isTuple(ctx)) {
-                const proto::ProtoTuple* t = item->asTuple(ctx);
-                if (t->getSize(ctx) >= 2) {
-                    blockStack.push_back({
-                        static_cast<unsigned long>(t->getAt(ctx, 0)->asLong(ctx)),
-                        static_cast<size_t>(t->getAt(ctx, 1)->asLong(ctx))
-                    });
-                }
-            }
-        }
-    }
-
-    unsigned long pc = (pcObj && pcObj->isInteger(ctx)) ? static_cast<unsigned long>(pcObj->asLong(ctx)) : 0;
-    const proto::ProtoList* co_code_list = codeObj->getAttribute(ctx, env->getCoCodeString())->asList(ctx);
-    if (!co_code_list) return PROTO_NONE;
-    
-    if (pc >= co_code_list->getSize(ctx)) {
+    // 3. Resume from the native state
+    const DecodedCode* decoded = state->decoded;
+    if (state->finished()) {
         env->raiseStopIteration(ctx, PROTO_NONE);
         return PROTO_NONE;
     }
 
-    // 3. Restore stack
-    std::vector<const proto::ProtoObject*> stack;
-    const proto::ProtoList* slist = stackObj ? stackObj->asList(ctx) : nullptr;
-    
-    if (slist) {
-        unsigned long size = slist->getSize(ctx);
-        for (unsigned long i = 0; i < size; ++i) {
-             const proto::ProtoObject* item = slist->getAt(ctx, static_cast<int>(i));
-             stack.push_back(item);
-        }
-    }
-
     // 4. If sendVal is provided, push it (unless it's the very first call and None)
-    if (pc > 0) {
-        stack.push_back(sendVal);
+    if (state->pc > 0) {
+        state->stack.push_back(sendVal);
     } else if (sendVal != PROTO_NONE) {
         env->raiseTypeError(ctx, "can't send non-None value to a just-started generator");
         return PROTO_NONE;
     }
 
     // 5. Run
-    self->setAttribute(ctx, env->getGiRunningString(), PROTO_TRUE);
-    
-    if (throwExc) {
-        env->setPendingException(throwExc);
-    }
-    
-    unsigned long nextPc = pc; // Default to current if we exception immediately
+    unsigned long nextPc = decoded->codeSize; // Finished unless the body yields
     bool yielded = false;
-    
     const proto::ProtoObject* result = nullptr;
     {
-        const proto::ProtoObject* co_varnames_obj = codeObj->getAttribute(ctx, env->getCoVarnamesString());
-        const proto::ProtoList* co_varnames = co_varnames_obj ? co_varnames_obj->asList(ctx) : nullptr;
-        const proto::ProtoObject* co_automatic_obj = codeObj->getAttribute(ctx, env->getCoAutomaticCountString());
-        int automatic_count = co_automatic_obj ? static_cast<int>(co_automatic_obj->asLong(ctx)) : 0;
-        
-        const proto::ProtoList* localNames = ctx->newList();
-        if (co_varnames) {
-            unsigned long vSize = co_varnames->getSize(ctx);
-            for (int i = 0; i < automatic_count; ++i) {
-                const proto::ProtoObject* name = (i < static_cast<int>(vSize)) ? co_varnames->getAt(ctx, i) : PROTO_NONE;
-                localNames = localNames->appendLast(ctx, name);
-            }
+        GeneratorRunScope running(*state);
+        if (throwExc) {
+            env->setPendingException(throwExc);
         }
-        
-        ContextScope scope(ctx->space, ctx, nullptr, localNames, nullptr, nullptr);
+
+        ContextScope scope(ctx->space, ctx, nullptr, state->localNames, nullptr, nullptr);
         proto::ProtoContext* calleeCtx = scope.context();
-        
-        // Restore locals from gi_locals
-        const proto::ProtoObject* localsObj = self->getAttribute(ctx, env->getGiLocalsString());
-        const proto::ProtoList* savedLocals = localsObj ? localsObj->asList(ctx) : nullptr;
+        proto::ProtoObject** slots = const_cast<proto::ProtoObject**>(calleeCtx->getAutomaticLocals());
+        const size_t nSlots = slots ? std::min<size_t>(calleeCtx->getAutomaticLocalsCount(), state->locals.size()) : 0;
+        for (size_t i = 0; i < nSlots; ++i)
+            slots[i] = const_cast<proto::ProtoObject*>(state->locals[i]);
 
-        if (savedLocals) {
-            proto::ProtoObject** slots = const_cast<proto::ProtoObject**>(calleeCtx->getAutomaticLocals());
-            for (unsigned int i = 0; i < calleeCtx->getAutomaticLocalsCount() && i < savedLocals->getSize(ctx); ++i) {
-                slots[i] = const_cast<proto::ProtoObject*>(savedLocals->getAt(ctx, i));
-            }
-        }
-        
-        const proto::ProtoObject* globals = frame->getAttribute(calleeCtx, env->getFGlobalsString());
-        if (!globals) globals = env->getGlobals();
-        GlobalsScope gscope(globals);
-        
-        const proto::ProtoList* co_consts = codeObj->getAttribute(calleeCtx, env->getCoConstsString())->asList(calleeCtx);
-        const proto::ProtoList* co_names = codeObj->getAttribute(calleeCtx, env->getCoNamesString())->asList(calleeCtx);
-        
-        unsigned long stackOffset = co_varnames ? co_varnames->getSize(calleeCtx) : 0;
-        result = executeBytecodeRange(calleeCtx, 
-            co_consts,
-            co_code_list,
-            co_names,
+        GlobalsScope gscope(state->globals ? state->globals : env->getGlobals());
+        proto::ProtoObject* frame = state->frame;
+        result = executeDecodedRange(calleeCtx,
+            decoded,
             frame,
-            pc,
-            co_code_list->getSize(calleeCtx),
-            stackOffset,
-            &stack,
+            state->pc,
+            decoded->codeSize,
+            state->stackOffset,
+            &state->stack,
             &nextPc,
             &yielded,
-            &blockStack);
-            
-        const proto::ProtoList* newLocals = calleeCtx->newList();
-        const proto::ProtoObject** updatedSlots = calleeCtx->getAutomaticLocals();
-        for (unsigned int i = 0; i < calleeCtx->getAutomaticLocalsCount(); ++i) {
-            newLocals = newLocals->appendLast(calleeCtx, updatedSlots[i]);
-        }
-        self->setAttribute(calleeCtx, env->getGiLocalsString(), newLocals->asObject(calleeCtx));
-    }
+            &state->blocks);
 
-    // 8. Clear running (already done above but let's be explicit)
-    self->setAttribute(ctx, env->getGiRunningString(), PROTO_FALSE);
-    self->setAttribute(ctx, env->getGiPCString(), ctx->fromInteger(nextPc));
-
-    // 6. Save stack back
-    const proto::ProtoList* newStack = ctx->newList();
-    for (const auto* obj : stack)
-        newStack = newStack->appendLast(ctx, obj);
-    self->setAttribute(ctx, env->getGiStackString(), newStack->asObject(ctx));
+        if (yielded) saveGeneratorSlots(ctx, env, self, *state, slots, nSlots);
+    }
 
-    // Save blockStack back
-    const proto::ProtoList* newBlocks = ctx->newList();
-    for (const auto& b : blockStack) {
-        const proto::ProtoList* tempL = ctx->newList();
-        tempL = tempL->appendLast(ctx, ctx->fromInteger(b.handlerPc));
-        tempL = tempL->appendLast(ctx, ctx->fromInteger(b.stackDepth));
-        const proto::ProtoObject* bTup = ctx->newTupleFromList(tempL)->asObject(ctx);
-        newBlocks = newBlocks->appendLast(ctx, bTup);
+    // 6. Suspend or finish; a yield only rewrites the pins that changed.
+    if (yielded) {
+        state->pc = nextPc;
+    } else {
+        state->pc = decoded->codeSize;
+        releaseGeneratorSlots(ctx, env, self, *state);
     }
-    self->setAttribute(ctx, env->getGiBlocksString(), newBlocks->asObject(ctx));
 
     if (!yielded && !env->hasPendingException()) {
         env->raiseStopIteration(ctx, result);
@@ -1022,7 +1029,8 @@ const proto::ProtoObject* py_generator_repr(
     PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
     if (!env) return ctx->fromUTF8String("<generator object>");
 
-    const proto::ProtoObject* code = self->getAttribute(ctx, env->getGiCodeString());
+    const GeneratorState* state = getGeneratorState(ctx, self);
+    const proto::ProtoObject* code = state ? state->code : nullptr;
     std::string name = "<unknown>";
     if (code) {
         const proto::ProtoObject* co_name = code->getAttribute(ctx, env->getCoNameString());
@@ -1065,8 +1073,10 @@ const proto::ProtoObject* py_generator_close(
     if (!env) return PROTO_NONE;
     
     // Check if already closed
-    const proto::ProtoObject* pcObj = self->getAttribute(ctx, env->getGiPCString());
-    const proto::ProtoObject* codeObj = self->getAttribute(ctx, env->getGiCodeString());
+    const GeneratorState* state = getGeneratorState(ctx, self);
+    if (state && state->finished()) return PROTO_NONE;
+    const proto::ProtoObject* pcObj = state ? nullptr : self->getAttribute(ctx, env->getGiPCString());
+    const proto::ProtoObject* codeObj = state ? nullptr : self->getAttribute(ctx, env->getGiCodeString());
     if (pcObj && codeObj && pcObj->isInteger(ctx) && codeObj->getAttribute(ctx, env->getCoCodeString())->asList(ctx)) {
         unsigned long pc = static_cast<unsigned long>(pcObj->asLong(ctx));
         if (pc >= codeObj->getAttribute(ctx, env->getCoCodeString())->asList(ctx)->getSize(ctx)) {
@@ -1091,6 +1101,99 @@ const proto::ProtoObject* py_generator_close(
     return PROTO_NONE;
 }
 
+namespace {
+
+/** Generator a gi_* descriptor's __get__ was invoked for (args are (obj, type)). */
+const GeneratorState* viewedGeneratorState(proto::ProtoContext* ctx, const proto::ProtoList* args) {
+    if (!args || args->getSize(ctx) < 1) return nullptr;
+    return getGeneratorState(ctx, args->getAt(ctx, 0));
+}
+
+const proto::ProtoObject* objectListView(proto::ProtoContext* ctx, const proto::ProtoObject* const* values, size_t n) {
+    const proto::ProtoList* list = ctx->newList();
+    for (size_t i = 0; i < n; ++i)
+        list = list->appendLast(ctx, values[i] ? values[i] : PROTO_NONE);
+    return list->asObject(ctx);
+}
+
+} // anonymous namespace
+
+const proto::ProtoObject* py_generator_gi_code(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    return state && state->code ? state->code : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_generator_gi_frame(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    return state && !state->finished() && state->frame ? state->frame : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_generator_gi_running(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    if (!state) return PROTO_NONE;
+    return state->running ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_generator_gi_pc(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    return state ? ctx->fromInteger(static_cast<long long>(state->pc)) : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_generator_gi_stack(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    return state ? objectListView(ctx, state->stack.data(), state->stack.size()) : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_generator_gi_blocks(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    if (!state) return PROTO_NONE;
+    const proto::ProtoList* blocks = ctx->newList();
+    for (const Block& b : state->blocks) {
+        const proto::ProtoList* pair = ctx->newList()
+            ->appendLast(ctx, ctx->fromInteger(static_cast<long long>(b.handlerPc)))
+            ->appendLast(ctx, ctx->fromInteger(static_cast<long long>(b.stackDepth)));
+        blocks = blocks->appendLast(ctx, ctx->newTupleFromList(pair)->asObject(ctx));
+    }
+    return blocks->asObject(ctx);
+}
+
+const proto::ProtoObject* py_generator_gi_locals(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    return state ? objectListView(ctx, state->locals.data(), state->locals.size()) : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_generator_gi_yieldfrom(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    const GeneratorState* state = viewedGeneratorState(ctx, args);
+    if (!state || state->finished() || state->stack.empty()) return PROTO_NONE;
+    // Suspended inside YIELD_FROM: the delegate stays on top of the saved stack.
+    if (state->decoded->instrs[state->pc >> 1].generic != OP_YIELD_FROM) return PROTO_NONE;
+    return state->stack.back();
+}
+
 const proto::ProtoObject* invokePythonCallable(proto::ProtoContext* ctx,
     const proto::ProtoObject* callable, const proto::ProtoList* args, const proto::ProtoSparseList* kwargs) {
     return invokeCallable(ctx, callable, args, kwargs);
@@ -1101,17 +1204,8 @@ static bool get_env_diag() {
     return diag;
 }
 
-static void checkSTW(proto::ProtoContext* ctx) {
-    if (ctx && ctx->space && ctx->space->stwFlag.load()) {
-        if (ctx->space->gcThread && std::this_thread::get_id() == ctx->space->gcThread->get_id()) return;
-        ctx->space->parkedThreads++;
-        {
-            std::unique_lock<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
-            ctx->space->gcCV.notify_all();
-            ctx->space->stopTheWorldCV.wait(lock, [ctx] { return !ctx->space->stwFlag.load(); });
-        }
-        ctx->space->parkedThreads--;
-    }
+static inline void checkSTW(proto::ProtoContext* ctx) {
+    if (ctx && ctx->space && ctx->space->stwFlag.load()) gcSafepoint(ctx);
 }
 
 static const proto::ProtoObject* invokeDunder(proto::ProtoContext* ctx, const proto::ProtoObject* container, const proto::ProtoString* name, const proto::ProtoList* args) {
@@ -1129,6 +1223,272 @@ static const proto::ProtoObject* invokeDunder(proto::ProtoContext* ctx, const pr
     return invokeCallable(ctx, method, args);
 }
 
+static void appendListItems(proto::ProtoContext* ctx, const proto::ProtoList* list,
+    std::vector<const proto::ProtoObject*>& out) {
+    if (!list) return;
+    out.reserve(list->getSize(ctx));
+    const proto::ProtoListIterator* it = list->getIterator(ctx);
+    while (it && it->hasNext(ctx)) {
+        out.push_back(it->next(ctx));
+        it = it->advance(ctx);
+    }
+}
+
+/** Fuse common instruction sequences into superinstructions (see OP_LOAD_FAST_LOAD_FAST). */
+static void fuseSuperinstructions(DecodedCode* code) {
+    std::vector<DecodedInstr>& instrs = code->instrs;
+    const size_t count = instrs.size();
+    // Instructions something can jump to; a fused sequence must not cover one past its head.
+    std::vector<bool> target(count + 1, false);
+    auto mark = [&](long long pc) {
+        if (pc >= 0 && (pc & 1) == 0 && static_cast<size_t>(pc >> 1) < count) target[pc >> 1] = true;
+    };
+    for (size_t k = 0; k < count; ++k) {
+        const DecodedInstr& d = instrs[k];
+        switch (d.op) {
+            case OP_POP_JUMP_IF_FALSE: case OP_POP_JUMP_IF_TRUE: case OP_JUMP_ABSOLUTE: case OP_FOR_ITER:
+            case OP_SETUP_FINALLY: case OP_SETUP_WITH: case OP_SETUP_ASYNC_WITH:
+                mark(d.arg);
+                break;
+            case OP_JUMP_FORWARD:
+                mark(static_cast<long long>(2 * k + 2) + d.arg);
+                break;
+            default:
+                break;
+        }
+    }
+    auto opAt = [&](size_t k) { return k < count && !target[k] ? instrs[k].op : OP_DECODED_SKIP; };
+    for (size_t k = 0; k < count; ++k) {
+        int fused = 0;
+        if (instrs[k].op == OP_LOAD_FAST) {
+            int add = opAt(k + 2);
+            if (opAt(k + 1) == OP_LOAD_CONST && (add == OP_BINARY_ADD || add == OP_INPLACE_ADD) &&
+                opAt(k + 3) == OP_STORE_FAST)
+                fused = OP_LOAD_FAST_ADD_CONST_STORE_FAST;
+            else if (opAt(k + 1) == OP_LOAD_FAST)
+                fused = OP_LOAD_FAST_LOAD_FAST;
+        } else if (instrs[k].op == OP_COMPARE_OP && opAt(k + 1) == OP_POP_JUMP_IF_FALSE) {
+            fused = OP_COMPARE_OP_POP_JUMP_IF_FALSE;
+        }
+        if (!fused) continue;
+        instrs[k].fused = fused;
+        instrs[k].op = fused;
+        instrs[k].counter = -1;  // The head's generic handler must not quicken over the fusion.
+        k += superinstructionLength(fused) - 1;
+    }
+}
+
+static void decoded_code_finalizer(void* ptr) {
+    delete static_cast<DecodedCode*>(ptr);
+}
+
+DecodedCode* decodeBytecode(proto::ProtoContext* ctx,
+    const proto::ProtoList* constants,
+    const proto::ProtoList* bytecode,
+    const proto::ProtoList* names) {
+    DecodedCode* code = new DecodedCode();
+    if (!ctx) return code;
+    appendListItems(ctx, constants, code->consts);
+    appendListItems(ctx, names, code->names);
+
+    // One in-order walk of the AVL list instead of two getAt() lookups per instruction.
+    std::vector<const proto::ProtoObject*> words;
+    appendListItems(ctx, bytecode, words);
+    code->codeSize = words.size();
+    code->instrs.resize((words.size() + 1) / 2);
+    for (size_t i = 0; i < words.size(); i += 2) {
+        const proto::ProtoObject* opObj = words[i];
+        const proto::ProtoObject* argObj = (i + 1 < words.size()) ? words[i + 1] : nullptr;
+        DecodedInstr& d = code->instrs[i >> 1];
+        d.op = (opObj && opObj->isInteger(ctx)) ? static_cast<int>(opObj->asLong(ctx)) : OP_DECODED_SKIP;
+        d.arg = (argObj && argObj->isInteger(ctx)) ? static_cast<int>(argObj->asLong(ctx)) : 0;
+        d.generic = d.op;
+        if (d.op == OP_LOAD_ATTR || d.op == OP_STORE_ATTR)
+            d.cache = static_cast<int>(code->attrCacheSites++);
+        else if (d.op == OP_LOAD_NAME || d.op == OP_LOAD_GLOBAL)
+            d.cache = static_cast<int>(code->globalCacheSites++);
+    }
+    fuseSuperinstructions(code);
+    return code;
+}
+
+proto::ProtoObject* materializeFrame(LazyFrame* lazy) {
+    if (!lazy || !lazy->ctx) return nullptr;
+    if (lazy->frame) return lazy->frame;
+    proto::ProtoContext* ctx = lazy->ctx;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    if (env) {
+        frame = const_cast<proto::ProtoObject*>(frame->addParent(ctx, env->getFramePrototype()));
+        if (lazy->closure) frame = const_cast<proto::ProtoObject*>(frame->addParent(ctx, lazy->closure));
+        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(ctx, env->getFCodeString(), lazy->code));
+        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(ctx, env->getFGlobalsString(), lazy->globals));
+        frame = const_cast<proto::ProtoObject*>(frame->setAttribute(ctx, env->getFLocalsString(), frame));
+    }
+    lazy->frame = frame;
+    return frame;
+}
+
+/** Load co_exceptiontable and drop SETUP_FINALLY/POP_BLOCK from the dispatched stream. */
+static void attachExceptionTable(proto::ProtoContext* ctx, const proto::ProtoList* table, DecodedCode& code) {
+    std::vector<const proto::ProtoObject*> words;
+    appendListItems(ctx, table, words);
+    for (size_t k = 0; k + 3 < words.size(); k += 4) {
+        long long v[4];
+        for (int j = 0; j < 4; ++j)
+            v[j] = (words[k + j] && words[k + j]->isInteger(ctx)) ? words[k + j]->asLong(ctx) : -1;
+        if (v[0] < 0 || v[1] < v[0] || v[2] < 0 || v[3] < 0) continue;
+        code.exceptionTable.push_back({static_cast<unsigned long>(v[0]), static_cast<unsigned long>(v[1]),
+            static_cast<unsigned long>(v[2]), static_cast<size_t>(v[3])});
+    }
+    code.staticHandlers = true;
+    for (DecodedInstr& d : code.instrs) {
+        // generic keeps the original opcode for getBasicBlockBoundaries.
+        if (d.generic == OP_SETUP_FINALLY || d.generic == OP_POP_BLOCK) d.op = OP_DECODED_SKIP;
+    }
+}
+
+/** Innermost exception table entry covering pc, or nullptr. */
+static const ExceptionTableEntry* findExceptionHandler(const DecodedCode& code, unsigned long pc) {
+    for (const ExceptionTableEntry& e : code.exceptionTable) {
+        if (pc >= e.start && pc <= e.end) return &e;
+    }
+    return nullptr;
+}
+
+static int intAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const proto::ProtoString* name) {
+    const proto::ProtoObject* v = obj->getAttribute(ctx, name);
+    return (v && v->isInteger(ctx)) ? static_cast<int>(v->asLong(ctx)) : 0;
+}
+
+/**
+ * Fill call from the code object's co_* attributes. Returns the list that pins call's
+ * ContextScope name lists, for the caller to store on codeObj (nullptr: nothing to pin).
+ */
+static const proto::ProtoList* describeCall(proto::ProtoContext* ctx, PythonEnvironment* env,
+    const proto::ProtoObject* codeObj, const DecodedCode& code, CodeCallInfo& call) {
+    const proto::ProtoObject* varnamesObj = codeObj->getAttribute(ctx,
+        env ? env->getCoVarnamesString() : proto::ProtoString::fromUTF8String(ctx, "co_varnames"));
+    const proto::ProtoList* varnames = varnamesObj ? varnamesObj->asList(ctx) : nullptr;
+    call.flags = intAttribute(ctx, codeObj, env ? env->getCoFlagsString() : proto::ProtoString::fromUTF8String(ctx, "co_flags"));
+    call.nparams = intAttribute(ctx, codeObj, env ? env->getCoNparamsString() : proto::ProtoString::fromUTF8String(ctx, "co_nparams"));
+    call.kwonly = intAttribute(ctx, codeObj, env ? env->getCoKwonlyargcountString() : proto::ProtoString::fromUTF8String(ctx, "co_kwonlyargcount"));
+    call.automaticCount = intAttribute(ctx, codeObj, env ? env->getCoAutomaticCountString() : proto::ProtoString::fromUTF8String(ctx, "co_automatic_count"));
+    const proto::ProtoObject* isGen = codeObj->getAttribute(ctx,
+        env ? env->getCoIsGeneratorString() : proto::ProtoString::fromUTF8String(ctx, "co_is_generator"));
+    call.isGenerator = isGen && isGen->isBoolean(ctx) && isGen->asBoolean(ctx);
+    call.needsFrame = !(call.flags & CO_OPTIMIZED) || call.isGenerator;
+    for (const DecodedInstr& d : code.instrs) {
+        switch (d.generic) {
+            case OP_STORE_NAME: case OP_DELETE_NAME:
+            case OP_STORE_GLOBAL: case OP_DELETE_GLOBAL:
+            case OP_LOAD_DEREF: case OP_STORE_DEREF:
+            case OP_BUILD_FUNCTION: case OP_BUILD_CLASS: case OP_IMPORT_STAR:
+                call.needsFrame = true;
+                break;
+            default:
+                break;
+        }
+    }
+    call.valid = true;
+    if (!varnames) return nullptr;
+
+    appendListItems(ctx, varnames, call.varnames);
+    const int size = static_cast<int>(call.varnames.size());
+    for (int i = 0; i < call.nparams + call.kwonly && i < size; ++i) {
+        if (call.varnames[i]) call.paramSlots.emplace(call.varnames[i]->getHash(ctx), i);
+    }
+
+    if (call.nparams > 0 && call.nparams <= size) {
+        const proto::ProtoList* parameterNames = ctx->newList();
+        for (int i = 0; i < call.nparams; ++i)
+            parameterNames = parameterNames->appendLast(ctx, call.varnames[i]);
+        call.parameterNames = parameterNames;
+    }
+    if (call.automaticCount > 0) {
+        const proto::ProtoList* localNames = ctx->newList();
+        for (int i = 0; i < call.automaticCount; ++i)
+            localNames = localNames->appendLast(ctx, i < size ? call.varnames[i] : PROTO_NONE);
+        call.localNames = localNames;
+    }
+    return ctx->newList()
+        ->appendLast(ctx, call.parameterNames ? call.parameterNames->asObject(ctx) : PROTO_NONE)
+        ->appendLast(ctx, call.localNames ? call.localNames->asObject(ctx) : PROTO_NONE);
+}
+
+/** Serializes publishing __co_decoded__, so a DecodedCode is never replaced while it runs. */
+static FutexMutex s_decodedPublishMutex;
+
+static const DecodedCode* decodedCodeOf(proto::ProtoContext* ctx, const proto::ProtoObject* handle) {
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<const DecodedCode*>(ext->getPointer(ctx)) : nullptr;
+}
+
+const DecodedCode* attachDecodedCode(proto::ProtoContext* ctx, const proto::ProtoObject* codeObj) {
+    if (!ctx || !codeObj) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoString* decodedS = env ? env->getCoDecodedString() : proto::ProtoString::fromUTF8String(ctx, "__co_decoded__");
+    const proto::ProtoString* constsS = env ? env->getCoConstsString() : proto::ProtoString::fromUTF8String(ctx, "co_consts");
+    const proto::ProtoString* namesS = env ? env->getCoNamesString() : proto::ProtoString::fromUTF8String(ctx, "co_names");
+    const proto::ProtoString* codeS = env ? env->getCoCodeString() : proto::ProtoString::fromUTF8String(ctx, "co_code");
+    const proto::ProtoString* tableS = env ? env->getCoExceptionTableString() : proto::ProtoString::fromUTF8String(ctx, "co_exceptiontable");
+
+    const proto::ProtoObject* constsObj = codeObj->getAttribute(ctx, constsS);
+    const proto::ProtoObject* namesObj = codeObj->getAttribute(ctx, namesS);
+    const proto::ProtoObject* bytecodeObj = codeObj->getAttribute(ctx, codeS);
+    const proto::ProtoList* bytecode = bytecodeObj ? bytecodeObj->asList(ctx) : nullptr;
+    if (!bytecode) return nullptr;
+
+    DecodedCode* code = decodeBytecode(ctx,
+        constsObj ? constsObj->asList(ctx) : nullptr,
+        bytecode,
+        namesObj ? namesObj->asList(ctx) : nullptr);
+    if (env && (code->attrCacheSites > 0 || code->globalCacheSites > 0))
+        code->caches = std::make_unique<InlineCacheTable>(codeObj, code->attrCacheSites, code->globalCacheSites);
+    const proto::ProtoList* callNames = describeCall(ctx, env, codeObj, *code, code->call);
+    const proto::ProtoObject* tableObj = codeObj->getAttribute(ctx, tableS);
+    const proto::ProtoList* table = tableObj ? tableObj->asList(ctx) : nullptr;
+    if (table) attachExceptionTable(ctx, table, *code);
+
+    // Threads that decoded the same code object concurrently: the first to publish wins,
+    // the others drop their copy and run the winner's.
+    s_decodedPublishMutex.lock(ctx->space);
+    if (const DecodedCode* published = decodedCodeOf(ctx, codeObj->getAttribute(ctx, decodedS))) {
+        s_decodedPublishMutex.unlock();
+        delete code;
+        return published;
+    }
+    if (callNames) {
+        codeObj->setAttribute(ctx,
+            env ? env->getCoCallNamesString() : proto::ProtoString::fromUTF8String(ctx, "__co_call_names__"),
+            callNames->asObject(ctx));
+    }
+    codeObj->setAttribute(ctx, decodedS, ctx->fromExternalPointer(code, decoded_code_finalizer));
+    s_decodedPublishMutex.unlock();
+    return code;
+}
+
+const DecodedCode* getDecodedCode(proto::ProtoContext* ctx, const proto::ProtoObject* codeObj) {
+    if (!ctx || !codeObj) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoString* decodedS = env ? env->getCoDecodedString() : proto::ProtoString::fromUTF8String(ctx, "__co_decoded__");
+    if (const DecodedCode* decoded = decodedCodeOf(ctx, codeObj->getAttribute(ctx, decodedS)))
+        return decoded;
+    // Code objects not built by makeCodeObject are decoded on first execution.
+    return attachDecodedCode(ctx, codeObj);
+}
+
+GeneratorState* getGeneratorState(proto::ProtoContext* ctx, const proto::ProtoObject* gen) {
+    if (!ctx || !gen) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoString* stateS = env ? env->getGiStateString() : proto::ProtoString::fromUTF8String(ctx, "__gi_state__");
+    const proto::ProtoObject* handle = gen->getAttribute(ctx, stateS);
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<GeneratorState*>(ext->getPointer(ctx)) : nullptr;
+}
+
 namespace {
 struct GCStack {
     proto::ProtoObject** slots;
@@ -1159,11 +1519,278 @@ struct GCStack {
 };
 }
 
-const proto::ProtoObject* executeBytecodeRange(
+/*
+ * Opcode dispatch. Every handler is a `TARGET(OP_X) { ... DISPATCH(); }` block of one
+ * switch. With GCC/Clang the handlers are threaded (computed goto): each one ends by
+ * fetching the next instruction and jumping straight to its handler through a table of
+ * label addresses, so there is one indirect branch per handler for the predictor to learn
+ * and no trip through the loop head. Build with PROTO_NO_COMPUTED_GOTO (or any other
+ * compiler) to use the plain switch, where every handler returns to the loop head.
+ *
+ * The loop head holds the slow path: exception unwinding, the GC safepoint poll, skipped
+ * instructions and the end of the range. Handlers reach it by:
+ *   DISPATCH()       after work that may raise: polls the pending-exception slot first.
+ *   FAST_DISPATCH()  after work that cannot raise (stack, locals, specialized arithmetic).
+ *   JUMP_TO(pc)      taken branch; backward branches go through the loop head.
+ *   DISPATCH_POLL()  after calls, and in handlers with a local that has a destructor in
+ *                    scope (a computed goto would skip it).
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(PROTO_NO_COMPUTED_GOTO)
+#define PROTO_COMPUTED_GOTO 1
+#define TARGET(name) case name: TARGET_##name:
+#define FAST_DISPATCH() do { \
+        if (i + 2 > pcEnd) goto dispatch_poll; \
+        op = loadRelaxed(instrs[(i >> 1) + 1].op); \
+        if (static_cast<unsigned int>(op) >= kDispatchTableSize) goto dispatch_poll; \
+        i += 2; \
+        faultPc = i; \
+        ip = &instrs[i >> 1]; \
+        arg = ip->arg; \
+        ++executed.count; \
+        goto *dispatchTable[op]; \
+    } while (0)
+#define DISPATCH() do { if (*pending) goto dispatch_poll; FAST_DISPATCH(); } while (0)
+#define DISPATCH_POLL() goto dispatch_poll
+#define JUMP_TO(pc) do { \
+        const unsigned long to_ = static_cast<unsigned long>(pc); \
+        const bool backward_ = to_ <= i; \
+        i = to_ - 2; \
+        if (backward_) goto dispatch_poll; \
+    } while (0)
+#else
+#define PROTO_COMPUTED_GOTO 0
+#define TARGET(name) case name:
+#define FAST_DISPATCH() continue
+#define DISPATCH() continue
+#define DISPATCH_POLL() continue
+#define JUMP_TO(pc) do { i = static_cast<unsigned long>(pc) - 2; } while (0)
+#endif
+/** Guard failed in a specialized handler: restore the generic opcode and run it instead. */
+#define DEOPTIMIZE() do { deoptimizeInstr(*ip, op); op = ip->generic; goto redispatch; } while (0)
+/** Superinstruction cannot run as a whole (e.g. it would cross pcEnd): run its first instruction. */
+#define UNFUSE() do { op = ip->generic; goto redispatch; } while (0)
+
+/** Opcodes with a TARGET handler; used to fill the computed-goto table. */
+#define PROTO_DISPATCHED_OPCODES(X) \
+    X(OP_LOAD_CONST) X(OP_RETURN_VALUE) X(OP_YIELD_VALUE) X(OP_GET_YIELD_FROM_ITER) \
+    X(OP_YIELD_FROM) X(OP_LOAD_NAME) X(OP_STORE_NAME) X(OP_LOAD_FAST) X(OP_STORE_FAST) \
+    X(OP_BINARY_ADD) X(OP_INPLACE_ADD) X(OP_BINARY_SUBTRACT) X(OP_INPLACE_SUBTRACT) \
+    X(OP_BINARY_MULTIPLY) X(OP_INPLACE_MULTIPLY) X(OP_BINARY_TRUE_DIVIDE) \
+    X(OP_BINARY_MODULO) X(OP_BINARY_MATRIX_MULTIPLY) X(OP_INPLACE_MATRIX_MULTIPLY) \
+    X(OP_RERAISE) X(OP_JUMP_FORWARD) X(OP_POP_EXCEPT) X(OP_BINARY_POWER) \
+    X(OP_BINARY_FLOOR_DIVIDE) X(OP_INPLACE_TRUE_DIVIDE) X(OP_INPLACE_FLOOR_DIVIDE) \
+    X(OP_INPLACE_MODULO) X(OP_INPLACE_POWER) X(OP_INPLACE_LSHIFT) X(OP_INPLACE_RSHIFT) \
+    X(OP_INPLACE_AND) X(OP_INPLACE_OR) X(OP_INPLACE_XOR) X(OP_BINARY_LSHIFT) \
+    X(OP_BINARY_RSHIFT) X(OP_BINARY_AND) X(OP_BINARY_OR) X(OP_BINARY_XOR) \
+    X(OP_UNARY_NEGATIVE) X(OP_UNARY_NOT) X(OP_UNARY_INVERT) X(OP_RAISE_VARARGS) \
+    X(OP_IMPORT_STAR) X(OP_SETUP_WITH) X(OP_WITH_CLEANUP) X(OP_POP_TOP) X(OP_UNARY_POSITIVE) \
+    X(OP_NOP) X(OP_COMPARE_OP) X(OP_POP_JUMP_IF_FALSE) X(OP_POP_JUMP_IF_TRUE) \
+    X(OP_LIST_APPEND) X(OP_MAP_ADD) X(OP_SET_ADD) X(OP_DICT_UPDATE) X(OP_LIST_EXTEND) \
+    X(OP_SET_UPDATE) X(OP_BUILD_SET) X(OP_BUILD_STRING) X(OP_LOAD_DEREF) X(OP_STORE_DEREF) \
+    X(OP_JUMP_ABSOLUTE) X(OP_LOAD_ATTR) X(OP_STORE_ATTR) X(OP_BUILD_LIST) \
+    X(OP_BINARY_SUBSCR) X(OP_BUILD_MAP) X(OP_STORE_SUBSCR) X(OP_CALL_FUNCTION_KW) \
+    X(OP_CALL_FUNCTION) X(OP_CALL_FUNCTION_EX) X(OP_BUILD_TUPLE) X(OP_BUILD_FUNCTION) \
+    X(OP_BUILD_CLASS) X(OP_GET_ITER) X(OP_FOR_ITER) X(OP_UNPACK_SEQUENCE) X(OP_UNPACK_EX) \
+    X(OP_LOAD_GLOBAL) X(OP_STORE_GLOBAL) X(OP_BUILD_SLICE) X(OP_ROT_TWO) X(OP_ROT_THREE) \
+    X(OP_ROT_FOUR) X(OP_LIST_TO_TUPLE) X(OP_DUP_TOP_TWO) X(OP_DUP_TOP) X(OP_DELETE_NAME) \
+    X(OP_DELETE_GLOBAL) X(OP_DELETE_FAST) X(OP_DELETE_ATTR) X(OP_DELETE_SUBSCR) \
+    X(OP_SETUP_FINALLY) X(OP_POP_BLOCK) X(OP_GET_AWAITABLE) X(OP_GET_AITER) X(OP_GET_ANEXT) \
+    X(OP_EXCEPTION_MATCH) X(OP_SETUP_ASYNC_WITH) \
+    X(OP_BINARY_ADD_INT) X(OP_BINARY_ADD_FLOAT) X(OP_BINARY_SUBTRACT_INT) X(OP_COMPARE_OP_INT) \
+    X(OP_BINARY_SUBSCR_LIST_INT) X(OP_BINARY_SUBSCR_DICT) \
+    X(OP_LOAD_FAST_LOAD_FAST) X(OP_LOAD_FAST_ADD_CONST_STORE_FAST) X(OP_COMPARE_OP_POP_JUMP_IF_FALSE)
+
+namespace {
+constexpr unsigned int kDispatchTableSize = 256;
+
+std::atomic<unsigned long long> g_executedInstructions{0};
+
+bool instructionStatsEnabled() {
+    static bool enabled = std::getenv("PROTO_INSTR_STATS") != nullptr;
+    return enabled;
+}
+
+struct SpecializationCounters {
+    std::atomic<unsigned long long> hits{0};
+    std::atomic<unsigned long long> quickens{0};
+    std::atomic<unsigned long long> deopts{0};
+};
+SpecializationCounters g_specializations[OP_SPECIALIZED_COUNT];
+
+const char* const kSpecializedNames[OP_SPECIALIZED_COUNT] = {
+    "BINARY_ADD_INT", "BINARY_ADD_FLOAT", "BINARY_SUBTRACT_INT", "COMPARE_OP_INT",
+    "BINARY_SUBSCR_LIST_INT", "BINARY_SUBSCR_DICT",
+};
+
+/** Counts instructions in a register; published once per executeDecodedRange call. */
+struct InstructionCounter {
+    unsigned long long count{0};
+    unsigned long long hits[OP_SPECIALIZED_COUNT]{};
+    ~InstructionCounter() {
+        if (!count || !instructionStatsEnabled()) return;
+        g_executedInstructions.fetch_add(count, std::memory_order_relaxed);
+        for (int k = 0; k < OP_SPECIALIZED_COUNT; ++k)
+            if (hits[k]) g_specializations[k].hits.fetch_add(hits[k], std::memory_order_relaxed);
+    }
+};
+
+/*
+ * Quickening. Generic handlers report which specialization fits the operands they just
+ * saw; after kQuickenWarmup consecutive fits the instruction's op is rewritten. Other
+ * threads may run the same DecodedCode, so op/counter/deopts use relaxed atomics (any
+ * interleaving leaves op a valid generic or specialized opcode of that instruction).
+ */
+constexpr int kQuickenWarmup = 8;
+constexpr int kMaxDeopts = 4;
+
+int loadRelaxed(const int& field) {
+    return std::atomic_ref<int>(const_cast<int&>(field)).load(std::memory_order_relaxed);
+}
+
+void storeRelaxed(const int& field, int value) {
+    std::atomic_ref<int>(const_cast<int&>(field)).store(value, std::memory_order_relaxed);
+}
+
+/** pick() returns the fitting specialized opcode, or -1. */
+template <typename Pick>
+inline void adaptInstr(const DecodedInstr& instr, Pick&& pick) {
+    int c = loadRelaxed(instr.counter);
+    if (c < 0) return;
+    int specialized = pick();
+    if (specialized < 0) {
+        if (c) storeRelaxed(instr.counter, 0);
+        return;
+    }
+    if (++c < kQuickenWarmup) {
+        storeRelaxed(instr.counter, c);
+        return;
+    }
+    storeRelaxed(instr.counter, 0);
+    storeRelaxed(instr.op, specialized);
+    g_specializations[specialized - OP_FIRST_SPECIALIZED].quickens.fetch_add(1, std::memory_order_relaxed);
+}
+
+void deoptimizeInstr(const DecodedInstr& instr, int specialized) {
+    int d = loadRelaxed(instr.deopts) + 1;
+    storeRelaxed(instr.deopts, d);
+    // An instruction that keeps failing its guards stays generic.
+    storeRelaxed(instr.counter, d >= kMaxDeopts ? -1 : 0);
+    storeRelaxed(instr.op, instr.generic);
+    g_specializations[specialized - OP_FIRST_SPECIALIZED].deopts.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline bool isSmallInt(proto::ProtoContext* ctx, const proto::ProtoObject* o) {
+    return isEmbeddedValue(o) && o->isInteger(ctx);
+}
+
+inline bool isDoubleValue(proto::ProtoContext* ctx, const proto::ProtoObject* o) {
+    return o && o != PROTO_NONE && o->isDouble(ctx);
+}
+
+/** Exact builtin instance: single parent proto, no own __getitem__. */
+bool isExactBuiltin(proto::ProtoContext* ctx, PythonEnvironment* env,
+    const proto::ProtoObject* obj, const proto::ProtoObject* proto) {
+    if (!env || !proto || !obj || obj == PROTO_NONE || isEmbeddedValue(obj)) return false;
+    const proto::ProtoList* parents = obj->getParents(ctx);
+    if (!parents || parents->getSize(ctx) != 1 || parents->getAt(ctx, 0) != proto) return false;
+    const proto::ProtoSparseList* own = obj->getOwnAttributes(ctx);
+    return !(own && own->has(ctx, reinterpret_cast<unsigned long>(env->getGetItemString())));
+}
+
+bool isExactList(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* obj) {
+    return isExactBuiltin(ctx, env, obj, env ? env->getListPrototype() : nullptr);
+}
+
+/** LOAD_FAST's value for slot: unbound reads as None, an out-of-range slot as PROTO_NONE. */
+inline const proto::ProtoObject* loadFastSlot(proto::ProtoContext* ctx, PythonEnvironment* env, int slot) {
+    if (slot < 0 || static_cast<unsigned long>(slot) >= ctx->getAutomaticLocalsCount()) return PROTO_NONE;
+    const proto::ProtoObject* val = ctx->getAutomaticLocals()[slot];
+    return val ? val : (env ? env->getNonePrototype() : PROTO_NONE);
+}
+
+/** Compact table of an exact dict (no subclass, no own __getitem__). */
+DictTable* exactDictTable(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* obj) {
+    const proto::ProtoObject* proto = env ? env->getDictPrototype() : nullptr;
+    if (!proto || !obj || obj == PROTO_NONE || isEmbeddedValue(obj)) return nullptr;
+    const proto::ProtoList* parents = obj->getParents(ctx);
+    if (!parents || parents->getSize(ctx) != 1 || parents->getAt(ctx, 0) != proto) return nullptr;
+    const proto::ProtoSparseList* own = obj->getOwnAttributes(ctx);
+    if (own && own->has(ctx, reinterpret_cast<unsigned long>(env->getGetItemString()))) return nullptr;
+    return dictTable(ctx, obj);
+}
+}
+
+unsigned long long getExecutedInstructionCount() {
+    return g_executedInstructions.load(std::memory_order_relaxed);
+}
+
+namespace {
+constexpr size_t kVectorcallSlots = 512;
+
+/** Open-addressed; method is published (release) after vectorcall is stored. */
+struct VectorcallSlot {
+    std::atomic<NativeMethod> method{nullptr};
+    std::atomic<VectorcallMethod> vectorcall{nullptr};
+};
+VectorcallSlot g_vectorcalls[kVectorcallSlots];
+std::mutex g_vectorcallMutex;
+
+size_t vectorcallSlotFor(NativeMethod method) {
+    uintptr_t h = reinterpret_cast<uintptr_t>(method);
+    return ((h >> 4) ^ (h >> 13)) % kVectorcallSlots;
+}
+}
+
+void registerVectorcall(NativeMethod method, VectorcallMethod vectorcall) {
+    if (!method || !vectorcall) return;
+    std::lock_guard<std::mutex> lock(g_vectorcallMutex);
+    size_t k = vectorcallSlotFor(method);
+    for (size_t probe = 0; probe < kVectorcallSlots; ++probe, k = (k + 1) % kVectorcallSlots) {
+        NativeMethod current = g_vectorcalls[k].method.load(std::memory_order_relaxed);
+        if (current == method) {
+            g_vectorcalls[k].vectorcall.store(vectorcall, std::memory_order_release);
+            return;
+        }
+        if (!current) {
+            g_vectorcalls[k].vectorcall.store(vectorcall, std::memory_order_relaxed);
+            g_vectorcalls[k].method.store(method, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+VectorcallMethod findVectorcall(NativeMethod method) {
+    size_t k = vectorcallSlotFor(method);
+    for (size_t probe = 0; probe < kVectorcallSlots; ++probe, k = (k + 1) % kVectorcallSlots) {
+        NativeMethod current = g_vectorcalls[k].method.load(std::memory_order_acquire);
+        if (current == method) return g_vectorcalls[k].vectorcall.load(std::memory_order_acquire);
+        if (!current) return nullptr;
+    }
+    return nullptr;
+}
+
+namespace {
+[[maybe_unused]] const bool g_engineVectorcalls = [] {
+    registerVectorcall(runUserFunctionCall, runUserFunctionVectorcall);
+    registerVectorcall(runBoundMethodCall, runBoundMethodVectorcall);
+    return true;
+}();
+}
+
+std::vector<SpecializationStats> getSpecializationStats() {
+    std::vector<SpecializationStats> out;
+    for (int k = 0; k < OP_SPECIALIZED_COUNT; ++k) {
+        out.push_back({kSpecializedNames[k],
+            g_specializations[k].hits.load(std::memory_order_relaxed),
+            g_specializations[k].quickens.load(std::memory_order_relaxed),
+            g_specializations[k].deopts.load(std::memory_order_relaxed)});
+    }
+    return out;
+}
+
+const proto::ProtoObject* executeDecodedRange(
     proto::ProtoContext* ctx,
-    const proto::ProtoList* constants,
-    const proto::ProtoList* bytecode,
-    const proto::ProtoList* names,
+    const DecodedCode* code,
     proto::ProtoObject*& frame,
     unsigned long pcStart,
     unsigned long pcEnd,
@@ -1172,22 +1799,30 @@ const proto::ProtoObject* executeBytecodeRange(
     unsigned long* outPc,
     bool* yielded,
     std::vector<Block>* externalBlockStack) {
-    if (!ctx || !constants || !bytecode) return nullptr;
+    if (!ctx || !code) return nullptr;
     PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
     if (!env && std::getenv("PROTO_THREAD_DIAG")) {
         // log removed
     }
     
     FrameScope fscope(frame);
-    unsigned long n = bytecode->getSize(ctx);
+    unsigned long n = code->codeSize;
     if (n == 0) return nullptr;
+    const DecodedInstr* instrs = code->instrs.data();
+    const std::vector<const proto::ProtoObject*>& constants = code->consts;
+    const std::vector<const proto::ProtoObject*>& names = code->names;
+    auto nameAt = [&names](int idx) -> const proto::ProtoObject* {
+        return (idx >= 0 && static_cast<size_t>(idx) < names.size()) ? names[idx] : nullptr;
+    };
+    InlineCacheTable* caches = env ? code->caches.get() : nullptr;
     if (pcEnd >= n) pcEnd = n - 1;
 
     unsigned int nSlots = ctx->getAutomaticLocalsCount();
     proto::ProtoObject** allSlots = const_cast<proto::ProtoObject**>(ctx->getAutomaticLocals());
     
-    // Fallback stack for contexts without pre-allocated slots (e.g. some unit tests)
-    std::vector<const proto::ProtoObject*> fallbackStack;
+    // Contexts without pre-allocated slots (module/class bodies, unit tests) borrow a
+    // pooled value stack from the thread's ValueStackArena.
+    std::optional<ValueStackLease> fallbackStack;
     proto::ProtoObject** stackBase = nullptr;
     size_t stackCap = 0;
     
@@ -1195,9 +1830,9 @@ const proto::ProtoObject* executeBytecodeRange(
         stackBase = allSlots + stackOffset;
         stackCap = nSlots - stackOffset;
     } else {
-        fallbackStack.resize(1024); // Default capacity for manual/test execution
-        stackBase = const_cast<proto::ProtoObject**>(fallbackStack.data());
-        stackCap = fallbackStack.size();
+        fallbackStack.emplace();
+        stackBase = fallbackStack->data();
+        stackCap = ValueStackLease::size();
     }
     
     GCStack stack(stackBase, stackCap);
@@ -1212,14 +1847,52 @@ const proto::ProtoObject* executeBytecodeRange(
     if (externalBlockStack) {
         blockStack = *externalBlockStack;
     }
+#if PROTO_COMPUTED_GOTO
+    static void* dispatchTable[kDispatchTableSize];
+    static std::atomic<bool> dispatchTableReady{false};
+    if (!dispatchTableReady.load(std::memory_order_acquire)) {
+        static std::mutex dispatchTableMutex;
+        std::lock_guard<std::mutex> lock(dispatchTableMutex);
+        if (!dispatchTableReady.load(std::memory_order_relaxed)) {
+            for (auto& target : dispatchTable) target = &&dispatch_switch;
+#define PROTO_SET_TARGET(name) \
+            static_assert(name >= 0 && name < static_cast<int>(kDispatchTableSize), "opcode outside dispatch table"); \
+            dispatchTable[name] = &&TARGET_##name;
+            PROTO_DISPATCHED_OPCODES(PROTO_SET_TARGET)
+#undef PROTO_SET_TARGET
+            dispatchTableReady.store(true, std::memory_order_release);
+        }
+    }
+#endif
+
+    InstructionCounter executed;
     const bool sync_globals = (frame == PythonEnvironment::getCurrentGlobals());
+    // Polled at the loop head and after raising handlers; looked up once per range.
+    static const proto::ProtoObject* const noPending = nullptr;
+    const proto::ProtoObject* const* pending = env ? PythonEnvironment::pendingExceptionSlot() : &noPending;
+    unsigned long faultPc = pcStart;  // Instruction that raised a pending exception.
+    const DecodedInstr* ip = nullptr;
+    int op = 0;
+    int arg = 0;
     for (unsigned long i = pcStart; i <= pcEnd; i += 2) {
-        if (env && env->hasPendingException()) {
+        if (*pending) {
             if (get_env_diag()) {
                 const proto::ProtoObject* exc = env->peekPendingException();
                 std::cerr << "[proto-diag] Exception pending at top-of-loop: exc=" << exc << " blockStackSize=" << blockStack.size() << "\n" << std::flush;
             }
-            if (!blockStack.empty()) {
+            if (code->staticHandlers) {
+                if (const ExceptionTableEntry* h = findExceptionHandler(*code, faultPc)) {
+                    if (get_env_diag()) {
+                        std::cerr << "[proto-diag] Found exception handler: jump to " << h->handler << " stackDepth=" << h->depth << "\n" << std::flush;
+                    }
+                    while (stack.size() > h->depth) stack.pop_back();
+                    const proto::ProtoObject* exc = env->peekPendingException();
+                    if (exc) stack.push_back(exc);
+                    env->clearPendingException();
+                    i = h->handler - 2; // -2 because loop will i += 2
+                    continue;
+                }
+            } else if (!blockStack.empty()) {
                 Block b = blockStack.back();
                 blockStack.pop_back();
                 if (get_env_diag()) {
@@ -1238,39 +1911,56 @@ const proto::ProtoObject* executeBytecodeRange(
             }
             return nullptr;
         }
+#if PROTO_COMPUTED_GOTO
+        checkSTW(ctx);  // Threaded handlers only come here on backward branches, calls and raises.
+#else
         if ((i & 0x7FF) == 0) checkSTW(ctx);
-        const proto::ProtoObject* instr = bytecode->getAt(ctx, static_cast<int>(i));
-        if (!instr || !instr->isInteger(ctx)) {
+#endif
+        faultPc = i;
+        ip = &instrs[i >> 1];
+        op = loadRelaxed(ip->op);
+        if (op == OP_DECODED_SKIP) {
             continue;
         }
-        int op = static_cast<int>(instr->asLong(ctx));
-        int arg = (i + 1 < n && bytecode->getAt(ctx, static_cast<int>(i + 1))->isInteger(ctx))
-            ? static_cast<int>(bytecode->getAt(ctx, static_cast<int>(i + 1))->asLong(ctx)) : 0;
-
+        arg = ip->arg;
+        ++executed.count;
 
-        if (op == OP_LOAD_CONST) {
-            if (static_cast<unsigned long>(arg) < constants->getSize(ctx)) {
-                stack.push_back(constants->getAt(ctx, arg));
+    redispatch:
+#if PROTO_COMPUTED_GOTO
+        if (static_cast<unsigned int>(op) < kDispatchTableSize) goto *dispatchTable[op];
+    dispatch_switch:
+#endif
+        switch (op) {
+        TARGET(OP_LOAD_CONST) {
+            if (static_cast<unsigned long>(arg) < constants.size()) {
+                stack.push_back(constants[arg]);
             }
-        } else if (op == OP_RETURN_VALUE) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_RETURN_VALUE) {
             if (stack.empty()) return PROTO_NONE;
             const proto::ProtoObject* ret = stack.back();
             ctx->returnValue = ret;
             if (outPc) *outPc = pcEnd + 1; // Mark finished
             return ret;  /* exit block immediately; destructor will promote */
-        } else if (op == OP_YIELD_VALUE) {
+        }
+        TARGET(OP_YIELD_VALUE) {
             if (stack.empty()) return PROTO_NONE;
             const proto::ProtoObject* ret = stack.back();
             stack.pop_back();
             ctx->returnValue = ret;
             if (yielded) *yielded = true;
-            if (outPc) *outPc = i + 1; // Resume at NEXT instruction
+            if (outPc) *outPc = i + 2; // Resume at NEXT instruction
             if (externalStack) {
                 externalStack->clear();
                 for (size_t j = 0; j < stack.size(); ++j) externalStack->push_back(stack[j]);
             }
+            if (externalBlockStack) {
+                *externalBlockStack = blockStack;
+            }
             return ret;
-        } else if (op == OP_GET_YIELD_FROM_ITER) {
+        }
+        TARGET(OP_GET_YIELD_FROM_ITER) {
             if (stack.empty()) continue;
             const proto::ProtoObject* obj = stack.back();
             stack.pop_back();
@@ -1282,7 +1972,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 iterator = obj;
             }
             stack.push_back(iterator);
-        } else if (op == OP_YIELD_FROM) {
+            DISPATCH();
+        }
+        TARGET(OP_YIELD_FROM) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* sendVal = stack.back();
             stack.pop_back();
@@ -1330,7 +2022,7 @@ const proto::ProtoObject* executeBytecodeRange(
                 }
                 ctx->returnValue = result;
                 if (yielded) *yielded = true;
-                if (outPc) *outPc = i - 1; // RESTAY at current instruction (the OP_YIELD_FROM itself)
+                if (outPc) *outPc = i; // RESTAY at current instruction (the OP_YIELD_FROM itself)
                 if (externalStack) {
                     externalStack->clear();
                     for (size_t j = 0; j < stack.size(); ++j) externalStack->push_back(stack[j]);
@@ -1340,53 +2032,63 @@ const proto::ProtoObject* executeBytecodeRange(
                 }
                 return result;
             }
-        } else if (op == OP_LOAD_NAME) {
-            if (names && frame && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+            DISPATCH();
+        }
+        TARGET(OP_LOAD_NAME) {
+            if (static_cast<unsigned long>(arg) < names.size()) {
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj->isString(ctx)) {
                     const proto::ProtoString* nameS = nameObj->asString(ctx);
-                    std::string nStr;
-                    nameS->toUTF8String(ctx, nStr);
-                    if (std::getenv("PROTO_ENV_DIAG")) {
-                        std::cerr << "[proto-diag] OP_LOAD_NAME: name='" << nStr << "'\n" << std::flush;
+                    auto nameStr = [ctx, nameS]() {
+                        std::string s;
+                        nameS->toUTF8String(ctx, s);
+                        return s;
+                    };
+                    if (get_env_diag()) {
+                        std::cerr << "[proto-diag] OP_LOAD_NAME: name='" << nameStr() << "'\n" << std::flush;
                     }
                     const proto::ProtoObject* val = nullptr;
                     bool found = false;
-                    if (frame->hasAttribute(ctx, nameS) == PROTO_TRUE) {
+                    // Without a frame object (LazyFrame) there is nothing to search before the globals.
+                    if (frame && frame->hasAttribute(ctx, nameS) == PROTO_TRUE) {
                         val = frame->getAttribute(ctx, nameS);
                         found = true;
                     }
-                    if (std::getenv("PROTO_ENV_DIAG")) {
+                    if (get_env_diag()) {
                         std::cerr << "[proto-diag] OP_LOAD_NAME: val=" << val << " found=" << (found ? "1" : "0") << "\n" << std::flush;
                     }
 
                     if (found) {
                         stack.push_back(val);
                     } else if (env) {
-                        const proto::ProtoObject* r = env->resolve(nameS, ctx);
+                        const proto::ProtoObject* r = nullptr;
+                        if (!(caches && caches->loadGlobal(ctx, env, ip->cache, nameS, r)))
+                            r = env->resolve(nameS, ctx);
                         if (r) {
-                            if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] OP_LOAD_NAME: resolved '" << nStr << "' to " << r << "\n";
+                            if (get_env_diag()) std::cerr << "[proto-diag] OP_LOAD_NAME: resolved '" << nameStr() << "' to " << r << "\n";
                             stack.push_back(r);
                         } else {
-                            if (!env->hasPendingException()) env->raiseNameError(ctx, nStr);
+                            if (!env->hasPendingException()) env->raiseNameError(ctx, nameStr());
                             return nullptr;
                         }
                     } else {
-                        std::cerr << "Engine Error: env is NULL in OP_LOAD_NAME for '" << nStr << "'\n";
+                        std::cerr << "Engine Error: env is NULL in OP_LOAD_NAME for '" << nameStr() << "'\n";
                         return nullptr;
                     }
                 } else {
                     stack.push_back(PROTO_NONE);
                 }
             }
-        } else if (op == OP_STORE_NAME) {
-            if (names && frame && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
+            DISPATCH();
+        }
+        TARGET(OP_STORE_NAME) {
+            if (frame && static_cast<unsigned long>(arg) < names.size()) {
                 if (stack.empty()) continue;
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
                 if (nameObj->isString(ctx)) {
-                    if (std::getenv("PROTO_ENV_DIAG")) {
+                    if (get_env_diag()) {
                         std::string n;
                         nameObj->asString(ctx)->toUTF8String(ctx, n);
                         std::cerr << "[proto-diag] OP_STORE_NAME: name='" << n << "' val=" << val << "\n" << std::flush;
@@ -1398,16 +2100,17 @@ const proto::ProtoObject* executeBytecodeRange(
                     if (env) {
                         PythonEnvironment::setCurrentFrame(frame);
                         if (sync_globals) PythonEnvironment::setCurrentGlobals(frame);
-                        env->invalidateResolveCache();
                     }
                 }
             }
-        } else if (op == OP_LOAD_FAST) {
+            DISPATCH();
+        }
+        TARGET(OP_LOAD_FAST) {
             const unsigned int nSlots = ctx->getAutomaticLocalsCount();
             if (arg >= 0 && static_cast<unsigned long>(arg) < nSlots) {
                 const proto::ProtoObject** slots = ctx->getAutomaticLocals();
                 const proto::ProtoObject* val = slots[arg];
-                if (std::getenv("PROTO_ENV_DIAG")) {
+                if (get_env_diag()) {
                     std::cerr << "[proto-diag] OP_LOAD_FAST: arg=" << arg << " val=" << val << " isNone=" << (val == (env ? env->getNonePrototype() : PROTO_NONE) ? "yes" : "no") << "\n";
                 }
                 stack.push_back(val ? val : (env ? env->getNonePrototype() : PROTO_NONE));
@@ -1417,7 +2120,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 }
                 stack.push_back(PROTO_NONE);
             }
-        } else if (op == OP_STORE_FAST) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_STORE_FAST) {
             if (stack.empty()) continue;
             const unsigned int nSlots = ctx->getAutomaticLocalsCount();
             if (arg >= 0 && static_cast<unsigned long>(arg) < nSlots) {
@@ -1426,15 +2131,71 @@ const proto::ProtoObject* executeBytecodeRange(
                 proto::ProtoObject** slots = const_cast<proto::ProtoObject**>(ctx->getAutomaticLocals());
                 slots[arg] = const_cast<proto::ProtoObject*>(val);
             }
-        } else if (op == OP_BINARY_ADD) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_LOAD_FAST_LOAD_FAST) {
+            if (i + 2 > pcEnd) UNFUSE();
+            stack.push_back(loadFastSlot(ctx, env, arg));
+            stack.push_back(loadFastSlot(ctx, env, instrs[(i >> 1) + 1].arg));
+            i += 2;
+            FAST_DISPATCH();
+        }
+        TARGET(OP_LOAD_FAST_ADD_CONST_STORE_FAST) {
+            if (i + 6 > pcEnd) UNFUSE();
+            const proto::ProtoObject* a = loadFastSlot(ctx, env, arg);
+            const int constIdx = instrs[(i >> 1) + 1].arg;
+            const int dst = instrs[(i >> 1) + 3].arg;
+            const proto::ProtoObject* c = (constIdx >= 0 && static_cast<unsigned long>(constIdx) < constants.size())
+                ? constants[constIdx] : nullptr;
+            if (c && isSmallInt(ctx, a) && isSmallInt(ctx, c) &&
+                dst >= 0 && static_cast<unsigned long>(dst) < ctx->getAutomaticLocalsCount()) {
+                proto::ProtoObject** slots = const_cast<proto::ProtoObject**>(ctx->getAutomaticLocals());
+                slots[dst] = const_cast<proto::ProtoObject*>(ctx->fromInteger(a->asLong(ctx) + c->asLong(ctx)));
+                i += 6;
+                FAST_DISPATCH();
+            }
+            // Not int + int: do the two loads here and let the add and store run unfused.
+            stack.push_back(a);
+            if (c) stack.push_back(c);
+            i += 2;
+            FAST_DISPATCH();
+        }
+        TARGET(OP_BINARY_ADD) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
+            adaptInstr(*ip, [&] {
+                if (isSmallInt(ctx, a) && isSmallInt(ctx, b)) return OP_BINARY_ADD_INT;
+                if (isDoubleValue(ctx, a) && isDoubleValue(ctx, b)) return OP_BINARY_ADD_FLOAT;
+                return -1;
+            });
             const proto::ProtoObject* r = binaryAdd(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_INPLACE_ADD) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_ADD_INT) {
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* b = stack.back();
+            const proto::ProtoObject* a = stack[stack.size() - 2];
+            if (!isSmallInt(ctx, a) || !isSmallInt(ctx, b)) DEOPTIMIZE();
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(ctx->fromInteger(a->asLong(ctx) + b->asLong(ctx)));
+            ++executed.hits[OP_BINARY_ADD_INT - OP_FIRST_SPECIALIZED];
+            FAST_DISPATCH();
+        }
+        TARGET(OP_BINARY_ADD_FLOAT) {
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* b = stack.back();
+            const proto::ProtoObject* a = stack[stack.size() - 2];
+            if (!isDoubleValue(ctx, a) || !isDoubleValue(ctx, b)) DEOPTIMIZE();
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(ctx->fromDouble(a->asDouble(ctx) + b->asDouble(ctx)));
+            ++executed.hits[OP_BINARY_ADD_FLOAT - OP_FIRST_SPECIALIZED];
+            FAST_DISPATCH();
+        }
+        TARGET(OP_INPLACE_ADD) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1446,18 +2207,35 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* result = iadd->asMethod(ctx)(ctx, a, nullptr, oneArg, nullptr);
                 if (result) stack.push_back(result);
             } else {
+                // Embedded ints never have __iadd__, so ADD_INT is exact here too.
+                adaptInstr(*ip, [&] { return isSmallInt(ctx, a) && isSmallInt(ctx, b) ? OP_BINARY_ADD_INT : -1; });
                 const proto::ProtoObject* r = binaryAdd(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_BINARY_SUBTRACT) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_SUBTRACT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
+            adaptInstr(*ip, [&] { return isSmallInt(ctx, a) && isSmallInt(ctx, b) ? OP_BINARY_SUBTRACT_INT : -1; });
             const proto::ProtoObject* r = binarySubtract(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_INPLACE_SUBTRACT) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_SUBTRACT_INT) {
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* b = stack.back();
+            const proto::ProtoObject* a = stack[stack.size() - 2];
+            if (!isSmallInt(ctx, a) || !isSmallInt(ctx, b)) DEOPTIMIZE();
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(ctx->fromInteger(a->asLong(ctx) - b->asLong(ctx)));
+            ++executed.hits[OP_BINARY_SUBTRACT_INT - OP_FIRST_SPECIALIZED];
+            FAST_DISPATCH();
+        }
+        TARGET(OP_INPLACE_SUBTRACT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1469,10 +2247,13 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* result = isub->asMethod(ctx)(ctx, a, nullptr, oneArg, nullptr);
                 if (result) stack.push_back(result);
             } else {
+                adaptInstr(*ip, [&] { return isSmallInt(ctx, a) && isSmallInt(ctx, b) ? OP_BINARY_SUBTRACT_INT : -1; });
                 const proto::ProtoObject* r = binarySubtract(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_BINARY_MULTIPLY) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_MULTIPLY) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1480,7 +2261,9 @@ const proto::ProtoObject* executeBytecodeRange(
             stack.pop_back();
             const proto::ProtoObject* r = binaryMultiply(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_INPLACE_MULTIPLY) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_MULTIPLY) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1495,7 +2278,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* r = binaryMultiply(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_BINARY_TRUE_DIVIDE) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_TRUE_DIVIDE) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1503,11 +2288,15 @@ const proto::ProtoObject* executeBytecodeRange(
             stack.pop_back();
             const proto::ProtoObject* r = binaryTrueDivide(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_BINARY_MODULO) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_MODULO) {
             const proto::ProtoObject* right = stack.back(); stack.pop_back();
             const proto::ProtoObject* left = stack.back(); stack.pop_back();
             stack.push_back(left->modulo(ctx, right));
-        } else if (op == OP_BINARY_MATRIX_MULTIPLY) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_MATRIX_MULTIPLY) {
             const proto::ProtoObject* right = stack.back(); stack.pop_back();
             const proto::ProtoObject* left = stack.back(); stack.pop_back();
             // TODO: properly implement matmul in protoCore. For now, stub as error or special attr
@@ -1518,7 +2307,9 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 env->setPendingException(ctx->fromUTF8String("TypeError: '@' operator not supported (stubbed)"));
             }
-        } else if (op == OP_INPLACE_MATRIX_MULTIPLY) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_MATRIX_MULTIPLY) {
             const proto::ProtoObject* right = stack.back(); stack.pop_back();
             const proto::ProtoObject* left = stack.back(); stack.pop_back();
             const proto::ProtoString* imatmulS = proto::ProtoString::fromUTF8String(ctx, "__imatmul__");
@@ -1535,17 +2326,24 @@ const proto::ProtoObject* executeBytecodeRange(
                     env->setPendingException(ctx->fromUTF8String("TypeError: '@=' operator not supported (stubbed)"));
                 }
             }
-        } else if (op == OP_RERAISE) {
+            DISPATCH();
+        }
+        TARGET(OP_RERAISE) {
             // Re-raise the exception on top of block stack
             if (!env) return nullptr;
             // stub: if we have a pending exception, just return nullptr to trigger handler search
             return nullptr;
-        } else if (op == OP_JUMP_FORWARD) {
+        }
+        TARGET(OP_JUMP_FORWARD) {
             i += arg;
-        } else if (op == OP_POP_EXCEPT) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_POP_EXCEPT) {
             // Restore previous exception state if we tracked it, 
             // but for now just a NOP since we handle it in blockStack
-        } else if (op == OP_BINARY_POWER) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_BINARY_POWER) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1553,7 +2351,9 @@ const proto::ProtoObject* executeBytecodeRange(
             stack.pop_back();
             const proto::ProtoObject* r = binaryPower(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_BINARY_FLOOR_DIVIDE) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_FLOOR_DIVIDE) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1561,7 +2361,9 @@ const proto::ProtoObject* executeBytecodeRange(
             stack.pop_back();
             const proto::ProtoObject* r = binaryFloorDivide(ctx, a, b);
             stack.push_back(r);
-        } else if (op == OP_INPLACE_TRUE_DIVIDE) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_TRUE_DIVIDE) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1576,7 +2378,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* r = binaryTrueDivide(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_INPLACE_FLOOR_DIVIDE) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_FLOOR_DIVIDE) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1591,7 +2395,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* r = binaryFloorDivide(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_INPLACE_MODULO) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_MODULO) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1606,7 +2412,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* r = binaryModulo(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_INPLACE_POWER) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_POWER) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1621,7 +2429,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* r = binaryPower(ctx, a, b);
                 stack.push_back(r);
             }
-        } else if (op == OP_INPLACE_LSHIFT) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_LSHIFT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1639,7 +2449,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 else av = static_cast<long long>(static_cast<unsigned long long>(av) << bv);
                 stack.push_back(ctx->fromInteger(av));
             }
-        } else if (op == OP_INPLACE_RSHIFT) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_RSHIFT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1657,7 +2469,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 else av = av >> bv;
                 stack.push_back(ctx->fromInteger(av));
             }
-        } else if (op == OP_INPLACE_AND) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_AND) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1685,7 +2499,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_INPLACE_OR) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_OR) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1713,7 +2529,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_INPLACE_XOR) {
+            DISPATCH();
+        }
+        TARGET(OP_INPLACE_XOR) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1741,7 +2559,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_BINARY_LSHIFT) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_LSHIFT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1754,7 +2574,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 else av = static_cast<long long>(static_cast<unsigned long long>(av) << bv);
                 stack.push_back(ctx->fromInteger(av));
             }
-        } else if (op == OP_BINARY_RSHIFT) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_RSHIFT) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1767,7 +2589,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 else av = av >> bv;
                 stack.push_back(ctx->fromInteger(av));
             }
-        } else if (op == OP_BINARY_AND) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_AND) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1792,7 +2616,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_BINARY_OR) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_OR) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1817,7 +2643,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_BINARY_XOR) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_XOR) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
@@ -1842,7 +2670,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_UNARY_NEGATIVE) {
+            DISPATCH();
+        }
+        TARGET(OP_UNARY_NEGATIVE) {
             if (stack.empty()) continue;
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
@@ -1850,12 +2680,16 @@ const proto::ProtoObject* executeBytecodeRange(
                 stack.push_back(ctx->fromInteger(-a->asLong(ctx)));
             else if (a->isDouble(ctx))
                 stack.push_back(ctx->fromDouble(-a->asDouble(ctx)));
-        } else if (op == OP_UNARY_NOT) {
+            DISPATCH();
+        }
+        TARGET(OP_UNARY_NOT) {
             if (stack.empty()) continue;
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
             stack.push_back(isTruthy(ctx, a) ? PROTO_FALSE : PROTO_TRUE);
-        } else if (op == OP_UNARY_INVERT) {
+            DISPATCH();
+        }
+        TARGET(OP_UNARY_INVERT) {
             if (stack.empty()) continue;
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
@@ -1873,7 +2707,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     if (result) stack.push_back(result);
                 }
             }
-        } else if (op == OP_RAISE_VARARGS) {
+            DISPATCH();
+        }
+        TARGET(OP_RAISE_VARARGS) {
             const proto::ProtoObject* exc = nullptr;
             if (arg == 1) {
                 if (!stack.empty()) {
@@ -1894,7 +2730,8 @@ const proto::ProtoObject* executeBytecodeRange(
                 if (exc) env->setPendingException(exc);
             }
             continue;
-        } else if (op == OP_IMPORT_STAR) {
+        }
+        TARGET(OP_IMPORT_STAR) {
             if (stack.size() < 1) continue;
             const proto::ProtoObject* mod = stack.back();
             stack.pop_back();
@@ -1937,7 +2774,8 @@ const proto::ProtoObject* executeBytecodeRange(
                 }
             }
             continue;
-        } else if (op == OP_SETUP_WITH) {
+        }
+        TARGET(OP_SETUP_WITH) {
             if (stack.size() < 1) continue;
             const proto::ProtoObject* manager = stack.back();
             stack.pop_back();
@@ -1957,11 +2795,13 @@ const proto::ProtoObject* executeBytecodeRange(
                 enterResult = manager;
             }
             
-            // Push block pointing to handler at arg (absolute PC)
-            blockStack.push_back({static_cast<unsigned long>(arg), stack.size()});
+            // Push block pointing to handler at arg (absolute PC); table-driven code needs none.
+            if (!code->staticHandlers) blockStack.push_back({static_cast<unsigned long>(arg), stack.size()});
             
             stack.push_back(enterResult);
-        } else if (op == OP_WITH_CLEANUP) {
+            DISPATCH();
+        }
+        TARGET(OP_WITH_CLEANUP) {
             // Stack: [..., __exit__, (None or Exc)]
             if (stack.size() < 2) continue;
             const proto::ProtoObject* excOrNone = stack.back();
@@ -1986,11 +2826,15 @@ const proto::ProtoObject* executeBytecodeRange(
             }
             // Push suppression flag
             stack.push_back(res ? res : PROTO_FALSE);
-        } else if (op == OP_POP_TOP) {
+            DISPATCH();
+        }
+        TARGET(OP_POP_TOP) {
             if (!stack.empty()) {
                 stack.pop_back();
             }
-        } else if (op == OP_UNARY_POSITIVE) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_UNARY_POSITIVE) {
             if (stack.empty()) continue;
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
@@ -2002,140 +2846,163 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 stack.push_back(a);
             }
-        } else if (op == OP_NOP) {
-        } else if (op == OP_COMPARE_OP) {
+            DISPATCH();
+        }
+        TARGET(OP_NOP) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_COMPARE_OP) {
             if (stack.size() < 2) continue;
             const proto::ProtoObject* b = stack.back();
             stack.pop_back();
             const proto::ProtoObject* a = stack.back();
             stack.pop_back();
+            adaptInstr(*ip, [&] {
+                return arg >= 0 && arg <= 5 && isSmallInt(ctx, a) && isSmallInt(ctx, b) ? OP_COMPARE_OP_INT : -1;
+            });
             const proto::ProtoObject* r = compareOp(ctx, a, b, arg);
             if (r) stack.push_back(r); else if (env && env->hasPendingException()) continue;
-        } else if (op == OP_POP_JUMP_IF_FALSE) {
+            DISPATCH();
+        }
+        TARGET(OP_COMPARE_OP_INT) {
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* b = stack.back();
+            const proto::ProtoObject* a = stack[stack.size() - 2];
+            if (!isSmallInt(ctx, a) || !isSmallInt(ctx, b)) DEOPTIMIZE();
+            long long x = a->asLong(ctx);
+            long long y = b->asLong(ctx);
+            bool result = false;
+            switch (arg) {
+                case 0: result = x == y; break;
+                case 1: result = x != y; break;
+                case 2: result = x < y; break;
+                case 3: result = x <= y; break;
+                case 4: result = x > y; break;
+                default: result = x >= y; break;
+            }
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(result ? PROTO_TRUE : PROTO_FALSE);
+            ++executed.hits[OP_COMPARE_OP_INT - OP_FIRST_SPECIALIZED];
+            FAST_DISPATCH();
+        }
+        TARGET(OP_COMPARE_OP_POP_JUMP_IF_FALSE) {
+            if (i + 2 > pcEnd || stack.size() < 2) UNFUSE();
+            const proto::ProtoObject* b = stack.back();
+            const proto::ProtoObject* a = stack[stack.size() - 2];
+            stack.pop_back();
+            stack.pop_back();
+            bool truth = false;
+            if (arg >= 0 && arg <= 5 && isSmallInt(ctx, a) && isSmallInt(ctx, b)) {
+                long long x = a->asLong(ctx);
+                long long y = b->asLong(ctx);
+                switch (arg) {
+                    case 0: truth = x == y; break;
+                    case 1: truth = x != y; break;
+                    case 2: truth = x < y; break;
+                    case 3: truth = x <= y; break;
+                    case 4: truth = x > y; break;
+                    default: truth = x >= y; break;
+                }
+            } else {
+                const proto::ProtoObject* r = compareOp(ctx, a, b, arg);
+                // As after COMPARE_OP: a pending exception unwinds before the jump runs.
+                if (!r) continue;
+                truth = isTruthy(ctx, r);
+            }
+            const int target = instrs[(i >> 1) + 1].arg;
+            if (!truth && target >= 0 && static_cast<unsigned long>(target) < n)
+                JUMP_TO(target);
+            else
+                i += 2;
+            DISPATCH();
+        }
+        TARGET(OP_POP_JUMP_IF_FALSE) {
             if (stack.empty()) continue;
             const proto::ProtoObject* top = stack.back();
             stack.pop_back();
             if (!isTruthy(ctx, top) && arg >= 0 && static_cast<unsigned long>(arg) < n)
-                i = static_cast<unsigned long>(arg) - 2;
-        } else if (op == OP_POP_JUMP_IF_TRUE) {
+                JUMP_TO(arg);
+            DISPATCH();
+        }
+        TARGET(OP_POP_JUMP_IF_TRUE) {
             if (stack.empty()) continue;
             const proto::ProtoObject* top = stack.back();
             stack.pop_back();
             if (isTruthy(ctx, top) && arg >= 0 && static_cast<unsigned long>(arg) < n)
-                i = static_cast<unsigned long>(arg) - 2;
-        } else if (op == OP_LIST_APPEND) {
+                JUMP_TO(arg);
+            DISPATCH();
+        }
+        TARGET(OP_LIST_APPEND) {
             if (stack.size() >= static_cast<size_t>(arg)) {
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
                 proto::ProtoObject* lstObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg]);
-                const proto::ProtoObject* data = lstObj->getAttribute(ctx, env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__"));
-                if (data && data->asList(ctx)) {
-                    const proto::ProtoList* lst = data->asList(ctx);
-                    lst = lst->appendLast(ctx, val);
-                    const proto::ProtoObject* newLst = lstObj->setAttribute(ctx, env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__"), lst->asObject(ctx));
-                    stack[stack.size() - arg] = const_cast<proto::ProtoObject*>(newLst);
-                }
+                listAppend(ctx, lstObj, val);
             }
-        } else if (op == OP_MAP_ADD) {
-            if (stack.size() >= static_cast<size_t>(arg)) {
-                const proto::ProtoObject* key = stack.back();
+            DISPATCH();
+        }
+        TARGET(OP_MAP_ADD) {
+            if (stack.size() >= static_cast<size_t>(arg + 2)) {
+                // key and value stay on the stack (rooted) while a colliding key's __eq__ may run.
+                const proto::ProtoObject* key = stack[stack.size() - 1];
+                const proto::ProtoObject* val = stack[stack.size() - 2];
+                dictSet(ctx, stack[stack.size() - 2 - arg], key, val);
                 stack.pop_back();
-                const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
-                proto::ProtoObject* mapObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg]);
-                const proto::ProtoString* dataString = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* data = mapObj->getAttribute(ctx, dataString);
-                if (data && data->asSparseList(ctx)) {
-                    const proto::ProtoSparseList* sl = data->asSparseList(ctx);
-                    unsigned long h = key->getHash(ctx);
-                    bool isNew = !sl->has(ctx, h);
-                    sl = sl->setAt(ctx, h, val);
-                    const proto::ProtoObject* newMap = mapObj->setAttribute(ctx, dataString, sl->asObject(ctx));
-                    stack[stack.size() - arg] = const_cast<proto::ProtoObject*>(newMap);
-                    if (isNew) {
-                         const proto::ProtoString* keysString = proto::ProtoString::fromUTF8String(ctx, "__keys__");
-                         const proto::ProtoObject* keysObj = newMap->getAttribute(ctx, keysString);
-                         const proto::ProtoList* keys = (keysObj && keysObj->asList(ctx)) ? keysObj->asList(ctx) : ctx->newList();
-                         keys = keys->appendLast(ctx, key);
-                         const proto::ProtoObject* finalMap = newMap->setAttribute(ctx, keysString, keys->asObject(ctx));
-                         stack[stack.size() - arg] = const_cast<proto::ProtoObject*>(finalMap);
-                    }
-                }
             }
-        } else if (op == OP_SET_ADD) {
+            DISPATCH();
+        }
+        TARGET(OP_SET_ADD) {
             if (stack.size() >= static_cast<size_t>(arg + 1)) {
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
                 const proto::ProtoObject* setObj = stack[stack.size() - arg];
                 const proto::ProtoString* dataString = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* data = setObj->getAttribute(ctx, dataString);
+                const proto::ProtoObject* data = dataAttribute(ctx, setObj);
                 const proto::ProtoSet* s = (data && data->asSet(ctx)) ? data->asSet(ctx) : ctx->newSet();
                 s = s->add(ctx, val);
                 const proto::ProtoObject* newSet = setObj->setAttribute(ctx, dataString, s->asObject(ctx));
                 stack[stack.size() - arg] = const_cast<proto::ProtoObject*>(newSet);
             }
-        } else if (op == OP_DICT_UPDATE) {
+            DISPATCH();
+        }
+        TARGET(OP_DICT_UPDATE) {
             if (stack.size() >= static_cast<size_t>(arg + 1)) {
                 const proto::ProtoObject* from = stack.back();
-                stack.pop_back();
-                proto::ProtoObject* toObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg]);
-                const proto::ProtoString* dataString = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* toData = toObj->getAttribute(ctx, dataString);
-                if (toData && toData->asSparseList(ctx)) {
-                    const proto::ProtoSparseList* toSL = toData->asSparseList(ctx);
-                    const proto::ProtoObject* fromData = from->getAttribute(ctx, dataString);
-                    if (fromData && fromData->asSparseList(ctx)) {
-                        const proto::ProtoSparseList* fromSL = fromData->asSparseList(ctx);
-                        const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(ctx, "__keys__");
-                        const proto::ProtoObject* fromKeysObj = from->getAttribute(ctx, keysName);
-                        if (fromKeysObj && fromKeysObj->asList(ctx)) {
-                            const proto::ProtoList* fromKeys = fromKeysObj->asList(ctx);
-                            const proto::ProtoObject* toKeysObj = toObj->getAttribute(ctx, keysName);
-                            const proto::ProtoList* toKeys = (toKeysObj && toKeysObj->asList(ctx)) ? toKeysObj->asList(ctx) : ctx->newList();
-                            for (unsigned long j = 0; j < fromKeys->getSize(ctx); ++j) {
-                                const proto::ProtoObject* k = fromKeys->getAt(ctx, j);
-                                unsigned long h = k->getHash(ctx);
-                                const proto::ProtoObject* v = fromSL->getAt(ctx, h);
-                                bool isNew = !toSL->has(ctx, h);
-                                toSL = toSL->setAt(ctx, h, v);
-                                if (isNew) toKeys = toKeys->appendLast(ctx, k);
-                            }
-                            toObj->setAttribute(ctx, keysName, toKeys->asObject(ctx));
-                            toObj->setAttribute(ctx, dataString, toSL->asObject(ctx));
-                        }
+                const proto::ProtoObject* toObj = stack[stack.size() - 1 - arg];
+                if (isDictLike(ctx, toObj) && isDictLike(ctx, from)) {
+                    const proto::ProtoList* entries = dictEntries(ctx, from);
+                    const unsigned long n = entries->getSize(ctx);
+                    for (unsigned long j = 0; j + 1 < n; j += 2) {
+                        if (!dictSet(ctx, toObj, entries->getAt(ctx, static_cast<int>(j)),
+                                     entries->getAt(ctx, static_cast<int>(j + 1)))) break;
                     }
                 }
+                stack.pop_back();
             }
-        } else if (op == OP_LIST_EXTEND) {
+            DISPATCH();
+        }
+        TARGET(OP_LIST_EXTEND) {
             if (stack.size() >= static_cast<size_t>(arg + 1)) {
                 const proto::ProtoObject* iterable = stack.back();
                 stack.pop_back();
                 proto::ProtoObject* lstObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg]);
-                const proto::ProtoString* dataString = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* dataObj = lstObj->getAttribute(ctx, dataString);
-                if (dataObj && dataObj->asList(ctx)) {
-                    const proto::ProtoList* lst = dataObj->asList(ctx);
-                    // iterable can be list or other iterable. For now, check if it has __data__ as list
-                    const proto::ProtoObject* fromData = iterable->getAttribute(ctx, dataString);
-                    const proto::ProtoList* fromList = (fromData && fromData->asList(ctx)) ? fromData->asList(ctx) : iterable->asList(ctx);
-                    if (fromList) {
-                        for (unsigned long j = 0; j < fromList->getSize(ctx); ++j) {
-                            lst = lst->appendLast(ctx, fromList->getAt(ctx, j));
-                        }
-                        lstObj->setAttribute(ctx, dataString, lst->asObject(ctx));
-                    }
-                }
+                // iterable can be list or other iterable. For now, only lists are unpacked here.
+                std::vector<const proto::ProtoObject*> items;
+                if (listItems(ctx, iterable, &items)) listExtend(ctx, lstObj, items);
             }
-        } else if (op == OP_SET_UPDATE) {
+            DISPATCH();
+        }
+        TARGET(OP_SET_UPDATE) {
             if (stack.size() >= static_cast<size_t>(arg + 1)) {
                 const proto::ProtoObject* iterable = stack.back();
                 stack.pop_back();
                 proto::ProtoObject* setObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg]);
                 const proto::ProtoString* dataString = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* dataObj = setObj->getAttribute(ctx, dataString);
+                const proto::ProtoObject* dataObj = dataAttribute(ctx, setObj);
                 if (dataObj && dataObj->asSet(ctx)) {
                     const proto::ProtoSet* s = dataObj->asSet(ctx);
-                    const proto::ProtoObject* fromData = iterable->getAttribute(ctx, dataString);
+                    const proto::ProtoObject* fromData = dataAttribute(ctx, iterable);
                     const proto::ProtoList* fromList = (fromData && fromData->asList(ctx)) ? fromData->asList(ctx) : iterable->asList(ctx);
                     if (fromList) {
                         for (unsigned long j = 0; j < fromList->getSize(ctx); ++j) {
@@ -2145,8 +3012,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
+            DISPATCH();
         }
- else if (op == OP_BUILD_SET) {
+        TARGET(OP_BUILD_SET) {
             if (stack.size() < static_cast<size_t>(arg)) continue;
             proto::ProtoObject* setObj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
             stack.push_back(setObj); // Root setObj
@@ -2166,16 +3034,20 @@ const proto::ProtoObject* executeBytecodeRange(
             const proto::ProtoObject* finalSet = stack[stack.size() - 2];
             for (int j = 0; j < arg + 2; ++j) stack.pop_back();
             stack.push_back(finalSet);
-        } else if (op == OP_BUILD_STRING) {
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_STRING) {
             if (stack.size() < static_cast<size_t>(arg)) continue;
             // GC safe: elements remain on stack until buildString returns
             const proto::ProtoObject** partsPtr = (const proto::ProtoObject**)(&stack[stack.size() - arg]);
             const proto::ProtoObject* res = env->buildString(partsPtr, arg);
             for (int j = 0; j < arg; ++j) stack.pop_back();
             stack.push_back(res);
-        } else if (op == OP_LOAD_DEREF) {
-            if (names && frame && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+            DISPATCH();
+        }
+        TARGET(OP_LOAD_DEREF) {
+            if (frame && static_cast<unsigned long>(arg) < names.size()) {
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj && nameObj->isString(ctx)) {
                     const proto::ProtoString* nameS = nameObj->asString(ctx);
                     unsigned long h = nameObj->getHash(ctx);
@@ -2201,7 +3073,10 @@ const proto::ProtoObject* executeBytecodeRange(
                         
                         const proto::ProtoString* dName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
                         const proto::ProtoObject* dataObj = curr->getAttribute(ctx, dName);
-                        if (dataObj && dataObj->asSparseList(ctx)) {
+                        if (DictTable* table = dictTable(ctx, curr)) {
+                            val = table->get(ctx, nameObj);
+                            if (val && val != PROTO_NONE) { found = true; break; }
+                        } else if (dataObj && dataObj->asSparseList(ctx)) {
                             val = dataObj->asSparseList(ctx)->getAt(ctx, h);
                             if (val && val != PROTO_NONE) { found = true; break; }
                         }
@@ -2227,11 +3102,13 @@ const proto::ProtoObject* executeBytecodeRange(
                     stack.push_back(val);
                 }
             }
-        } else if (op == OP_STORE_DEREF) {
-            if (names && stack.size() >= 1 && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
+            DISPATCH();
+        }
+        TARGET(OP_STORE_DEREF) {
+            if (stack.size() >= 1 && static_cast<unsigned long>(arg) < names.size()) {
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj && nameObj->isString(ctx)) {
                     const proto::ProtoString* nameS = nameObj->asString(ctx);
                     unsigned long h = nameObj->getHash(ctx);
@@ -2284,17 +3161,23 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_JUMP_ABSOLUTE) {
+            DISPATCH();
+        }
+        TARGET(OP_JUMP_ABSOLUTE) {
             if (arg >= 0 && static_cast<unsigned long>(arg) < n)
-                i = static_cast<unsigned long>(arg) - 2;
-        } else if (op == OP_LOAD_ATTR) {
-            if (names && stack.size() >= 1 && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
+                JUMP_TO(arg);
+            DISPATCH();
+        }
+        TARGET(OP_LOAD_ATTR) {
+            if (stack.size() >= 1 && static_cast<unsigned long>(arg) < names.size()) {
                 const proto::ProtoObject* obj = stack.back();
                 stack.pop_back();
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj->isString(ctx)) {
                     const proto::ProtoString* attrName = nameObj->asString(ctx);
-                    const proto::ProtoObject* val = env ? env->getAttribute(ctx, obj, attrName) : obj->getAttribute(ctx, attrName);
+                    const proto::ProtoObject* val = nullptr;
+                    if (!(caches && caches->loadAttr(ctx, env, ip->cache, obj, attrName, val)))
+                        val = env ? env->getAttribute(ctx, obj, attrName) : obj->getAttribute(ctx, attrName);
                     if (val) {
                         stack.push_back(val);
                     } else {
@@ -2305,21 +3188,25 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_STORE_ATTR) {
-            if (names && stack.size() >= 2 && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
+            DISPATCH();
+        }
+        TARGET(OP_STORE_ATTR) {
+            if (stack.size() >= 2 && static_cast<unsigned long>(arg) < names.size()) {
                 const proto::ProtoObject* obj = stack.back();
                 stack.pop_back();
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj->isString(ctx)) {
                     const proto::ProtoString* nameS = nameObj->asString(ctx);
-                    if (std::getenv("PROTO_ENV_DIAG")) {
+                    if (get_env_diag()) {
                         std::string n;
                         nameS->toUTF8String(ctx, n);
                         std::cerr << "[proto-diag] OP_STORE_ATTR: obj=" << obj << " name='" << n << "' val=" << val << "\n";
                     }
-                    if (env) {
+                    if (caches && caches->storeAttr(ctx, env, ip->cache, obj, nameS, val)) {
+                        // Inline cache hit: plain store, no data descriptor on the chain.
+                    } else if (env) {
                         obj = const_cast<proto::ProtoObject*>(env->setAttribute(ctx, obj, nameS, val));
                     } else {
                         proto::ProtoObject* mutableObj = const_cast<proto::ProtoObject*>(obj);
@@ -2327,7 +3214,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_BUILD_LIST) {
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_LIST) {
             if (stack.size() < static_cast<size_t>(arg)) continue;
             const proto::ProtoList* lst = ctx->newList();
             stack.push_back(lst->asObject(ctx)); // Root lst
@@ -2350,14 +3239,21 @@ const proto::ProtoObject* executeBytecodeRange(
             const proto::ProtoObject* finalList = listObj;
             for (int j = 0; j < arg + 2; ++j) stack.pop_back();
             stack.push_back(finalList);
-        } else if (op == OP_BINARY_SUBSCR) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_SUBSCR) {
             // i++;
             if (stack.size() < 2) continue;
             const proto::ProtoObject* key = stack.back();
             stack.pop_back();
             const proto::ProtoObject* container = stack.back();
             stack.pop_back();
-            
+            adaptInstr(*ip, [&] {
+                if (key->isInteger(ctx) && isExactList(ctx, env, container)) return OP_BINARY_SUBSCR_LIST_INT;
+                if (exactDictTable(ctx, env, container)) return OP_BINARY_SUBSCR_DICT;
+                return -1;
+            });
+
             const proto::ProtoString* getItemS = env ? env->getGetItemString() : proto::ProtoString::fromUTF8String(ctx, "__getitem__");
             const proto::ProtoList* args = ctx->newList()->appendLast(ctx, key);
             const proto::ProtoObject* result = invokeDunder(ctx, container, getItemS, args);
@@ -2368,7 +3264,7 @@ const proto::ProtoObject* executeBytecodeRange(
                 return nullptr;
             } else {
                 // Fallback for minimal objects without __getitem__ (e.g. built-in lists/tuples if dunder is missing)
-                const proto::ProtoObject* data = container->getAttribute(ctx, env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__"));
+                const proto::ProtoObject* data = dataAttribute(ctx, container);
                 if (data) {
                     if (data->asList(ctx) && key->isInteger(ctx)) {
                         long long idx = key->asLong(ctx);
@@ -2426,42 +3322,47 @@ const proto::ProtoObject* executeBytecodeRange(
                     stack.push_back(PROTO_NONE);
                 }
             }
-        } else if (op == OP_BUILD_MAP) {
+            DISPATCH();
+        }
+        TARGET(OP_BINARY_SUBSCR_LIST_INT) {
+            // Inlined list.__getitem__ for an int index; same out-of-range result as py_list_getitem.
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* key = stack.back();
+            const proto::ProtoObject* container = stack[stack.size() - 2];
+            if (!key->isInteger(ctx) || !isExactList(ctx, env, container)) DEOPTIMIZE();
+            const proto::ProtoObject* item = nullptr;
+            if (!listGetAt(ctx, container, static_cast<long>(key->asLong(ctx)), &item)) DEOPTIMIZE();
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(item ? item : PROTO_NONE);
+            ++executed.hits[OP_BINARY_SUBSCR_LIST_INT - OP_FIRST_SPECIALIZED];
+            FAST_DISPATCH();
+        }
+        TARGET(OP_BINARY_SUBSCR_DICT) {
+            // Inlined dict.__getitem__; a missing key raises KeyError like py_dict_getitem.
+            if (stack.size() < 2) continue;
+            const proto::ProtoObject* key = stack.back();
+            DictTable* dict = exactDictTable(ctx, env, stack[stack.size() - 2]);
+            if (!dict) DEOPTIMIZE();
+            const proto::ProtoObject* val = dict->get(ctx, key);
+            if (!val && !env->hasPendingException()) env->raiseKeyError(ctx, key);
+            stack.pop_back();
+            stack.back() = const_cast<proto::ProtoObject*>(val ? val : PROTO_NONE);
+            ++executed.hits[OP_BINARY_SUBSCR_DICT - OP_FIRST_SPECIALIZED];
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_MAP) {
             if (stack.size() < static_cast<size_t>(arg * 2)) continue;
-            const proto::ProtoSparseList* data = ctx->newSparseList();
-            stack.push_back(data->asObject(ctx)); // Root data
-            const proto::ProtoList* keys = ctx->newList();
-            stack.push_back(keys->asObject(ctx)); // Root keys
-            
-            size_t baseIdx = stack.size() - 2 - 2 * arg;
+            stack.push_back(newDict(ctx, nullptr, static_cast<size_t>(arg))); // Root the dict
+            const proto::ProtoObject* dictObj = stack.back();
+            size_t baseIdx = stack.size() - 1 - 2 * arg;
             for (int k = 0; k < arg; ++k) {
-                const proto::ProtoObject* key = stack[baseIdx + 2 * k];
-                const proto::ProtoObject* val = stack[baseIdx + 2 * k + 1];
-                data = data->setAt(ctx, key->getHash(ctx), val);
-                stack[stack.size() - 2] = const_cast<proto::ProtoObject*>(data->asObject(ctx)); // Update data root
-                keys = keys->appendLast(ctx, key);
-                stack[stack.size() - 1] = const_cast<proto::ProtoObject*>(keys->asObject(ctx)); // Update keys root
-            }
-            
-            proto::ProtoObject* dictObj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
-            stack.push_back(dictObj); // Root dictObj
-            if (env && env->getDictPrototype()) {
-                dictObj = const_cast<proto::ProtoObject*>(dictObj->addParent(ctx, env->getDictPrototype()));
-                stack.back() = dictObj;
+                if (!dictSet(ctx, dictObj, stack[baseIdx + 2 * k], stack[baseIdx + 2 * k + 1])) break;
             }
-            
-            const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-            const proto::ProtoString* keysName = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(ctx, "__keys__");
-            
-            dictObj = const_cast<proto::ProtoObject*>(dictObj->setAttribute(ctx, dataName, data->asObject(ctx)));
-            stack.back() = dictObj;
-            dictObj = const_cast<proto::ProtoObject*>(dictObj->setAttribute(ctx, keysName, keys->asObject(ctx)));
-            stack.back() = dictObj;
-            
-            const proto::ProtoObject* finalDict = dictObj;
-            for (int k = 0; k < 2 * arg + 3; ++k) stack.pop_back();
-            stack.push_back(finalDict);
-        } else if (op == OP_STORE_SUBSCR) {
+            for (int k = 0; k < 2 * arg + 1; ++k) stack.pop_back();
+            stack.push_back(dictObj);
+            DISPATCH();
+        }
+        TARGET(OP_STORE_SUBSCR) {
             // i++;
             if (stack.size() < 3) continue;
             const proto::ProtoObject* value = stack.back();
@@ -2485,7 +3386,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     container->asList(ctx)->setAt(ctx, static_cast<int>(idx), value);
                 }
             }
-        } else if (op == OP_CALL_FUNCTION_KW) {
+            DISPATCH();
+        }
+        TARGET(OP_CALL_FUNCTION_KW) {
             if (stack.size() < 2) continue; // at least callable and names_tuple
             const proto::ProtoObject* namesTupleObj = stack.back();
             stack.pop_back();
@@ -2528,19 +3431,15 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 stack.push_back(env ? env->getNonePrototype() : PROTO_NONE);
             }
-        } else if (op == OP_CALL_FUNCTION) {
+            DISPATCH_POLL();
+        }
+        TARGET(OP_CALL_FUNCTION) {
             if (stack.size() < static_cast<size_t>(arg) + 1) continue;
-            std::vector<const proto::ProtoObject*> argVec(arg);
-            for (int j = arg - 1; j >= 0; --j) {
-                argVec[j] = stack.back();
-                stack.pop_back();
-            }
-            const proto::ProtoObject* callable = stack.back();
-            stack.pop_back();
-            const proto::ProtoList* args = ctx->newList();
-            for (int j = 0; j < arg; ++j)
-                args = args->appendLast(ctx, argVec[j]);
-            const proto::ProtoObject* result = invokeCallable(ctx, callable, args);
+            // Arguments stay on the value stack (a GC root) for the duration of the call.
+            const size_t argBase = stack.size() - static_cast<size_t>(arg);
+            const proto::ProtoObject* callable = stack[argBase - 1];
+            const proto::ProtoObject* result = vectorcallObject(ctx, callable, stack.data() + argBase, static_cast<size_t>(arg));
+            for (int j = 0; j <= arg; ++j) stack.pop_back();
             PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
             if (result) {
                 stack.push_back(result);
@@ -2550,7 +3449,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 // Return value was None (nullptr) but no exception.
                 stack.push_back(env ? env->getNonePrototype() : PROTO_NONE);
             }
-        } else if (op == OP_CALL_FUNCTION_EX) {
+            DISPATCH_POLL();
+        }
+        TARGET(OP_CALL_FUNCTION_EX) {
             const proto::ProtoObject* kwargs = (arg & 1) ? stack.back() : nullptr;
             if (arg & 1) stack.pop_back();
             const proto::ProtoObject* starargs = stack.back();
@@ -2587,17 +3488,15 @@ const proto::ProtoObject* executeBytecodeRange(
             if (kwargs && kwargs->asSparseList(ctx)) {
                 kwArgs = kwargs->asSparseList(ctx);
             } else if (kwargs && kwargs != PROTO_NONE && env) {
-                 // Fallback: check if it has __data__ (for dict objects)
-                 const proto::ProtoString* dName = env->getDataString();
-                 const proto::ProtoObject* data = kwargs->getAttribute(ctx, dName);
-                 if (data && data->asSparseList(ctx)) kwArgs = data->asSparseList(ctx);
+                 // Dict objects: the callee takes the hash-keyed view.
+                 kwArgs = dictHashData(ctx, kwargs);
             }
             
             bool pushed = false;
             if (kwargs && env) {
-                 const proto::ProtoObject* keysListObj = kwargs->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"));
-                 if (keysListObj && keysListObj->asList(ctx)) {
-                     env->pushKwNames(ctx->newTupleFromList(keysListObj->asList(ctx)));
+                 const proto::ProtoObject* keysListObj = dictTable(ctx, kwargs) ? nullptr : kwargs->getAttribute(ctx, env->getKeysString());
+                 if (dictTable(ctx, kwargs) || (keysListObj && keysListObj->asList(ctx))) {
+                     env->pushKwNames(ctx->newTupleFromList(dictKeys(ctx, kwargs)));
                      pushed = true;
                  }
             }
@@ -2611,7 +3510,9 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 stack.push_back(env ? env->getNonePrototype() : PROTO_NONE);
             }
-        } else if (op == OP_BUILD_TUPLE) {
+            DISPATCH_POLL();
+        }
+        TARGET(OP_BUILD_TUPLE) {
             if (stack.size() < static_cast<size_t>(arg)) continue;
             // i++;
             const proto::ProtoList* lst = ctx->newList();
@@ -2633,7 +3534,9 @@ const proto::ProtoObject* executeBytecodeRange(
             const proto::ProtoObject* finalTup = tupObj;
             for (int j = 0; j < arg + 2; ++j) stack.pop_back();
             stack.push_back(finalTup);
-        } else if (op == OP_BUILD_FUNCTION) {
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_FUNCTION) {
             const proto::ProtoObject* kwDefaults = (arg & 0x02) ? stack.back() : nullptr;
             if (arg & 0x02) stack.pop_back();
             const proto::ProtoObject* defaults = (arg & 0x01) ? stack.back() : nullptr;
@@ -2647,7 +3550,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     stack.push_back(fn);
                 }
             }
-        } else if (op == OP_BUILD_CLASS) {
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_CLASS) {
             // No argument for BUILD_CLASS
             if (stack.size() >= 4 && frame) {
                 const proto::ProtoObject* body = stack.back();
@@ -2749,11 +3654,14 @@ const proto::ProtoObject* executeBytecodeRange(
                 
                 // Set __call__ to support instantiation
                 targetClass = const_cast<proto::ProtoObject*>(targetClass->setAttribute(ctx, callS, ctx->fromMethod(targetClass, runUserClassCall)));
+                // Subclasses of _thread._local construct per-thread instances.
+                targetClass = const_cast<proto::ProtoObject*>(bindThreadLocalClass(ctx, targetClass));
 
                 stack.push_back(targetClass);
             }
+            DISPATCH();
         }
-        else if (op == OP_GET_ITER) {
+        TARGET(OP_GET_ITER) {
             if (stack.empty()) continue;
             const proto::ProtoObject* iterable = stack.back();
             stack.pop_back();
@@ -2769,7 +3677,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 // Fallback for native objects (should be handled by env->iter if possible)
                 stack.push_back(iterable);
             }
-        } else if (op == OP_FOR_ITER) {
+            DISPATCH();
+        }
+        TARGET(OP_FOR_ITER) {
             if (stack.empty()) continue;
             const proto::ProtoObject* iterator = stack.back();
 
@@ -2784,9 +3694,9 @@ const proto::ProtoObject* executeBytecodeRange(
                   } else {
                      stack.pop_back();
                      if (arg >= 0 && static_cast<unsigned long>(arg) < n)
-                        i = static_cast<unsigned long>(arg) - 2;
+                        JUMP_TO(arg);
                  }
-                 continue;
+                 FAST_DISPATCH();
             }
 
             PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
@@ -2801,19 +3711,18 @@ const proto::ProtoObject* executeBytecodeRange(
                 // exhaustion
                 stack.pop_back();
                 if (arg >= 0 && static_cast<unsigned long>(arg) < n)
-                    i = static_cast<unsigned long>(arg) - 2;
-                continue;
+                    JUMP_TO(arg);
             }
-            // continue normal execution after pushing val
-            continue;
-        } else if (op == OP_UNPACK_SEQUENCE) {
+            DISPATCH();
+        }
+        TARGET(OP_UNPACK_SEQUENCE) {
             if (stack.empty() || arg <= 0) continue;
             const proto::ProtoObject* seq = stack.back();
             stack.pop_back();
             const proto::ProtoList* list = seq->asList(ctx);
             const proto::ProtoTuple* tup = seq->asTuple(ctx);
             if (!list && !tup) {
-                 const proto::ProtoObject* data = seq->getAttribute(ctx, env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__"));
+                 const proto::ProtoObject* data = dataAttribute(ctx, seq);
                  if (data) {
                      list = data->asList(ctx);
                      tup = data->asTuple(ctx);
@@ -2830,7 +3739,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     stack.push_back(tup->getAt(ctx, j));
                 }
             }
-        } else if (op == OP_UNPACK_EX) {
+            DISPATCH();
+        }
+        TARGET(OP_UNPACK_EX) {
             if (stack.empty()) continue;
             int num_before = arg & 0xFF;
             int num_after = (arg >> 8) & 0xFF;
@@ -2838,7 +3749,7 @@ const proto::ProtoObject* executeBytecodeRange(
             stack.pop_back();
 
             std::vector<const proto::ProtoObject*> all;
-            const proto::ProtoList* list = seq->asList(ctx);
+            const proto::ProtoList* list = asListData(ctx, seq);
             const proto::ProtoTuple* tup = seq->asTuple(ctx);
             if (list) {
                 for (size_t i = 0; i < list->getSize(ctx); ++i) all.push_back(list->getAt(ctx, i));
@@ -2864,17 +3775,24 @@ const proto::ProtoObject* executeBytecodeRange(
             for (int i = num_before - 1; i >= 0; --i) {
                 stack.push_back(all[i]);
             }
-        } else if (op == OP_LOAD_GLOBAL) {
-                if (names && frame && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+            DISPATCH_POLL();
+        }
+        TARGET(OP_LOAD_GLOBAL) {
+            if (static_cast<unsigned long>(arg) < names.size()) {
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj->isString(ctx)) {
                     const proto::ProtoString* nameS = nameObj->asString(ctx);
-                    const proto::ProtoObject* val = frame->getAttribute(ctx, nameS);
+                    // Without a frame object (LazyFrame) there is nothing to search before the globals.
+                    const proto::ProtoObject* val = frame ? frame->getAttribute(ctx, nameS) : nullptr;
                     bool found = (val != nullptr);
-                    if (!found) {
+                    if (!found && frame) {
                         const proto::ProtoString* dName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
                         const proto::ProtoObject* dataObj = frame->getAttribute(ctx, dName);
-                        if (dataObj && dataObj->asSparseList(ctx)) {
+                        if (DictTable* table = dictTable(ctx, frame)) {
+                            // exec()/eval() with a dict as the namespace.
+                            val = table->get(ctx, nameObj);
+                            found = (val != nullptr);
+                        } else if (dataObj && dataObj->asSparseList(ctx)) {
                             if (dataObj->asSparseList(ctx)->has(ctx, nameObj->getHash(ctx))) {
                                 val = dataObj->asSparseList(ctx)->getAt(ctx, nameObj->getHash(ctx));
                                 found = true;
@@ -2885,7 +3803,8 @@ const proto::ProtoObject* executeBytecodeRange(
                         stack.push_back(val);
                     } else {
                         if (env) {
-                            val = env->resolve(nameS, ctx);
+                            if (!(caches && caches->loadGlobal(ctx, env, ip->cache, nameS, val)))
+                                val = env->resolve(nameS, ctx);
                             if (val != nullptr) {
                                 stack.push_back(val);
                             } else {
@@ -2902,20 +3821,23 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_STORE_GLOBAL) {
-            if (names && frame && static_cast<unsigned long>(arg) < names->getSize(ctx)) {
+            DISPATCH();
+        }
+        TARGET(OP_STORE_GLOBAL) {
+            if (frame && static_cast<unsigned long>(arg) < names.size()) {
                 if (stack.empty()) continue;
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 const proto::ProtoObject* val = stack.back();
                 stack.pop_back();
                 if (nameObj->isString(ctx)) {
                     frame = const_cast<proto::ProtoObject*>(frame->setAttribute(ctx, nameObj->asString(ctx), val));
                     PythonEnvironment::setCurrentFrame(frame);
                     if (sync_globals) PythonEnvironment::setCurrentGlobals(frame);
-                    if (env) env->invalidateResolveCache();
                 }
             }
-        } else if (op == OP_BUILD_SLICE) {
+            DISPATCH();
+        }
+        TARGET(OP_BUILD_SLICE) {
             // i++;
             if ((arg != 2 && arg != 3) || stack.size() < static_cast<size_t>(arg)) continue;
             long long step = 1;
@@ -2938,7 +3860,9 @@ const proto::ProtoObject* executeBytecodeRange(
             sliceObj = const_cast<proto::ProtoObject*>(sliceObj->setAttribute(ctx, env ? env->getStepString() : proto::ProtoString::fromUTF8String(ctx, "step"), stepObj));
             if (env && env->getSliceType()) sliceObj->addParent(ctx, env->getSliceType());
             stack.push_back(sliceObj);
-        } else if (op == OP_ROT_TWO) {
+            DISPATCH();
+        }
+        TARGET(OP_ROT_TWO) {
             if (stack.size() >= 2) {
                 const proto::ProtoObject* a = stack.back();
                 stack.pop_back();
@@ -2947,7 +3871,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 stack.push_back(a);
                 stack.push_back(b);
             }
-        } else if (op == OP_ROT_THREE) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_ROT_THREE) {
             if (stack.size() >= 3) {
                 const proto::ProtoObject* a = stack.back();
                 stack.pop_back();
@@ -2959,7 +3885,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 stack.push_back(a);
                 stack.push_back(c);
             }
-        } else if (op == OP_ROT_FOUR) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_ROT_FOUR) {
             if (stack.size() >= 4) {
                 const proto::ProtoObject* a = stack.back();
                 stack.pop_back();
@@ -2974,115 +3902,15 @@ const proto::ProtoObject* executeBytecodeRange(
                 stack.push_back(a);
                 stack.push_back(d);
             }
-        } else if (op == OP_LIST_EXTEND) {
-            if (stack.size() >= static_cast<size_t>(arg + 1)) {
-                // stack[-2] is listObj, stack[-1] is iterable
-                const proto::ProtoObject* iterable = stack.back();
-                proto::ProtoObject* listObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg - 1]);
-                
-                const proto::ProtoString* dataS = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* data = listObj->getAttribute(ctx, dataS);
-                const proto::ProtoList* L = (data && data->asList(ctx)) ? data->asList(ctx) : nullptr;
-                
-                if (L && env) {
-                    stack.push_back(L->asObject(ctx)); // TEMP ROOT at index top-1
-                    const proto::ProtoObject* iter = env->iter(iterable);
-                    stack.push_back(iter); // TEMP ROOT at index top-1
-                    while (iter) {
-                        const proto::ProtoObject* item = env->next(iter);
-                        if (!item) break;
-                        L = L->appendLast(ctx, item);
-                        stack[stack.size() - 2] = const_cast<proto::ProtoObject*>(L->asObject(ctx)); // Update L root
-                    }
-                    if (env->hasPendingException()) {
-                        const proto::ProtoObject* exc = env->takePendingException();
-                        if (!env->isStopIteration(ctx, exc)) {
-                            env->setPendingException(exc);
-                            return nullptr;
-                        }
-                    }
-                    listObj->setAttribute(ctx, dataS, L->asObject(ctx));
-                    stack.pop_back(); // pop iter
-                    stack.pop_back(); // pop L
-                }
-                stack.pop_back(); // pop iterable
-            }
-        } else if (op == OP_DICT_UPDATE) {
-            // GC Safe: iterable stays on stack until updated
-            if (stack.size() >= static_cast<size_t>(arg + 1)) {
-                const proto::ProtoObject* other = stack.back();
-                proto::ProtoObject* dictObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg - 1]);
-                
-                const proto::ProtoString* dataS = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoString* keysS = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(ctx, "__keys__");
-                
-                const proto::ProtoObject* data = dictObj->getAttribute(ctx, dataS);
-                const proto::ProtoSparseList* sl = (data && data->asSparseList(ctx)) ? data->asSparseList(ctx) : nullptr;
-                
-                if (sl && env) {
-                    const proto::ProtoObject* otherData = other->getAttribute(ctx, dataS);
-                    const proto::ProtoSparseList* otherSl = (otherData && otherData->asSparseList(ctx)) ? otherData->asSparseList(ctx) : nullptr;
-                    if (otherSl) {
-                        const proto::ProtoObject* keysObj = other->getAttribute(ctx, keysS);
-                        const proto::ProtoList* otherKeys = (keysObj && keysObj->asList(ctx)) ? keysObj->asList(ctx) : nullptr;
-                        if (otherKeys) {
-                            for (unsigned long j = 0; j < otherKeys->getSize(ctx); ++j) {
-                                const proto::ProtoObject* k = otherKeys->getAt(ctx, static_cast<int>(j));
-                                unsigned long h = k->getHash(ctx);
-                                const proto::ProtoObject* v = otherSl->getAt(ctx, h);
-                                
-                                bool isNew = !sl->has(ctx, h);
-                                sl = sl->setAt(ctx, h, v);
-                                if (isNew) {
-                                    const proto::ProtoObject* myKeysObj = dictObj->getAttribute(ctx, keysS);
-                                    const proto::ProtoList* myKeys = (myKeysObj && myKeysObj->asList(ctx)) ? myKeysObj->asList(ctx) : ctx->newList();
-                                    myKeys = myKeys->appendLast(ctx, k);
-                                    dictObj->setAttribute(ctx, keysS, myKeys->asObject(ctx));
-                                }
-                            }
-                        }
-                    } else {
-                        // Handle generic mapping/iterable (simplified for now: expect dict-like)
-                    }
-                    dictObj->setAttribute(ctx, dataS, sl->asObject(ctx));
-                }
-                stack.pop_back();
-            }
-        } else if (op == OP_SET_UPDATE) {
-            // GC Safe: iterable stays on stack until updated
-            if (stack.size() >= static_cast<size_t>(arg + 1)) {
-                const proto::ProtoObject* iterable = stack.back();
-                proto::ProtoObject* setObj = const_cast<proto::ProtoObject*>(stack[stack.size() - arg - 1]);
-                
-                const proto::ProtoString* dataS = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* data = setObj->getAttribute(ctx, dataS);
-                const proto::ProtoSet* s = (data && data->asSet(ctx)) ? data->asSet(ctx) : nullptr;
-                
-                if (s && env) {
-                    const proto::ProtoObject* iter = env->iter(iterable);
-                    while (iter) {
-                        const proto::ProtoObject* item = env->next(iter);
-                        if (!item) break;
-                        s = s->add(ctx, item);
-                    }
-                    if (env->hasPendingException()) {
-                        const proto::ProtoObject* exc = env->takePendingException();
-                        if (!env->isStopIteration(ctx, exc)) {
-                            env->setPendingException(exc);
-                            return nullptr;
-                        }
-                    }
-                    setObj->setAttribute(ctx, dataS, s->asObject(ctx));
-                }
-                stack.pop_back();
-            }
-        } else if (op == OP_LIST_TO_TUPLE) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_LIST_TO_TUPLE) {
             // GC Safe: list stays on stack until tuple is ready
             if (!stack.empty()) {
                 proto::ProtoObject* listObj = const_cast<proto::ProtoObject*>(stack.back());
                 
                 const proto::ProtoString* dataS = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                const proto::ProtoObject* data = listObj->getAttribute(ctx, dataS);
+                const proto::ProtoObject* data = dataAttribute(ctx, listObj);
                 const proto::ProtoList* L = (data && data->asList(ctx)) ? data->asList(ctx) : nullptr;
                 
                 if (L) {
@@ -3100,7 +3928,9 @@ const proto::ProtoObject* executeBytecodeRange(
                     stack.push_back(PROTO_NONE);
                 }
             }
-        } else if (op == OP_DUP_TOP_TWO) {
+            DISPATCH();
+        }
+        TARGET(OP_DUP_TOP_TWO) {
             if (stack.size() >= 2) {
                 const proto::ProtoObject* b = stack.back();
                 stack.pop_back();
@@ -3111,19 +3941,22 @@ const proto::ProtoObject* executeBytecodeRange(
                 stack.push_back(a);
                 stack.push_back(b);
             }
-        } else if (op == OP_DUP_TOP) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_DUP_TOP) {
             if (!stack.empty())
                 stack.push_back(stack.back());
-        } else if (op == OP_POP_TOP) {
-            if (!stack.empty())
-                stack.pop_back();
-        } else if (op == OP_DELETE_NAME || op == OP_DELETE_GLOBAL) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_DELETE_NAME)
+        TARGET(OP_DELETE_GLOBAL) {
             // i++;
             if (frame) {
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj && nameObj->isString(ctx)) {
                     frame->setAttribute(ctx, nameObj->asString(ctx), nullptr);
                     // Also check __data__ if frame is a dict
+                    if (DictTable* table = dictTable(ctx, frame)) table->pop(ctx, nameObj);
                     const proto::ProtoString* data_name = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
                     const proto::ProtoObject* data = frame->getAttribute(ctx, data_name);
                     if (data && data->asSparseList(ctx)) {
@@ -3131,24 +3964,29 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-            if (env) env->invalidateResolveCache();
-        } else if (op == OP_DELETE_FAST) {
+            DISPATCH();
+        }
+        TARGET(OP_DELETE_FAST) {
             const unsigned int nSlots = ctx->getAutomaticLocalsCount();
             if (arg >= 0 && static_cast<unsigned long>(arg) < nSlots) {
                 proto::ProtoObject** slots = const_cast<proto::ProtoObject**>(ctx->getAutomaticLocals());
                 slots[arg] = nullptr; 
             }
-        } else if (op == OP_DELETE_ATTR) {
+            DISPATCH();
+        }
+        TARGET(OP_DELETE_ATTR) {
             // i++;
             if (!stack.empty()) {
                 const proto::ProtoObject* obj = stack.back();
                 stack.pop_back();
-                const proto::ProtoObject* nameObj = names->getAt(ctx, arg);
+                const proto::ProtoObject* nameObj = nameAt(arg);
                 if (nameObj && nameObj->isString(ctx)) {
-                    obj->setAttribute(ctx, nameObj->asString(ctx), nullptr);
+                    threadLocalStorage(ctx, obj)->setAttribute(ctx, nameObj->asString(ctx), nullptr);
                 }
             }
-        } else if (op == OP_DELETE_SUBSCR) {
+            DISPATCH();
+        }
+        TARGET(OP_DELETE_SUBSCR) {
             if (stack.size() >= 2) {
                 const proto::ProtoObject* key = stack.back();
                 stack.pop_back();
@@ -3159,8 +3997,7 @@ const proto::ProtoObject* executeBytecodeRange(
                 const proto::ProtoObject* result = invokeDunder(ctx, container, delItemS, args);
                 if (!result) {
                     // Fallback for list/dict
-                    const proto::ProtoString* data_name = env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
-                    const proto::ProtoObject* data = container->getAttribute(ctx, data_name);
+                    const proto::ProtoObject* data = dataAttribute(ctx, container);
                     if (data) {
                         if (data->asList(ctx) && key->isInteger(ctx)) {
                             long long idx = key->asLong(ctx);
@@ -3181,11 +4018,17 @@ const proto::ProtoObject* executeBytecodeRange(
                     }
                 }
             }
-        } else if (op == OP_SETUP_FINALLY) {
+            DISPATCH();
+        }
+        TARGET(OP_SETUP_FINALLY) {
              blockStack.push_back({static_cast<unsigned long>(arg), stack.size()});
-        } else if (op == OP_POP_BLOCK) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_POP_BLOCK) {
             if (!blockStack.empty()) blockStack.pop_back();
-        } else if (op == OP_GET_AWAITABLE) {
+            FAST_DISPATCH();
+        }
+        TARGET(OP_GET_AWAITABLE) {
             if (stack.empty()) continue;
             const proto::ProtoObject* obj = stack.back();
             stack.pop_back();
@@ -3198,7 +4041,9 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 stack.push_back(obj);
             }
-        } else if (op == OP_GET_AITER) {
+            DISPATCH();
+        }
+        TARGET(OP_GET_AITER) {
             if (stack.empty()) continue;
             const proto::ProtoObject* obj = stack.back();
             stack.pop_back();
@@ -3209,7 +4054,9 @@ const proto::ProtoObject* executeBytecodeRange(
             } else {
                 stack.push_back(obj);
             }
-        } else if (op == OP_GET_ANEXT) {
+            DISPATCH();
+        }
+        TARGET(OP_GET_ANEXT) {
             if (stack.empty()) continue;
             const proto::ProtoObject* aiter = stack.back();
             if (std::getenv("PROTO_ENV_DIAG")) {
@@ -3228,7 +4075,9 @@ const proto::ProtoObject* executeBytecodeRange(
                 }
                 continue;
             }
-        } else if (op == OP_EXCEPTION_MATCH) {
+            DISPATCH();
+        }
+        TARGET(OP_EXCEPTION_MATCH) {
              if (stack.size() < 2) continue;
              const proto::ProtoObject* type = stack.back();
              stack.pop_back();
@@ -3255,7 +4104,9 @@ const proto::ProtoObject* executeBytecodeRange(
                  // Exception match diagnostic removed
              }
              stack.push_back(match ? PROTO_TRUE : PROTO_FALSE);
-        } else if (op == OP_SETUP_ASYNC_WITH) {
+            DISPATCH();
+        }
+        TARGET(OP_SETUP_ASYNC_WITH) {
             if (stack.empty()) continue;
             const proto::ProtoObject* mgr = stack.back();
             stack.pop_back();
@@ -3270,12 +4121,38 @@ const proto::ProtoObject* executeBytecodeRange(
                 if (env) env->raiseTypeError(ctx, "async with expression must have __aenter__");
                 return PROTO_NONE;
             }
-            blockStack.push_back({static_cast<unsigned long>(arg), stack.size()});
+            if (!code->staticHandlers) blockStack.push_back({static_cast<unsigned long>(arg), stack.size()});
+            DISPATCH();
+        }
+        default:
+            DISPATCH();
         }
+#if PROTO_COMPUTED_GOTO
+    dispatch_poll:;
+#endif
     }
     return stack.empty() ? PROTO_NONE : stack.back();
 }
 
+const proto::ProtoObject* executeBytecodeRange(
+    proto::ProtoContext* ctx,
+    const proto::ProtoList* constants,
+    const proto::ProtoList* bytecode,
+    const proto::ProtoList* names,
+    proto::ProtoObject*& frame,
+    unsigned long pcStart,
+    unsigned long pcEnd,
+    unsigned long stackOffset,
+    std::vector<const proto::ProtoObject*>* externalStack,
+    unsigned long* outPc,
+    bool* yielded,
+    std::vector<Block>* externalBlockStack) {
+    if (!ctx || !constants || !bytecode) return nullptr;
+    std::unique_ptr<DecodedCode> code(decodeBytecode(ctx, constants, bytecode, names));
+    return executeDecodedRange(ctx, code.get(), frame, pcStart, pcEnd, stackOffset,
+        externalStack, outPc, yielded, externalBlockStack);
+}
+
 const proto::ProtoObject* executeMinimalBytecode(
     proto::ProtoContext* ctx,
     const proto::ProtoList* constants,
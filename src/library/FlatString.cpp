@@ -0,0 +1,159 @@
+#include <protoPython/FlatString.h>
+#include <protoPython/StringKernels.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace protoPython {
+
+namespace {
+
+/** Strings shorter than this are flattened per call, not cached. */
+constexpr unsigned long kCacheMin = 32;
+constexpr size_t kSlots = 256;
+constexpr size_t kCacheBytes = 16u << 20;
+
+struct FlatCache {
+    struct Entry {
+        const proto::ProtoString* str = nullptr;
+        FlatTextRef text;
+    };
+    std::vector<Entry> entries;
+    size_t bytes = 0;
+    const proto::ProtoList* rooted = nullptr;    ///< entries[i].str at i, PROTO_NONE for empty slots.
+    const proto::ProtoObject* holder = nullptr;  ///< Roots rooted (in moduleRoots).
+    const proto::ProtoString* rootedName = nullptr;
+    proto::ProtoSpace* space = nullptr;
+};
+
+thread_local FlatCache s_cache;
+
+size_t slotOf(const proto::ProtoString* s) {
+    const uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(s) >> 4) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h >> 56) % kSlots;
+}
+
+bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+void resetSlots(proto::ProtoContext* ctx, FlatCache& c) {
+    c.entries.assign(kSlots, FlatCache::Entry());
+    c.bytes = 0;
+    const proto::ProtoList* rooted = ctx->newList();
+    for (size_t i = 0; i < kSlots; ++i) rooted = rooted->appendLast(ctx, PROTO_NONE);
+    c.rooted = rooted;
+}
+
+void publishRooted(proto::ProtoContext* ctx, FlatCache& c) {
+    if (!c.holder) {
+        c.holder = ctx->newObject(true);
+        c.rootedName = proto::ProtoString::fromUTF8String(ctx, "__flat_strings__");
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        ctx->space->moduleRoots.push_back(c.holder);
+        ctx->space->moduleRoots.push_back(reinterpret_cast<const proto::ProtoObject*>(c.rootedName));
+    }
+    c.holder->setAttribute(ctx, c.rootedName, c.rooted->asObject(ctx));
+}
+
+} // anonymous namespace
+
+// --- FlatText ---
+
+FlatTextRef FlatText::fromUTF8(std::string utf8) {
+    auto text = std::make_shared<FlatText>();
+    text->utf8 = std::move(utf8);
+    const std::string& s = text->utf8;
+    if (asciiPrefix(s.data(), s.size()) == s.size()) {
+        text->length = s.size();
+        return text;
+    }
+    text->ascii = false;
+    unsigned long count = 0;
+    for (size_t pos = 0; pos < s.size(); ++pos) {
+        if (isContinuation(static_cast<unsigned char>(s[pos]))) continue;
+        if (count % kStride == 0) text->stride.push_back(pos);
+        ++count;
+    }
+    text->length = count;
+    return text;
+}
+
+size_t FlatText::offsetOf(unsigned long index) const {
+    if (index >= length) return utf8.size();
+    if (ascii) return index;
+    size_t pos = stride[index / kStride];
+    for (unsigned long n = index % kStride; n > 0; --n) {
+        ++pos;
+        while (pos < utf8.size() && isContinuation(static_cast<unsigned char>(utf8[pos]))) ++pos;
+    }
+    return pos;
+}
+
+unsigned long FlatText::indexOf(size_t offset) const {
+    if (ascii) return static_cast<unsigned long>(std::min(offset, utf8.size()));
+    if (offset >= utf8.size()) return length;
+    const size_t k = static_cast<size_t>(std::upper_bound(stride.begin(), stride.end(), offset) - stride.begin()) - 1;
+    unsigned long index = static_cast<unsigned long>(k * kStride);
+    for (size_t pos = stride[k] + 1; pos <= offset; ++pos) {
+        if (!isContinuation(static_cast<unsigned char>(utf8[pos]))) ++index;
+    }
+    return index;
+}
+
+size_t FlatText::charBytes(size_t offset) const {
+    if (offset >= utf8.size()) return 0;
+    if (ascii) return 1;
+    size_t end = offset + 1;
+    while (end < utf8.size() && isContinuation(static_cast<unsigned char>(utf8[end]))) ++end;
+    return end - offset;
+}
+
+// --- Cache ---
+
+FlatTextRef flatText(proto::ProtoContext* ctx, const proto::ProtoString* s) {
+    if (s->getSize(ctx) < kCacheMin) {
+        std::string utf8;
+        s->toUTF8String(ctx, utf8);
+        return FlatText::fromUTF8(std::move(utf8));
+    }
+    FlatCache& c = s_cache;
+    if (c.space != ctx->space) {
+        c = FlatCache();
+        c.space = ctx->space;
+    }
+    if (c.entries.empty()) resetSlots(ctx, c);
+    const size_t slot = slotOf(s);
+    FlatCache::Entry& e = c.entries[slot];
+    if (e.str == s) return e.text;
+
+    std::string utf8;
+    s->toUTF8String(ctx, utf8);
+    FlatTextRef text = FlatText::fromUTF8(std::move(utf8));
+    if (e.text) c.bytes -= e.text->utf8.size();
+    if (c.bytes + text->utf8.size() > kCacheBytes && c.bytes > 0) resetSlots(ctx, c);
+    FlatCache::Entry& fresh = c.entries[slot];
+    fresh.str = s;
+    fresh.text = text;
+    c.bytes += text->utf8.size();
+    c.rooted = c.rooted->setAt(ctx, static_cast<int>(slot), s->asObject(ctx));
+    publishRooted(ctx, c);
+    return text;
+}
+
+void releaseFlatStrings(proto::ProtoSpace* space) {
+    FlatCache& c = s_cache;
+    if (c.holder && c.space == space) {
+        std::lock_guard<std::mutex> lock(space->moduleRootsMutex);
+        auto& roots = space->moduleRoots;
+        const proto::ProtoObject* name = reinterpret_cast<const proto::ProtoObject*>(c.rootedName);
+        roots.erase(std::remove_if(roots.begin(), roots.end(),
+                                   [&](const proto::ProtoObject* r) { return r == c.holder || r == name; }),
+                    roots.end());
+    }
+    c = FlatCache();
+}
+
+} // namespace protoPython
@@ -0,0 +1,380 @@
+#include <protoPython/FutexSync.h>
+#include <protoPython/BlockingRegion.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <unistd.h>
+#endif
+
+namespace protoPython {
+
+namespace {
+
+constexpr int kSpinTries = 64;
+
+/** Nanoseconds left until deadline (-1: none); 0 once it has passed. */
+int64_t remainingNs(int64_t deadline) {
+    if (deadline < 0) return -1;
+    return std::max<int64_t>(0, deadline - monotonicNs());
+}
+
+int64_t deadlineFor(int64_t timeoutNs) {
+    return timeoutNs < 0 ? -1 : monotonicNs() + timeoutNs;
+}
+
+} // anonymous namespace
+
+int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__)
+
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs) {
+    timespec ts{};
+    timespec* tsp = nullptr;
+    if (timeoutNs >= 0) {
+        ts.tv_sec = static_cast<time_t>(timeoutNs / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeoutNs % 1000000000);
+        tsp = &ts;
+    }
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+#else
+
+// No futex: poll the word with a short sleep. Waits still honour the deadline.
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs) {
+    const int64_t slice = 200000;  // 200 µs
+    const int64_t nap = timeoutNs < 0 ? slice : std::min(timeoutNs, slice);
+    if (word.load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nap));
+}
+
+void futexWake(std::atomic<uint32_t>&, int) {}
+
+#endif
+
+void futexWakeAll(std::atomic<uint32_t>& word) {
+    futexWake(word, INT_MAX);
+}
+
+uintptr_t currentThreadToken() {
+    static thread_local char token;
+    return reinterpret_cast<uintptr_t>(&token);
+}
+
+// --- Asymmetric fences and OwnerBias ---
+
+namespace {
+
+bool registerAsymmetricFences() {
+#if defined(__linux__) && defined(SYS_membarrier)
+    const long cmds = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+    if (cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) return false;
+    return syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+} // anonymous namespace
+
+const bool g_asymmetricFences = registerAsymmetricFences();
+
+void heavyBarrier() {
+#if defined(__linux__) && defined(SYS_membarrier)
+    if (g_asymmetricFences && syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) == 0) return;
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void OwnerBias::revoke(proto::ProtoSpace* space) {
+    // Dekker with the owner's enter(): it stores busy_ then reads owner_, we store owner_
+    // then read busy_; heavyBarrier() orders both sides, so either the owner sees the
+    // revocation or we see it busy and wait for its leave().
+    owner_.store(0, std::memory_order_relaxed);
+    heavyBarrier();
+    if (busy_.load(std::memory_order_acquire) == 0) return;
+    BlockingRegion blocking(space);
+    while (busy_.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+}
+
+// --- FutexMutex (three-state mutex, Drepper, "Futexes Are Tricky") ---
+
+bool FutexMutex::lockSlow(proto::ProtoSpace* space, int64_t timeoutNs) {
+    for (int i = 0; i < kSpinTries; ++i) {
+        if (state_.load(std::memory_order_relaxed) == 0 && tryLock()) return true;
+    }
+    uint32_t c = state_.exchange(2, std::memory_order_acquire);
+    if (c == 0) return true;
+    if (timeoutNs == 0) return false;
+    const int64_t deadline = deadlineFor(timeoutNs);
+    BlockingRegion blocking(space);
+    while (c != 0) {
+        const int64_t left = remainingNs(deadline);
+        if (left == 0) return false;
+        futexWait(state_, 2, left);
+        c = state_.exchange(2, std::memory_order_acquire);
+    }
+    return true;
+}
+
+// --- FutexRecursiveMutex ---
+
+bool FutexRecursiveMutex::tryLock() {
+    const uintptr_t me = currentThreadToken();
+    if (owner_.load(std::memory_order_relaxed) == me) {
+        ++depth_;
+        return true;
+    }
+    if (!mutex_.tryLock()) return false;
+    owner_.store(me, std::memory_order_relaxed);
+    depth_ = 1;
+    return true;
+}
+
+bool FutexRecursiveMutex::lock(proto::ProtoSpace* space, int64_t timeoutNs) {
+    const uintptr_t me = currentThreadToken();
+    if (owner_.load(std::memory_order_relaxed) == me) {
+        ++depth_;
+        return true;
+    }
+    if (!mutex_.lock(space, timeoutNs)) return false;
+    owner_.store(me, std::memory_order_relaxed);
+    depth_ = 1;
+    return true;
+}
+
+bool FutexRecursiveMutex::unlock() {
+    if (!isOwned()) return false;
+    if (--depth_ == 0) {
+        owner_.store(0, std::memory_order_relaxed);
+        mutex_.unlock();
+    }
+    return true;
+}
+
+uint32_t FutexRecursiveMutex::releaseAll() {
+    if (!isOwned()) return 0;
+    const uint32_t depth = depth_;
+    depth_ = 0;
+    owner_.store(0, std::memory_order_relaxed);
+    mutex_.unlock();
+    return depth;
+}
+
+bool FutexRecursiveMutex::restore(proto::ProtoSpace* space, uint32_t depth, int64_t timeoutNs) {
+    if (!mutex_.lock(space, timeoutNs)) return false;
+    owner_.store(currentThreadToken(), std::memory_order_relaxed);
+    depth_ = depth;
+    return true;
+}
+
+// --- FutexSemaphore ---
+
+bool FutexSemaphore::acquireSlow(proto::ProtoSpace* space, int64_t timeoutNs) {
+    if (timeoutNs == 0) return false;
+    const int64_t deadline = deadlineFor(timeoutNs);
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    bool acquired = false;
+    {
+        BlockingRegion blocking(space);
+        for (;;) {
+            if (tryAcquire()) {
+                acquired = true;
+                break;
+            }
+            const int64_t left = remainingNs(deadline);
+            if (left == 0) break;
+            futexWait(value_, 0, left);
+        }
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return acquired;
+}
+
+bool FutexSemaphore::release(uint32_t n, uint32_t limit) {
+    uint32_t v = value_.load(std::memory_order_relaxed);
+    do {
+        if (v > limit || n > limit - v) return false;
+    } while (!value_.compare_exchange_weak(v, v + n, std::memory_order_seq_cst, std::memory_order_relaxed));
+    if (waiters_.load(std::memory_order_seq_cst) != 0) futexWake(value_, static_cast<int>(std::min<uint32_t>(n, INT_MAX)));
+    return true;
+}
+
+// --- FutexEvent ---
+
+void FutexEvent::set() {
+    if (state_.exchange(1, std::memory_order_seq_cst) == 0 && waiters_.load(std::memory_order_seq_cst) != 0)
+        futexWakeAll(state_);
+}
+
+bool FutexEvent::wait(proto::ProtoSpace* space, int64_t timeoutNs) {
+    if (isSet()) return true;
+    if (timeoutNs == 0) return false;
+    const int64_t deadline = deadlineFor(timeoutNs);
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    bool set = false;
+    {
+        BlockingRegion blocking(space);
+        for (;;) {
+            if (state_.load(std::memory_order_seq_cst) != 0) {
+                set = true;
+                break;
+            }
+            const int64_t left = remainingNs(deadline);
+            if (left == 0) break;
+            futexWait(state_, 0, left);
+        }
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return set;
+}
+
+// --- FutexCondition ---
+
+bool FutexCondition::waitFrom(proto::ProtoSpace* space, uint32_t seen, int64_t timeoutNs) {
+    const int64_t deadline = deadlineFor(timeoutNs);
+    bool notified = false;
+    {
+        BlockingRegion blocking(space);
+        for (;;) {
+            if (seq_.load(std::memory_order_acquire) != seen) {
+                notified = true;
+                break;
+            }
+            const int64_t left = remainingNs(deadline);
+            if (left == 0) break;
+            futexWait(seq_, seen, left);
+        }
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return notified;
+}
+
+void FutexCondition::notify(int n) {
+    if (n <= 0 || waiters_.load(std::memory_order_seq_cst) == 0) return;
+    seq_.fetch_add(1, std::memory_order_seq_cst);
+    futexWake(seq_, n);
+}
+
+void FutexCondition::notifyAll() {
+    if (waiters_.load(std::memory_order_seq_cst) == 0) return;
+    seq_.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(seq_);
+}
+
+// --- FutexBarrier ---
+
+void FutexBarrier::breakLocked() {
+    broken_ = true;
+    brokenPhase_ = phase_.load(std::memory_order_relaxed);
+    count_ = 0;
+    phase_.fetch_add(1, std::memory_order_release);
+    futexWakeAll(phase_);
+}
+
+FutexBarrier::Result FutexBarrier::arrive(proto::ProtoSpace* space, int64_t timeoutNs, uint32_t& index) {
+    const int64_t deadline = deadlineFor(timeoutNs);
+    const auto sleepWhile = [&](uint32_t seen) {
+        BlockingRegion blocking(space);
+        while (phase_.load(std::memory_order_acquire) == seen) {
+            const int64_t left = remainingNs(deadline);
+            if (left == 0) return;
+            futexWait(phase_, seen, left);
+        }
+    };
+
+    lock_.lock(nullptr);
+    // The previous phase is still letting its threads out: wait for it to finish.
+    while (!broken_ && count_ >= parties_) {
+        const uint32_t seen = phase_.load(std::memory_order_relaxed);
+        lock_.unlock();
+        sleepWhile(seen);
+        lock_.lock(nullptr);
+        if (remainingNs(deadline) == 0 && count_ >= parties_) {
+            breakLocked();
+            break;
+        }
+    }
+    if (broken_) {
+        lock_.unlock();
+        return Result::Broken;
+    }
+    index = count_++;
+    const uint32_t seen = phase_.load(std::memory_order_relaxed);
+    if (count_ == parties_) {
+        lastPhase_ = seen;
+        lock_.unlock();
+        return Result::Last;
+    }
+    lock_.unlock();
+
+    sleepWhile(seen);
+
+    lock_.lock(nullptr);
+    if (phase_.load(std::memory_order_relaxed) == seen) breakLocked();  // Timed out: break it for everyone.
+    const Result result = brokenPhase_ == seen ? Result::Broken : Result::Passed;
+    lock_.unlock();
+    return result;
+}
+
+bool FutexBarrier::complete(bool actionSucceeded) {
+    lock_.lock(nullptr);
+    if (phase_.load(std::memory_order_relaxed) != lastPhase_) {
+        lock_.unlock();
+        return false;
+    }
+    if (!actionSucceeded) {
+        breakLocked();
+        lock_.unlock();
+        return false;
+    }
+    count_ = 0;
+    phase_.fetch_add(1, std::memory_order_release);
+    futexWakeAll(phase_);
+    lock_.unlock();
+    return true;
+}
+
+void FutexBarrier::reset() {
+    lock_.lock(nullptr);
+    if (count_ > 0) breakLocked();
+    broken_ = false;
+    lock_.unlock();
+}
+
+void FutexBarrier::abort() {
+    lock_.lock(nullptr);
+    breakLocked();
+    lock_.unlock();
+}
+
+uint32_t FutexBarrier::waiting() {
+    lock_.lock(nullptr);
+    const uint32_t n = count_ >= parties_ ? 0 : count_;
+    lock_.unlock();
+    return n;
+}
+
+bool FutexBarrier::broken() {
+    lock_.lock(nullptr);
+    const bool b = broken_;
+    lock_.unlock();
+    return b;
+}
+
+} // namespace protoPython
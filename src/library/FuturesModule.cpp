@@ -0,0 +1,708 @@
+#include <protoPython/FuturesModule.h>
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/ListBuffer.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadingStrategy.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace protoPython {
+namespace futures_module {
+
+namespace {
+
+enum FutureStatus : int { kPending = 0, kRunning = 1, kFinished = 2, kCancelled = 3 };
+
+/** Native side of a Future; owned by the future object (external pointer under _state). */
+struct FutureState {
+    std::atomic<int> status{kPending};
+    std::mutex mutex;                  ///< Guards completion, callbacks and timed waits.
+    std::condition_variable cv;
+    const proto::ProtoObject* result{nullptr};      ///< Also stored as the future's _result.
+    const proto::ProtoObject* exception{nullptr};   ///< Also stored as the future's _exception.
+
+    bool done() const {
+        const int s = status.load(std::memory_order_acquire);
+        return s == kFinished || s == kCancelled;
+    }
+};
+
+/** Shared by an executor object and its queued jobs, so either may go first. */
+struct ExecutorState {
+    std::atomic<bool> shutdown{false};
+    std::atomic<uint32_t> pending{0};
+    int maxWorkers{0};
+};
+
+/**
+ * A submitted call. Until it has run only the scheduler's native queues refer to it, so
+ * fn, args and kwargs hang off the future (_fn, _args, _kwargs) and the future sits in
+ * a pending shard (see PendingShard); both are cleared when the job finishes.
+ */
+struct FutureJob : SchedulerJob {
+    std::shared_ptr<ExecutorState> executor;
+    FutureState* state{nullptr};
+    uint64_t id{0};                    ///< Key in its pending shard.
+    const proto::ProtoObject* future{nullptr};
+    const proto::ProtoObject* fn{nullptr};
+    const proto::ProtoList* args{nullptr};
+    const proto::ProtoSparseList* kwargs{nullptr};
+};
+
+const proto::ProtoObject* futureProt = nullptr;
+const proto::ProtoObject* executorProt = nullptr;
+const proto::ProtoSpace* protoSpace = nullptr;  ///< Space the prototypes and registry were built (and rooted) in.
+std::mutex s_protoMutex;
+
+/**
+ * Futures whose job has not finished, keyed by job id in a sparse list (_pending) on a
+ * holder rooted in the space. Consecutive ids go to different shards, so submitters and
+ * finishing workers rarely wait on the same mutex.
+ */
+struct PendingShard {
+    std::mutex mutex;
+    const proto::ProtoObject* holder{nullptr};
+    const proto::ProtoSparseList* futures{nullptr};
+};
+constexpr size_t kPendingShards = 16;
+PendingShard s_pending[kPendingShards];
+std::atomic<uint64_t> s_nextJobId{0};
+
+/** Interned with the prototypes and rooted. */
+const proto::ProtoString* s_pendingName = nullptr;
+const proto::ProtoString* s_fnName = nullptr;
+const proto::ProtoString* s_argsName = nullptr;
+const proto::ProtoString* s_kwargsName = nullptr;
+
+const proto::ProtoString* str(proto::ProtoContext* ctx, const char* s) {
+    return proto::ProtoString::fromUTF8String(ctx, s);
+}
+
+/** Hang job's inputs off its future and add the future to its pending shard. */
+void pinJob(proto::ProtoContext* ctx, FutureJob* job) {
+    job->future->setAttribute(ctx, s_fnName, job->fn);
+    job->future->setAttribute(ctx, s_argsName, job->args->asObject(ctx));
+    if (job->kwargs) job->future->setAttribute(ctx, s_kwargsName, job->kwargs->asObject(ctx));
+    job->id = s_nextJobId.fetch_add(1, std::memory_order_relaxed);
+    PendingShard& shard = s_pending[job->id % kPendingShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.futures = shard.futures->setAt(ctx, job->id, job->future);
+    shard.holder->setAttribute(ctx, s_pendingName, shard.futures->asObject(ctx));
+}
+
+/** Undo pinJob once the job has finished; the future may be collected afterwards. */
+void unpinJob(proto::ProtoContext* ctx, FutureJob* job) {
+    job->future->setAttribute(ctx, s_fnName, PROTO_NONE);
+    job->future->setAttribute(ctx, s_argsName, PROTO_NONE);
+    if (job->kwargs) job->future->setAttribute(ctx, s_kwargsName, PROTO_NONE);
+    PendingShard& shard = s_pending[job->id % kPendingShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.futures = shard.futures->removeAt(ctx, job->id);
+    shard.holder->setAttribute(ctx, s_pendingName, shard.futures->asObject(ctx));
+}
+
+void future_state_finalizer(void* ptr) {
+    delete static_cast<FutureState*>(ptr);
+}
+
+void executor_state_finalizer(void* ptr) {
+    delete static_cast<std::shared_ptr<ExecutorState>*>(ptr);
+}
+
+FutureState* futureOf(proto::ProtoContext* ctx, const proto::ProtoObject* self) {
+    const proto::ProtoObject* handle = self ? self->getAttribute(ctx, str(ctx, "_state")) : nullptr;
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<FutureState*>(ext->getPointer(ctx)) : nullptr;
+}
+
+std::shared_ptr<ExecutorState> executorOf(proto::ProtoContext* ctx, const proto::ProtoObject* self) {
+    const proto::ProtoObject* handle = self ? self->getAttribute(ctx, str(ctx, "_state")) : nullptr;
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    auto* box = ext ? static_cast<std::shared_ptr<ExecutorState>*>(ext->getPointer(ctx)) : nullptr;
+    return box ? *box : nullptr;
+}
+
+const proto::ProtoObject* kwarg(proto::ProtoContext* ctx, const proto::ProtoSparseList* kwargs, const char* name) {
+    if (!kwargs) return nullptr;
+    const unsigned long key = str(ctx, name)->getHash(ctx);
+    return kwargs->has(ctx, key) ? kwargs->getAt(ctx, key) : nullptr;
+}
+
+/** Positional argument i, else keyword name, else nullptr. */
+const proto::ProtoObject* argOrKwarg(proto::ProtoContext* ctx, const proto::ProtoList* posArgs,
+                                     const proto::ProtoSparseList* kwargs, unsigned long i, const char* name) {
+    if (posArgs && posArgs->getSize(ctx) > i) return posArgs->getAt(ctx, static_cast<int>(i));
+    return kwarg(ctx, kwargs, name);
+}
+
+/** Seconds as a double; negative (wait forever) for None or a missing argument. */
+double timeoutOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!obj || obj == PROTO_NONE) return -1.0;
+    if (obj->isDouble(ctx)) return std::max(0.0, obj->asDouble(ctx));
+    if (obj->isInteger(ctx)) return std::max<double>(0.0, static_cast<double>(obj->asLong(ctx)));
+    return -1.0;
+}
+
+/** Block until pred() holds (a scheduler worker runs other jobs first); in a blocking region while blocked. */
+template<typename Pred>
+void waitUntil(proto::ProtoContext* ctx, std::atomic<uint32_t>& word, Pred pred) {
+    if (pred()) return;
+    if (WorkStealingScheduler* scheduler = WorkStealingScheduler::current())
+        scheduler->helpWhile([&] { return !pred(); });
+    if (pred()) return;
+    BlockingRegion blocking(ctx->space);
+    for (;;) {
+        const uint32_t seen = word.load(std::memory_order_acquire);
+        if (pred()) return;
+        word.wait(seen, std::memory_order_acquire);
+    }
+}
+
+/** Wait for a future; false on timeout. */
+bool waitFuture(proto::ProtoContext* ctx, FutureState* st, double timeout) {
+    if (st->done()) return true;
+    if (WorkStealingScheduler* scheduler = WorkStealingScheduler::current()) {
+        scheduler->helpWhile([st] { return !st->done(); });
+        if (st->done()) return true;
+    }
+    BlockingRegion blocking(ctx->space);
+    std::unique_lock<std::mutex> lock(st->mutex);
+    if (timeout < 0) {
+        st->cv.wait(lock, [st] { return st->done(); });
+        return true;
+    }
+    return st->cv.wait_for(lock, std::chrono::duration<double>(timeout), [st] { return st->done(); });
+}
+
+void runCallbacks(proto::ProtoContext* ctx, const proto::ProtoObject* future, const proto::ProtoObject* callbacks) {
+    const proto::ProtoList* list = callbacks ? callbacks->asList(ctx) : nullptr;
+    if (!list) return;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    for (unsigned long i = 0; i < list->getSize(ctx); ++i) {
+        try {
+            invokePythonCallable(ctx, list->getAt(ctx, static_cast<int>(i)), ctx->newList()->appendLast(ctx, future), nullptr);
+        } catch (const proto::ProtoObject*) {
+        }
+        // Like concurrent.futures, a failing callback does not affect the future or later callbacks.
+        if (env) env->clearPendingException();
+    }
+}
+
+/** Move st to a terminal status and run the callbacks registered so far. */
+void settle(proto::ProtoContext* ctx, const proto::ProtoObject* future, FutureState* st, int status,
+            const proto::ProtoObject* result, const proto::ProtoObject* exception) {
+    const proto::ProtoObject* callbacks = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(st->mutex);
+        st->result = result ? result : PROTO_NONE;
+        st->exception = exception;
+        if (exception) future->setAttribute(ctx, str(ctx, "_exception"), exception);
+        else future->setAttribute(ctx, str(ctx, "_result"), st->result);
+        callbacks = future->getAttribute(ctx, str(ctx, "_callbacks"));
+        future->setAttribute(ctx, str(ctx, "_callbacks"), PROTO_NONE);
+        st->status.store(status, std::memory_order_release);
+    }
+    st->cv.notify_all();
+    runCallbacks(ctx, future, callbacks);
+}
+
+/** Call fn(*args); returns the result, or nullptr with the raised exception in excOut. */
+const proto::ProtoObject* callCapturing(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* fn,
+                                        const proto::ProtoList* args, const proto::ProtoSparseList* kwargs,
+                                        const proto::ProtoObject*& excOut) {
+    const proto::ProtoObject* result = nullptr;
+    excOut = nullptr;
+    try {
+        result = invokePythonCallable(ctx, fn, args, kwargs);
+    } catch (const proto::ProtoObject* exc) {
+        excOut = exc;
+    }
+    if (!excOut && env && env->hasPendingException()) excOut = env->takePendingException();
+    return excOut ? nullptr : (result ? result : PROTO_NONE);
+}
+
+void runFutureJob(proto::ProtoContext* ctx, SchedulerJob* job) {
+    FutureJob* fj = static_cast<FutureJob*>(job);
+    FutureState* st = fj->state;
+    int expected = kPending;
+    if (st->status.compare_exchange_strong(expected, kRunning, std::memory_order_acq_rel)) {
+        PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+        const proto::ProtoObject* exc = nullptr;
+        const proto::ProtoObject* result = callCapturing(ctx, env, fj->fn, fj->args, fj->kwargs, exc);
+        settle(ctx, fj->future, st, kFinished, result, exc);
+    }
+    // st is not touched after this.
+    unpinJob(ctx, fj);
+    std::shared_ptr<ExecutorState> executor = std::move(fj->executor);
+    delete fj;
+    if (executor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) executor->pending.notify_all();
+}
+
+/** Items of iterable as a ProtoList (lists and tuples without copying elements), or nullptr with an exception pending. */
+const proto::ProtoList* itemsOf(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* iterable) {
+    if (!iterable || iterable == PROTO_NONE) {
+        env->raiseTypeError(ctx, "'NoneType' object is not iterable");
+        return nullptr;
+    }
+    if (const proto::ProtoList* list = iterable->asList(ctx)) return list;
+    const proto::ProtoObject* data = dataAttribute(ctx, iterable);
+    if (data && data->asList(ctx)) return data->asList(ctx);
+    const proto::ProtoList* items = ctx->newList();
+    if (const proto::ProtoTuple* tuple = iterable->asTuple(ctx)) {
+        for (unsigned long i = 0; i < tuple->getSize(ctx); ++i)
+            items = items->appendLast(ctx, tuple->getAt(ctx, static_cast<int>(i)));
+        return items;
+    }
+    const proto::ProtoObject* it = env->iter(iterable);
+    if (!it || env->hasPendingException()) return nullptr;
+    for (;;) {
+        const proto::ProtoObject* item = env->next(it);
+        if (!item) break;
+        items = items->appendLast(ctx, item);
+    }
+    return env->hasPendingException() ? nullptr : items;
+}
+
+// --- Chunked parallel map ---
+
+/**
+ * One parallel map call. Chunks are claimed from nextChunk by the caller and by up to
+ * one helper job per worker, so a slow chunk never holds up an idle thread. Each chunk
+ * writes its results (or its exception) to its own holder object.
+ */
+struct MapBatch {
+    const proto::ProtoObject* fn{nullptr};
+    const proto::ProtoList* items{nullptr};
+    bool spread{false};               ///< Each item is an argument list (executor.map over several iterables).
+    size_t count{0};
+    size_t chunk{1};
+    size_t chunks{0};
+    std::vector<const proto::ProtoObject*> holders;  ///< Allocated in the caller's context, which owns them.
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> failed{false};
+    std::atomic<uint32_t> helpersLeft{0};
+};
+
+struct MapHelperJob : SchedulerJob {
+    std::shared_ptr<MapBatch> batch;
+};
+
+void runChunks(proto::ProtoContext* ctx, MapBatch& batch) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoString* resultsName = str(ctx, "_results");
+    const proto::ProtoString* exceptionName = str(ctx, "_exception");
+    for (;;) {
+        const size_t c = batch.nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (c >= batch.chunks || batch.failed.load(std::memory_order_relaxed)) return;
+        const size_t lo = c * batch.chunk;
+        const size_t hi = std::min(batch.count, lo + batch.chunk);
+        const proto::ProtoList* out = ctx->newList();
+        for (size_t i = lo; i < hi; ++i) {
+            const proto::ProtoObject* item = batch.items->getAt(ctx, static_cast<int>(i));
+            const proto::ProtoList* args = batch.spread ? item->asList(ctx) : ctx->newList()->appendLast(ctx, item);
+            const proto::ProtoObject* exc = nullptr;
+            const proto::ProtoObject* result = callCapturing(ctx, env, batch.fn, args, nullptr, exc);
+            if (exc) {
+                batch.holders[c]->setAttribute(ctx, exceptionName, exc);
+                batch.failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            out = out->appendLast(ctx, result);
+        }
+        batch.holders[c]->setAttribute(ctx, resultsName, out->asObject(ctx));
+    }
+}
+
+void runMapHelper(proto::ProtoContext* ctx, SchedulerJob* job) {
+    MapHelperJob* helper = static_cast<MapHelperJob*>(job);
+    std::shared_ptr<MapBatch> batch = std::move(helper->batch);
+    delete helper;
+    runChunks(ctx, *batch);
+    if (batch->helpersLeft.fetch_sub(1, std::memory_order_acq_rel) == 1) batch->helpersLeft.notify_all();
+}
+
+/**
+ * fn applied to every item, in order, as a list. chunksize 0 picks about four chunks
+ * per thread. Returns nullptr with the first failing chunk's exception pending.
+ */
+const proto::ProtoObject* mapItems(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* fn,
+                                   const proto::ProtoList* items, bool spread, long chunksize, int maxHelpers) {
+    WorkStealingScheduler* scheduler = env->getScheduler(ctx);
+    const size_t threads = (scheduler ? scheduler->workerCount() : 0) + 1;
+    auto batch = std::make_shared<MapBatch>();
+    batch->fn = fn;
+    batch->items = items;
+    batch->spread = spread;
+    batch->count = items->getSize(ctx);
+    if (batch->count == 0) return ctx->newList()->asObject(ctx);
+    batch->chunk = chunksize > 0 ? static_cast<size_t>(chunksize)
+                                 : std::max<size_t>(1, (batch->count + threads * 4 - 1) / (threads * 4));
+    batch->chunks = (batch->count + batch->chunk - 1) / batch->chunk;
+    batch->holders.reserve(batch->chunks);
+    for (size_t c = 0; c < batch->chunks; ++c) batch->holders.push_back(ctx->newObject(true));
+
+    size_t helpers = scheduler ? std::min(scheduler->workerCount(), batch->chunks - 1) : 0;
+    if (maxHelpers > 0) helpers = std::min(helpers, static_cast<size_t>(maxHelpers));
+    batch->helpersLeft.store(static_cast<uint32_t>(helpers), std::memory_order_relaxed);
+    for (size_t h = 0; h < helpers; ++h) {
+        MapHelperJob* job = new MapHelperJob();
+        job->run = runMapHelper;
+        job->batch = batch;
+        scheduler->submit(job);
+    }
+    runChunks(ctx, *batch);
+    waitUntil(ctx, batch->helpersLeft, [&] { return batch->helpersLeft.load(std::memory_order_acquire) == 0; });
+
+    const proto::ProtoString* resultsName = str(ctx, "_results");
+    const proto::ProtoString* exceptionName = str(ctx, "_exception");
+    const proto::ProtoList* out = ctx->newList();
+    for (const proto::ProtoObject* holder : batch->holders) {
+        const proto::ProtoObject* exc = holder->getAttribute(ctx, exceptionName);
+        if (exc && exc != PROTO_NONE) {
+            env->setPendingException(exc);
+            return nullptr;
+        }
+        const proto::ProtoObject* results = holder->getAttribute(ctx, resultsName);
+        const proto::ProtoList* list = results ? results->asList(ctx) : nullptr;
+        if (!list) continue;  // Skipped after another chunk failed; that failure is raised above.
+        for (unsigned long i = 0; i < list->getSize(ctx); ++i)
+            out = out->appendLast(ctx, list->getAt(ctx, static_cast<int>(i)));
+    }
+    return out->asObject(ctx);
+}
+
+long chunksizeOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj, long fallback) {
+    if (!obj || obj == PROTO_NONE || !obj->isInteger(ctx)) return fallback;
+    return static_cast<long>(obj->asLong(ctx));
+}
+
+// --- Future ---
+
+const proto::ProtoObject* newFuture(proto::ProtoContext* ctx, FutureState*& stateOut) {
+    const proto::ProtoObject* obj = ctx->newObject(true);
+    if (futureProt) obj = obj->addParent(ctx, futureProt);
+    FutureState* st = new FutureState();
+    obj = obj->setAttribute(ctx, str(ctx, "_state"), ctx->fromExternalPointer(st, future_state_finalizer));
+    obj = obj->setAttribute(ctx, str(ctx, "_callbacks"), PROTO_NONE);
+    if (futureProt) obj = obj->setAttribute(ctx, str(ctx, "__class__"), futureProt);
+    stateOut = st;
+    return obj;
+}
+
+const proto::ProtoObject* py_future_result(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    FutureState* st = futureOf(ctx, self);
+    if (!env || !st) return PROTO_NONE;
+    if (!waitFuture(ctx, st, timeoutOf(ctx, argOrKwarg(ctx, posArgs, kwargs, 0, "timeout")))) {
+        env->raiseRuntimeError(ctx, "timed out waiting for future");
+        return PROTO_NONE;
+    }
+    if (st->status.load(std::memory_order_acquire) == kCancelled) {
+        env->raiseRuntimeError(ctx, "future was cancelled");
+        return PROTO_NONE;
+    }
+    if (st->exception) {
+        env->setPendingException(st->exception);
+        return PROTO_NONE;
+    }
+    return st->result;
+}
+
+const proto::ProtoObject* py_future_exception(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    FutureState* st = futureOf(ctx, self);
+    if (!env || !st) return PROTO_NONE;
+    if (!waitFuture(ctx, st, timeoutOf(ctx, argOrKwarg(ctx, posArgs, kwargs, 0, "timeout")))) {
+        env->raiseRuntimeError(ctx, "timed out waiting for future");
+        return PROTO_NONE;
+    }
+    if (st->status.load(std::memory_order_acquire) == kCancelled) {
+        env->raiseRuntimeError(ctx, "future was cancelled");
+        return PROTO_NONE;
+    }
+    return st->exception ? st->exception : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_future_done(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    FutureState* st = futureOf(ctx, self);
+    return st && st->done() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_future_running(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    FutureState* st = futureOf(ctx, self);
+    return st && st->status.load(std::memory_order_acquire) == kRunning ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_future_cancelled(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    FutureState* st = futureOf(ctx, self);
+    return st && st->status.load(std::memory_order_acquire) == kCancelled ? PROTO_TRUE : PROTO_FALSE;
+}
+
+/** Cancel a call that has not started; its job still runs later and only releases the future. */
+const proto::ProtoObject* py_future_cancel(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    FutureState* st = futureOf(ctx, self);
+    if (!st) return PROTO_FALSE;
+    if (st->status.load(std::memory_order_acquire) == kCancelled) return PROTO_TRUE;
+    // Claim the future like a starting job would, so the two cannot both settle it.
+    int expected = kPending;
+    if (!st->status.compare_exchange_strong(expected, kRunning, std::memory_order_acq_rel)) return PROTO_FALSE;
+    settle(ctx, self, st, kCancelled, PROTO_NONE, nullptr);
+    return PROTO_TRUE;
+}
+
+const proto::ProtoObject* py_future_add_done_callback(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    FutureState* st = futureOf(ctx, self);
+    if (!st || !posArgs || posArgs->getSize(ctx) < 1) return PROTO_NONE;
+    const proto::ProtoObject* fn = posArgs->getAt(ctx, 0);
+    {
+        std::lock_guard<std::mutex> lock(st->mutex);
+        if (!st->done()) {
+            const proto::ProtoObject* current = self->getAttribute(ctx, str(ctx, "_callbacks"));
+            const proto::ProtoList* list = current && current->asList(ctx) ? current->asList(ctx) : ctx->newList();
+            self->setAttribute(ctx, str(ctx, "_callbacks"), list->appendLast(ctx, fn)->asObject(ctx));
+            return PROTO_NONE;
+        }
+    }
+    runCallbacks(ctx, self, ctx->newList()->appendLast(ctx, fn)->asObject(ctx));
+    return PROTO_NONE;
+}
+
+// --- ThreadPoolExecutor ---
+
+const proto::ProtoObject* py_executor_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* maxObj = argOrKwarg(ctx, posArgs, kwargs, 0, "max_workers");
+    auto state = std::make_shared<ExecutorState>();
+    if (maxObj && maxObj != PROTO_NONE) {
+        if (!maxObj->isInteger(ctx) || maxObj->asLong(ctx) <= 0) {
+            if (env) env->raiseValueError(ctx, ctx->fromUTF8String("max_workers must be greater than 0"));
+            return PROTO_NONE;
+        }
+        state->maxWorkers = static_cast<int>(maxObj->asLong(ctx));
+    }
+    const proto::ProtoObject* obj = self->newChild(ctx, true);
+    obj = obj->setAttribute(ctx, str(ctx, "__class__"), self);
+    obj = obj->setAttribute(ctx, str(ctx, "_max_workers"),
+        ctx->fromInteger(state->maxWorkers > 0 ? state->maxWorkers : getWorkerCount()));
+    obj = obj->setAttribute(ctx, str(ctx, "_state"),
+        ctx->fromExternalPointer(new std::shared_ptr<ExecutorState>(std::move(state)), executor_state_finalizer));
+    return obj;
+}
+
+const proto::ProtoObject* py_executor_submit(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    std::shared_ptr<ExecutorState> executor = executorOf(ctx, self);
+    if (!env || !executor) return PROTO_NONE;
+    if (!posArgs || posArgs->getSize(ctx) < 1) {
+        env->raiseTypeError(ctx, "submit() missing required argument 'fn'");
+        return PROTO_NONE;
+    }
+    if (executor->shutdown.load(std::memory_order_acquire)) {
+        env->raiseRuntimeError(ctx, "cannot schedule new futures after shutdown");
+        return PROTO_NONE;
+    }
+    const proto::ProtoList* args = ctx->newList();
+    for (unsigned long i = 1; i < posArgs->getSize(ctx); ++i)
+        args = args->appendLast(ctx, posArgs->getAt(ctx, static_cast<int>(i)));
+
+    FutureState* st = nullptr;
+    const proto::ProtoObject* future = newFuture(ctx, st);
+
+    FutureJob* job = new FutureJob();
+    job->run = runFutureJob;
+    job->executor = executor;
+    job->state = st;
+    job->future = future;
+    job->fn = posArgs->getAt(ctx, 0);
+    job->args = args;
+    job->kwargs = kwargs;
+    pinJob(ctx, job);
+    executor->pending.fetch_add(1, std::memory_order_acq_rel);
+
+    if (WorkStealingScheduler* scheduler = env->getScheduler(ctx)) scheduler->submit(job);
+    else runFutureJob(ctx, job);  // No workers: run inline, the future is already done.
+    return future;
+}
+
+const proto::ProtoObject* py_executor_map(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    std::shared_ptr<ExecutorState> executor = executorOf(ctx, self);
+    if (!env || !executor) return PROTO_NONE;
+    if (!posArgs || posArgs->getSize(ctx) < 2) {
+        env->raiseTypeError(ctx, "map() requires a function and at least one iterable");
+        return PROTO_NONE;
+    }
+    if (executor->shutdown.load(std::memory_order_acquire)) {
+        env->raiseRuntimeError(ctx, "cannot schedule new futures after shutdown");
+        return PROTO_NONE;
+    }
+    const proto::ProtoObject* fn = posArgs->getAt(ctx, 0);
+    const long chunksize = chunksizeOf(ctx, kwarg(ctx, kwargs, "chunksize"), 1);
+    const int helpers = executor->maxWorkers > 0 ? executor->maxWorkers - 1 : 0;
+    if (posArgs->getSize(ctx) == 2) {
+        const proto::ProtoList* items = itemsOf(ctx, env, posArgs->getAt(ctx, 1));
+        return items ? mapItems(ctx, env, fn, items, false, chunksize, helpers) : PROTO_NONE;
+    }
+    // Several iterables: zip them into one argument list per call, stopping at the shortest.
+    std::vector<const proto::ProtoList*> columns;
+    size_t count = static_cast<size_t>(-1);
+    for (unsigned long i = 1; i < posArgs->getSize(ctx); ++i) {
+        const proto::ProtoList* items = itemsOf(ctx, env, posArgs->getAt(ctx, static_cast<int>(i)));
+        if (!items) return PROTO_NONE;
+        columns.push_back(items);
+        count = std::min<size_t>(count, items->getSize(ctx));
+    }
+    const proto::ProtoList* rows = ctx->newList();
+    for (size_t r = 0; r < count; ++r) {
+        const proto::ProtoList* row = ctx->newList();
+        for (const proto::ProtoList* column : columns) row = row->appendLast(ctx, column->getAt(ctx, static_cast<int>(r)));
+        rows = rows->appendLast(ctx, row->asObject(ctx));
+    }
+    return mapItems(ctx, env, fn, rows, true, chunksize, helpers);
+}
+
+const proto::ProtoObject* py_executor_shutdown(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    std::shared_ptr<ExecutorState> executor = executorOf(ctx, self);
+    if (!executor) return PROTO_NONE;
+    executor->shutdown.store(true, std::memory_order_release);
+    const proto::ProtoObject* wait = argOrKwarg(ctx, posArgs, kwargs, 0, "wait");
+    if (wait == PROTO_FALSE) return PROTO_NONE;
+    waitUntil(ctx, executor->pending, [&] { return executor->pending.load(std::memory_order_acquire) == 0; });
+    return PROTO_NONE;
+}
+
+const proto::ProtoObject* py_executor_enter(
+    proto::ProtoContext*, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return self;
+}
+
+const proto::ProtoObject* py_executor_exit(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    py_executor_shutdown(ctx, self, parentLink, ctx->newList(), nullptr);
+    return PROTO_FALSE;
+}
+
+// --- Module functions ---
+
+const proto::ProtoObject* py_parallel_map(
+    proto::ProtoContext* ctx, const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env) return PROTO_NONE;
+    if (!posArgs || posArgs->getSize(ctx) < 2) {
+        env->raiseTypeError(ctx, "parallel_map(func, iterable, chunksize=0)");
+        return PROTO_NONE;
+    }
+    const long chunksize = chunksizeOf(ctx, argOrKwarg(ctx, posArgs, kwargs, 2, "chunksize"), 0);
+    const proto::ProtoList* items = itemsOf(ctx, env, posArgs->getAt(ctx, 1));
+    if (!items) return PROTO_NONE;
+    const proto::ProtoObject* result = mapItems(ctx, env, posArgs->getAt(ctx, 0), items, false, chunksize, 0);
+    return result ? result : PROTO_NONE;
+}
+
+const proto::ProtoObject* py_worker_count(
+    proto::ProtoContext* ctx, const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    WorkStealingScheduler* scheduler = env ? env->getScheduler(ctx) : nullptr;
+    return ctx->fromInteger(scheduler ? static_cast<long long>(scheduler->workerCount()) : 0);
+}
+
+void ensurePrototypes(proto::ProtoContext* ctx) {
+    std::lock_guard<std::mutex> guard(s_protoMutex);
+    if (protoSpace == ctx->space) return;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+
+    const proto::ProtoObject* f = ctx->newObject(true);
+    if (env && env->getObjectPrototype()) f = f->addParent(ctx, env->getObjectPrototype());
+    f = f->setAttribute(ctx, str(ctx, "__name__"), ctx->fromUTF8String("Future"));
+    f = f->setAttribute(ctx, str(ctx, "result"), ctx->fromMethod(nullptr, py_future_result));
+    f = f->setAttribute(ctx, str(ctx, "exception"), ctx->fromMethod(nullptr, py_future_exception));
+    f = f->setAttribute(ctx, str(ctx, "done"), ctx->fromMethod(nullptr, py_future_done));
+    f = f->setAttribute(ctx, str(ctx, "running"), ctx->fromMethod(nullptr, py_future_running));
+    f = f->setAttribute(ctx, str(ctx, "cancelled"), ctx->fromMethod(nullptr, py_future_cancelled));
+    f = f->setAttribute(ctx, str(ctx, "cancel"), ctx->fromMethod(nullptr, py_future_cancel));
+    f = f->setAttribute(ctx, str(ctx, "add_done_callback"), ctx->fromMethod(nullptr, py_future_add_done_callback));
+
+    const proto::ProtoObject* e = ctx->newObject(true);
+    if (env && env->getObjectPrototype()) e = e->addParent(ctx, env->getObjectPrototype());
+    if (env && env->getTypePrototype()) e = e->setAttribute(ctx, str(ctx, "__class__"), env->getTypePrototype());
+    e = e->setAttribute(ctx, str(ctx, "__name__"), ctx->fromUTF8String("ThreadPoolExecutor"));
+    e = e->setAttribute(ctx, str(ctx, "__call__"), ctx->fromMethod(nullptr, py_executor_new));
+    e = e->setAttribute(ctx, str(ctx, "submit"), ctx->fromMethod(nullptr, py_executor_submit));
+    e = e->setAttribute(ctx, str(ctx, "map"), ctx->fromMethod(nullptr, py_executor_map));
+    e = e->setAttribute(ctx, str(ctx, "shutdown"), ctx->fromMethod(nullptr, py_executor_shutdown));
+    e = e->setAttribute(ctx, str(ctx, "__enter__"), ctx->fromMethod(nullptr, py_executor_enter));
+    e = e->setAttribute(ctx, str(ctx, "__exit__"), ctx->fromMethod(nullptr, py_executor_exit));
+
+    futureProt = f;
+    executorProt = e;
+    s_pendingName = str(ctx, "_pending");
+    s_fnName = str(ctx, "_fn");
+    s_argsName = str(ctx, "_args");
+    s_kwargsName = str(ctx, "_kwargs");
+    for (PendingShard& shard : s_pending) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.futures = ctx->newSparseList();
+        shard.holder = ctx->newObject(true);
+        shard.holder->setAttribute(ctx, s_pendingName, shard.futures->asObject(ctx));
+    }
+    protoSpace = ctx->space;
+    std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+    ctx->space->moduleRoots.push_back(futureProt);
+    ctx->space->moduleRoots.push_back(executorProt);
+    for (const proto::ProtoString* name : {s_pendingName, s_fnName, s_argsName, s_kwargsName})
+        ctx->space->moduleRoots.push_back(name->asObject(ctx));
+    for (const PendingShard& shard : s_pending) ctx->space->moduleRoots.push_back(shard.holder);
+}
+
+} // anonymous namespace
+
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx) {
+    ensurePrototypes(ctx);
+    const proto::ProtoObject* mod = ctx->newObject(true);
+    mod = mod->setAttribute(ctx, str(ctx, "Future"), futureProt);
+    mod = mod->setAttribute(ctx, str(ctx, "ThreadPoolExecutor"), executorProt);
+    mod = mod->setAttribute(ctx, str(ctx, "parallel_map"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_parallel_map));
+    mod = mod->setAttribute(ctx, str(ctx, "worker_count"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_worker_count));
+    return mod;
+}
+
+} // namespace futures_module
+} // namespace protoPython
@@ -0,0 +1,344 @@
+#include <protoPython/InlineCache.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <proto_internal.h>
+#include <cstdint>
+
+namespace protoPython {
+
+namespace {
+
+/** Attribute tables are keyed by the interned name pointer (see getOwnAttributes iteration). */
+unsigned long nameKey(const proto::ProtoString* name) {
+    return reinterpret_cast<unsigned long>(name);
+}
+
+bool isEmbeddedValue(const proto::ProtoObject* obj) {
+    return (reinterpret_cast<uintptr_t>(obj) & 0x3FUL) == POINTER_TAG_EMBEDDED_VALUE;
+}
+
+bool isCacheableReceiver(const proto::ProtoObject* obj) {
+    return obj && obj != PROTO_NONE && !isEmbeddedValue(obj);
+}
+
+/** The receiver's only parent (nullptr if it has none). False for multiple parents. */
+bool receiverType(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const proto::ProtoObject*& type) {
+    const proto::ProtoList* parents = obj->getParents(ctx);
+    unsigned long n = parents ? parents->getSize(ctx) : 0;
+    if (n > 1) return false;
+    type = n ? parents->getAt(ctx, 0) : nullptr;
+    return true;
+}
+
+bool isPresent(const proto::ProtoObject* v) {
+    return v && v != PROTO_NONE;
+}
+
+/** Mirrors PythonEnvironment::getAttribute: methods are not bound to modules. */
+bool ownModuleMarker(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoSparseList* own) {
+    if (!own) return false;
+    unsigned long fileKey = nameKey(env->getFileDunderString());
+    unsigned long pathKey = nameKey(env->getPathDunderString());
+    return (own->has(ctx, fileKey) && isPresent(own->getAt(ctx, fileKey))) ||
+           (own->has(ctx, pathKey) && isPresent(own->getAt(ctx, pathKey)));
+}
+
+/**
+ * Work out how name resolves on obj using protoCore lookups only (no Python code
+ * runs, so this is safe under the fill lock). Each answer is checked against
+ * obj->getAttribute so a cached entry never disagrees with the generic path.
+ */
+bool analyzeLoad(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* obj,
+                 const proto::ProtoString* name, AttrCacheEntry& e) {
+    if (!receiverType(ctx, obj, e.type) || !e.typeChain.capture(ctx, e.type)) return false;
+    unsigned long key = nameKey(name);
+    const proto::ProtoObject* generic = obj->getAttribute(ctx, name);
+    const proto::ProtoSparseList* own = obj->getOwnAttributes(ctx);
+    if (own && own->has(ctx, key)) {
+        if (own->getAt(ctx, key) != generic) return false;
+        e.kind = AttrCacheKind::Own;
+        return true;
+    }
+
+    bool found = false;
+    const proto::ProtoObject* v = e.typeChain.lookup(ctx, key, found);
+    if (!found || !v || v != generic) return false;
+    e.value = v;
+    if (v == PROTO_NONE || !v->isCell(ctx)) {
+        e.kind = AttrCacheKind::Plain;
+        return true;
+    }
+    if (v->isMethod(ctx)) {
+        bool fileFound = false, pathFound = false;
+        const proto::ProtoObject* file = e.typeChain.lookup(ctx, nameKey(env->getFileDunderString()), fileFound);
+        const proto::ProtoObject* path = e.typeChain.lookup(ctx, nameKey(env->getPathDunderString()), pathFound);
+        if (ownModuleMarker(ctx, env, own) || (fileFound && isPresent(file)) || (pathFound && isPresent(path)))
+            return false;
+        e.kind = AttrCacheKind::Method;
+        return true;
+    }
+
+    if (!e.valueChain.capture(ctx, v)) return false;
+    bool getFound = false;
+    const proto::ProtoObject* getM = e.valueChain.lookup(ctx, nameKey(env->getGetDunderString()), getFound);
+    if (!getFound) getM = nullptr;
+    if (getM != v->getAttribute(ctx, env->getGetDunderString())) return false;
+    if (isPresent(getM) && getM->asMethod(ctx)) {
+        bool classFound = false;
+        const proto::ProtoObject* cls = e.typeChain.lookup(ctx, nameKey(env->getClassString()), classFound);
+        e.kind = AttrCacheKind::Descriptor;
+        e.getter = getM;
+        e.classValue = classFound ? cls : nullptr;
+        return true;
+    }
+    e.kind = AttrCacheKind::Plain;
+    return true;
+}
+
+/** A store is cacheable when the chain holds no cell under name, hence no data descriptor. */
+bool analyzeStore(proto::ProtoContext* ctx, const proto::ProtoObject* obj,
+                  const proto::ProtoString* name, AttrCacheEntry& e) {
+    if (!receiverType(ctx, obj, e.type) || !e.typeChain.capture(ctx, e.type)) return false;
+    bool found = false;
+    const proto::ProtoObject* v = e.typeChain.lookup(ctx, nameKey(name), found);
+    if (found && isPresent(v) && v->isCell(ctx)) return false;
+    if (obj->hasOwnAttribute(ctx, name) == PROTO_FALSE) {
+        const proto::ProtoObject* generic = obj->getAttribute(ctx, name);
+        if (found ? generic != v : isPresent(generic)) return false;
+    }
+    e.kind = AttrCacheKind::Store;
+    return true;
+}
+
+} // namespace
+
+bool ProtoChainGuard::capture(proto::ProtoContext* ctx, const proto::ProtoObject* first) {
+    depth = 0;
+    for (const proto::ProtoObject* cur = first; cur; ) {
+        if (depth == kMaxDepth || !isCacheableReceiver(cur)) return false;
+        const proto::ProtoList* ps = cur->getParents(ctx);
+        unsigned long n = ps ? ps->getSize(ctx) : 0;
+        if (n > 1) return false;
+        objects[depth] = cur;
+        parents[depth] = ps;
+        attrs[depth] = cur->getOwnAttributes(ctx);
+        ++depth;
+        cur = n ? ps->getAt(ctx, 0) : nullptr;
+    }
+    return true;
+}
+
+bool ProtoChainGuard::matches(proto::ProtoContext* ctx, const proto::ProtoObject* first) const {
+    if (depth == 0) return first == nullptr;
+    if (first != objects[0]) return false;
+    // Equal parents lists imply the next level is objects[k + 1].
+    for (int k = 0; k < depth; ++k) {
+        if (objects[k]->getParents(ctx) != parents[k] || objects[k]->getOwnAttributes(ctx) != attrs[k])
+            return false;
+    }
+    return true;
+}
+
+const proto::ProtoObject* ProtoChainGuard::lookup(proto::ProtoContext* ctx, unsigned long key, bool& found) const {
+    for (int k = 0; k < depth; ++k) {
+        if (attrs[k] && attrs[k]->has(ctx, key)) {
+            found = true;
+            return attrs[k]->getAt(ctx, key);
+        }
+    }
+    found = false;
+    return nullptr;
+}
+
+InlineCacheTable::InlineCacheTable(const proto::ProtoObject* owner, size_t attrSites, size_t globalSites)
+    : owner_(owner), attrSites_(new AttrCacheSite[attrSites]), attrSiteCount_(attrSites),
+      globalSites_(new GlobalCacheSite[globalSites]), globalSiteCount_(globalSites) {}
+
+InlineCacheTable::~InlineCacheTable() {
+    for (size_t i = 0; i < attrSiteCount_; ++i)
+        delete attrSites_[i].state.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < globalSiteCount_; ++i)
+        delete globalSites_[i].state.load(std::memory_order_relaxed);
+    for (const AttrCacheState* s : retired_) delete s;
+    for (const GlobalCacheState* s : retiredGlobals_) delete s;
+}
+
+bool InlineCacheTable::loadAttr(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+    const proto::ProtoObject* obj, const proto::ProtoString* name, const proto::ProtoObject*& out) {
+    if (!env || site < 0 || static_cast<size_t>(site) >= attrSiteCount_ || !isCacheableReceiver(obj)) return false;
+    const AttrCacheState* st = attrSites_[site].state.load(std::memory_order_acquire);
+    if (st && st->megamorphic) return false;
+    const proto::ProtoObject* type = nullptr;
+    if (!receiverType(ctx, obj, type)) return false;
+
+    if (st) {
+        unsigned long key = nameKey(name);
+        const proto::ProtoSparseList* own = obj->getOwnAttributes(ctx);
+        bool ownHas = own && own->has(ctx, key);
+        for (int k = 0; k < st->count; ++k) {
+            const AttrCacheEntry& e = st->entries[k];
+            if (e.type != type || (e.kind == AttrCacheKind::Own) != ownHas || !e.typeChain.matches(ctx, type))
+                continue;
+            switch (e.kind) {
+            case AttrCacheKind::Own: {
+                // Own cells may need binding or __get__; leave those to the generic path.
+                const proto::ProtoObject* v = own->getAt(ctx, key);
+                if (!v || (v != PROTO_NONE && v->isCell(ctx))) return false;
+                out = v;
+                return true;
+            }
+            case AttrCacheKind::Plain:
+                if (e.valueChain.depth && !e.valueChain.matches(ctx, e.value)) continue;
+                out = e.value;
+                return true;
+            case AttrCacheKind::Method:
+                if (ownModuleMarker(ctx, env, own)) return false;
+                out = ctx->fromMethod(const_cast<proto::ProtoObject*>(obj), e.value->asMethod(ctx));
+                return true;
+            case AttrCacheKind::Descriptor: {
+                if (!e.valueChain.matches(ctx, e.value)) continue;
+                const proto::ProtoObject* typeObj = e.classValue;
+                unsigned long classKey = nameKey(env->getClassString());
+                if (own && own->has(ctx, classKey)) typeObj = own->getAt(ctx, classKey);
+                const proto::ProtoList* getArgs = ctx->newList()->appendLast(ctx, obj)->appendLast(ctx, typeObj ? typeObj : PROTO_NONE);
+                out = e.getter->asMethod(ctx)(ctx, e.value, nullptr, getArgs, nullptr);
+                return true;
+            }
+            default:
+                continue;
+            }
+        }
+    }
+    fill(ctx, env, site, false, obj, name);
+    return false;
+}
+
+bool InlineCacheTable::storeAttr(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+    const proto::ProtoObject* obj, const proto::ProtoString* name, const proto::ProtoObject* value) {
+    if (!env || site < 0 || static_cast<size_t>(site) >= attrSiteCount_ || !isCacheableReceiver(obj)) return false;
+    const AttrCacheState* st = attrSites_[site].state.load(std::memory_order_acquire);
+    if (st && st->megamorphic) return false;
+    const proto::ProtoObject* type = nullptr;
+    if (!receiverType(ctx, obj, type)) return false;
+
+    if (st) {
+        for (int k = 0; k < st->count; ++k) {
+            const AttrCacheEntry& e = st->entries[k];
+            if (e.kind == AttrCacheKind::Store && e.type == type && e.typeChain.matches(ctx, type)) {
+                const_cast<proto::ProtoObject*>(obj)->setAttribute(ctx, name, value);
+                return true;
+            }
+        }
+    }
+    fill(ctx, env, site, true, obj, name);
+    return false;
+}
+
+void InlineCacheTable::fill(proto::ProtoContext* ctx, PythonEnvironment* env, int site, bool isStore,
+    const proto::ProtoObject* obj, const proto::ProtoString* name) {
+    std::lock_guard<std::mutex> lock(fillMutex_);
+    AttrCacheSite& s = attrSites_[site];
+    const AttrCacheState* old = s.state.load(std::memory_order_relaxed);
+    if (old && old->megamorphic) return;
+
+    auto* next = new AttrCacheState();
+    if (old) {
+        // Keep only entries whose prototypes are unchanged.
+        for (int k = 0; k < old->count; ++k) {
+            if (old->entries[k].typeChain.matches(ctx, old->entries[k].type))
+                next->entries[next->count++] = old->entries[k];
+        }
+        next->fills = old->fills;
+    }
+    ++next->fills;
+
+    AttrCacheEntry e;
+    bool ok = isStore ? analyzeStore(ctx, obj, name, e) : analyzeLoad(ctx, env, obj, name, e);
+    if (next->fills > kAttrCacheMaxFills || (ok && next->count == kAttrCachePolymorphic)) {
+        next->megamorphic = true;
+        next->count = 0;
+    } else if (ok) {
+        pin(ctx, env, {&e.typeChain, &e.valueChain}, {e.value, e.getter, e.classValue});
+        next->entries[next->count++] = e;
+    }
+    s.state.store(next, std::memory_order_release);
+    if (old) retired_.push_back(old);
+}
+
+bool InlineCacheTable::loadGlobal(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+    const proto::ProtoString* name, const proto::ProtoObject*& out) {
+    if (!env || site < 0 || static_cast<size_t>(site) >= globalSiteCount_) return false;
+    const proto::ProtoObject* globals = PythonEnvironment::getCurrentGlobals();
+    if (globals) {
+        if (!isCacheableReceiver(globals)) return false;
+        // A module-level binding is read live, so stores to globals never invalidate this site.
+        unsigned long key = nameKey(name);
+        const proto::ProtoSparseList* own = globals->getOwnAttributes(ctx);
+        if (own && own->has(ctx, key)) {
+            const proto::ProtoObject* v = own->getAt(ctx, key);
+            if (!v) return false;
+            out = v;
+            return true;
+        }
+        if (globals->hasAttribute(ctx, name) == PROTO_TRUE) return false;
+    }
+
+    const proto::ProtoObject* builtins = env->getBuiltins();
+    if (!isCacheableReceiver(builtins)) return false;
+    const GlobalCacheState* st = globalSites_[site].state.load(std::memory_order_acquire);
+    if (st) {
+        if (st->megamorphic) return false;
+        if (st->valid && st->builtins.matches(ctx, builtins)) {
+            out = st->value;
+            return true;
+        }
+    }
+    fillGlobal(ctx, env, site, builtins, name);
+    return false;
+}
+
+void InlineCacheTable::fillGlobal(proto::ProtoContext* ctx, PythonEnvironment* env, int site,
+    const proto::ProtoObject* builtins, const proto::ProtoString* name) {
+    std::lock_guard<std::mutex> lock(fillMutex_);
+    GlobalCacheSite& s = globalSites_[site];
+    const GlobalCacheState* old = s.state.load(std::memory_order_relaxed);
+    if (old && old->megamorphic) return;
+
+    auto* next = new GlobalCacheState();
+    next->fills = (old ? old->fills : 0) + 1;
+    if (next->fills > kAttrCacheMaxFills) {
+        next->megamorphic = true;
+    } else if (next->builtins.capture(ctx, builtins)) {
+        bool found = false;
+        const proto::ProtoObject* v = next->builtins.lookup(ctx, nameKey(name), found);
+        if (found && v && v == builtins->getAttribute(ctx, name)) {
+            next->valid = true;
+            next->value = v;
+            pin(ctx, env, {&next->builtins}, {v});
+        }
+    }
+    s.state.store(next, std::memory_order_release);
+    if (old) retiredGlobals_.push_back(old);
+}
+
+void InlineCacheTable::pin(proto::ProtoContext* ctx, PythonEnvironment* env,
+    std::initializer_list<const ProtoChainGuard*> guards, std::initializer_list<const proto::ProtoObject*> objects) {
+    const proto::ProtoString* pinsS = env->getCoIcPinsString();
+    const proto::ProtoObject* current = owner_->getAttribute(ctx, pinsS);
+    const proto::ProtoList* pins = isPresent(current) ? current->asList(ctx) : nullptr;
+    if (!pins) pins = ctx->newList();
+    auto add = [&](const proto::ProtoObject* o) {
+        if (isCacheableReceiver(o)) pins = pins->appendLast(ctx, o);
+    };
+    for (const ProtoChainGuard* g : guards) {
+        for (int k = 0; k < g->depth; ++k) {
+            add(g->objects[k]);
+            if (g->parents[k]) add(g->parents[k]->asObject(ctx));
+            if (g->attrs[k]) add(g->attrs[k]->asObject(ctx));
+        }
+    }
+    for (const proto::ProtoObject* o : objects) add(o);
+    const_cast<proto::ProtoObject*>(owner_)->setAttribute(ctx, pinsS, pins->asObject(ctx));
+}
+
+} // namespace protoPython
@@ -1,4 +1,6 @@
 #include <protoPython/JsonModule.h>
+#include <protoPython/CompactDict.h>
+#include <protoPython/ListBuffer.h>
 #include <sstream>
 #include <string>
 #include <cctype>
@@ -47,15 +49,11 @@ static const proto::ProtoObject* jsonParse(proto::ProtoContext* ctx, const std::
     }
     if (s[i] == '{') {
         ++i;
-        const proto::ProtoList* keys = ctx->newList();
-        const proto::ProtoSparseList* data = ctx->newSparseList();
+        const proto::ProtoObject* obj = newDict(ctx);
         jsonSkipWs(s, i);
         if (i < s.size() && s[i] == '}') {
             ++i;
-            const proto::ProtoObject* emptyObj = ctx->newObject(true);
-            emptyObj = emptyObj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"), keys->asObject(ctx));
-            emptyObj = emptyObj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"), data->asObject(ctx));
-            return emptyObj;
+            return obj;
         }
         for (;;) {
             const proto::ProtoObject* k = jsonParse(ctx, s, i);
@@ -65,17 +63,13 @@ static const proto::ProtoObject* jsonParse(proto::ProtoContext* ctx, const std::
             ++i;
             const proto::ProtoObject* v = jsonParse(ctx, s, i);
             if (!v) break;
-            keys = keys->appendLast(ctx, k);
-            data = data->setAt(ctx, k->getHash(ctx), v);
+            dictSet(ctx, obj, k, v);
             jsonSkipWs(s, i);
             if (i >= s.size() || s[i] != ',') break;
             ++i;
         }
         jsonSkipWs(s, i);
         if (i < s.size() && s[i] == '}') ++i;
-        const proto::ProtoObject* obj = ctx->newObject(true);
-        obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"), keys->asObject(ctx));
-        obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"), data->asObject(ctx));
         return obj;
     }
     if (std::isdigit(static_cast<unsigned char>(s[i])) || (s[i] == '-' && i + 1 < s.size() && std::isdigit(static_cast<unsigned char>(s[i+1])))) {
@@ -126,8 +120,7 @@ static void dumpValue(proto::ProtoContext* ctx, std::ostream& out, const proto::
         out << '"';
         return;
     }
-    if (obj->asList(ctx)) {
-        const proto::ProtoList* list = obj->asList(ctx);
+    if (const proto::ProtoList* list = asListData(ctx, obj)) {
         out << '[';
         for (unsigned long i = 0; i < list->getSize(ctx); ++i) {
             if (i > 0) out << ',';
@@ -136,18 +129,14 @@ static void dumpValue(proto::ProtoContext* ctx, std::ostream& out, const proto::
         out << ']';
         return;
     }
-    const proto::ProtoObject* keysObj = obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"));
-    const proto::ProtoObject* dataObj = obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
-    if (keysObj && keysObj->asList(ctx) && dataObj && dataObj->asSparseList(ctx)) {
-        const proto::ProtoList* keys = keysObj->asList(ctx);
-        const proto::ProtoSparseList* data = dataObj->asSparseList(ctx);
+    if (isDictLike(ctx, obj)) {
+        const proto::ProtoList* entries = dictEntries(ctx, obj);
         out << '{';
-        for (unsigned long i = 0; i < keys->getSize(ctx); ++i) {
+        for (unsigned long i = 0; i + 1 < entries->getSize(ctx); i += 2) {
             if (i > 0) out << ',';
-            dumpValue(ctx, out, keys->getAt(ctx, static_cast<int>(i)));
+            dumpValue(ctx, out, entries->getAt(ctx, static_cast<int>(i)));
             out << ':';
-            const proto::ProtoObject* v = data->getAt(ctx, keys->getAt(ctx, static_cast<int>(i))->getHash(ctx));
-            dumpValue(ctx, out, v);
+            dumpValue(ctx, out, entries->getAt(ctx, static_cast<int>(i + 1)));
         }
         out << '}';
         return;
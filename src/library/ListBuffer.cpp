@@ -0,0 +1,334 @@
+#include <protoPython/ListBuffer.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <utility>
+
+namespace protoPython {
+
+namespace {
+
+void list_buffer_finalizer(void* ptr) {
+    delete static_cast<ListBuffer*>(ptr);
+}
+
+const proto::ProtoString* bufferName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getListBufferString() : proto::ProtoString::fromUTF8String(ctx, "__list_buffer__");
+}
+
+const proto::ProtoString* chunksName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getListChunksString() : proto::ProtoString::fromUTF8String(ctx, "__list_chunks__");
+}
+
+const proto::ProtoString* dataName(proto::ProtoContext* ctx, PythonEnvironment* env) {
+    return env ? env->getDataString() : proto::ProtoString::fromUTF8String(ctx, "__data__");
+}
+
+bool isEmbedded(const proto::ProtoObject* obj) {
+    return (reinterpret_cast<uintptr_t>(obj) & 0x3FUL) == POINTER_TAG_EMBEDDED_VALUE;
+}
+
+/** The buffer attached to obj itself, live or retired; nullptr when obj never had one. */
+ListBuffer* ownBuffer(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* obj) {
+    const proto::ProtoObject* handle = obj->getAttribute(ctx, bufferName(ctx, env));
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    ListBuffer* buffer = ext ? static_cast<ListBuffer*>(ext->getPointer(ctx)) : nullptr;
+    // A child of a list object inherits the attribute but not the buffer.
+    return buffer && buffer->object() == obj ? buffer : nullptr;
+}
+
+/** Python index semantics; false when out of range. */
+bool normalizeIndex(long* index, size_t size) {
+    if (*index < 0) *index += static_cast<long>(size);
+    return *index >= 0 && static_cast<size_t>(*index) < size;
+}
+
+void appendItems(proto::ProtoContext* ctx, const proto::ProtoList* list, std::vector<const proto::ProtoObject*>* out) {
+    out->reserve(out->size() + list->getSize(ctx));
+    const proto::ProtoListIterator* it = list->getIterator(ctx);
+    while (it && it->hasNext(ctx)) {
+        out->push_back(it->next(ctx));
+        it = it->advance(ctx);
+    }
+}
+
+} // anonymous namespace
+
+// --- ListBuffer ---
+
+ListBuffer::ListBuffer(const proto::ProtoObject* list) : list_(list) {}
+
+bool ListBuffer::usable(proto::ProtoContext* ctx) {
+    if (promoted_.load(std::memory_order_relaxed)) return false;
+    if (bias_.isShared()) {
+        // Seen by another thread: from now on the list lives in its persistent form.
+        promoteLocked(ctx);
+        return false;
+    }
+    return true;
+}
+
+void ListBuffer::appendLocked(proto::ProtoContext* ctx, const proto::ProtoObject* value) {
+    const size_t at = items_.size();
+    items_.push_back(value);
+    const size_t chunk = at / kChunk;
+    if (chunk == chunks_.size()) {
+        chunks_.push_back(ctx->newList());
+        holders_.push_back(ctx->newObject(true));
+        roots_ = roots_->appendLast(ctx, holders_.back());
+        publishRoots(ctx);
+    }
+    chunks_[chunk] = chunks_[chunk]->appendLast(ctx, value);
+    storeChunk(ctx, chunk);
+}
+
+void ListBuffer::storeChunk(proto::ProtoContext* ctx, size_t chunk) {
+    holders_[chunk]->setAttribute(ctx, dataName(ctx, PythonEnvironment::fromContext(ctx)), chunks_[chunk]->asObject(ctx));
+}
+
+void ListBuffer::publishRoots(proto::ProtoContext* ctx) {
+    list_->setAttribute(ctx, chunksName(ctx, PythonEnvironment::fromContext(ctx)), roots_ ? roots_->asObject(ctx) : nullptr);
+}
+
+const proto::ProtoList* ListBuffer::promoteLocked(proto::ProtoContext* ctx) {
+    const proto::ProtoList* data = ctx->newList();
+    for (const proto::ProtoObject* item : items_) data = data->appendLast(ctx, item);
+    list_->setAttribute(ctx, dataName(ctx, PythonEnvironment::fromContext(ctx)), data->asObject(ctx));
+    retireLocked(ctx);
+    return data;
+}
+
+void ListBuffer::retireLocked(proto::ProtoContext* ctx) {
+    promoted_.store(true, std::memory_order_release);
+    std::vector<const proto::ProtoObject*>().swap(items_);
+    std::vector<const proto::ProtoList*>().swap(chunks_);
+    std::vector<const proto::ProtoObject*>().swap(holders_);
+    roots_ = nullptr;
+    publishRoots(ctx);
+}
+
+bool ListBuffer::append(proto::ProtoContext* ctx, const proto::ProtoObject* value) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    appendLocked(ctx, value);
+    return true;
+}
+
+bool ListBuffer::extend(proto::ProtoContext* ctx, const std::vector<const proto::ProtoObject*>& values) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    items_.reserve(items_.size() + values.size());
+    for (const proto::ProtoObject* value : values) appendLocked(ctx, value);
+    return true;
+}
+
+bool ListBuffer::size(proto::ProtoContext* ctx, unsigned long* out) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    *out = items_.size();
+    return true;
+}
+
+bool ListBuffer::getAt(proto::ProtoContext* ctx, long index, const proto::ProtoObject** out) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    *out = normalizeIndex(&index, items_.size()) ? items_[index] : nullptr;
+    return true;
+}
+
+bool ListBuffer::setAt(proto::ProtoContext* ctx, long index, const proto::ProtoObject* value, bool* inRange) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    *inRange = normalizeIndex(&index, items_.size());
+    if (!*inRange) return true;
+    items_[index] = value;
+    const size_t chunk = static_cast<size_t>(index) / kChunk;
+    chunks_[chunk] = chunks_[chunk]->setAt(ctx, static_cast<int>(index % kChunk), value);
+    storeChunk(ctx, chunk);
+    return true;
+}
+
+bool ListBuffer::popLast(proto::ProtoContext* ctx, const proto::ProtoObject** out) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    if (items_.empty()) {
+        *out = nullptr;
+        return true;
+    }
+    const size_t at = items_.size() - 1;
+    *out = items_[at];
+    items_.pop_back();
+    // The emptied holder stays and is refilled by the next append into its range.
+    const size_t chunk = at / kChunk;
+    chunks_[chunk] = chunks_[chunk]->removeAt(ctx, static_cast<int>(at % kChunk));
+    storeChunk(ctx, chunk);
+    return true;
+}
+
+bool ListBuffer::clear(proto::ProtoContext* ctx) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    items_.clear();
+    chunks_.clear();
+    holders_.clear();
+    roots_ = ctx->newList();
+    publishRoots(ctx);
+    return true;
+}
+
+bool ListBuffer::copyItems(proto::ProtoContext* ctx, std::vector<const proto::ProtoObject*>* out) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!usable(ctx)) return false;
+    out->insert(out->end(), items_.begin(), items_.end());
+    return true;
+}
+
+const proto::ProtoList* ListBuffer::promote(proto::ProtoContext* ctx) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!promoted_.load(std::memory_order_relaxed)) return promoteLocked(ctx);
+    const proto::ProtoObject* data = list_->getAttribute(ctx, dataName(ctx, PythonEnvironment::fromContext(ctx)));
+    return data ? data->asList(ctx) : nullptr;
+}
+
+void ListBuffer::discard(proto::ProtoContext* ctx) {
+    OwnerBiasGuard guard(bias_, ctx->space);
+    if (!promoted_.load(std::memory_order_relaxed)) retireLocked(ctx);
+}
+
+ListBuffer* ListBuffer::attach(proto::ProtoContext* ctx, const proto::ProtoObject* list,
+                               std::vector<const proto::ProtoObject*> items) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (ownBuffer(ctx, env, list)) return nullptr;
+    ListBuffer* buffer = new ListBuffer(list);
+    OwnerBiasGuard guard(buffer->bias_, ctx->space);
+    buffer->roots_ = ctx->newList();
+    buffer->items_.reserve(items.size());
+    for (const proto::ProtoObject* item : items) buffer->appendLocked(ctx, item);
+    // Attach before dropping __data__: a reader that finds no __data__ finds the buffer.
+    list->setAttribute(ctx, bufferName(ctx, env), ctx->fromExternalPointer(buffer, list_buffer_finalizer));
+    list->setAttribute(ctx, dataName(ctx, env), nullptr);
+    return buffer;
+}
+
+// --- Free functions ---
+
+ListBuffer* listBuffer(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!obj || obj == PROTO_NONE || isEmbedded(obj)) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (obj->getAttribute(ctx, dataName(ctx, env))) return nullptr;
+    ListBuffer* buffer = ownBuffer(ctx, env, obj);
+    return buffer && !buffer->promoted() ? buffer : nullptr;
+}
+
+const proto::ProtoObject* dataAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!obj || obj == PROTO_NONE || isEmbedded(obj)) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* data = obj->getAttribute(ctx, dataName(ctx, env));
+    if (data) return data;
+    ListBuffer* buffer = ownBuffer(ctx, env, obj);
+    const proto::ProtoList* list = buffer ? buffer->promote(ctx) : nullptr;
+    return list ? list->asObject(ctx) : nullptr;
+}
+
+const proto::ProtoList* asListData(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!obj || obj == PROTO_NONE) return nullptr;
+    if (const proto::ProtoList* list = obj->asList(ctx)) return list;
+    const proto::ProtoObject* data = dataAttribute(ctx, obj);
+    return data && data != obj ? data->asList(ctx) : nullptr;
+}
+
+void setDataAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const proto::ProtoObject* data) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (ListBuffer* buffer = ownBuffer(ctx, env, obj)) buffer->discard(ctx);
+    obj->setAttribute(ctx, dataName(ctx, env), data);
+}
+
+bool listAppend(proto::ProtoContext* ctx, const proto::ProtoObject* list, const proto::ProtoObject* value) {
+    if (!list || list == PROTO_NONE || isEmbedded(list)) return false;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* data = list->getAttribute(ctx, dataName(ctx, env));
+    ListBuffer* buffer = data ? nullptr : ownBuffer(ctx, env, list);
+    if (buffer && buffer->append(ctx, value)) return true;
+    if (!data) data = dataAttribute(ctx, list);
+    const proto::ProtoList* items = data ? data->asList(ctx) : nullptr;
+    if (!items) return false;
+    if (items->getSize(ctx) + 1 >= ListBuffer::kThawSize && !buffer && !ownBuffer(ctx, env, list)) {
+        std::vector<const proto::ProtoObject*> all;
+        appendItems(ctx, items, &all);
+        all.push_back(value);
+        if (ListBuffer::attach(ctx, list, std::move(all))) return true;
+    }
+    list->setAttribute(ctx, dataName(ctx, env), items->appendLast(ctx, value)->asObject(ctx));
+    return true;
+}
+
+bool listExtend(proto::ProtoContext* ctx, const proto::ProtoObject* list, const std::vector<const proto::ProtoObject*>& values) {
+    if (!list || list == PROTO_NONE || isEmbedded(list)) return false;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* data = list->getAttribute(ctx, dataName(ctx, env));
+    ListBuffer* buffer = data ? nullptr : ownBuffer(ctx, env, list);
+    if (buffer && buffer->extend(ctx, values)) return true;
+    if (!data) data = dataAttribute(ctx, list);
+    const proto::ProtoList* items = data ? data->asList(ctx) : nullptr;
+    if (!items) return false;
+    if (items->getSize(ctx) + values.size() >= ListBuffer::kThawSize && !buffer && !ownBuffer(ctx, env, list)) {
+        std::vector<const proto::ProtoObject*> all;
+        appendItems(ctx, items, &all);
+        all.insert(all.end(), values.begin(), values.end());
+        if (ListBuffer::attach(ctx, list, std::move(all))) return true;
+    }
+    for (const proto::ProtoObject* value : values) items = items->appendLast(ctx, value);
+    list->setAttribute(ctx, dataName(ctx, env), items->asObject(ctx));
+    return true;
+}
+
+bool listSize(proto::ProtoContext* ctx, const proto::ProtoObject* list, unsigned long* out) {
+    if (ListBuffer* buffer = listBuffer(ctx, list)) {
+        if (buffer->size(ctx, out)) return true;
+    }
+    const proto::ProtoObject* data = dataAttribute(ctx, list);
+    const proto::ProtoList* items = data ? data->asList(ctx) : nullptr;
+    if (!items) return false;
+    *out = items->getSize(ctx);
+    return true;
+}
+
+bool listGetAt(proto::ProtoContext* ctx, const proto::ProtoObject* list, long index, const proto::ProtoObject** out) {
+    if (ListBuffer* buffer = listBuffer(ctx, list)) {
+        if (buffer->getAt(ctx, index, out)) return true;
+    }
+    const proto::ProtoObject* data = dataAttribute(ctx, list);
+    const proto::ProtoList* items = data ? data->asList(ctx) : nullptr;
+    if (!items) return false;
+    *out = normalizeIndex(&index, items->getSize(ctx)) ? items->getAt(ctx, static_cast<int>(index)) : nullptr;
+    return true;
+}
+
+bool listItems(proto::ProtoContext* ctx, const proto::ProtoObject* list, std::vector<const proto::ProtoObject*>* out) {
+    if (ListBuffer* buffer = listBuffer(ctx, list)) {
+        if (buffer->copyItems(ctx, out)) return true;
+    }
+    const proto::ProtoList* items = asListData(ctx, list);
+    if (!items) return false;
+    appendItems(ctx, items, out);
+    return true;
+}
+
+const proto::ProtoObject* newListObject(proto::ProtoContext* ctx, std::vector<const proto::ProtoObject*> items) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* list = ctx->newObject(true);
+    if (env && env->getListPrototype()) {
+        list = list->addParent(ctx, env->getListPrototype());
+        list->setAttribute(ctx, env->getClassString(), env->getListPrototype());
+    }
+    if (items.size() >= ListBuffer::kThawSize) {
+        ListBuffer::attach(ctx, list, std::move(items));
+        return list;
+    }
+    const proto::ProtoList* data = ctx->newList();
+    for (const proto::ProtoObject* item : items) data = data->appendLast(ctx, item);
+    list->setAttribute(ctx, dataName(ctx, env), data->asObject(ctx));
+    return list;
+}
+
+} // namespace protoPython
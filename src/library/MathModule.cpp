@@ -1,4 +1,5 @@
 #include <protoPython/MathModule.h>
+#include <protoPython/ListBuffer.h>
 #include <cmath>
 #include <limits>
 
@@ -330,8 +331,8 @@ static const proto::ProtoObject* py_dist(
         const proto::ProtoObject* pb = posArgs->getAt(ctx, 1);
         const proto::ProtoList* la = nullptr;
         const proto::ProtoList* lb = nullptr;
-        const proto::ProtoObject* da = pa->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
-        const proto::ProtoObject* db = pb->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
+        const proto::ProtoObject* da = dataAttribute(ctx, pa);
+        const proto::ProtoObject* db = dataAttribute(ctx, pb);
         if (da && da->asList(ctx)) la = da->asList(ctx);
         else if (pa->asList(ctx)) la = pa->asList(ctx);
         if (db && db->asList(ctx)) lb = db->asList(ctx);
@@ -408,7 +409,7 @@ static const proto::ProtoObject* py_prod(
     if (posArgs->getSize(ctx) < 1) return PROTO_NONE;
     const proto::ProtoObject* iterable = posArgs->getAt(ctx, 0);
     double result = 1.0;
-    const proto::ProtoObject* da = iterable->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
+    const proto::ProtoObject* da = dataAttribute(ctx, iterable);
     if (!da || !da->asList(ctx)) return PROTO_NONE;
     const proto::ProtoList* list = da->asList(ctx);
     for (int i = 0, sz = list->getSize(ctx); i < sz; ++i)
@@ -422,8 +423,8 @@ static const proto::ProtoObject* py_sumprod(
     if (posArgs->getSize(ctx) < 2) return PROTO_NONE;
     const proto::ProtoObject* a = posArgs->getAt(ctx, 0);
     const proto::ProtoObject* b = posArgs->getAt(ctx, 1);
-    const proto::ProtoObject* da = a->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
-    const proto::ProtoObject* db = b->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"));
+    const proto::ProtoObject* da = dataAttribute(ctx, a);
+    const proto::ProtoObject* db = dataAttribute(ctx, b);
     if (!da || !db || !da->asList(ctx) || !db->asList(ctx)) return PROTO_NONE;
     const proto::ProtoList* la = da->asList(ctx);
     const proto::ProtoList* lb = db->asList(ctx);
@@ -1,4 +1,5 @@
 #include <protoPython/OsModule.h>
+#include <protoPython/BlockingRegion.h>
 #include <protoCore.h>
 #include <cstdlib>
 #include <cstring>
@@ -191,7 +192,11 @@ static const proto::ProtoObject* py_waitpid(
     int options = static_cast<int>(posArgs->getAt(ctx, 1)->asLong(ctx));
     int status = 0;
 #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
-    int res = waitpid(pid, &status, options);
+    int res;
+    {
+        BlockingRegion waiting(ctx->space);
+        res = waitpid(pid, &status, options);
+    }
     const proto::ProtoList* tuple = ctx->newList();
     tuple = tuple->appendLast(ctx, ctx->fromInteger(res));
     tuple = tuple->appendLast(ctx, ctx->fromInteger(status));
@@ -27,6 +27,17 @@
 #include <protoPython/CollectionsAbcModule.h>
 #include <protoPython/AtexitModule.h>
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/EventLoop.h>
+#include <protoPython/FuturesModule.h>
+#include <protoPython/QueueModule.h>
+#include <protoPython/ThreadLocal.h>
+#include <protoPython/CompactDict.h>
+#include <protoPython/FlatString.h>
+#include <protoPython/ListBuffer.h>
+#include <protoPython/StringBuilder.h>
+#include <protoPython/StringKernels.h>
+#include <protoPython/ThreadingStrategy.h>
 #include <protoPython/Parser.h>
 #include <protoPython/Compiler.h>
 #include <protoCore.h>
@@ -59,6 +70,11 @@ static bool get_env_diag() {
     return diag;
 }
 
+static bool get_resolve_diag() {
+    static bool diag = std::getenv("PROTO_RESOLVE_DIAG") != nullptr;
+    return diag;
+}
+
 namespace protoPython {
 
 static bool isEmbeddedValue(const proto::ProtoObject* obj) {
@@ -129,29 +145,9 @@ PythonEnvironment::SafeImportLock::SafeImportLock(PythonEnvironment* env, proto:
     }
     if (s_importLockRecursionDepth == 0 && ctx_ && ctx_->thread) {
         auto* threadImpl = proto::toImpl<proto::ProtoThreadImplementation>(ctx_->thread);
-        auto* space = threadImpl->space;
-        
-        {
-            std::lock_guard<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
-            space->parkedThreads++;
-            space->gcCV.notify_all();
-        }
-        
-        if (std::getenv("PROTO_THREAD_DIAG")) {
-        }
-        env_->importLock_.lock();
-        if (std::getenv("PROTO_THREAD_DIAG")) {
-        }
-        
-        {
-            std::unique_lock<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
-            if (space->stwFlag.load()) {
-                if (std::getenv("PROTO_THREAD_DIAG")) {
-                }
-                space->gcCV.notify_all();
-                space->stopTheWorldCV.wait(lock, [space] { return !space->stwFlag.load(); });
-            }
-            space->parkedThreads--;
+        if (!env_->importLock_.try_lock()) {
+            BlockingRegion blocking(threadImpl->space);
+            env_->importLock_.lock();
         }
     } else {
         if (std::getenv("PROTO_THREAD_DIAG")) {
@@ -457,22 +453,24 @@ static const proto::ProtoObject* py_repr_call(
 
 // --- List Methods ---
 
+static void list_append_item(proto::ProtoContext* context, const proto::ProtoObject* self, const proto::ProtoObject* item) {
+    listAppend(context, self, item);
+}
+
 static const proto::ProtoObject* py_list_append(
     proto::ProtoContext* context,
     const proto::ProtoObject* self,
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return PROTO_NONE;
-    const proto::ProtoList* list = data->asList(context);
+    if (positionalParameters->getSize(context) > 0)
+        list_append_item(context, self, positionalParameters->getAt(context, 0));
+    return PROTO_NONE;
+}
 
-    if (positionalParameters->getSize(context) > 0) {
-        const proto::ProtoObject* item = positionalParameters->getAt(context, 0);
-        const proto::ProtoList* newList = list->appendLast(context, item);
-        self->setAttribute(context, dataName, newList->asObject(context));
-    }
+static const proto::ProtoObject* py_list_append_vectorcall(proto::ProtoContext* context,
+    const proto::ProtoObject* self, const proto::ProtoObject* const* args, size_t nargs) {
+    if (nargs > 0) list_append_item(context, self, args[0]);
     return PROTO_NONE;
 }
 
@@ -482,10 +480,9 @@ static const proto::ProtoObject* py_list_len(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return context->fromInteger(0);
-    return context->fromInteger(data->asList(context)->getSize(context));
+    unsigned long size = 0;
+    if (!listSize(context, self, &size)) return context->fromInteger(0);
+    return context->fromInteger(static_cast<long long>(size));
 }
 
 struct SliceBounds { bool isSlice; long long start, stop, step; };
@@ -528,22 +525,20 @@ static const proto::ProtoObject* py_list_getitem(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return PROTO_NONE;
-    const proto::ProtoList* list = data->asList(context);
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* indexObj = positionalParameters->getAt(context, 0);
-    long long size = static_cast<long long>(list->getSize(context));
-
     if (indexObj->isInteger(context)) {
-        int index = static_cast<int>(indexObj->asLong(context));
-        unsigned long ulen = list->getSize(context);
-        if (index < 0) index += static_cast<int>(ulen);
-        if (index < 0 || static_cast<unsigned long>(index) >= ulen) return PROTO_NONE;
-        return list->getAt(context, index);
+        const proto::ProtoObject* item = nullptr;
+        if (!listGetAt(context, self, static_cast<long>(indexObj->asLong(context)), &item)) return PROTO_NONE;
+        return item ? item : PROTO_NONE;
     }
 
+    // Slices need the persistent list.
+    const proto::ProtoObject* data = dataAttribute(context, self);
+    if (!data || !data->asList(context)) return PROTO_NONE;
+    const proto::ProtoList* list = data->asList(context);
+    long long size = static_cast<long long>(list->getSize(context));
+
     const proto::ProtoList* sliceList = indexObj->asList(context);
     if (sliceList) {
         unsigned long sliceSize = sliceList->getSize(context);
@@ -597,12 +592,16 @@ static const proto::ProtoObject* py_list_setitem(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return PROTO_NONE;
-    const proto::ProtoList* list = data->asList(context);
     if (positionalParameters->getSize(context) < 2) return PROTO_NONE;
     int index = static_cast<int>(positionalParameters->getAt(context, 0)->asLong(context));
     const proto::ProtoObject* value = positionalParameters->getAt(context, 1);
+    if (ListBuffer* buffer = listBuffer(context, self)) {
+        bool inRange = false;
+        if (buffer->setAt(context, index, value, &inRange)) return PROTO_NONE;
+    }
+    const proto::ProtoObject* data = dataAttribute(context, self);
+    if (!data || !data->asList(context)) return PROTO_NONE;
+    const proto::ProtoList* list = data->asList(context);
     unsigned long size = list->getSize(context);
     if (index < 0) index += static_cast<int>(size);
     if (index < 0 || static_cast<unsigned long>(index) >= size) return PROTO_NONE;
@@ -618,7 +617,7 @@ static const proto::ProtoObject* py_list_delitem(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* dataName = PythonEnvironment::fromContext(context)->getDataString();
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asList(context)) return PROTO_NONE;
     const proto::ProtoList* list = data->asList(context);
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
@@ -642,11 +641,19 @@ static const proto::ProtoObject* py_list_iter(
     const proto::ProtoObject* iterProto = env ? env->getAttribute(context, self, iterProtoName) : self->getAttribute(context, iterProtoName);
     if (!iterProto) return PROTO_NONE;
 
+    const proto::ProtoString* iterListName = proto::ProtoString::fromUTF8String(context, "__iter_list__");
+    if (listBuffer(context, self)) {
+        // Walk a buffered list by index, without taking a snapshot.
+        const proto::ProtoObject* iterObj = iterProto->newChild(context, true);
+        iterObj = iterObj->setAttribute(context, iterListName, self);
+        iterObj = iterObj->setAttribute(context, proto::ProtoString::fromUTF8String(context, "__iter_index__"), context->fromInteger(0));
+        return iterObj;
+    }
+
     const proto::ProtoList* list = self->asList(context);
     const proto::ProtoObject* data = self;
     if (!list) {
-        const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-        data = self->getAttribute(context, dataName);
+        data = dataAttribute(context, self);
         if (data) list = data->asList(context);
     }
     if (!list) return PROTO_NONE;
@@ -654,7 +661,6 @@ static const proto::ProtoObject* py_list_iter(
     const proto::ProtoListIterator* it = list->getIterator(context);
 
     const proto::ProtoObject* iterObj = iterProto->newChild(context, true);
-    const proto::ProtoString* iterListName = proto::ProtoString::fromUTF8String(context, "__iter_list__");
     const proto::ProtoString* iterItName = proto::ProtoString::fromUTF8String(context, "__iter_it__");
     iterObj = iterObj->setAttribute(context, iterListName, data);
     iterObj = iterObj->setAttribute(context, iterItName, it->asObject(context));
@@ -669,7 +675,21 @@ static const proto::ProtoObject* py_list_iter_next(
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* iterItName = proto::ProtoString::fromUTF8String(context, "__iter_it__");
     const proto::ProtoObject* itObj = self->getAttribute(context, iterItName);
-    if (!itObj || !itObj->asListIterator(context)) return PROTO_NONE;
+    if (!itObj) {
+        const proto::ProtoString* iterIndexName = proto::ProtoString::fromUTF8String(context, "__iter_index__");
+        const proto::ProtoObject* indexObj = self->getAttribute(context, iterIndexName);
+        const proto::ProtoObject* listObj = self->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__iter_list__"));
+        if (!indexObj || !indexObj->isInteger(context) || !listObj) return PROTO_NONE;
+        const long index = static_cast<long>(indexObj->asLong(context));
+        const proto::ProtoObject* value = nullptr;
+        if (index < 0 || !listGetAt(context, listObj, index, &value) || !value) {
+            self->setAttribute(context, iterIndexName, context->fromInteger(-1));
+            return nullptr;
+        }
+        self->setAttribute(context, iterIndexName, context->fromInteger(index + 1));
+        return value;
+    }
+    if (!itObj->asListIterator(context)) return PROTO_NONE;
     const proto::ProtoListIterator* it = itObj->asListIterator(context);
     if (!it->hasNext(context)) return nullptr;
     const proto::ProtoObject* value = it->next(context);
@@ -685,8 +705,7 @@ static const proto::ProtoObject* py_list_reversed(
     const proto::ProtoString* revProtoName = proto::ProtoString::fromUTF8String(context, "__reversed_prototype__");
     const proto::ProtoObject* revProto = self->getAttribute(context, revProtoName);
     if (!revProto) return PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asList(context)) return PROTO_NONE;
     const proto::ProtoList* list = data->asList(context);
     long long n = static_cast<long long>(list->getSize(context));
@@ -717,8 +736,7 @@ static const proto::ProtoObject* py_list_contains(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asList(context)) return PROTO_FALSE;
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -734,9 +752,8 @@ static const proto::ProtoObject* py_list_eq(
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* other = positionalParameters->getAt(context, 0);
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoObject* otherData = other->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
+    const proto::ProtoObject* otherData = dataAttribute(context, other);
     const proto::ProtoList* list = (data && data != PROTO_NONE && data->asList(context)) ? data->asList(context) : self->asList(context);
     const proto::ProtoList* otherList = (otherData && otherData != PROTO_NONE && otherData->asList(context)) ? otherData->asList(context) : other->asList(context);
     if (!list || !otherList) return PROTO_FALSE;
@@ -778,9 +795,8 @@ static int compare_values(proto::ProtoContext* context, const proto::ProtoObject
 }
 
 static int compare_lists(proto::ProtoContext* context, const proto::ProtoObject* self, const proto::ProtoObject* other, bool* ok) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoObject* otherData = other->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
+    const proto::ProtoObject* otherData = dataAttribute(context, other);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : self->asList(context);
     const proto::ProtoList* otherList = otherData && otherData->asList(context) ? otherData->asList(context) : other->asList(context);
     if (!list || !otherList) {
@@ -865,23 +881,12 @@ static const proto::ProtoObject* py_dict_getitem(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
+    if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
+    const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
+    const proto::ProtoObject* res = dictGet(context, self, key);
+    if (res) return res;
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context)) return PROTO_NONE;
-
-    if (positionalParameters->getSize(context) > 0) {
-        const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
-        unsigned long hash = key->getHash(context);
-        const proto::ProtoSparseList* dict = data->asSparseList(context);
-        if (dict->has(context, hash)) {
-            const proto::ProtoObject* res = dict->getAt(context, hash);
-            return res;
-        }
-        PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        if (env) env->raiseKeyError(context, key);
-        return PROTO_NONE;
-    }
+    if (env && !env->hasPendingException()) env->raiseKeyError(context, key);
     return PROTO_NONE;
 }
 
@@ -891,25 +896,8 @@ static const proto::ProtoObject* py_dict_setitem(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context)) return PROTO_NONE;
     if (positionalParameters->getSize(context) < 2) return PROTO_NONE;
-    const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
-    const proto::ProtoObject* value = positionalParameters->getAt(context, 1);
-    unsigned long hash = key->getHash(context);
-    bool hadKey = data->asSparseList(context)->has(context, hash);
-    const proto::ProtoSparseList* newSparse = data->asSparseList(context)->setAt(context, hash, value);
-    self->setAttribute(context, dataName, newSparse->asObject(context));
-
-    if (!hadKey) {
-        const proto::ProtoString* keysName = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(context, "__keys__");
-        const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-        const proto::ProtoList* keysList = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-        keysList = keysList->appendLast(context, key);
-        self->setAttribute(context, keysName, keysList->asObject(context));
-    }
+    dictSet(context, self, positionalParameters->getAt(context, 0), positionalParameters->getAt(context, 1));
     return PROTO_NONE;
 }
 
@@ -920,34 +908,10 @@ static const proto::ProtoObject* py_dict_delitem(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env->getDataString();
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context)) return PROTO_NONE;
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
-    unsigned long hash = key->getHash(context);
-    
-    if (!data->asSparseList(context)->has(context, hash)) {
+    if (!dictPop(context, self, key) && env && !env->hasPendingException())
         env->raiseKeyError(context, key);
-        return PROTO_NONE;
-    }
-
-    const proto::ProtoSparseList* newSparse = data->asSparseList(context)->removeAt(context, hash);
-    self->setAttribute(context, dataName, newSparse->asObject(context));
-
-    const proto::ProtoString* keysName = env->getKeysString();
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    if (keysObj && keysObj->asList(context)) {
-        const proto::ProtoList* list = keysObj->asList(context);
-        for (int i = 0; i < list->getSize(context); ++i) {
-            unsigned long kh = list->getAt(context, i)->getHash(context);
-            if (kh == hash) {
-                 list = list->removeAt(context, i);
-                 break;
-            }
-        }
-        self->setAttribute(context, keysName, list->asObject(context));
-    }
     return PROTO_NONE;
 }
 
@@ -957,10 +921,7 @@ static const proto::ProtoObject* py_dict_len(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context)) return context->fromInteger(0);
-    return context->fromInteger(data->asSparseList(context)->getSize(context));
+    return context->fromInteger(static_cast<long long>(dictSize(context, self)));
 }
 
 static const proto::ProtoObject* py_dict_iter(
@@ -988,9 +949,8 @@ static const proto::ProtoObject* py_dict_iter(
             keysList = context->newList();
         }
     } else {
-        const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-        const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-        keysList = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
+        // A snapshot: the iteration does not see later insertions or deletions.
+        keysList = dictKeys(context, self);
     }
 
     const proto::ProtoListIterator* it = keysList->getIterator(context);
@@ -1006,17 +966,8 @@ static const proto::ProtoObject* py_dict_contains(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context)) return PROTO_FALSE;
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
-    const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
-    unsigned long h = key->getHash(context);
-    bool found = data->asSparseList(context)->has(context, h);
-    if (std::getenv("PROTO_ENV_DIAG")) {
-        // dict contains diagnostic removed
-    }
-    return found ? PROTO_TRUE : PROTO_FALSE;
+    return dictGet(context, self, positionalParameters->getAt(context, 0)) ? PROTO_TRUE : PROTO_FALSE;
 }
 
 static const proto::ProtoObject* py_dict_eq(
@@ -1027,28 +978,16 @@ static const proto::ProtoObject* py_dict_eq(
     const proto::ProtoSparseList* keywordParameters) {
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* other = positionalParameters->getAt(context, 0);
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoObject* otherData = other->getAttribute(context, dataName);
-    if (!data || !data->asSparseList(context) || !otherData || !otherData->asSparseList(context)) return PROTO_FALSE;
-    const proto::ProtoSparseList* dictA = data->asSparseList(context);
-    const proto::ProtoSparseList* dictB = otherData->asSparseList(context);
-
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObjA = self->getAttribute(context, keysName);
-    const proto::ProtoObject* keysObjB = other->getAttribute(context, keysName);
-    const proto::ProtoList* keysA = keysObjA && keysObjA->asList(context) ? keysObjA->asList(context) : context->newList();
-    const proto::ProtoList* keysB = keysObjB && keysObjB->asList(context) ? keysObjB->asList(context) : context->newList();
-    if (keysA->getSize(context) != keysB->getSize(context)) return PROTO_FALSE;
-
-    unsigned long size = keysA->getSize(context);
-    for (unsigned long i = 0; i < size; ++i) {
-        const proto::ProtoObject* key = keysA->getAt(context, static_cast<int>(i));
-        unsigned long hash = key->getHash(context);
-        if (!dictB->has(context, hash)) return PROTO_FALSE;
-        const proto::ProtoObject* vA = dictA->getAt(context, hash);
-        const proto::ProtoObject* vB = dictB->getAt(context, hash);
-        PythonEnvironment* env = PythonEnvironment::fromContext(context);
+    if (!isDictLike(context, self) || !isDictLike(context, other)) return PROTO_FALSE;
+    if (dictSize(context, self) != dictSize(context, other)) return PROTO_FALSE;
+
+    PythonEnvironment* env = PythonEnvironment::fromContext(context);
+    const proto::ProtoList* entries = dictEntries(context, self);
+    const unsigned long size = entries->getSize(context);
+    for (unsigned long i = 0; i + 1 < size; i += 2) {
+        const proto::ProtoObject* vA = entries->getAt(context, static_cast<int>(i + 1));
+        const proto::ProtoObject* vB = dictGet(context, other, entries->getAt(context, static_cast<int>(i)));
+        if (!vB) return PROTO_FALSE;
         if (env && !env->objectsEqual(context, vA, vB)) return PROTO_FALSE;
         if (!env && vA->compare(context, vB) != 0) return PROTO_FALSE;
     }
@@ -1138,8 +1077,7 @@ static const proto::ProtoObject* py_list_repr(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     
     if (std::getenv("PROTO_ENV_DIAG")) {
@@ -1183,8 +1121,7 @@ static const proto::ProtoObject* py_tuple_repr(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoTuple* tup = (data && data->asTuple(context)) ? data->asTuple(context) : self->asTuple(context);
     const proto::ProtoList* list = tup ? tup->asList(context) : nullptr;
     if (!list) return context->fromUTF8String("()");
@@ -1211,9 +1148,8 @@ static const proto::ProtoObject* py_tuple_eq(
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* other = positionalParameters->getAt(context, 0);
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoObject* otherData = other->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
+    const proto::ProtoObject* otherData = dataAttribute(context, other);
     const proto::ProtoTuple* tup = (data && data != PROTO_NONE && data->asTuple(context)) ? data->asTuple(context) : self->asTuple(context);
     const proto::ProtoTuple* otherTup = (otherData && otherData != PROTO_NONE && otherData->asTuple(context)) ? otherData->asTuple(context) : other->asTuple(context);
     const proto::ProtoList* list = tup ? tup->asList(context) : nullptr;
@@ -1238,11 +1174,9 @@ static const proto::ProtoObject* py_list_bool(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
-    if (!list) return PROTO_FALSE;
-    return list->getSize(context) > 0 ? PROTO_TRUE : PROTO_FALSE;
+    unsigned long size = 0;
+    if (!listSize(context, self, &size)) return PROTO_FALSE;
+    return size > 0 ? PROTO_TRUE : PROTO_FALSE;
 }
 
 static bool list_elem_equal(proto::ProtoContext* context, const proto::ProtoObject* elem, const proto::ProtoObject* value) {
@@ -1266,8 +1200,21 @@ static const proto::ProtoObject* py_list_pop(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
+    const proto::ProtoObject* idxObj = positionalParameters && positionalParameters->getSize(context) > 0
+        ? positionalParameters->getAt(context, 0) : nullptr;
+    const bool last = !idxObj || (idxObj->isInteger(context) && idxObj->asLong(context) == -1);
+    if (ListBuffer* buffer = last ? listBuffer(context, self) : nullptr) {
+        const proto::ProtoObject* item = nullptr;
+        if (buffer->popLast(context, &item)) {
+            if (item) return item;
+            PythonEnvironment* env = PythonEnvironment::fromContext(context);
+            if (env) env->raiseIndexError(context, "pop from empty list");
+            return PROTO_NONE;
+        }
+    }
+
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     
@@ -1316,40 +1263,19 @@ static const proto::ProtoObject* py_list_extend(
     const proto::ProtoObject* otherObj = positionalParameters->getAt(context, 0);
     if (!otherObj) return PROTO_NONE;
 
-    const proto::ProtoList* otherList = otherObj->asList(context);
-    const proto::ProtoTuple* otherTuple = nullptr;
-    if (!otherList) {
-        otherTuple = otherObj->asTuple(context);
+    // Copied first, so l.extend(l) appends the original items once.
+    std::vector<const proto::ProtoObject*> items;
+    if (!listItems(context, otherObj, &items)) {
+        const proto::ProtoTuple* otherTuple = otherObj->asTuple(context);
         if (!otherTuple) {
-            const proto::ProtoObject* otherData = otherObj->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"));
-            if (otherData) {
-                otherList = otherData->asList(context);
-                if (!otherList) otherTuple = otherData->asTuple(context);
-            }
-        }
-    }
-    
-    // Get the current list from self
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return PROTO_NONE;
-    const proto::ProtoList* list = data->asList(context);
-    
-    if (!otherList && !otherTuple) return PROTO_NONE;
-    
-    const proto::ProtoList* newList = list;
-    if (otherList) {
-        unsigned long otherSize = otherList->getSize(context);
-        for (unsigned long i = 0; i < otherSize; ++i) {
-            newList = newList->appendLast(context, otherList->getAt(context, static_cast<int>(i)));
+            const proto::ProtoObject* otherData = dataAttribute(context, otherObj);
+            if (otherData) otherTuple = otherData->asTuple(context);
         }
-    } else if (otherTuple) {
+        if (!otherTuple) return PROTO_NONE;
         unsigned long otherSize = otherTuple->getSize(context);
-        for (unsigned long i = 0; i < otherSize; ++i) {
-            newList = newList->appendLast(context, otherTuple->getAt(context, static_cast<int>(i)));
-        }
+        for (unsigned long i = 0; i < otherSize; ++i) items.push_back(otherTuple->getAt(context, static_cast<int>(i)));
     }
-    self->setAttribute(context, dataName, newList->asObject(context));
+    listExtend(context, self, items);
     return PROTO_NONE;
 }
 
@@ -1364,23 +1290,9 @@ static const proto::ProtoObject* py_list_iadd(
     const proto::ProtoObject* otherObj = positionalParameters->getAt(context, 0);
     if (!otherObj) return PROTO_NONE;
 
-    const proto::ProtoList* otherList = otherObj->asList(context);
-    if (!otherList) {
-        const proto::ProtoObject* otherData = otherObj->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"));
-        if (otherData) otherList = otherData->asList(context);
-    }
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    if (!data || !data->asList(context)) return PROTO_NONE;
-    const proto::ProtoList* list = data->asList(context);
-    if (!otherList) return PROTO_NONE;
-
-    const proto::ProtoList* newList = list;
-    unsigned long otherSize = otherList->getSize(context);
-    for (unsigned long i = 0; i < otherSize; ++i) {
-        newList = newList->appendLast(context, otherList->getAt(context, static_cast<int>(i)));
-    }
-    const_cast<proto::ProtoObject*>(self)->setAttribute(context, dataName, newList->asObject(context));
+    std::vector<const proto::ProtoObject*> items;
+    if (!listItems(context, otherObj, &items)) return PROTO_NONE;
+    if (!listExtend(context, self, items)) return PROTO_NONE;
     return self;
 }
 
@@ -1394,7 +1306,7 @@ static const proto::ProtoObject* py_list_reverse(
     (void)positionalParameters;
     (void)keywordParameters;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     unsigned long size = list->getSize(context);
@@ -1415,7 +1327,7 @@ static const proto::ProtoObject* py_list_sort(
     (void)positionalParameters;
     (void)keywordParameters;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     unsigned long size = list->getSize(context);
@@ -1440,7 +1352,7 @@ static const proto::ProtoObject* py_list_insert(
     const proto::ProtoSparseList* keywordParameters) {
     if (positionalParameters->getSize(context) < 2) return PROTO_NONE;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     int index = static_cast<int>(positionalParameters->getAt(context, 0)->asLong(context));
@@ -1462,7 +1374,7 @@ static const proto::ProtoObject* py_list_remove(
     const proto::ProtoSparseList* keywordParameters) {
     if (!positionalParameters || positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -1486,8 +1398,10 @@ static const proto::ProtoObject* py_list_clear(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    self->setAttribute(context, dataName, context->newList()->asObject(context));
+    if (ListBuffer* buffer = listBuffer(context, self)) {
+        if (buffer->clear(context)) return PROTO_NONE;
+    }
+    setDataAttribute(context, self, context->newList()->asObject(context));
     return PROTO_NONE;
 }
 
@@ -1497,8 +1411,12 @@ static const proto::ProtoObject* py_list_copy(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
+    if (listBuffer(context, self)) {
+        std::vector<const proto::ProtoObject*> items;
+        if (listItems(context, self, &items)) return newListObject(context, std::move(items));
+    }
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
@@ -1518,7 +1436,7 @@ static const proto::ProtoObject* py_list_mul(
     long long n = other->asLong(context);
     if (n < 0) n = 0;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
@@ -1541,8 +1459,7 @@ static const proto::ProtoObject* py_list_index(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     if (!positionalParameters || positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return PROTO_NONE;
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -1570,8 +1487,7 @@ static const proto::ProtoObject* py_list_count(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     if (!positionalParameters || positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoList* list = data && data->asList(context) ? data->asList(context) : nullptr;
     if (!list) return context->fromInteger(0);
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -1649,8 +1565,7 @@ static const proto::ProtoObject* py_bytes_repr(
 }
 
 static const proto::ProtoString* bytes_data(proto::ProtoContext* context, const proto::ProtoObject* self) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     return data && data->isString(context) ? data->asString(context) : nullptr;
 }
 
@@ -1810,11 +1725,10 @@ static const proto::ProtoObject* py_list_call(
 
     if (positionalParameters && positionalParameters->getSize(context) >= 1) {
         const proto::ProtoObject* iterable = positionalParameters->getAt(context, 0);
-        const proto::ProtoList* otherL = iterable->asList(context);
-        if (otherL) {
-            unsigned long sz = otherL->getSize(context);
-            for (unsigned long i = 0; i < sz; ++i) {
-                l = const_cast<proto::ProtoList*>(l->appendLast(context, otherL->getAt(context, static_cast<int>(i))));
+        std::vector<const proto::ProtoObject*> items;
+        if (listItems(context, iterable, &items)) {
+            for (const proto::ProtoObject* item : items) {
+                l = const_cast<proto::ProtoList*>(l->appendLast(context, item));
             }
         } else {
             const proto::ProtoTuple* otherT = iterable->asTuple(context);
@@ -1873,11 +1787,10 @@ static const proto::ProtoObject* py_tuple_call(
 
     if (positionalParameters && positionalParameters->getSize(context) >= 1) {
         const proto::ProtoObject* iterable = positionalParameters->getAt(context, 0);
-        const proto::ProtoList* otherL = iterable->asList(context);
-        if (otherL) {
-            unsigned long sz = otherL->getSize(context);
-            for (unsigned long i = 0; i < sz; ++i) {
-                l = const_cast<proto::ProtoList*>(l->appendLast(context, otherL->getAt(context, static_cast<int>(i))));
+        std::vector<const proto::ProtoObject*> items;
+        if (listItems(context, iterable, &items)) {
+            for (const proto::ProtoObject* item : items) {
+                l = const_cast<proto::ProtoList*>(l->appendLast(context, item));
             }
         } else {
             const proto::ProtoTuple* otherT = iterable->asTuple(context);
@@ -1921,18 +1834,22 @@ static const proto::ProtoObject* py_dict_call(
     const proto::ProtoSparseList* keywordParameters) {
     (void)parentLink;
 
-    proto::ProtoObject* instance = const_cast<proto::ProtoObject*>(self->newChild(context, true));
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
-    const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoString* keysName = env ? env->getKeysString() : proto::ProtoString::fromUTF8String(context, "__keys__");
-    proto::ProtoSparseList* d = const_cast<proto::ProtoSparseList*>(context->newSparseList());
-    proto::ProtoList* keysList = const_cast<proto::ProtoList*>(context->newList());
+    const proto::ProtoObject* instance = newDict(context, self);
 
     if (positionalParameters && positionalParameters->getSize(context) >= 1) {
         const proto::ProtoObject* iterable = positionalParameters->getAt(context, 0);
         const proto::ProtoString* iterS = env ? env->getIterString() : proto::ProtoString::fromUTF8String(context, "__iter__");
         const proto::ProtoObject* iterM = iterable->getAttribute(context, iterS);
-        if (iterM && iterM->asMethod(context)) {
+        if (isDictLike(context, iterable)) {
+            // dict(mapping): iterating a dict yields keys, so copy its entries instead.
+            const proto::ProtoList* entries = dictEntries(context, iterable);
+            const unsigned long n = entries->getSize(context);
+            for (unsigned long i = 0; i + 1 < n; i += 2) {
+                if (!dictSet(context, instance, entries->getAt(context, static_cast<int>(i)), entries->getAt(context, static_cast<int>(i + 1))))
+                    return PROTO_NONE;
+            }
+        } else if (iterM && iterM->asMethod(context)) {
             const proto::ProtoList* emptyL = env ? env->getEmptyList() : context->newList();
             const proto::ProtoObject* it = iterM->asMethod(context)(context, iterable, nullptr, emptyL, nullptr);
             if (it && it != PROTO_NONE) {
@@ -1955,13 +1872,7 @@ static const proto::ProtoObject* py_dict_call(
                             v = pairT->getAt(context, 1);
                         }
                         
-                        if (k && v) {
-                            unsigned long hash = k->getHash(context);
-                            if (!d->has(context, hash)) {
-                                keysList = const_cast<proto::ProtoList*>(keysList->appendLast(context, k));
-                            }
-                            d = const_cast<proto::ProtoSparseList*>(d->setAt(context, hash, v));
-                        }
+                        if (k && v && !dictSet(context, instance, k, v)) return PROTO_NONE;
                     }
                 }
             }
@@ -1977,18 +1888,11 @@ static const proto::ProtoObject* py_dict_call(
                 const proto::ProtoString* ks = keyObj->asString(context);
                 unsigned long hash = ks->getHash(context);
                 const proto::ProtoObject* val = keywordParameters->getAt(context, hash);
-                if (val) {
-                    if (!d->has(context, hash)) {
-                        keysList = const_cast<proto::ProtoList*>(keysList->appendLast(context, keyObj));
-                    }
-                    d = const_cast<proto::ProtoSparseList*>(d->setAt(context, hash, val));
-                }
+                if (val) dictSet(context, instance, keyObj, val);
             }
         }
     }
 
-    instance->setAttribute(context, dataName, d->asObject(context));
-    instance->setAttribute(context, keysName, keysList->asObject(context));
     instance->setAttribute(context, env ? env->getClassString() : proto::ProtoString::fromUTF8String(context, "__class__"), self);
     return instance;
 }
@@ -2013,7 +1917,7 @@ static const proto::ProtoObject* py_set_len(
     const proto::ProtoSet* s = self->asSet(context);
     if (!s) {
         PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        const proto::ProtoObject* data = self->getAttribute(context, env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__"));
+        const proto::ProtoObject* data = dataAttribute(context, self);
         s = data ? data->asSet(context) : nullptr;
     }
     if (!s) return context->fromInteger(0);
@@ -2029,7 +1933,7 @@ static const proto::ProtoObject* py_set_contains(
     const proto::ProtoSet* s = self->asSet(context);
     if (!s) {
         PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        const proto::ProtoObject* data = self->getAttribute(context, env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__"));
+        const proto::ProtoObject* data = dataAttribute(context, self);
         s = data ? data->asSet(context) : nullptr;
     }
     if (!s || positionalParameters->getSize(context) < 1) return PROTO_FALSE;
@@ -2045,7 +1949,7 @@ static const proto::ProtoObject* py_set_bool(
     const proto::ProtoSet* s = self->asSet(context);
     if (!s) {
         PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        const proto::ProtoObject* data = self->getAttribute(context, env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__"));
+        const proto::ProtoObject* data = dataAttribute(context, self);
         s = data ? data->asSet(context) : nullptr;
     }
     if (!s) return PROTO_FALSE;
@@ -2060,7 +1964,7 @@ static const proto::ProtoObject* py_set_add(
     const proto::ProtoSparseList* keywordParameters) {
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoSet* s = data && data->asSet(context) ? data->asSet(context) : context->newSet();
     const proto::ProtoSet* newSet = s->add(context, positionalParameters->getAt(context, 0));
     self->setAttribute(context, dataName, newSet->asObject(context));
@@ -2075,7 +1979,7 @@ static const proto::ProtoObject* py_set_remove(
     const proto::ProtoSparseList* keywordParameters) {
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoSet* s = data && data->asSet(context) ? data->asSet(context) : context->newSet();
     const proto::ProtoSet* newSet = s->remove(context, positionalParameters->getAt(context, 0));
     self->setAttribute(context, dataName, newSet->asObject(context));
@@ -2398,7 +2302,7 @@ static const proto::ProtoObject* py_set_pop(
     if (!it || !it->hasNext(context)) return PROTO_NONE;
     const proto::ProtoObject* value = it->next(context);
     const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     const proto::ProtoSet* current = data && data->asSet(context) ? data->asSet(context) : context->newSet();
     const proto::ProtoSet* newSet = current->remove(context, value);
     self->setAttribute(context, dataName, newSet->asObject(context));
@@ -2597,7 +2501,7 @@ static const proto::ProtoObject* py_int_hash(
 
 static const proto::ProtoString* bytes_from_object(proto::ProtoContext* context, const proto::ProtoObject* obj) {
     if (obj->isString(context)) return obj->asString(context);
-    const proto::ProtoObject* data = obj->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"));
+    const proto::ProtoObject* data = dataAttribute(context, obj);
     return data && data->isString(context) ? data->asString(context) : nullptr;
 }
 
@@ -2664,8 +2568,7 @@ static const proto::ProtoObject* py_tuple_hash(
     proto::ProtoContext* context,
     const proto::ProtoObject* self,
     const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return context->fromInteger(0);
     const proto::ProtoTuple* t = data->asTuple(context);
     unsigned long h = 0x345678UL;
@@ -2683,8 +2586,7 @@ static const proto::ProtoObject* py_tuple_len(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return context->fromInteger(0);
     return context->fromInteger(data->asTuple(context)->getSize(context));
 }
@@ -2695,8 +2597,7 @@ static const proto::ProtoObject* py_tuple_getitem(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return PROTO_NONE;
     const proto::ProtoTuple* tuple = data->asTuple(context);
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
@@ -2721,8 +2622,7 @@ static const proto::ProtoObject* py_tuple_iter(
     const proto::ProtoTuple* tuple = self->asTuple(context);
     const proto::ProtoObject* data = self;
     if (!tuple) {
-        const proto::ProtoString* dataName = env ? env->getDataString() : proto::ProtoString::fromUTF8String(context, "__data__");
-        data = self->getAttribute(context, dataName);
+        data = dataAttribute(context, self);
         if (data) tuple = data->asTuple(context);
     }
     if (!tuple) return PROTO_NONE;
@@ -2763,8 +2663,7 @@ static const proto::ProtoObject* py_tuple_contains(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return PROTO_FALSE;
     if (positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -2777,8 +2676,7 @@ static const proto::ProtoObject* py_tuple_bool(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return PROTO_FALSE;
     return data->asTuple(context)->getSize(context) > 0 ? PROTO_TRUE : PROTO_FALSE;
 }
@@ -2790,8 +2688,7 @@ static const proto::ProtoObject* py_tuple_index(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     if (!positionalParameters || positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return PROTO_NONE;
     const proto::ProtoTuple* tuple = data->asTuple(context);
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -2819,8 +2716,7 @@ static const proto::ProtoObject* py_tuple_count(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     if (!positionalParameters || positionalParameters->getSize(context) < 1) return context->fromInteger(0);
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
+    const proto::ProtoObject* data = dataAttribute(context, self);
     if (!data || !data->asTuple(context)) return context->fromInteger(0);
     const proto::ProtoTuple* tuple = data->asTuple(context);
     const proto::ProtoObject* value = positionalParameters->getAt(context, 0);
@@ -2948,16 +2844,18 @@ static const proto::ProtoObject* py_bytes_find(
         needle = static_cast<char>(static_cast<unsigned char>(v));
     } else if (sub->isString(context)) {
         sub->asString(context)->toUTF8String(context, needle);
-    } else if (sub->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    } else if (dataAttribute(context, sub)) {
         const proto::ProtoString* subStr = bytes_data(context, sub);
         if (!subStr) return context->fromInteger(-1);
         subStr->toUTF8String(context, needle);
     } else
         return context->fromInteger(-1);
-    size_t pos = haystack.find(needle, static_cast<size_t>(start));
-    if (pos == std::string::npos || static_cast<long long>(pos) >= end)
+    if (start < 0 || start > static_cast<long long>(haystack.size())) return context->fromInteger(-1);
+    const size_t found = findSubstring(haystack.data() + start, haystack.size() - static_cast<size_t>(start),
+                                       needle.data(), needle.size());
+    if (found == kNotFound || start + static_cast<long long>(found) >= end)
         return context->fromInteger(-1);
-    return context->fromInteger(static_cast<long long>(pos));
+    return context->fromInteger(start + static_cast<long long>(found));
 }
 
 static const proto::ProtoObject* py_bytes_count(
@@ -2979,20 +2877,19 @@ static const proto::ProtoObject* py_bytes_count(
         long long v = sub->asLong(context);
         if (v < 0 || v > 255) return context->fromInteger(0);
         needle = static_cast<char>(static_cast<unsigned char>(v));
-    } else if (sub->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    } else if (dataAttribute(context, sub)) {
         const proto::ProtoString* subStr = bytes_data(context, sub);
         if (!subStr) return context->fromInteger(0);
         subStr->toUTF8String(context, needle);
     } else
         return context->fromInteger(0);
-    size_t count = 0;
-    size_t pos = static_cast<size_t>(start);
-    while (pos < haystack.size() && static_cast<long long>(pos) < end) {
-        size_t found = haystack.find(needle, pos);
-        if (found == std::string::npos || static_cast<long long>(found) >= end) break;
-        count++;
-        pos = found + (needle.empty() ? 1 : needle.size());
-    }
+    // Counts matches that start in [start, end).
+    const long long size = static_cast<long long>(haystack.size());
+    if (start < 0 || start >= size || end <= start) return context->fromInteger(0);
+    if (needle.empty()) return context->fromInteger(std::min(size, end) - start);
+    const long long limit = std::min(size, end + static_cast<long long>(needle.size()) - 1);
+    const size_t count = countSubstring(haystack.data() + start, static_cast<size_t>(limit - start),
+                                        needle.data(), needle.size());
     return context->fromInteger(static_cast<long long>(count));
 }
 
@@ -3002,7 +2899,7 @@ static void bytes_needle_from_arg(proto::ProtoContext* context, const proto::Pro
         if (v >= 0 && v <= 255) out = static_cast<char>(static_cast<unsigned char>(v));
     } else if (arg->isString(context)) {
         arg->asString(context)->toUTF8String(context, out);
-    } else if (arg->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    } else if (dataAttribute(context, arg)) {
         const proto::ProtoString* subStr = bytes_data(context, arg);
         if (subStr) subStr->toUTF8String(context, out);
     }
@@ -3084,7 +2981,7 @@ static const proto::ProtoObject* py_bytes_rfind(
         long long v = sub->asLong(context);
         if (v < 0 || v > 255) return context->fromInteger(-1);
         needle = static_cast<char>(static_cast<unsigned char>(v));
-    } else if (sub->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    } else if (dataAttribute(context, sub)) {
         const proto::ProtoString* subStr = bytes_data(context, sub);
         if (!subStr) return context->fromInteger(-1);
         subStr->toUTF8String(context, needle);
@@ -3093,9 +2990,8 @@ static const proto::ProtoObject* py_bytes_rfind(
     if (start >= end || static_cast<size_t>(start) >= haystack.size())
         return context->fromInteger(-1);
     size_t len = static_cast<size_t>(std::min(end, static_cast<long long>(haystack.size())) - start);
-    std::string slice = haystack.substr(static_cast<size_t>(start), len);
-    size_t found = slice.rfind(needle);
-    if (found == std::string::npos)
+    const size_t found = findLastSubstring(haystack.data() + start, len, needle.data(), needle.size());
+    if (found == kNotFound)
         return context->fromInteger(-1);
     return context->fromInteger(static_cast<long long>(start) + static_cast<long long>(found));
 }
@@ -3131,11 +3027,11 @@ static const proto::ProtoObject* py_bytes_replace(
     size_t start = 0;
     long long n = 0;
     while (count < 0 || n < count) {
-        size_t pos = raw.find(old_str, start);
-        if (pos == std::string::npos) break;
-        out += raw.substr(start, pos - start);
+        const size_t found = findSubstring(raw.data() + start, raw.size() - start, old_str.data(), old_str.size());
+        if (found == kNotFound) break;
+        out.append(raw, start, found);
         out += new_str;
-        start = pos + old_str.size();
+        start += found + old_str.size();
         n++;
     }
     out += raw.substr(start);
@@ -3249,7 +3145,7 @@ static const proto::ProtoObject* py_bytes_lstrip(
     std::string raw;
     s->toUTF8String(context, raw);
     std::string chars;
-    if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    if (posArgs && posArgs->getSize(context) >= 1 && dataAttribute(context, posArgs->getAt(context, 0))) {
         const proto::ProtoString* chStr = bytes_data(context, posArgs->getAt(context, 0));
         if (chStr) chStr->toUTF8String(context, chars);
     }
@@ -3273,7 +3169,7 @@ static const proto::ProtoObject* py_bytes_rstrip(
     std::string raw;
     s->toUTF8String(context, raw);
     std::string chars;
-    if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    if (posArgs && posArgs->getSize(context) >= 1 && dataAttribute(context, posArgs->getAt(context, 0))) {
         const proto::ProtoString* chStr = bytes_data(context, posArgs->getAt(context, 0));
         if (chStr) chStr->toUTF8String(context, chars);
     }
@@ -3297,7 +3193,7 @@ static const proto::ProtoObject* py_bytes_strip(
     std::string raw;
     s->toUTF8String(context, raw);
     std::string chars;
-    if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    if (posArgs && posArgs->getSize(context) >= 1 && dataAttribute(context, posArgs->getAt(context, 0))) {
         const proto::ProtoString* chStr = bytes_data(context, posArgs->getAt(context, 0));
         if (chStr) chStr->toUTF8String(context, chars);
     }
@@ -3320,7 +3216,7 @@ static std::string bytes_sep_from_arg(proto::ProtoContext* context, const proto:
         if (v < 0 || v > 255) return " ";
         return std::string(1, static_cast<char>(static_cast<unsigned char>(v)));
     }
-    if (arg->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+    if (dataAttribute(context, arg)) {
         const proto::ProtoString* s = bytes_data(context, arg);
         if (s) { std::string r; s->toUTF8String(context, r); return r; }
     }
@@ -3344,17 +3240,17 @@ static const proto::ProtoObject* py_bytes_split(
     const proto::ProtoList* result = context->newList();
     size_t start = 0;
     for (;;) {
-        size_t pos = raw.find(sep, start);
-        if (pos == std::string::npos) {
+        const size_t found = findSubstring(raw.data() + start, raw.size() - start, sep.data(), sep.size());
+        if (found == kNotFound) {
             proto::ProtoObject* b = const_cast<proto::ProtoObject*>(bytesProto->newChild(context, true));
             b->setAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"), context->fromUTF8String(raw.substr(start).c_str()));
             result = result->appendLast(context, b);
             break;
         }
         proto::ProtoObject* b = const_cast<proto::ProtoObject*>(bytesProto->newChild(context, true));
-        b->setAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"), context->fromUTF8String(raw.substr(start, pos - start).c_str()));
+        b->setAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"), context->fromUTF8String(raw.substr(start, found).c_str()));
         result = result->appendLast(context, b);
-        start = pos + sep.size();
+        start += found + sep.size();
     }
     return result->asObject(context);
 }
@@ -3384,7 +3280,7 @@ static const proto::ProtoObject* py_bytes_join(
         if (item->isInteger(context)) {
             long long v = item->asLong(context);
             if (v >= 0 && v <= 255) out += static_cast<char>(static_cast<unsigned char>(v));
-        } else if (item->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"))) {
+        } else if (dataAttribute(context, item)) {
             const proto::ProtoString* bs = bytes_data(context, item);
             if (bs) { std::string p; bs->toUTF8String(context, p); out += p; }
         }
@@ -3400,7 +3296,7 @@ static const proto::ProtoObject* py_bytes_join(
 
 static const proto::ProtoString* str_from_self(proto::ProtoContext* context, const proto::ProtoObject* self) {
     if (self->isString(context)) return self->asString(context);
-    const proto::ProtoObject* data = self->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__data__"));
+    const proto::ProtoObject* data = dataAttribute(context, self);
     return data && data->isString(context) ? data->asString(context) : nullptr;
 }
 
@@ -3426,11 +3322,12 @@ static const proto::ProtoObject* py_str_contains(
     if (!str || positionalParameters->getSize(context) < 1) return PROTO_FALSE;
     const proto::ProtoObject* item = positionalParameters->getAt(context, 0);
     if (!item->isString(context)) return PROTO_FALSE;
-    std::string haystack;
-    str->toUTF8String(context, haystack);
+    FlatTextRef haystackText = flatText(context, str);
+    const std::string& haystack = haystackText->utf8;
     std::string needle;
     item->asString(context)->toUTF8String(context, needle);
-    return haystack.find(needle) != std::string::npos ? PROTO_TRUE : PROTO_FALSE;
+    return findSubstring(haystack.data(), haystack.size(), needle.data(), needle.size()) != kNotFound
+        ? PROTO_TRUE : PROTO_FALSE;
 }
 
 static bool is_ascii_whitespace(char c) {
@@ -3450,8 +3347,8 @@ static const proto::ProtoObject* py_str_find(
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || positionalParameters->getSize(context) < 1) return context->fromInteger(-1);
-    std::string haystack;
-    str->toUTF8String(context, haystack);
+    FlatTextRef haystackText = flatText(context, str);
+    const std::string& haystack = haystackText->utf8;
     const proto::ProtoObject* subObj = positionalParameters->getAt(context, 0);
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
     if (!subObj->isString(context)) {
@@ -3461,13 +3358,15 @@ static const proto::ProtoObject* py_str_find(
     std::string needle;
     subObj->asString(context)->toUTF8String(context, needle);
 
+    // start/end and the result count characters; the search runs on the UTF-8 bytes.
+    const long long length = static_cast<long long>(haystackText->length);
     long long start = 0;
-    long long end = static_cast<long long>(haystack.size());
+    long long end = length;
     if (positionalParameters->getSize(context) >= 2) {
         const proto::ProtoObject* sObj = positionalParameters->getAt(context, 1);
         if (sObj->isInteger(context)) {
             start = sObj->asLong(context);
-            if (start < 0) start += static_cast<long long>(haystack.size());
+            if (start < 0) start += length;
             if (start < 0) start = 0;
         }
     }
@@ -3475,17 +3374,19 @@ static const proto::ProtoObject* py_str_find(
         const proto::ProtoObject* eObj = positionalParameters->getAt(context, 2);
         if (eObj->isInteger(context)) {
             end = eObj->asLong(context);
-            if (end < 0) end += static_cast<long long>(haystack.size());
-            if (end > static_cast<long long>(haystack.size())) end = static_cast<long long>(haystack.size());
+            if (end < 0) end += length;
+            if (end > length) end = length;
         }
     }
 
-    if (start > static_cast<long long>(haystack.size())) return context->fromInteger(-1);
+    if (start > length) return context->fromInteger(-1);
     if (end < start) return context->fromInteger(-1);
 
-    std::string searchSpace = haystack.substr(static_cast<size_t>(start), static_cast<size_t>(end - start));
-    size_t pos = searchSpace.find(needle);
-    return context->fromInteger(pos == std::string::npos ? -1 : static_cast<long long>(pos + start));
+    const size_t from = haystackText->offsetOf(static_cast<unsigned long>(start));
+    const size_t to = haystackText->offsetOf(static_cast<unsigned long>(end));
+    const size_t pos = findSubstring(haystack.data() + from, to - from, needle.data(), needle.size());
+    if (pos == kNotFound) return context->fromInteger(-1);
+    return context->fromInteger(static_cast<long long>(haystackText->indexOf(from + pos)));
 }
 
 static const proto::ProtoObject* py_str_index(
@@ -3511,24 +3412,26 @@ static const proto::ProtoObject* py_str_rfind(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return context->fromInteger(-1);
-    std::string haystack;
-    str->toUTF8String(context, haystack);
+    FlatTextRef haystackText = flatText(context, str);
+    const std::string& haystack = haystackText->utf8;
     const proto::ProtoObject* subObj = posArgs->getAt(context, 0);
     if (!subObj->isString(context)) return context->fromInteger(-1);
     std::string needle;
     subObj->asString(context)->toUTF8String(context, needle);
-    long long start = 0, end = static_cast<long long>(haystack.size());
+    const long long length = static_cast<long long>(haystackText->length);
+    long long start = 0, end = length;
     if (posArgs->getSize(context) >= 2 && posArgs->getAt(context, 1)->isInteger(context))
         start = posArgs->getAt(context, 1)->asLong(context);
     if (posArgs->getSize(context) >= 3 && posArgs->getAt(context, 2)->isInteger(context))
         end = posArgs->getAt(context, 2)->asLong(context);
     if (start < 0) start = 0;
-    if (end > static_cast<long long>(haystack.size())) end = static_cast<long long>(haystack.size());
+    if (end > length) end = length;
     if (start >= end) return context->fromInteger(-1);
-    std::string slice = haystack.substr(static_cast<size_t>(start), static_cast<size_t>(end - start));
-    size_t found = slice.rfind(needle);
-    if (found == std::string::npos) return context->fromInteger(-1);
-    return context->fromInteger(static_cast<long long>(start) + static_cast<long long>(found));
+    const size_t from = haystackText->offsetOf(static_cast<unsigned long>(start));
+    const size_t to = haystackText->offsetOf(static_cast<unsigned long>(end));
+    const size_t found = findLastSubstring(haystack.data() + from, to - from, needle.data(), needle.size());
+    if (found == kNotFound) return context->fromInteger(-1);
+    return context->fromInteger(static_cast<long long>(haystackText->indexOf(from + found)));
 }
 
 static const proto::ProtoObject* py_str_rindex(
@@ -3552,33 +3455,28 @@ static const proto::ProtoObject* py_str_count(
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || positionalParameters->getSize(context) < 1) return context->fromInteger(0);
-    std::string haystack;
-    str->toUTF8String(context, haystack);
+    FlatTextRef haystackText = flatText(context, str);
+    const std::string& haystack = haystackText->utf8;
     const proto::ProtoObject* subObj = positionalParameters->getAt(context, 0);
     if (!subObj->isString(context)) return context->fromInteger(0);
     std::string needle;
     subObj->asString(context)->toUTF8String(context, needle);
-    if (needle.empty()) return context->fromInteger(static_cast<long long>(haystack.size()) + 1);
+    const long long length = static_cast<long long>(haystackText->length);
+    if (needle.empty()) return context->fromInteger(length + 1);
     long long start = 0;
-    long long end = static_cast<long long>(haystack.size());
+    long long end = length;
     if (positionalParameters->getSize(context) >= 2 && positionalParameters->getAt(context, 1) != PROTO_NONE)
         start = positionalParameters->getAt(context, 1)->asLong(context);
     if (positionalParameters->getSize(context) >= 3 && positionalParameters->getAt(context, 2) != PROTO_NONE)
         end = positionalParameters->getAt(context, 2)->asLong(context);
-    if (start < 0) start += static_cast<long long>(haystack.size());
-    if (end < 0) end += static_cast<long long>(haystack.size());
+    if (start < 0) start += length;
+    if (end < 0) end += length;
     if (start < 0) start = 0;
-    if (end > static_cast<long long>(haystack.size())) end = static_cast<long long>(haystack.size());
+    if (end > length) end = length;
     if (start >= end) return context->fromInteger(0);
-    size_t count = 0;
-    size_t pos = static_cast<size_t>(start);
-    const size_t endPos = static_cast<size_t>(end);
-    while (pos < endPos) {
-        size_t found = haystack.find(needle, pos);
-        if (found == std::string::npos || found >= endPos) break;
-        count++;
-        pos = found + needle.size();
-    }
+    const size_t pos = haystackText->offsetOf(static_cast<unsigned long>(start));
+    const size_t endPos = haystackText->offsetOf(static_cast<unsigned long>(end));
+    const size_t count = countSubstring(haystack.data() + pos, endPos - pos, needle.data(), needle.size());
     return context->fromInteger(static_cast<long long>(count));
 }
 
@@ -3601,14 +3499,17 @@ static const proto::ProtoObject* py_str_getitem(
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
-    long long size = static_cast<long long>(s.size());
+    // O(1) character offsets for ASCII text, a stride-index lookup otherwise.
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
+    long long size = static_cast<long long>(sText->length);
     const proto::ProtoObject* indexObj = positionalParameters->getAt(context, 0);
 
     SliceBounds sb = get_slice_bounds(context, indexObj, size);
     if (sb.isSlice && sb.step == 1) {
-        std::string sub = s.substr(static_cast<size_t>(sb.start), static_cast<size_t>(sb.stop - sb.start));
+        const size_t from = sText->offsetOf(static_cast<unsigned long>(sb.start));
+        const size_t to = sText->offsetOf(static_cast<unsigned long>(sb.stop));
+        std::string sub = s.substr(from, to - from);
         return context->fromUTF8String(sub.c_str());
     }
 
@@ -3623,15 +3524,18 @@ static const proto::ProtoObject* py_str_getitem(
         if (start < 0) start = 0;
         if (stop > size) stop = size;
         if (start > stop) start = stop;
-        std::string sub = s.substr(static_cast<size_t>(start), static_cast<size_t>(stop - start));
+        const size_t from = sText->offsetOf(static_cast<unsigned long>(start));
+        const size_t to = sText->offsetOf(static_cast<unsigned long>(stop));
+        std::string sub = s.substr(from, to - from);
         return context->fromUTF8String(sub.c_str());
     }
 
-    int idx = static_cast<int>(indexObj->asLong(context));
-    if (idx < 0) idx += static_cast<int>(size);
-    if (idx < 0 || static_cast<unsigned long>(idx) >= s.size()) return PROTO_NONE;
-    char c[2] = { s[static_cast<size_t>(idx)], '\0' };
-    return context->fromUTF8String(c);
+    long long idx = indexObj->asLong(context);
+    if (idx < 0) idx += size;
+    if (idx < 0 || idx >= size) return PROTO_NONE;
+    const size_t at = sText->offsetOf(static_cast<unsigned long>(idx));
+    std::string c = s.substr(at, sText->charBytes(at));
+    return context->fromUTF8String(c.c_str());
 }
 
 static const proto::ProtoObject* py_slice_call(
@@ -3690,9 +3594,7 @@ static const proto::ProtoObject* py_str_upper(
     if (!str) return PROTO_NONE;
     std::string s;
     str->toUTF8String(context, s);
-    for (char& c : s) {
-        if (c >= 'a' && c <= 'z') c -= 32;
-    }
+    asciiUpper(s.data(), s.size());
     return context->fromUTF8String(s.c_str());
 }
 
@@ -3704,8 +3606,8 @@ static const proto::ProtoObject* py_str_format(
     const proto::ProtoSparseList* keywordParameters) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string tpl;
-    str->toUTF8String(context, tpl);
+    FlatTextRef tplText = flatText(context, str);
+    const std::string& tpl = tplText->utf8;
     std::string out;
     unsigned long idx = 0;
     for (size_t i = 0; i < tpl.size(); ++i) {
@@ -3739,9 +3641,7 @@ static const proto::ProtoObject* py_str_lower(
     if (!str) return PROTO_NONE;
     std::string s;
     str->toUTF8String(context, s);
-    for (char& c : s) {
-        if (c >= 'A' && c <= 'Z') c += 32;
-    }
+    asciiLower(s.data(), s.size());
     return context->fromUTF8String(s.c_str());
 }
 
@@ -3751,8 +3651,8 @@ static const proto::ProtoObject* py_str_split(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
 
     const proto::ProtoObject* sepObj = (posArgs && posArgs->getSize(context) >= 1) ? posArgs->getAt(context, 0) : nullptr;
     PythonEnvironment* env = PythonEnvironment::fromContext(context);
@@ -3783,10 +3683,14 @@ static const proto::ProtoObject* py_str_split(
         size_t start = 0;
         int count = 0;
         while (start < s.size() && (maxsplit < 0 || count < maxsplit)) {
-            while (start < s.size() && is_ascii_whitespace(s[start])) start++;
-            if (start >= s.size()) break;
-            size_t end = start;
-            while (end < s.size() && !is_ascii_whitespace(s[end])) end++;
+            const size_t word = skipWhitespace(s.data() + start, s.size() - start);
+            if (word == kNotFound) {
+                start = s.size();
+                break;
+            }
+            start += word;
+            const size_t gap = findWhitespace(s.data() + start, s.size() - start);
+            const size_t end = gap == kNotFound ? s.size() : start + gap;
             result = result->appendLast(context, context->fromUTF8String(s.substr(start, end - start).c_str()));
             start = end;
             count++;
@@ -3802,10 +3706,10 @@ static const proto::ProtoObject* py_str_split(
         size_t start = 0;
         int count = 0;
         while (maxsplit < 0 || count < maxsplit) {
-            size_t pos = s.find(sep, start);
-            if (pos == std::string::npos) break;
-            result = result->appendLast(context, context->fromUTF8String(s.substr(start, pos - start).c_str()));
-            start = pos + sep.size();
+            const size_t found = findSubstring(s.data() + start, s.size() - start, sep.data(), sep.size());
+            if (found == kNotFound) break;
+            result = result->appendLast(context, context->fromUTF8String(s.substr(start, found).c_str()));
+            start += found + sep.size();
             count++;
         }
         result = result->appendLast(context, context->fromUTF8String(s.substr(start).c_str()));
@@ -3824,8 +3728,8 @@ static const proto::ProtoObject* py_str_rsplit(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string sep = " ";
     if (posArgs->getSize(context) >= 1) {
         const proto::ProtoObject* sepObj = posArgs->getAt(context, 0);
@@ -3865,8 +3769,8 @@ static const proto::ProtoObject* py_str_splitlines(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     bool keepends = false;
     if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->isInteger(context))
         keepends = posArgs->getAt(context, 0)->asLong(context) != 0;
@@ -3874,20 +3778,21 @@ static const proto::ProtoObject* py_str_splitlines(
     size_t start = 0;
     size_t i = 0;
     while (i < s.size()) {
+        const size_t lineBreak = findLineBreak(s.data() + i, s.size() - i);
+        if (lineBreak == kNotFound) break;
+        i += lineBreak;
         if (s[i] == '\n') {
             std::string line = s.substr(start, i - start);
             if (keepends) line += '\n';
             result = result->appendLast(context, context->fromUTF8String(line.c_str()));
             start = i + 1;
             i++;
-        } else if (s[i] == '\r') {
+        } else {
             std::string line = s.substr(start, i - start);
             if (keepends) line += (i + 1 < s.size() && s[i + 1] == '\n') ? "\r\n" : "\r";
             result = result->appendLast(context, context->fromUTF8String(line.c_str()));
             i = (i + 1 < s.size() && s[i + 1] == '\n') ? i + 2 : i + 1;
             start = i;
-        } else {
-            i++;
         }
     }
     result = result->appendLast(context, context->fromUTF8String(s.substr(start).c_str()));
@@ -3902,8 +3807,8 @@ static const proto::ProtoObject* py_str_strip(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string chars;
     if (posArgs && posArgs->getSize(context) >= 1) {
         const proto::ProtoObject* charsObj = posArgs->getAt(context, 0);
@@ -3931,8 +3836,8 @@ static const proto::ProtoObject* py_str_lstrip(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string chars;
     if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->isString(context))
         posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, chars);
@@ -3947,8 +3852,8 @@ static const proto::ProtoObject* py_str_rstrip(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string chars;
     if (posArgs && posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->isString(context))
         posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, chars);
@@ -3963,8 +3868,8 @@ static const proto::ProtoObject* py_str_removeprefix(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || !posArgs || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string prefix;
     if (posArgs->getAt(context, 0)->isString(context))
         posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, prefix);
@@ -3979,8 +3884,8 @@ static const proto::ProtoObject* py_str_removesuffix(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || !posArgs || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string suffix;
     if (posArgs->getAt(context, 0)->isString(context))
         posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, suffix);
@@ -3995,8 +3900,8 @@ static const proto::ProtoObject* py_str_startswith(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || !posArgs || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
 
     long long start = 0;
     long long end = static_cast<long long>(s.size());
@@ -4046,8 +3951,8 @@ static const proto::ProtoObject* py_str_endswith(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || !posArgs || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
 
     long long start = 0;
     long long end = static_cast<long long>(s.size());
@@ -4097,8 +4002,8 @@ static const proto::ProtoObject* py_str_replace(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || !posArgs || posArgs->getSize(context) < 2) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
 
     const proto::ProtoObject* oldObj = posArgs->getAt(context, 0);
     const proto::ProtoObject* newObj = posArgs->getAt(context, 1);
@@ -4137,15 +4042,15 @@ static const proto::ProtoObject* py_str_replace(
     size_t pos = 0;
     int replaced = 0;
     while (pos < s.size() && (count < 0 || replaced < count)) {
-        size_t found = s.find(oldStr, pos);
-        if (found == std::string::npos) {
-            result += s.substr(pos);
+        const size_t found = findSubstring(s.data() + pos, s.size() - pos, oldStr.data(), oldStr.size());
+        if (found == kNotFound) {
+            result.append(s, pos, std::string::npos);
             pos = s.size();
             break;
         }
-        result += s.substr(pos, found - pos);
+        result.append(s, pos, found);
         result += newStr;
-        pos = found + oldStr.size();
+        pos += found + oldStr.size();
         replaced++;
     }
     if (pos < s.size())
@@ -4159,8 +4064,8 @@ static const proto::ProtoObject* py_str_capitalize(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return context->fromUTF8String("");
     std::string r;
     r += static_cast<char>(std::toupper(static_cast<unsigned char>(s[0])));
@@ -4175,8 +4080,8 @@ static const proto::ProtoObject* py_str_title(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string r;
     bool after_boundary = true;
     for (unsigned char c : s) {
@@ -4197,8 +4102,8 @@ static const proto::ProtoObject* py_str_swapcase(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string r;
     for (unsigned char c : s) {
         if (std::isupper(c)) r += static_cast<char>(std::tolower(c));
@@ -4214,8 +4119,8 @@ static const proto::ProtoObject* py_str_casefold(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string r;
     for (unsigned char c : s)
         r += static_cast<char>(std::tolower(c));
@@ -4228,8 +4133,8 @@ static const proto::ProtoObject* py_str_isalpha(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isalpha(c)) return PROTO_FALSE;
@@ -4242,8 +4147,8 @@ static const proto::ProtoObject* py_str_isdigit(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isdigit(c)) return PROTO_FALSE;
@@ -4256,8 +4161,8 @@ static const proto::ProtoObject* py_str_isdecimal(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isdigit(c)) return PROTO_FALSE;
@@ -4270,8 +4175,8 @@ static const proto::ProtoObject* py_str_isnumeric(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isdigit(c)) return PROTO_FALSE;
@@ -4284,8 +4189,8 @@ static const proto::ProtoObject* py_str_isspace(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isspace(c)) return PROTO_FALSE;
@@ -4298,8 +4203,8 @@ static const proto::ProtoObject* py_str_isalnum(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (!std::isalnum(c)) return PROTO_FALSE;
@@ -4312,8 +4217,8 @@ static const proto::ProtoObject* py_str_isupper(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (std::isalpha(c) && !std::isupper(c)) return PROTO_FALSE;
@@ -4326,8 +4231,8 @@ static const proto::ProtoObject* py_str_islower(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     for (unsigned char c : s)
         if (std::isalpha(c) && !std::islower(c)) return PROTO_FALSE;
@@ -4340,8 +4245,8 @@ static const proto::ProtoObject* py_str_isprintable(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_TRUE;
     for (unsigned char c : s)
         if (!std::isprint(c)) return PROTO_FALSE;
@@ -4354,8 +4259,8 @@ static const proto::ProtoObject* py_str_isascii(
     const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     for (unsigned char c : s)
         if (c > 127) return PROTO_FALSE;
     return PROTO_TRUE;
@@ -4367,8 +4272,8 @@ static const proto::ProtoObject* py_str_isidentifier(
     const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_FALSE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     if (s.empty()) return PROTO_FALSE;
     unsigned char c0 = static_cast<unsigned char>(s[0]);
     if (!std::isalpha(c0) && c0 != '_') return PROTO_FALSE;
@@ -4385,8 +4290,8 @@ static const proto::ProtoObject* py_str_center(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     int width = static_cast<int>(posArgs->getAt(context, 0)->asLong(context));
     char fillchar = ' ';
     if (posArgs->getSize(context) >= 2 && posArgs->getAt(context, 1)->isString(context)) {
@@ -4429,8 +4334,8 @@ static const proto::ProtoObject* py_str_rjust(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     int width = static_cast<int>(posArgs->getAt(context, 0)->asLong(context));
     char fillchar = ' ';
     if (posArgs->getSize(context) >= 2 && posArgs->getAt(context, 1)->isString(context)) {
@@ -4450,8 +4355,8 @@ static const proto::ProtoObject* py_str_expandtabs(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     int tabsize = 8;
     if (posArgs->getSize(context) >= 1 && posArgs->getAt(context, 0)->isInteger(context))
         tabsize = static_cast<int>(posArgs->getAt(context, 0)->asLong(context));
@@ -4478,8 +4383,8 @@ static const proto::ProtoObject* py_str_zfill(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     int width = static_cast<int>(posArgs->getAt(context, 0)->asLong(context));
     if (width <= static_cast<int>(s.size())) return context->fromUTF8String(s.c_str());
     size_t sign = 0;
@@ -4496,8 +4401,8 @@ static const proto::ProtoObject* py_str_partition(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string sep;
     posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, sep);
     if (sep.empty()) return PROTO_NONE;
@@ -4526,13 +4431,13 @@ static const proto::ProtoObject* py_str_rpartition(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     const proto::ProtoString* str = str_from_self(context, self);
     if (!str || posArgs->getSize(context) < 1) return PROTO_NONE;
-    std::string s;
-    str->toUTF8String(context, s);
+    FlatTextRef sText = flatText(context, str);
+    const std::string& s = sText->utf8;
     std::string sep;
     posArgs->getAt(context, 0)->asString(context)->toUTF8String(context, sep);
     if (sep.empty()) return PROTO_NONE;
-    size_t pos = s.rfind(sep);
-    if (pos == std::string::npos) {
+    size_t pos = findLastSubstring(s.data(), s.size(), sep.data(), sep.size());
+    if (pos == kNotFound) {
         const proto::ProtoList* lst = context->newList()
             ->appendLast(context, context->fromUTF8String(""))
             ->appendLast(context, context->fromUTF8String(""))
@@ -4560,7 +4465,28 @@ static const proto::ProtoObject* py_str_join(
     }
     std::string sepStr;
     sep->toUTF8String(context, sepStr);
+    const unsigned long sepChars = sep->getSize(context);
     const proto::ProtoObject* iterable = posArgs->getAt(context, 0);
+    StringBuilder out;
+    bool first = true;
+    auto addItem = [&](const proto::ProtoObject* item) {
+        if (!item->isString(context)) {
+            PythonEnvironment* env = PythonEnvironment::fromContext(context);
+            if (env) env->raiseTypeError(context, "sequence item: expected str instance");
+            return false;
+        }
+        if (!first) out.appendUTF8(context, sepStr, sepChars);
+        first = false;
+        out.append(context, item->asString(context));
+        return true;
+    };
+    std::vector<const proto::ProtoObject*> items;
+    if (listItems(context, iterable, &items)) {
+        for (const proto::ProtoObject* item : items) {
+            if (!addItem(item)) return PROTO_NONE;
+        }
+        return out.build(context)->asObject(context);
+    }
     const proto::ProtoString* iterS = proto::ProtoString::fromUTF8String(context, "__iter__");
     const proto::ProtoObject* iterM = iterable->getAttribute(context, iterS);
     if (!iterM || !iterM->asMethod(context)) {
@@ -4578,23 +4504,12 @@ static const proto::ProtoObject* py_str_join(
         return context->fromUTF8String("");
     }
     auto nextFn = nextM->asMethod(context);
-    std::string out;
-    bool first = true;
-    for (int i = 0; ; i++) {
+    for (;;) {
         const proto::ProtoObject* item = nextFn(context, it, nullptr, context->newList(), nullptr);
         if (!item || item == PROTO_NONE) break;
-        if (!item->isString(context)) {
-            PythonEnvironment* env = PythonEnvironment::fromContext(context);
-            if (env) env->raiseTypeError(context, "sequence item: expected str instance");
-            return PROTO_NONE;
-        }
-        if (!first) out += sepStr;
-        first = false;
-        std::string part;
-        item->asString(context)->toUTF8String(context, part);
-        out += part;
+        if (!addItem(item)) return PROTO_NONE;
     }
-    return context->fromUTF8String(out.c_str());
+    return out.build(context)->asObject(context);
 }
 
 static const proto::ProtoObject* py_dict_repr(
@@ -4603,25 +4518,17 @@ static const proto::ProtoObject* py_dict_repr(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return context->fromUTF8String("{}");
+    if (!isDictLike(context, self)) return context->fromUTF8String("{}");
+    const proto::ProtoList* entries = dictEntries(context, self);
 
-    unsigned long size = keys->getSize(context);
+    unsigned long size = entries->getSize(context) / 2;
     unsigned long limit = 20;
     std::string out = "{";
     for (unsigned long i = 0; i < size && i < limit; ++i) {
         if (i > 0) out += ", ";
-        const proto::ProtoObject* key = keys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* value = dict->getAt(context, key->getHash(context));
-        out += PythonEnvironment::reprObject(context, key);
+        out += PythonEnvironment::reprObject(context, entries->getAt(context, static_cast<int>(2 * i)));
         out += ": ";
-        out += PythonEnvironment::reprObject(context, value);
+        out += PythonEnvironment::reprObject(context, entries->getAt(context, static_cast<int>(2 * i + 1)));
     }
     if (size > limit) out += ", ...";
     out += "}";
@@ -4643,11 +4550,7 @@ static const proto::ProtoObject* py_dict_bool(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return PROTO_FALSE;
-    return dict->getSize(context) > 0 ? PROTO_TRUE : PROTO_FALSE;
+    return dictSize(context, self) > 0 ? PROTO_TRUE : PROTO_FALSE;
 }
 
 static const proto::ProtoObject* py_dict_keys(
@@ -4656,10 +4559,7 @@ static const proto::ProtoObject* py_dict_keys(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    return keys->asObject(context);
+    return dictKeys(context, self)->asObject(context);
 }
 
 static const proto::ProtoObject* py_dict_values(
@@ -4668,22 +4568,11 @@ static const proto::ProtoObject* py_dict_values(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return context->newList()->asObject(context);
-
+    const proto::ProtoList* entries = dictEntries(context, self);
     const proto::ProtoList* values = context->newList();
-    unsigned long size = keys->getSize(context);
-    for (unsigned long i = 0; i < size; ++i) {
-        const proto::ProtoObject* key = keys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* val = dict->getAt(context, key->getHash(context));
-        values = values->appendLast(context, val ? val : PROTO_NONE);
-    }
+    unsigned long size = entries->getSize(context);
+    for (unsigned long i = 1; i < size; i += 2)
+        values = values->appendLast(context, entries->getAt(context, static_cast<int>(i)));
     return values->asObject(context);
 }
 
@@ -4693,26 +4582,17 @@ static const proto::ProtoObject* py_dict_items(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return context->newList()->asObject(context);
-
+    const proto::ProtoList* entries = dictEntries(context, self);
     const proto::ProtoList* items = context->newList();
-    unsigned long size = keys->getSize(context);
-    for (unsigned long i = 0; i < size; ++i) {
-        const proto::ProtoObject* key = keys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* val = dict->getAt(context, key->getHash(context));
-        const proto::ProtoList* pairList = context->newList()->appendLast(context, key)->appendLast(context, val ? val : PROTO_NONE);
+    unsigned long size = entries->getSize(context);
+    for (unsigned long i = 0; i + 1 < size; i += 2) {
+        const proto::ProtoList* pairList = context->newList()
+            ->appendLast(context, entries->getAt(context, static_cast<int>(i)))
+            ->appendLast(context, entries->getAt(context, static_cast<int>(i + 1)));
         const proto::ProtoTuple* pairTuple = context->newTupleFromList(pairList);
         items = items->appendLast(context, pairTuple->asObject(context));
     }
-    const proto::ProtoObject* res = items->asObject(context);
-    return res;
+    return items->asObject(context);
 }
 
 static const proto::ProtoObject* py_dict_get(
@@ -4724,15 +4604,27 @@ static const proto::ProtoObject* py_dict_get(
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
     const proto::ProtoObject* defaultVal = positionalParameters->getSize(context) > 1 ? positionalParameters->getAt(context, 1) : PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return defaultVal;
-    unsigned long hash = key->getHash(context);
-    if (dict->has(context, hash)) {
-        return dict->getAt(context, hash);
+    const proto::ProtoObject* value = dictGet(context, self, key);
+    return value ? value : defaultVal;
+}
+
+/** Copy other's entries into dict, in other's order; false when a key's __eq__ raised. */
+static bool dict_merge(proto::ProtoContext* context, const proto::ProtoObject* dict, const proto::ProtoObject* other) {
+    if (!isDictLike(context, other)) return true;
+    const proto::ProtoList* entries = dictEntries(context, other);
+    unsigned long size = entries->getSize(context);
+    for (unsigned long i = 0; i + 1 < size; i += 2) {
+        if (!dictSet(context, dict, entries->getAt(context, static_cast<int>(i)), entries->getAt(context, static_cast<int>(i + 1))))
+            return false;
     }
-    return defaultVal;
+    return true;
+}
+
+/** A new compact dict whose parent is the first parent of like (dict or a subclass). */
+static const proto::ProtoObject* dict_new_like(proto::ProtoContext* context, const proto::ProtoObject* like, size_t capacity) {
+    const proto::ProtoList* parents = like->getParents(context);
+    const proto::ProtoObject* parent = parents && parents->getSize(context) > 0 ? parents->getAt(context, 0) : nullptr;
+    return newDict(context, parent, capacity);
 }
 
 static const proto::ProtoObject* py_dict_update(
@@ -4742,36 +4634,7 @@ static const proto::ProtoObject* py_dict_update(
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoObject* other = positionalParameters->getAt(context, 0);
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    const proto::ProtoObject* dataObj = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = dataObj && dataObj->asSparseList(context) ? dataObj->asSparseList(context) : context->newSparseList();
-
-    const proto::ProtoObject* otherKeysObj = other->getAttribute(context, keysName);
-    const proto::ProtoList* otherKeys = otherKeysObj && otherKeysObj->asList(context) ? otherKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* otherDataObj = other->getAttribute(context, dataName);
-    const proto::ProtoSparseList* otherDict = otherDataObj && otherDataObj->asSparseList(context) ? otherDataObj->asSparseList(context) : nullptr;
-
-    if (otherDict) {
-        for (unsigned long i = 0; i < otherKeys->getSize(context); ++i) {
-            const proto::ProtoObject* key = otherKeys->getAt(context, static_cast<int>(i));
-            const proto::ProtoObject* value = otherDict->getAt(context, key->getHash(context));
-            if (!value) continue;
-                unsigned long hash = key->getHash(context);
-            dict = dict->setAt(context, hash, value);
-            bool found = false;
-            for (unsigned long j = 0; j < keys->getSize(context); ++j) {
-                if (keys->getAt(context, static_cast<int>(j))->getHash(context) == hash) { found = true; break; }
-            }
-            if (!found) keys = keys->appendLast(context, key);
-        }
-    }
-    self->setAttribute(context, keysName, keys->asObject(context));
-    self->setAttribute(context, dataName, dict->asObject(context));
+    dict_merge(context, self, positionalParameters->getAt(context, 0));
     return PROTO_NONE;
 }
 
@@ -4781,10 +4644,7 @@ static const proto::ProtoObject* py_dict_clear(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    self->setAttribute(context, keysName, context->newList()->asObject(context));
-    self->setAttribute(context, dataName, context->newSparseList()->asObject(context));
+    dictClear(context, self);
     return PROTO_NONE;
 }
 
@@ -4804,26 +4664,12 @@ static const proto::ProtoObject* py_dict_fromkeys(
     const proto::ProtoObject* nextM = itObj->getAttribute(context, proto::ProtoString::fromUTF8String(context, "__next__"));
     if (!nextM || !nextM->asMethod(context)) return PROTO_NONE;
 
-    const proto::ProtoList* keysList = context->newList();
-    const proto::ProtoSparseList* sparse = context->newSparseList();
+    const proto::ProtoObject* result = newDict(context, self);
     for (;;) {
         const proto::ProtoObject* key = nextM->asMethod(context)(context, itObj, nullptr, context->newList(), nullptr);
         if (!key || key == PROTO_NONE) break;
-        unsigned long hash = key->getHash(context);
-        bool found = false;
-        for (unsigned long j = 0; j < keysList->getSize(context); ++j) {
-            if (keysList->getAt(context, static_cast<int>(j))->getHash(context) == hash) { found = true; break; }
-        }
-        if (!found) keysList = keysList->appendLast(context, key);
-        sparse = sparse->setAt(context, hash, value);
+        if (!dictSet(context, result, key, value)) return PROTO_NONE;
     }
-
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* result = context->newObject(true);
-    result = result->addParent(context, self);
-    result = result->setAttribute(context, keysName, keysList->asObject(context));
-    result = result->setAttribute(context, dataName, sparse->asObject(context));
     return result;
 }
 
@@ -4833,19 +4679,8 @@ static const proto::ProtoObject* py_dict_copy(
     const proto::ParentLink* parentLink,
     const proto::ProtoList* positionalParameters,
     const proto::ProtoSparseList* keywordParameters) {
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoObject* dataObj = self->getAttribute(context, dataName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    const proto::ProtoSparseList* dict = dataObj && dataObj->asSparseList(context) ? dataObj->asSparseList(context) : context->newSparseList();
-
-    const proto::ProtoList* parents = self->getParents(context);
-    const proto::ProtoObject* parent = parents && parents->getSize(context) > 0 ? parents->getAt(context, 0) : nullptr;
-    const proto::ProtoObject* copyObj = context->newObject(true);
-    if (parent) copyObj = copyObj->addParent(context, parent);
-    copyObj = copyObj->setAttribute(context, keysName, keys->asObject(context));
-    copyObj = copyObj->setAttribute(context, dataName, dict->asObject(context));
+    const proto::ProtoObject* copyObj = dict_new_like(context, self, dictSize(context, self));
+    if (!dict_merge(context, copyObj, self)) return PROTO_NONE;
     return copyObj;
 }
 
@@ -4855,45 +4690,8 @@ static const proto::ProtoObject* py_dict_or(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     if (posArgs->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* other = posArgs->getAt(context, 0);
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* selfKeysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* selfKeys = selfKeysObj && selfKeysObj->asList(context) ? selfKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* selfDataObj = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* selfDict = selfDataObj && selfDataObj->asSparseList(context) ? selfDataObj->asSparseList(context) : context->newSparseList();
-    const proto::ProtoList* keys = context->newList();
-    const proto::ProtoSparseList* dict = context->newSparseList();
-    for (unsigned long i = 0; i < selfKeys->getSize(context); ++i) {
-        const proto::ProtoObject* key = selfKeys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* value = selfDict->getAt(context, key->getHash(context));
-        if (!value) continue;
-        keys = keys->appendLast(context, key);
-        dict = dict->setAt(context, key->getHash(context), value);
-    }
-    const proto::ProtoObject* otherKeysObj = other->getAttribute(context, keysName);
-    const proto::ProtoList* otherKeys = otherKeysObj && otherKeysObj->asList(context) ? otherKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* otherDataObj = other->getAttribute(context, dataName);
-    const proto::ProtoSparseList* otherDict = otherDataObj && otherDataObj->asSparseList(context) ? otherDataObj->asSparseList(context) : nullptr;
-    if (otherDict) {
-        for (unsigned long i = 0; i < otherKeys->getSize(context); ++i) {
-            const proto::ProtoObject* key = otherKeys->getAt(context, static_cast<int>(i));
-            const proto::ProtoObject* value = otherDict->getAt(context, key->getHash(context));
-            if (!value) continue;
-            unsigned long hash = key->getHash(context);
-            dict = dict->setAt(context, hash, value);
-            bool found = false;
-            for (unsigned long j = 0; j < keys->getSize(context); ++j) {
-                if (keys->getAt(context, static_cast<int>(j))->getHash(context) == hash) { found = true; break; }
-            }
-            if (!found) keys = keys->appendLast(context, key);
-        }
-    }
-    const proto::ProtoList* parents = self->getParents(context);
-    const proto::ProtoObject* parent = parents && parents->getSize(context) > 0 ? parents->getAt(context, 0) : nullptr;
-    const proto::ProtoObject* result = context->newObject(true);
-    if (parent) result = result->addParent(context, parent);
-    result = result->setAttribute(context, keysName, keys->asObject(context));
-    result = result->setAttribute(context, dataName, dict->asObject(context));
+    const proto::ProtoObject* result = dict_new_like(context, self, dictSize(context, self));
+    if (!dict_merge(context, result, self) || !dict_merge(context, result, other)) return PROTO_NONE;
     return result;
 }
 
@@ -4903,45 +4701,8 @@ static const proto::ProtoObject* py_dict_ror(
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     if (posArgs->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* other = posArgs->getAt(context, 0);
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* otherKeysObj = other->getAttribute(context, keysName);
-    const proto::ProtoList* otherKeys = otherKeysObj && otherKeysObj->asList(context) ? otherKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* otherDataObj = other->getAttribute(context, dataName);
-    const proto::ProtoSparseList* otherDict = otherDataObj && otherDataObj->asSparseList(context) ? otherDataObj->asSparseList(context) : context->newSparseList();
-    const proto::ProtoList* keys = context->newList();
-    const proto::ProtoSparseList* dict = context->newSparseList();
-    for (unsigned long i = 0; i < otherKeys->getSize(context); ++i) {
-        const proto::ProtoObject* key = otherKeys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* value = otherDict->getAt(context, key->getHash(context));
-        if (!value) continue;
-        keys = keys->appendLast(context, key);
-        dict = dict->setAt(context, key->getHash(context), value);
-    }
-    const proto::ProtoObject* selfKeysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* selfKeys = selfKeysObj && selfKeysObj->asList(context) ? selfKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* selfDataObj = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* selfDict = selfDataObj && selfDataObj->asSparseList(context) ? selfDataObj->asSparseList(context) : nullptr;
-    if (selfDict) {
-        for (unsigned long i = 0; i < selfKeys->getSize(context); ++i) {
-            const proto::ProtoObject* key = selfKeys->getAt(context, static_cast<int>(i));
-            const proto::ProtoObject* value = selfDict->getAt(context, key->getHash(context));
-            if (!value) continue;
-            unsigned long hash = key->getHash(context);
-            dict = dict->setAt(context, hash, value);
-            bool found = false;
-            for (unsigned long j = 0; j < keys->getSize(context); ++j) {
-                if (keys->getAt(context, static_cast<int>(j))->getHash(context) == hash) { found = true; break; }
-            }
-            if (!found) keys = keys->appendLast(context, key);
-        }
-    }
-    const proto::ProtoList* parents = other->getParents(context);
-    const proto::ProtoObject* parent = parents && parents->getSize(context) > 0 ? parents->getAt(context, 0) : nullptr;
-    const proto::ProtoObject* result = context->newObject(true);
-    if (parent) result = result->addParent(context, parent);
-    result = result->setAttribute(context, keysName, keys->asObject(context));
-    result = result->setAttribute(context, dataName, dict->asObject(context));
+    const proto::ProtoObject* result = dict_new_like(context, other, dictSize(context, other));
+    if (!dict_merge(context, result, other) || !dict_merge(context, result, self)) return PROTO_NONE;
     return result;
 }
 
@@ -4950,43 +4711,7 @@ static const proto::ProtoObject* py_dict_ior(
     const proto::ProtoObject* self,
     const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     if (posArgs->getSize(context) < 1) return PROTO_NONE;
-    const proto::ProtoObject* other = posArgs->getAt(context, 0);
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* selfKeysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* selfKeys = selfKeysObj && selfKeysObj->asList(context) ? selfKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* selfDataObj = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* selfDict = selfDataObj && selfDataObj->asSparseList(context) ? selfDataObj->asSparseList(context) : context->newSparseList();
-    const proto::ProtoList* keys = context->newList();
-    const proto::ProtoSparseList* dict = context->newSparseList();
-    for (unsigned long i = 0; i < selfKeys->getSize(context); ++i) {
-        const proto::ProtoObject* key = selfKeys->getAt(context, static_cast<int>(i));
-        const proto::ProtoObject* value = selfDict->getAt(context, key->getHash(context));
-        if (!value) continue;
-        keys = keys->appendLast(context, key);
-        dict = dict->setAt(context, key->getHash(context), value);
-    }
-    const proto::ProtoObject* otherKeysObj = other->getAttribute(context, keysName);
-    const proto::ProtoList* otherKeys = otherKeysObj && otherKeysObj->asList(context) ? otherKeysObj->asList(context) : context->newList();
-    const proto::ProtoObject* otherDataObj = other->getAttribute(context, dataName);
-    const proto::ProtoSparseList* otherDict = otherDataObj && otherDataObj->asSparseList(context) ? otherDataObj->asSparseList(context) : nullptr;
-    if (otherDict) {
-        for (unsigned long i = 0; i < otherKeys->getSize(context); ++i) {
-            const proto::ProtoObject* key = otherKeys->getAt(context, static_cast<int>(i));
-            const proto::ProtoObject* value = otherDict->getAt(context, key->getHash(context));
-            if (!value) continue;
-            unsigned long hash = key->getHash(context);
-            dict = dict->setAt(context, hash, value);
-            bool found = false;
-            for (unsigned long j = 0; j < keys->getSize(context); ++j) {
-                if (keys->getAt(context, static_cast<int>(j))->getHash(context) == hash) { found = true; break; }
-            }
-            if (!found) keys = keys->appendLast(context, key);
-        }
-    }
-    proto::ProtoObject* mutSelf = const_cast<proto::ProtoObject*>(self);
-    mutSelf->setAttribute(context, keysName, keys->asObject(context));
-    mutSelf->setAttribute(context, dataName, dict->asObject(context));
+    if (!dict_merge(context, self, posArgs->getAt(context, 0))) return PROTO_NONE;
     return self;
 }
 
@@ -5006,21 +4731,10 @@ static const proto::ProtoObject* py_dict_setdefault(
     if (positionalParameters->getSize(context) < 1) return PROTO_NONE;
     const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
     const proto::ProtoObject* defaultVal = positionalParameters->getSize(context) > 1 ? positionalParameters->getAt(context, 1) : PROTO_NONE;
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* data = self->getAttribute(context, dataName);
-    const proto::ProtoSparseList* dict = data && data->asSparseList(context) ? data->asSparseList(context) : nullptr;
-    if (!dict) return PROTO_NONE;
-    unsigned long hash = key->getHash(context);
-    const proto::ProtoObject* existing = dict->getAt(context, hash);
+    if (!isDictLike(context, self)) return PROTO_NONE;
+    const proto::ProtoObject* existing = dictGet(context, self, key);
     if (existing) return existing;
-    const proto::ProtoSparseList* newDict = dict->setAt(context, hash, defaultVal);
-    self->setAttribute(context, dataName, newDict->asObject(context));
-
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoList* keysList = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    keysList = keysList->appendLast(context, key);
-    self->setAttribute(context, keysName, keysList->asObject(context));
+    if (!dictSet(context, self, key, defaultVal)) return PROTO_NONE;
     return defaultVal;
 }
 
@@ -5032,45 +4746,19 @@ static const proto::ProtoObject* py_dict_pop(
     const proto::ProtoSparseList* keywordParameters) {
     (void)parentLink;
     (void)keywordParameters;
+    PythonEnvironment* env = PythonEnvironment::fromContext(context);
     if (positionalParameters->getSize(context) < 1) {
-        PythonEnvironment* env = PythonEnvironment::fromContext(context);
         if (env) env->raiseValueError(context, context->fromUTF8String("pop expected at least 1 argument, got 0"));
         return PROTO_NONE;
     }
     const proto::ProtoObject* key = positionalParameters->getAt(context, 0);
     const proto::ProtoObject* defaultVal = positionalParameters->getSize(context) > 1 ? positionalParameters->getAt(context, 1) : nullptr;
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoObject* dataObj = self->getAttribute(context, dataName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    const proto::ProtoSparseList* dict = dataObj && dataObj->asSparseList(context) ? dataObj->asSparseList(context) : nullptr;
-    if (!dict) {
-        if (defaultVal) return defaultVal;
-        PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        if (env) env->raiseValueError(context, context->fromUTF8String("KeyError"));
-        return PROTO_NONE;
-    }
-    unsigned long hash = key->getHash(context);
-    if (!dict->has(context, hash)) {
-        if (defaultVal) return defaultVal;
-        PythonEnvironment* env = PythonEnvironment::fromContext(context);
-        if (env) env->raiseValueError(context, context->fromUTF8String("KeyError"));
-        return PROTO_NONE;
-    }
-    const proto::ProtoObject* value = dict->getAt(context, hash);
-    const proto::ProtoSparseList* newDict = dict->removeAt(context, hash);
-    const proto::ProtoList* newKeys = context->newList();
-    unsigned long size = keys->getSize(context);
-    for (unsigned long i = 0; i < size; ++i) {
-        const proto::ProtoObject* k = keys->getAt(context, static_cast<int>(i));
-        unsigned long kh = k->getHash(context);
-        if (kh != hash)
-            newKeys = newKeys->appendLast(context, k);
-    }
-    self->setAttribute(context, dataName, newDict->asObject(context));
-    self->setAttribute(context, keysName, newKeys->asObject(context));
-    return value;
+    const proto::ProtoObject* value = dictPop(context, self, key);
+    if (value) return value;
+    if (env && env->hasPendingException()) return PROTO_NONE;
+    if (defaultVal) return defaultVal;
+    if (env) env->raiseKeyError(context, key);
+    return PROTO_NONE;
 }
 
 static const proto::ProtoObject* py_dict_popitem(
@@ -5082,28 +4770,23 @@ static const proto::ProtoObject* py_dict_popitem(
     (void)parentLink;
     (void)positionalParameters;
     (void)keywordParameters;
-    const proto::ProtoString* keysName = proto::ProtoString::fromUTF8String(context, "__keys__");
-    const proto::ProtoString* dataName = proto::ProtoString::fromUTF8String(context, "__data__");
-    const proto::ProtoObject* keysObj = self->getAttribute(context, keysName);
-    const proto::ProtoObject* dataObj = self->getAttribute(context, dataName);
-    const proto::ProtoList* keys = keysObj && keysObj->asList(context) ? keysObj->asList(context) : context->newList();
-    const proto::ProtoSparseList* dict = dataObj && dataObj->asSparseList(context) ? dataObj->asSparseList(context) : nullptr;
-    if (!dict || keys->getSize(context) == 0) {
+    const proto::ProtoObject* key = nullptr;
+    const proto::ProtoObject* value = nullptr;
+    if (DictTable* table = dictTable(context, self)) {
+        if (!table->popLast(context, &key, &value)) key = nullptr;
+    } else {
+        const proto::ProtoList* keys = dictKeys(context, self);
+        if (keys->getSize(context) > 0) {
+            key = keys->getAt(context, static_cast<int>(keys->getSize(context) - 1));
+            value = dictPop(context, self, key);
+        }
+    }
+    if (!key) {
         PythonEnvironment* env = PythonEnvironment::fromContext(context);
         if (env) env->raiseKeyError(context, context->fromUTF8String("popitem(): dictionary is empty"));
         return PROTO_NONE;
     }
-    unsigned long lastIdx = keys->getSize(context) - 1;
-    const proto::ProtoObject* key = keys->getAt(context, static_cast<int>(lastIdx));
-    unsigned long hash = key->getHash(context);
-    const proto::ProtoObject* value = dict->getAt(context, hash);
-    const proto::ProtoSparseList* newDict = dict->removeAt(context, hash);
-    const proto::ProtoList* newKeys = context->newList();
-    for (unsigned long i = 0; i < lastIdx; ++i)
-        newKeys = newKeys->appendLast(context, keys->getAt(context, static_cast<int>(i)));
-    self->setAttribute(context, dataName, newDict->asObject(context));
-    self->setAttribute(context, keysName, newKeys->asObject(context));
-    const proto::ProtoList* pair = context->newList()->appendLast(context, key)->appendLast(context, value);
+    const proto::ProtoList* pair = context->newList()->appendLast(context, key)->appendLast(context, value ? value : PROTO_NONE);
     const proto::ProtoTuple* tup = context->newTupleFromList(pair);
     return tup ? tup->asObject(context) : PROTO_NONE;
 }
@@ -5116,18 +4799,72 @@ thread_local proto::ProtoContext* PythonEnvironment::s_threadContext = nullptr;
 thread_local int PythonEnvironment::s_recursionDepth = 0;
 thread_local bool PythonEnvironment::s_inRecursionError = false;
 thread_local const proto::ProtoObject* PythonEnvironment::s_currentFrame = nullptr;
+thread_local LazyFrame* PythonEnvironment::s_currentLazyFrame = nullptr;
 std::thread::id PythonEnvironment::s_mainThreadId;
 thread_local const proto::ProtoObject* PythonEnvironment::s_currentGlobals = nullptr;
 thread_local const proto::ProtoObject* PythonEnvironment::s_currentCodeObject = nullptr;
 
-/** Thread-local trace function and pending exception (no mutex in hot path). */
+/** Thread-local trace function (no mutex in hot path). */
 static thread_local const proto::ProtoObject* s_threadTraceFunction = nullptr;
-static thread_local const proto::ProtoObject* s_threadPendingException = nullptr;
 
-/** Per-thread resolve cache; generation check makes invalidation lock-free. */
-static thread_local std::unordered_map<std::string, const proto::ProtoObject*> s_threadResolveCache;
+/**
+ * Pending exception of the current thread. Threads registered through a PythonEnvironment
+ * or ContextScope keep it in the automatic local of their innermost PendingExceptionRoot
+ * (s_pendingExceptionSlot), which the collector scans; other threads fall back to an
+ * unrooted thread-local.
+ */
+static thread_local const proto::ProtoObject* s_unrootedPendingException = nullptr;
+static thread_local const proto::ProtoObject** s_pendingExceptionSlot = nullptr;
+static thread_local PythonEnvironment::PendingExceptionRoot* s_exceptionRootTop = nullptr;
+
+static inline const proto::ProtoObject*& threadPendingException() {
+    return s_pendingExceptionSlot ? *s_pendingExceptionSlot : s_unrootedPendingException;
+}
+
+PythonEnvironment::PendingExceptionRoot::PendingExceptionRoot(proto::ProtoContext* parent) {
+    const proto::ProtoList* names = parent->newList()->appendLast(parent, parent->fromUTF8String("__pending_exception__"));
+    ctx_ = new proto::ProtoContext(parent->space, parent, nullptr, names, nullptr, nullptr);
+    slot_ = ctx_->getAutomaticLocals();
+    slot_[0] = threadPendingException();
+    threadPendingException() = nullptr;
+    prev_ = s_exceptionRootTop;
+    s_exceptionRootTop = this;
+    s_pendingExceptionSlot = slot_;
+}
+
+bool PythonEnvironment::PendingExceptionRoot::active() {
+    return s_exceptionRootTop != nullptr;
+}
+
+PythonEnvironment::PendingExceptionRoot::~PendingExceptionRoot() {
+    const proto::ProtoObject* exc = slot_[0];
+    PendingExceptionRoot** link = &s_exceptionRootTop;
+    while (*link && *link != this) link = &(*link)->prev_;
+    if (*link) *link = prev_;
+    if (s_pendingExceptionSlot == slot_) {
+        s_pendingExceptionSlot = s_exceptionRootTop ? s_exceptionRootTop->slot_ : nullptr;
+        threadPendingException() = exc;
+    }
+    delete ctx_;
+}
+
+/** A resolve(std::string) name: its interned string, and its result if it did not come from globals or builtins. */
+struct ResolveCacheEntry {
+    const proto::ProtoString* name{nullptr};   ///< Rooted once, kept across invalidations.
+    const proto::ProtoObject* value{nullptr};
+    bool resolved{false};  ///< value holds a literal, sys.modules or import result (possibly nullptr).
+};
+
+/** Per-thread resolve(std::string) cache; generation check makes invalidation lock-free. */
+static thread_local std::unordered_map<std::string, ResolveCacheEntry> s_threadResolveCache;
 static thread_local uint64_t s_threadResolveCacheGeneration = 0;
 
+static void cacheResolved(const std::string& name, const proto::ProtoObject* value) {
+    ResolveCacheEntry& entry = s_threadResolveCache[name];
+    entry.value = value;
+    entry.resolved = true;
+}
+
 void PythonEnvironment::registerContext(proto::ProtoContext* ctx, PythonEnvironment* env) {
     if (std::getenv("PROTO_THREAD_DIAG")) {
     }
@@ -5147,6 +4884,7 @@ void PythonEnvironment::setCurrentFrame(const proto::ProtoObject* frame) {
 }
 
 const proto::ProtoObject* PythonEnvironment::getCurrentFrame() {
+    if (!s_currentFrame && s_currentLazyFrame) s_currentFrame = materializeFrame(s_currentLazyFrame);
     return s_currentFrame;
 }
 
@@ -5186,7 +4924,8 @@ const proto::ProtoObject* PythonEnvironment::getTraceFunction() const {
 }
 
 void PythonEnvironment::setPendingException(const proto::ProtoObject* exc) {
-    if (s_threadPendingException == exc) return;
+    const proto::ProtoObject*& pending = threadPendingException();
+    if (pending == exc) return;
     if (std::getenv("PROTO_ENV_DIAG") && exc) {
         std::string typeName = "unknown";
         if (exc == PROTO_NONE) {
@@ -5203,64 +4942,42 @@ void PythonEnvironment::setPendingException(const proto::ProtoObject* exc) {
         }
         std::cerr << "[proto-diag] setPendingException: exc=" << exc << " type=" << typeName << " from " << __builtin_return_address(0) << "\n" << std::flush;
     }
-    
-    // Explicitly root/unroot from ProtoSpace moduleRoots to survive GC
-    if (s_threadEnv && s_threadEnv->space_) {
-        std::lock_guard<std::mutex> lock(s_threadEnv->space_->moduleRootsMutex);
-        if (s_threadPendingException) {
-            auto& roots = s_threadEnv->space_->moduleRoots;
-            auto it = std::find(roots.begin(), roots.end(), s_threadPendingException);
-            if (it != roots.end()) roots.erase(it);
-        }
-        if (exc) {
-            s_threadEnv->space_->moduleRoots.push_back(const_cast<proto::ProtoObject*>(exc));
-        }
-    }
-    
-    s_threadPendingException = const_cast<proto::ProtoObject*>(exc);
+    // The slot is this thread's GC root (PendingExceptionRoot); no moduleRoots update.
+    pending = exc;
 }
 
 const proto::ProtoObject* PythonEnvironment::takePendingException() {
-    const proto::ProtoObject* e = s_threadPendingException;
-    if (e) {
-        if (std::getenv("PROTO_ENV_DIAG")) {
-            std::cerr << "[proto-diag] takePendingException: " << e << " from " << __builtin_return_address(0) << "\n";
-        }
-        if (s_threadEnv && s_threadEnv->space_) {
-            std::lock_guard<std::mutex> lock(s_threadEnv->space_->moduleRootsMutex);
-            auto& roots = s_threadEnv->space_->moduleRoots;
-            auto it = std::find(roots.begin(), roots.end(), e);
-            if (it != roots.end()) roots.erase(it);
-        }
+    const proto::ProtoObject*& pending = threadPendingException();
+    const proto::ProtoObject* e = pending;
+    if (e && std::getenv("PROTO_ENV_DIAG")) {
+        std::cerr << "[proto-diag] takePendingException: " << e << " from " << __builtin_return_address(0) << "\n";
     }
-    s_threadPendingException = nullptr;
+    pending = nullptr;
     return e;
 }
 
+const proto::ProtoObject* const* PythonEnvironment::pendingExceptionSlot() {
+    return &threadPendingException();
+}
+
 bool PythonEnvironment::hasPendingException() const {
-    return s_threadPendingException != nullptr;
+    return threadPendingException() != nullptr;
 }
 
 const proto::ProtoObject* PythonEnvironment::peekPendingException() const {
-    if (std::getenv("PROTO_ENV_DIAG") && s_threadPendingException) {
-        std::cerr << "[proto-diag] peekPendingException: " << s_threadPendingException << " from " << __builtin_return_address(0) << "\n";
+    const proto::ProtoObject* e = threadPendingException();
+    if (std::getenv("PROTO_ENV_DIAG") && e) {
+        std::cerr << "[proto-diag] peekPendingException: " << e << " from " << __builtin_return_address(0) << "\n";
     }
-    return s_threadPendingException;
+    return e;
 }
 
 void PythonEnvironment::clearPendingException() {
-    if (s_threadPendingException) {
-        if (std::getenv("PROTO_ENV_DIAG")) {
-            std::cerr << "[proto-diag] clearPendingException: " << s_threadPendingException << "\n";
-        }
-        if (s_threadEnv && s_threadEnv->space_) {
-            std::lock_guard<std::mutex> lock(s_threadEnv->space_->moduleRootsMutex);
-            auto& roots = s_threadEnv->space_->moduleRoots;
-            auto it = std::find(roots.begin(), roots.end(), s_threadPendingException);
-            if (it != roots.end()) roots.erase(it);
-        }
+    const proto::ProtoObject*& pending = threadPendingException();
+    if (pending && std::getenv("PROTO_ENV_DIAG")) {
+        std::cerr << "[proto-diag] clearPendingException: " << pending << "\n";
     }
-    s_threadPendingException = nullptr;
+    pending = nullptr;
 }
 
 bool PythonEnvironment::isStopIteration(proto::ProtoContext* ctx, const proto::ProtoObject* exc) const {
@@ -5322,15 +5039,25 @@ proto::ProtoSpace* PythonEnvironment::getProcessSpace() {
 static std::atomic<int> s_pythonEnvInstanceCount{0};
 
 PythonEnvironment::PythonEnvironment(const std::string& stdLibPath, const std::vector<std::string>& searchPaths,
-                                     const std::vector<std::string>& argv) : space_(getProcessSpace()), rootContext_(new proto::ProtoContext(space_)), argv_(argv) {
+                                     const std::vector<std::string>& argv) : space_(getProcessSpace()), baseContext_(new proto::ProtoContext(space_)), argv_(argv) {
     int prev = s_pythonEnvInstanceCount.fetch_add(1, std::memory_order_relaxed);
     // Multiple instances check removed for silence
     s_mainThreadId = std::this_thread::get_id();
+    exceptionRoot_ = std::make_unique<PendingExceptionRoot>(baseContext_);
+    rootContext_ = exceptionRoot_->context();
     registerContext(rootContext_, this);
     initializeRootObjects(stdLibPath, searchPaths);
 }
 
 PythonEnvironment::~PythonEnvironment() {
+    // Workers run against this environment: drain and join them before anything is torn down.
+    delete scheduler_.exchange(nullptr);
+    if (space_) {
+        releaseThreadLocals(space_);
+        releaseStringChain(space_);
+        releaseFlatStrings(space_);
+    }
+
     // Unregister roots from ProtoSpace to prevent dangling pointers in GC
     if (space_) {
         std::lock_guard<std::mutex> lock(space_->moduleRootsMutex);
@@ -5425,6 +5152,12 @@ PythonEnvironment::~PythonEnvironment() {
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_consts));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_names));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_code));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_decoded));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_ic_pins));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_call_names));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(co_exceptiontable));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(gi_state));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(gi_pins));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(sendString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(throwString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(closeString));
@@ -5448,6 +5181,8 @@ PythonEnvironment::~PythonEnvironment() {
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(py_ge_s));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(getDunderString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(setDunderString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(fileDunderString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(pathDunderString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(delDunderString));
         
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(__code__));
@@ -5484,6 +5219,10 @@ PythonEnvironment::~PythonEnvironment() {
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(delItemString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(dataString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(keysString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(dictTableString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(dictEntriesString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(listBufferString));
+        remove_if_match(reinterpret_cast<const proto::ProtoObject*>(listChunksString));
         
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(startString));
         remove_if_match(reinterpret_cast<const proto::ProtoObject*>(stopString));
@@ -5509,7 +5248,9 @@ PythonEnvironment::~PythonEnvironment() {
     }
 
     unregisterContext(rootContext_);
-    delete rootContext_;
+    exceptionRoot_.reset();
+    rootContext_ = nullptr;
+    delete baseContext_;
     s_pythonEnvInstanceCount.fetch_sub(1, std::memory_order_relaxed);
 }
 
@@ -5752,6 +5493,12 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
     co_consts = proto::ProtoString::fromUTF8String(rootContext_, "co_consts");
     co_names = proto::ProtoString::fromUTF8String(rootContext_, "co_names");
     co_code = proto::ProtoString::fromUTF8String(rootContext_, "co_code");
+    co_decoded = proto::ProtoString::fromUTF8String(rootContext_, "__co_decoded__");
+    co_ic_pins = proto::ProtoString::fromUTF8String(rootContext_, "__co_ic_pins__");
+    co_call_names = proto::ProtoString::fromUTF8String(rootContext_, "__co_call_names__");
+    co_exceptiontable = proto::ProtoString::fromUTF8String(rootContext_, "co_exceptiontable");
+    gi_state = proto::ProtoString::fromUTF8String(rootContext_, "__gi_state__");
+    gi_pins = proto::ProtoString::fromUTF8String(rootContext_, "__gi_pins__");
     sendString = proto::ProtoString::fromUTF8String(rootContext_, "send");
     throwString = proto::ProtoString::fromUTF8String(rootContext_, "throw");
     closeString = proto::ProtoString::fromUTF8String(rootContext_, "close");
@@ -5875,10 +5622,16 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
     filterBoolS = proto::ProtoString::fromUTF8String(rootContext_, "_bool");
     getDunderString = proto::ProtoString::fromUTF8String(rootContext_, "__get__");
     setDunderString = proto::ProtoString::fromUTF8String(rootContext_, "__set__");
+    fileDunderString = proto::ProtoString::fromUTF8String(rootContext_, "__file__");
+    pathDunderString = proto::ProtoString::fromUTF8String(rootContext_, "__path__");
     delDunderString = proto::ProtoString::fromUTF8String(rootContext_, "__delete__");
     dataString = proto::ProtoString::fromUTF8String(rootContext_, "__data__");
     space_->literalData = const_cast<proto::ProtoString*>(dataString);
     keysString = proto::ProtoString::fromUTF8String(rootContext_, "__keys__");
+    dictTableString = proto::ProtoString::fromUTF8String(rootContext_, "__dict_table__");
+    dictEntriesString = proto::ProtoString::fromUTF8String(rootContext_, "__dict_entries__");
+    listBufferString = proto::ProtoString::fromUTF8String(rootContext_, "__list_buffer__");
+    listChunksString = proto::ProtoString::fromUTF8String(rootContext_, "__list_chunks__");
     startString = proto::ProtoString::fromUTF8String(rootContext_, "start");
     stopString = proto::ProtoString::fromUTF8String(rootContext_, "stop");
     stepString = proto::ProtoString::fromUTF8String(rootContext_, "step");
@@ -6002,6 +5755,17 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
     generatorPrototype = generatorPrototype->setAttribute(rootContext_, proto::ProtoString::fromUTF8String(rootContext_, "send"), rootContext_->fromMethod(nullptr, py_generator_send));
     generatorPrototype = generatorPrototype->setAttribute(rootContext_, proto::ProtoString::fromUTF8String(rootContext_, "throw"), rootContext_->fromMethod(nullptr, py_generator_throw));
     generatorPrototype = generatorPrototype->setAttribute(rootContext_, proto::ProtoString::fromUTF8String(rootContext_, "close"), rootContext_->fromMethod(nullptr, py_generator_close));
+    // gi_* are read-only views over the generator's native GeneratorState.
+    const std::pair<const proto::ProtoString*, NativeMethod> generatorViews[] = {
+        {gi_code, py_generator_gi_code}, {gi_frame, py_generator_gi_frame},
+        {gi_running, py_generator_gi_running}, {gi_pc, py_generator_gi_pc},
+        {gi_stack, py_generator_gi_stack}, {gi_blocks, py_generator_gi_blocks},
+        {gi_locals, py_generator_gi_locals}, {gi_yieldfrom, py_generator_gi_yieldfrom}};
+    for (const auto& view : generatorViews) {
+        const proto::ProtoObject* desc = rootContext_->newObject(true);
+        desc->setAttribute(rootContext_, getDunderString, rootContext_->fromMethod(const_cast<proto::ProtoObject*>(desc), view.second));
+        generatorPrototype = generatorPrototype->setAttribute(rootContext_, view.first, desc);
+    }
 
     // 6. Basic types
     intPrototype = rootContext_->newObject(true);
@@ -6110,6 +5874,7 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
     listPrototype = listPrototype->setAttribute(rootContext_, proto::ProtoString::fromUTF8String(rootContext_, "__call__"), rootContext_->fromMethod(nullptr, py_list_call));
     listPrototype = listPrototype->setAttribute(rootContext_, py_repr, rootContext_->fromMethod(nullptr, py_type_repr));
     listPrototype = listPrototype->setAttribute(rootContext_, py_append, rootContext_->fromMethod(nullptr, py_list_append));
+    registerVectorcall(py_list_append, py_list_append_vectorcall);
     listPrototype = listPrototype->setAttribute(rootContext_, py_len, rootContext_->fromMethod(nullptr, py_list_len));
     listPrototype = listPrototype->setAttribute(rootContext_, py_getitem, rootContext_->fromMethod(nullptr, py_list_getitem));
     listPrototype = listPrototype->setAttribute(rootContext_, py_setitem, rootContext_->fromMethod(nullptr, py_list_setitem));
@@ -6396,6 +6161,9 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
     nativeProvider->registerModule("nt", [](proto::ProtoContext* ctx) { return os_module::initialize(ctx); });
     nativeProvider->registerModule("_signal", [](proto::ProtoContext* ctx) { return signal_module::initialize(ctx); });
     nativeProvider->registerModule("_thread", [](proto::ProtoContext* ctx) { return thread_module::initialize(ctx); });
+    nativeProvider->registerModule("_eventloop", [](proto::ProtoContext* ctx) { return event_loop_module::initialize(ctx); });
+    nativeProvider->registerModule("_futures", [](proto::ProtoContext* ctx) { return futures_module::initialize(ctx); });
+    nativeProvider->registerModule("_queue", [](proto::ProtoContext* ctx) { return queue_module::initialize(ctx); });
     nativeProvider->registerModule("functools", [](proto::ProtoContext* ctx) { return functools::initialize(ctx); });
     nativeProvider->registerModule("itertools", [](proto::ProtoContext* ctx) { return itertools::initialize(ctx); });
     nativeProvider->registerModule("re", [](proto::ProtoContext* ctx) { return re::initialize(ctx); });
@@ -6501,7 +6269,7 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
         ? pathListObj->asList(rootContext_) : rootContext_->newList();
     
     // If it's a Python list object, unwrap it
-    const proto::ProtoObject* dataAttr = pathListObj ? pathListObj->getAttribute(rootContext_, dataString) : nullptr;
+    const proto::ProtoObject* dataAttr = pathListObj ? dataAttribute(rootContext_, pathListObj) : nullptr;
     if (dataAttr && dataAttr->asList(rootContext_)) pList = dataAttr->asList(rootContext_);
 
     for (const auto& p : allPaths) {
@@ -6519,7 +6287,7 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
 
     if (std::getenv("PROTO_ENV_DIAG")) {
         const proto::ProtoObject* check = sysModule->getAttribute(rootContext_, py_path);
-        const proto::ProtoObject* d = check ? check->getAttribute(rootContext_, dataString) : nullptr;
+        const proto::ProtoObject* d = check ? dataAttribute(rootContext_, check) : nullptr;
         std::cerr << "[proto-diag] init: sys.path=" << check << " proto=" << (check ? check->getParents(rootContext_)->getAt(rootContext_,0) : nullptr) << " __data__=" << d << "\n";
     }
     
@@ -6638,6 +6406,12 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
         addRoot(reinterpret_cast<const proto::ProtoObject*>(co_consts));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(co_names));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(co_code));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(co_decoded));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(co_ic_pins));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(co_call_names));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(co_exceptiontable));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(gi_state));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(gi_pins));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(giNativeCallbackString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(sendString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(throwString));
@@ -6662,6 +6436,8 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
         addRoot(reinterpret_cast<const proto::ProtoObject*>(py_ge_s));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(getDunderString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(setDunderString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(fileDunderString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(pathDunderString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(delDunderString));
         
         addRoot(reinterpret_cast<const proto::ProtoObject*>(__iadd__));
@@ -6691,6 +6467,10 @@ void PythonEnvironment::initializeRootObjects(const std::string& stdLibPath, con
         addRoot(reinterpret_cast<const proto::ProtoObject*>(delItemString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(dataString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(keysString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(dictTableString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(dictEntriesString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(listBufferString));
+        addRoot(reinterpret_cast<const proto::ProtoObject*>(listChunksString));
         
         addRoot(reinterpret_cast<const proto::ProtoObject*>(startString));
         addRoot(reinterpret_cast<const proto::ProtoObject*>(stopString));
@@ -6888,7 +6668,7 @@ int PythonEnvironment::executeModule(const std::string& moduleName, bool asMain,
                         if (diagnostics) {
                             std::cerr << "[proto-diag] executeModule: executing " << path << "\n";
                         }
-                        const proto::ProtoObject* codeObj = makeCodeObject(ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), ctx->fromUTF8String(path.c_str())->asString(ctx), nullptr, 0, 0, 0, false);
+                        const proto::ProtoObject* codeObj = makeCodeObject(ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(), ctx->fromUTF8String(path.c_str())->asString(ctx), nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
                         if (codeObj) {
                             proto::ProtoObject* mutableMod = const_cast<proto::ProtoObject*>(mod);
                             if (dictPrototype) {
@@ -6904,7 +6684,7 @@ int PythonEnvironment::executeModule(const std::string& moduleName, bool asMain,
                             const proto::ProtoObject* oldGlobals = getCurrentGlobals();
                             setCurrentGlobals(mutableMod);
                             
-                            s_threadResolveCache[moduleName] = mutableMod;
+                            cacheResolved(moduleName, mutableMod);
                             const proto::ProtoObject* oldMod = mutableMod;
                             runCodeObject(ctx, codeObj, mutableMod);
                             if (std::getenv("PROTO_ENV_DIAG")) {
@@ -6914,7 +6694,7 @@ int PythonEnvironment::executeModule(const std::string& moduleName, bool asMain,
                             mod = mutableMod;
                             // Re-cache if it changed
                             if (oldMod != mutableMod) {
-                                s_threadResolveCache[moduleName] = mutableMod;
+                                cacheResolved(moduleName, mutableMod);
                             }
                             const proto::ProtoObject* excAfterExec = takePendingException();
                             if (excAfterExec && excAfterExec != PROTO_NONE) {
@@ -7617,15 +7397,13 @@ const proto::ProtoObject* PythonEnvironment::getAttribute(proto::ProtoContext* c
     }
     
     
-    // Use protoCore's native, cached lookup
-    const proto::ProtoObject* val = obj->getAttribute(ctx, name);
+    // Use protoCore's native, cached lookup (on a _local, in the calling thread's storage)
+    const proto::ProtoObject* val = threadLocalStorage(ctx, obj)->getAttribute(ctx, name);
     if (val && val != PROTO_NONE && val->isCell(ctx)) {
         if (val->isMethod(ctx)) {
             // Step V74: Don't bind methods to modules. Modules have __file__ or __path__.
-            const proto::ProtoString* fileS = proto::ProtoString::fromUTF8String(ctx, "__file__");
-            const proto::ProtoString* pathS = proto::ProtoString::fromUTF8String(ctx, "__path__");
-            const proto::ProtoObject* hasFile = obj->getAttribute(ctx, fileS);
-            const proto::ProtoObject* hasPath = obj->getAttribute(ctx, pathS);
+            const proto::ProtoObject* hasFile = obj->getAttribute(ctx, fileDunderString);
+            const proto::ProtoObject* hasPath = obj->getAttribute(ctx, pathDunderString);
             if ((hasFile == nullptr || hasFile == PROTO_NONE) && (hasPath == nullptr || hasPath == PROTO_NONE)) {
                 const proto::ProtoObject* bound = ctx->fromMethod(const_cast<proto::ProtoObject*>(obj), val->asMethod(ctx));
                 return bound;
@@ -7646,11 +7424,13 @@ const proto::ProtoObject* PythonEnvironment::getAttribute(proto::ProtoContext* c
 
 const proto::ProtoObject* PythonEnvironment::setAttribute(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const proto::ProtoString* name, const proto::ProtoObject* value) {
     if (!obj || isEmbeddedValue(obj)) return obj;
+    // A _local stores into the calling thread's storage object.
+    const proto::ProtoObject* target = threadLocalStorage(ctx, obj);
 
     // In Python, data descriptors (with __set__) shadow instance attributes
     // We check the class hierarchy for a descriptor if it's not already an "own" attribute shadowing it
-    if (obj->hasOwnAttribute(ctx, name) == PROTO_FALSE) {
-        const proto::ProtoObject* descr = obj->getAttribute(ctx, name);
+    if (target->hasOwnAttribute(ctx, name) == PROTO_FALSE) {
+        const proto::ProtoObject* descr = target->getAttribute(ctx, name);
         if (descr && descr != PROTO_NONE && descr->isCell(ctx)) {
             const proto::ProtoObject* setM = descr->getAttribute(ctx, setDunderString);
             if (setM && setM != PROTO_NONE && setM->asMethod(ctx)) {
@@ -7661,42 +7441,62 @@ const proto::ProtoObject* PythonEnvironment::setAttribute(proto::ProtoContext* c
         }
     }
 
+    if (target != obj) {
+        target->setAttribute(ctx, name, value);
+        return obj;
+    }
     return obj->setAttribute(ctx, name, value);
 }
 
 const proto::ProtoObject* PythonEnvironment::resolve(const std::string& name, proto::ProtoContext* ctx) {
-    if (std::getenv("PROTO_RESOLVE_DIAG")) {
+    if (get_resolve_diag()) {
         std::cerr << "[proto-resolve] resolve(string) name='" << name << "'\n" << std::flush;
     }
     if (!ctx) ctx = s_threadContext ? s_threadContext : rootContext_;
-    
-    // Check per-thread cache first (Lock-free)
+
+    // Check per-thread cache first (Lock-free); a hit needs no ProtoString allocation.
     uint64_t gen = resolveCacheGeneration_.load(std::memory_order_acquire);
     if (s_threadResolveCacheGeneration != gen) {
-        s_threadResolveCache.clear();
+        for (auto& cached : s_threadResolveCache) cached.second.resolved = false;
         s_threadResolveCacheGeneration = gen;
     }
-    auto it = s_threadResolveCache.find(name);
-    if (it != s_threadResolveCache.end())
-        return it->second;
+    ResolveCacheEntry& entry = s_threadResolveCache[name];
+    if (!entry.name) {
+        entry.name = proto::ProtoString::fromUTF8String(ctx, name.c_str());
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        ctx->space->moduleRoots.push_back(reinterpret_cast<const proto::ProtoObject*>(entry.name));
+    }
+    const proto::ProtoString* nameS = entry.name;
 
-    const proto::ProtoString* nameS = proto::ProtoString::fromUTF8String(ctx, name.c_str());
+    // Globals and builtins are checked live, so stores to them never invalidate the cache.
+    const proto::ProtoObject* result = nullptr;
+    if (lookupNamespaces(nameS, ctx, result)) return result;
+    if (entry.resolved) return entry.value;
+
+    // The slow path may import and invalidate the cache, so entry is not used past here.
     const proto::ProtoObject* res = resolve(nameS, ctx);
-    s_threadResolveCache[name] = res;
+    cacheResolved(name, res);
     return res;
 }
 
+bool PythonEnvironment::lookupNamespaces(const proto::ProtoString* nameObj, proto::ProtoContext* ctx, const proto::ProtoObject*& out) const {
+    // 1. Current module's globals (Lock-free)
+    if (s_currentGlobals && s_currentGlobals->hasAttribute(ctx, nameObj) == PROTO_TRUE) {
+        out = s_currentGlobals->getAttribute(ctx, nameObj);
+        return true;
+    }
+    // 2. Builtins (Lock-free)
+    if (builtinsModule && builtinsModule->hasAttribute(ctx, nameObj) == PROTO_TRUE) {
+        out = builtinsModule->getAttribute(ctx, nameObj);
+        return true;
+    }
+    return false;
+}
+
 const proto::ProtoObject* PythonEnvironment::resolve(const proto::ProtoString* nameObj, proto::ProtoContext* ctx) {
     if (!nameObj) return nullptr;
     if (!ctx) ctx = s_threadContext ? s_threadContext : rootContext_;
 
-    std::string nameStr;
-    nameObj->toUTF8String(ctx, nameStr);
-
-    if (std::getenv("PROTO_RESOLVE_DIAG")) {
-        std::cerr << "[proto-resolve] resolve(ProtoString) name='" << nameStr << "'\n" << std::flush;
-    }
-    
     static thread_local int resolveDepth = 0;
     if (++resolveDepth > 100) {
         --resolveDepth;
@@ -7708,26 +7508,21 @@ const proto::ProtoObject* PythonEnvironment::resolve(const proto::ProtoString* n
         ~DepthGuard() { --d; }
     } dg(resolveDepth);
 
-    // 1. Try current module's globals (Lock-free)
-    if (s_currentGlobals) {
-        if (s_currentGlobals->hasAttribute(ctx, nameObj) == PROTO_TRUE) {
-            const proto::ProtoObject* result = s_currentGlobals->getAttribute(ctx, nameObj);
-            if (std::getenv("PROTO_RESOLVE_DIAG")) std::cerr << "[proto-resolve] found in globals: " << nameStr << "\n";
-            return result;
+    // 1-2. Globals, then builtins
+    const proto::ProtoObject* found = nullptr;
+    if (lookupNamespaces(nameObj, ctx, found)) {
+        if (get_resolve_diag()) {
+            std::string n;
+            nameObj->toUTF8String(ctx, n);
+            std::cerr << "[proto-resolve] found in globals/builtins: " << n << "\n";
         }
+        return found;
     }
 
-    // 2. Builtins (Lock-free)
-    if (builtinsModule) {
-        if (builtinsModule->hasAttribute(ctx, nameObj) == PROTO_TRUE) {
-            const proto::ProtoObject* result = builtinsModule->getAttribute(ctx, nameObj);
-            if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] found in builtins: " << nameStr << " val=" << result << "\n";
-            return result;
-        } else {
-            if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] NOT found in builtins: " << nameStr << "\n";
-        }
-    } else {
-        if (std::getenv("PROTO_ENV_DIAG")) std::cerr << "[proto-diag] builtinsModule is NULL during resolve of " << nameStr << "\n";
+    std::string nameStr;
+    nameObj->toUTF8String(ctx, nameStr);
+    if (get_resolve_diag()) {
+        std::cerr << "[proto-resolve] resolve(ProtoString) name='" << nameStr << "'\n" << std::flush;
     }
 
     // 3. Literals Quick-Path (Lock-free)
@@ -7745,7 +7540,7 @@ const proto::ProtoObject* PythonEnvironment::resolve(const proto::ProtoString* n
         if (nameStr == "tuple") result = tuplePrototype;
         if (nameStr == "bool") result = boolPrototype;
         
-        if (result && std::getenv("PROTO_ENV_DIAG")) {
+        if (result && get_env_diag()) {
             std::cerr << "[proto-diag] resolve: quick-path match for " << nameStr << " val=" << result << "\n";
         }
         if (result) return result;
@@ -7761,7 +7556,7 @@ const proto::ProtoObject* PythonEnvironment::resolve(const proto::ProtoString* n
                 const proto::ProtoSparseList* dict = modules->asSparseList(ctx);
                 if (dict && dict->has(ctx, nameObj->getHash(ctx))) {
                     const proto::ProtoObject* mod = dict->getAt(ctx, nameObj->getHash(ctx));
-                    if (std::getenv("PROTO_RESOLVE_DIAG")) std::cerr << "[proto-resolve] found in sys.modules: " << nameStr << "\n";
+                    if (get_resolve_diag()) std::cerr << "[proto-resolve] found in sys.modules: " << nameStr << "\n";
                     return mod;
                 }
             }
@@ -7774,12 +7569,12 @@ const proto::ProtoObject* PythonEnvironment::resolve(const proto::ProtoString* n
             if (result && result != nullptr) {
                 const proto::ProtoObject* executedKey = result->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__executed__"));
                 if (!executedKey || executedKey == PROTO_FALSE || executedKey == PROTO_NONE) {
-                    if (std::getenv("PROTO_RESOLVE_DIAG")) std::cerr << "[proto-resolve] triggering executeModule for: " << nameStr << "\n";
+                    if (get_resolve_diag()) std::cerr << "[proto-resolve] triggering executeModule for: " << nameStr << "\n";
                     int ret = executeModule(nameStr, false, ctx);
                     if (ret != 0) return nullptr;
                     result = modWrapper->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "val"));
                 }
-                if (std::getenv("PROTO_RESOLVE_DIAG")) std::cerr << "[proto-resolve] found via ImportModule: " << nameStr << "\n";
+                if (get_resolve_diag()) std::cerr << "[proto-resolve] found via ImportModule: " << nameStr << "\n";
                 return result;
             }
         }
@@ -7933,39 +7728,37 @@ const proto::ProtoObject* PythonEnvironment::lookupName(const std::string& name)
 const proto::ProtoObject* PythonEnvironment::buildString(const proto::ProtoObject** parts, size_t count) {
     proto::ProtoContext* ctx = getCurrentContext();
     if (!ctx) ctx = rootContext_;
-    std::string result;
-    result.reserve(count * 16);
+    // Long parts are linked into the result rope, not copied.
+    StringBuilder result;
     for (size_t i = 0; i < count; ++i) {
         const proto::ProtoObject* obj = parts[i];
         if (!obj || obj == PROTO_NONE) {
-            result += "None";
+            result.appendAscii(ctx, "None");
         } else if (obj->isString(ctx)) {
-            std::string s; obj->asString(ctx)->toUTF8String(ctx, s);
-            result += s;
+            result.append(ctx, obj->asString(ctx));
         } else if (obj->isInteger(ctx)) {
-            result += std::to_string(obj->asLong(ctx));
+            result.appendAscii(ctx, std::to_string(obj->asLong(ctx)));
         } else if (obj->isDouble(ctx)) {
-            result += std::to_string(obj->asDouble(ctx));
+            result.appendAscii(ctx, std::to_string(obj->asDouble(ctx)));
         } else if (obj == PROTO_TRUE) {
-            result += "True";
+            result.appendAscii(ctx, "True");
         } else if (obj == PROTO_FALSE) {
-            result += "False";
+            result.appendAscii(ctx, "False");
         } else {
             const proto::ProtoObject* strFunc = resolve("str", ctx);
             if (strFunc) {
                 const proto::ProtoObject* sObj = callObject(strFunc, {obj});
                 if (sObj && sObj->isString(ctx)) {
-                    std::string s; sObj->asString(ctx)->toUTF8String(ctx, s);
-                    result += s;
+                    result.append(ctx, sObj->asString(ctx));
                 } else {
-                    result += "<object>";
+                    result.appendAscii(ctx, "<object>");
                 }
             } else {
-                result += "<object>";
+                result.appendAscii(ctx, "<object>");
             }
         }
     }
-    return proto::ProtoString::fromUTF8String(ctx, result.c_str())->asObject(ctx);
+    return result.build(ctx)->asObject(ctx);
 }
 
 void PythonEnvironment::storeName(const std::string& name, const proto::ProtoObject* val) {
@@ -8014,9 +7807,8 @@ const proto::ProtoObject* PythonEnvironment::callObjectEx(const proto::ProtoObje
     }
 
     if (kwargs && kwargs != PROTO_NONE) {
-        const proto::ProtoObject* keys = kwargs->getAttribute(ctx, getKeysString());
-        if (keys && keys->asList(ctx)) {
-            const proto::ProtoList* kList = keys->asList(ctx);
+        if (isDictLike(ctx, kwargs)) {
+            const proto::ProtoList* kList = dictKeys(ctx, kwargs);
             for (unsigned long i = 0; i < kList->getSize(ctx); ++i) {
                 const proto::ProtoObject* k = kList->getAt(ctx, i);
                 if (k && k->isString(ctx)) {
@@ -8417,7 +8209,7 @@ void PythonEnvironment::delItem(const proto::ProtoObject* container, const proto
     if (method && method->asMethod(ctx)) {
         method->asMethod(ctx)(ctx, container, nullptr, args, nullptr);
     } else {
-        const proto::ProtoObject* data = container->getAttribute(ctx, dataString);
+        const proto::ProtoObject* data = dataAttribute(ctx, container);
         if (data && data->asSparseList(ctx)) {
             data->asSparseList(ctx)->removeAt(ctx, key->getHash(ctx));
         }
@@ -8436,7 +8228,6 @@ void PythonEnvironment::delName(const std::string& name) {
     if (frame) {
         const_cast<proto::ProtoObject*>(frame)->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, name.c_str()), PROTO_NONE);
     }
-    invalidateResolveCache();
 }
 
 void PythonEnvironment::pushKwNames(const proto::ProtoTuple* names) {
@@ -8456,44 +8247,40 @@ const proto::ProtoTuple* PythonEnvironment::getCurrentKwNames() const {
 
 const proto::ProtoObject* PythonEnvironment::runUntilComplete(const proto::ProtoObject* coro) {
     if (!coro) return PROTO_NONE;
-    
-    // Add the initial coroutine as a task
-    addTask(coro);
-    
-    const proto::ProtoObject* lastResult = PROTO_NONE;
-    
-    while (taskQueue && taskQueue->getSize(rootContext_) > 0) {
-        // Simple FIFO queue: pull the first task
-        const proto::ProtoObject* task = taskQueue->getAt(rootContext_, 0);
-        taskQueue = taskQueue->removeAt(rootContext_, 0);
-        
-        // Resume the coroutine by calling .send(None)
-        const proto::ProtoObject* sendMethod = getAttr(task, "send");
-        if (sendMethod && sendMethod != PROTO_NONE) {
-            try {
-                lastResult = callObject(sendMethod, {PROTO_NONE});
-                
-                // If callObject returns successfully, it means the coroutine yielded.
-                // In a minimal loop, we just put it back at the end of the queue to be resumed later.
-                addTask(task);
-            } catch (const proto::ProtoObject* exc) {
-                // If it raised StopIteration, the coroutine is finished.
-                if (isStopIteration(rootContext_, exc)) {
-                    lastResult = getStopIterationValue(rootContext_, exc);
-                    // Finished - don't add back to queue.
-                } else {
-                    // A real error occurred - report and re-raise.
-                    handleException(exc);
-                    throw exc;
-                }
-            }
-        }
+    proto::ProtoContext* ctx = getCurrentContext() ? getCurrentContext() : rootContext_;
+    EventLoop loop(this, ctx);
+
+    // Coroutines scheduled with addTask before the loop started run alongside coro.
+    if (taskQueue) {
+        const unsigned long n = taskQueue->getSize(rootContext_);
+        for (unsigned long i = 0; i < n; ++i)
+            loop.createTask(ctx, taskQueue->getAt(rootContext_, static_cast<int>(i)));
+        taskQueue = nullptr;
     }
-    
-    return lastResult;
+    const proto::ProtoObject* result = loop.runUntilComplete(coro);
+    return result ? result : PROTO_NONE;
+}
+
+WorkStealingScheduler* PythonEnvironment::getScheduler(proto::ProtoContext* ctx) {
+    if (WorkStealingScheduler* scheduler = scheduler_.load(std::memory_order_acquire)) return scheduler;
+    std::call_once(schedulerOnce_, [this, ctx]() {
+        const int workers = getWorkerCount();
+        if (workers > 0) scheduler_.store(new WorkStealingScheduler(this, ctx ? ctx : rootContext_, workers), std::memory_order_release);
+    });
+    return scheduler_.load(std::memory_order_acquire);
+}
+
+size_t PythonEnvironment::getSchedulerThreadCount() const {
+    WorkStealingScheduler* scheduler = scheduler_.load(std::memory_order_acquire);
+    return scheduler ? scheduler->workerCount() : 0;
 }
 
 void PythonEnvironment::addTask(const proto::ProtoObject* coro) {
+    if (EventLoop* loop = EventLoop::current()) {
+        proto::ProtoContext* ctx = getCurrentContext() ? getCurrentContext() : rootContext_;
+        loop->createTask(ctx, coro);
+        return;
+    }
     if (!taskQueue) taskQueue = rootContext_->newList();
     taskQueue = taskQueue->appendLast(rootContext_, coro);
 }
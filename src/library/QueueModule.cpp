@@ -0,0 +1,831 @@
+#include <protoPython/QueueModule.h>
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/FutexSync.h>
+#include <protoPython/ListBuffer.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace protoPython {
+namespace queue_module {
+
+namespace {
+
+constexpr int64_t kForever = -1;
+constexpr uint64_t kInitialCapacity = 32;
+
+enum class Wait { Ok, Timeout, ShutDown };
+
+/**
+ * Permit counter (queued items, or free slots of a bounded queue) with futex
+ * waiting. Taking an available permit is one CAS; waiters sleep on a
+ * FutexCondition that give() only signals when someone is waiting.
+ */
+class Permits {
+public:
+    explicit Permits(uint32_t count) : count_(count) {}
+
+    bool tryTake() { return tryTakeUpTo(1) == 1; }
+
+    /** Take up to max permits without waiting; returns how many were taken. */
+    uint32_t tryTakeUpTo(uint32_t max) {
+        uint32_t c = count_.load(std::memory_order_relaxed);
+        while (c > 0) {
+            const uint32_t n = std::min(c, max);
+            if (count_.compare_exchange_weak(c, c - n, std::memory_order_acquire, std::memory_order_relaxed))
+                return n;
+        }
+        return 0;
+    }
+
+    /** Take one permit by deadline (monotonicNs(); kForever: no limit). ShutDown once closed and none are left. */
+    Wait take(proto::ProtoSpace* space, int64_t deadline, const std::atomic<bool>& closed) {
+        for (;;) {
+            if (tryTake()) return Wait::Ok;
+            if (closed.load(std::memory_order_acquire)) return Wait::ShutDown;
+            int64_t left = kForever;
+            if (deadline != kForever) {
+                left = deadline - monotonicNs();
+                if (left <= 0) return Wait::Timeout;
+            }
+            const uint32_t seen = ready_.prepareWait();
+            if (count_.load(std::memory_order_seq_cst) != 0 || closed.load(std::memory_order_seq_cst)) {
+                ready_.waitFrom(nullptr, seen, 0);
+                continue;
+            }
+            ready_.waitFrom(space, seen, left);
+        }
+    }
+
+    void give(uint32_t n) {
+        count_.fetch_add(n, std::memory_order_seq_cst);
+        ready_.notify(static_cast<int>(std::min<uint32_t>(n, INT_MAX)));
+    }
+
+    void wakeAll() { ready_.notifyAll(); }
+    uint32_t count() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> count_;
+    FutexCondition ready_;
+};
+
+/**
+ * Bounded MPMC ring (Vyukov). Each cell carries a sequence number, so a
+ * producer or consumer claims a cell with one CAS on tail or head and
+ * publishes it with a release store. Each cell's holder object keeps the
+ * queued item reachable for the GC while it sits in the ring.
+ */
+struct Ring {
+    struct Cell {
+        std::atomic<uint64_t> seq{0};
+        const proto::ProtoObject* item{nullptr};
+        const proto::ProtoObject* holder{nullptr};
+    };
+
+    explicit Ring(uint64_t capacity) : mask(capacity - 1), cells(new Cell[capacity]) {
+        for (uint64_t i = 0; i < capacity; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    uint64_t capacity() const { return mask + 1; }
+
+    /** Next free cell, claimed; nullptr when the ring is full. */
+    Cell* claimPush(uint64_t& pos) {
+        pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = &cells[pos & mask];
+            const int64_t d = static_cast<int64_t>(cell->seq.load(std::memory_order_acquire) - pos);
+            if (d == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return cell;
+            } else if (d < 0) {
+                return nullptr;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Oldest published cell, claimed; nullptr when none is published yet. */
+    Cell* claimPop(uint64_t& pos) {
+        pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = &cells[pos & mask];
+            const int64_t d = static_cast<int64_t>(cell->seq.load(std::memory_order_acquire) - (pos + 1));
+            if (d == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return cell;
+            } else if (d < 0) {
+                return nullptr;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publishPush(Cell* cell, uint64_t pos) { cell->seq.store(pos + 1, std::memory_order_release); }
+    void publishPop(Cell* cell, uint64_t pos) { cell->seq.store(pos + mask + 1, std::memory_order_release); }
+
+    const uint64_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<uint64_t> tail{0};
+    alignas(64) std::atomic<uint64_t> head{0};
+};
+
+enum class Order { Fifo, Lifo, Priority };
+
+/** Native side of a queue object (external pointer under _state). */
+struct QueueState {
+    QueueState(Order o, uint32_t max, bool tracked) : order(o), maxsize(max), tracksTasks(tracked), slots(max) {}
+    ~QueueState() { delete ring.load(std::memory_order_relaxed); }
+
+    const Order order;
+    const uint32_t maxsize;                 ///< 0: unbounded.
+    const bool tracksTasks;                 ///< task_done()/join(); not SimpleQueue.
+    const proto::ProtoObject* owner{nullptr};
+    Permits items{0};                       ///< Published items.
+    Permits slots;                          ///< Free slots of a bounded queue.
+    std::atomic<bool> closed{false};
+    alignas(64) std::atomic<uint32_t> unfinished{0};
+
+    // Fifo. Pushes and pops hold the gate (an active-operation count) so that
+    // growing the ring can wait for them to drain and then swap it alone.
+    std::atomic<Ring*> ring{nullptr};
+    alignas(64) std::atomic<uint32_t> gate{0};
+    FutexMutex growLock;
+
+    // Lifo / Priority: stack or binary heap under lock.
+    struct Entry {
+        const proto::ProtoObject* item;
+        const proto::ProtoObject* holder;
+    };
+    FutexMutex lock;
+    std::vector<Entry> entries;
+    std::vector<const proto::ProtoObject*> spareHolders;
+    const proto::ProtoList* holders{nullptr};   ///< Every holder made, stored as the owner's _cells.
+};
+
+constexpr uint32_t kGrowing = 1u << 31;
+
+const proto::ProtoObject* simpleQueueProt = nullptr;
+const proto::ProtoObject* queueProt = nullptr;
+const proto::ProtoObject* lifoQueueProt = nullptr;
+const proto::ProtoObject* priorityQueueProt = nullptr;
+const proto::ProtoObject* emptyError = nullptr;
+const proto::ProtoString* s_stateName = nullptr;
+const proto::ProtoString* s_itemName = nullptr;
+const proto::ProtoString* s_cellsName = nullptr;
+const proto::ProtoSpace* protoSpace = nullptr;  ///< Space the prototypes were built (and rooted) in.
+std::mutex s_protoMutex;
+
+const proto::ProtoString* str(proto::ProtoContext* ctx, const char* s) {
+    return proto::ProtoString::fromUTF8String(ctx, s);
+}
+
+void queue_state_finalizer(void* ptr) {
+    delete static_cast<QueueState*>(ptr);
+}
+
+QueueState* queueOf(proto::ProtoContext* ctx, const proto::ProtoObject* self) {
+    const proto::ProtoObject* handle = self ? self->getAttribute(ctx, s_stateName) : nullptr;
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<QueueState*>(ext->getPointer(ctx)) : nullptr;
+}
+
+const proto::ProtoObject* kwarg(proto::ProtoContext* ctx, const proto::ProtoSparseList* kwargs, const char* name) {
+    if (!kwargs) return nullptr;
+    const unsigned long key = str(ctx, name)->getHash(ctx);
+    return kwargs->has(ctx, key) ? kwargs->getAt(ctx, key) : nullptr;
+}
+
+/** Positional argument i, else keyword name, else nullptr. */
+const proto::ProtoObject* argOrKwarg(proto::ProtoContext* ctx, const proto::ProtoList* posArgs,
+                                     const proto::ProtoSparseList* kwargs, unsigned long i, const char* name) {
+    if (posArgs && posArgs->getSize(ctx) > i) return posArgs->getAt(ctx, static_cast<int>(i));
+    return kwarg(ctx, kwargs, name);
+}
+
+/**
+ * Deadline for (block=True, timeout=None) at argument offset: kForever, or a
+ * monotonicNs() instant (now for block=False). False with ValueError pending
+ * for a negative timeout.
+ */
+bool deadlineOf(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoList* posArgs,
+                const proto::ProtoSparseList* kwargs, unsigned long offset, int64_t& deadline) {
+    const proto::ProtoObject* blockObj = argOrKwarg(ctx, posArgs, kwargs, offset, "block");
+    const proto::ProtoObject* timeoutObj = argOrKwarg(ctx, posArgs, kwargs, offset + 1, "timeout");
+    if (blockObj && !env->isTrue(blockObj)) {
+        deadline = monotonicNs();
+        return true;
+    }
+    deadline = kForever;
+    if (!timeoutObj || timeoutObj == PROTO_NONE) return true;
+    double seconds = 0;
+    if (timeoutObj->isDouble(ctx)) seconds = timeoutObj->asDouble(ctx);
+    else if (timeoutObj->isInteger(ctx)) seconds = static_cast<double>(timeoutObj->asLong(ctx));
+    else return true;
+    if (seconds < 0) {
+        env->raiseValueError(ctx, ctx->fromUTF8String("'timeout' must be a non-negative number"));
+        return false;
+    }
+    if (seconds < 9.2e9) deadline = monotonicNs() + static_cast<int64_t>(seconds * 1e9);
+    return true;
+}
+
+/** Raise the class in self's attribute errorAttr (queue.Full, queue.ShutDown, ...), else RuntimeError. */
+void raiseQueueError(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* self,
+                     const char* errorAttr, const char* fallback) {
+    const proto::ProtoObject* cls = self->getAttribute(ctx, str(ctx, errorAttr));
+    if (cls && cls != PROTO_NONE) {
+        const proto::ProtoObject* exc = env->callObject(cls, {});
+        if (env->hasPendingException()) return;
+        if (exc && exc != PROTO_NONE) {
+            env->setPendingException(exc);
+            return;
+        }
+    }
+    env->raiseRuntimeError(ctx, fallback);
+}
+
+void raiseWait(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* self, Wait w, bool putting) {
+    if (w == Wait::ShutDown) raiseQueueError(ctx, env, self, "_shutdown_error", "queue is shut down");
+    else if (putting) raiseQueueError(ctx, env, self, "_full_error", "queue is full");
+    else raiseQueueError(ctx, env, self, "_empty_error", "queue is empty");
+}
+
+/** Wait briefly for another thread to publish a cell we are owed. */
+void backoff(proto::ProtoContext* ctx) {
+    std::this_thread::yield();
+    gcSafepoint(ctx);
+}
+
+// --- Fifo ring and its gate ---
+
+void leaveGate(QueueState* q) {
+    if (q->gate.fetch_sub(1, std::memory_order_release) == (kGrowing | 1)) futexWakeAll(q->gate);
+}
+
+void enterGate(QueueState* q, proto::ProtoSpace* space) {
+    for (;;) {
+        if (!(q->gate.fetch_add(1, std::memory_order_acquire) & kGrowing)) return;
+        leaveGate(q);
+        BlockingRegion blocking(space);
+        for (uint32_t g = q->gate.load(std::memory_order_acquire); g & kGrowing; g = q->gate.load(std::memory_order_acquire))
+            futexWait(q->gate, g, kForever);
+    }
+}
+
+Ring* newRing(proto::ProtoContext* ctx, QueueState* q, uint64_t capacity) {
+    Ring* ring = new Ring(capacity);
+    const proto::ProtoList* holders = ctx->newList();
+    for (uint64_t i = 0; i < capacity; ++i) {
+        ring->cells[i].holder = ctx->newObject(true);
+        holders = holders->appendLast(ctx, ring->cells[i].holder);
+    }
+    q->owner->setAttribute(ctx, s_cellsName, holders->asObject(ctx));
+    return ring;
+}
+
+/** Called with the gate held when seen was full: double it, unless another thread already has. */
+void growRing(proto::ProtoContext* ctx, QueueState* q, Ring* seen) {
+    leaveGate(q);
+    q->growLock.lock(ctx->space);
+    if (q->ring.load(std::memory_order_acquire) == seen) {
+        q->gate.fetch_or(kGrowing, std::memory_order_acq_rel);
+        {
+            BlockingRegion blocking(ctx->space);
+            for (uint32_t g = q->gate.load(std::memory_order_acquire); g != kGrowing; g = q->gate.load(std::memory_order_acquire))
+                futexWait(q->gate, g, kForever);
+        }
+        // No push or pop is in flight, so every cell from head to tail is published.
+        const uint64_t head = seen->head.load(std::memory_order_relaxed);
+        const uint64_t count = seen->tail.load(std::memory_order_relaxed) - head;
+        Ring* bigger = newRing(ctx, q, seen->capacity() * 2);
+        for (uint64_t i = 0; i < count; ++i) {
+            Ring::Cell& from = seen->cells[(head + i) & seen->mask];
+            Ring::Cell& to = bigger->cells[i];
+            to.item = from.item;
+            to.holder->setAttribute(ctx, s_itemName, from.item);
+            to.seq.store(i + 1, std::memory_order_relaxed);
+        }
+        bigger->tail.store(count, std::memory_order_relaxed);
+        q->ring.store(bigger, std::memory_order_release);
+        q->gate.fetch_and(~kGrowing, std::memory_order_release);
+        futexWakeAll(q->gate);
+        delete seen;
+    }
+    q->growLock.unlock();
+    enterGate(q, ctx->space);
+}
+
+void pushFifo(proto::ProtoContext* ctx, QueueState* q, const proto::ProtoObject* item) {
+    enterGate(q, ctx->space);
+    for (;;) {
+        Ring* ring = q->ring.load(std::memory_order_acquire);
+        uint64_t pos = 0;
+        if (Ring::Cell* cell = ring->claimPush(pos)) {
+            cell->item = item;
+            cell->holder->setAttribute(ctx, s_itemName, item);
+            ring->publishPush(cell, pos);
+            break;
+        }
+        growRing(ctx, q, ring);
+    }
+    leaveGate(q);
+}
+
+/** Caller holds an item permit, so an item is published or about to be. */
+const proto::ProtoObject* popFifo(proto::ProtoContext* ctx, QueueState* q) {
+    enterGate(q, ctx->space);
+    const proto::ProtoObject* item = nullptr;
+    for (;;) {
+        Ring* ring = q->ring.load(std::memory_order_acquire);
+        uint64_t pos = 0;
+        if (Ring::Cell* cell = ring->claimPop(pos)) {
+            item = cell->item;
+            cell->item = nullptr;
+            cell->holder->setAttribute(ctx, s_itemName, PROTO_NONE);
+            ring->publishPop(cell, pos);
+            break;
+        }
+        backoff(ctx);
+    }
+    leaveGate(q);
+    return item;
+}
+
+// --- Lifo / Priority ---
+
+/** a < b by Python comparison; false once an exception is pending. */
+bool less(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* a, const proto::ProtoObject* b) {
+    if (env->hasPendingException()) return false;
+    const proto::ProtoObject* r = env->compareObjects(ctx, a, b, 2);
+    return !env->hasPendingException() && r && env->isTrue(r);
+}
+
+void siftUp(proto::ProtoContext* ctx, PythonEnvironment* env, std::vector<QueueState::Entry>& heap, size_t i) {
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (!less(ctx, env, heap[i].item, heap[parent].item)) return;
+        std::swap(heap[i], heap[parent]);
+        i = parent;
+    }
+}
+
+void siftDown(proto::ProtoContext* ctx, PythonEnvironment* env, std::vector<QueueState::Entry>& heap, size_t i) {
+    const size_t n = heap.size();
+    for (;;) {
+        size_t smallest = i;
+        const size_t left = 2 * i + 1;
+        const size_t right = left + 1;
+        if (left < n && less(ctx, env, heap[left].item, heap[smallest].item)) smallest = left;
+        if (right < n && less(ctx, env, heap[right].item, heap[smallest].item)) smallest = right;
+        if (smallest == i) return;
+        std::swap(heap[i], heap[smallest]);
+        i = smallest;
+    }
+}
+
+void pushLocked(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q, const proto::ProtoObject* item) {
+    q->lock.lock(ctx->space);
+    const proto::ProtoObject* holder = nullptr;
+    if (!q->spareHolders.empty()) {
+        holder = q->spareHolders.back();
+        q->spareHolders.pop_back();
+    } else {
+        holder = ctx->newObject(true);
+        q->holders = q->holders->appendLast(ctx, holder);
+        q->owner->setAttribute(ctx, s_cellsName, q->holders->asObject(ctx));
+    }
+    holder->setAttribute(ctx, s_itemName, item);
+    q->entries.push_back({item, holder});
+    // A comparison that raises leaves the item queued, as heapq.heappush does.
+    if (q->order == Order::Priority) siftUp(ctx, env, q->entries, q->entries.size() - 1);
+    q->lock.unlock();
+}
+
+const proto::ProtoObject* popLocked(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q) {
+    q->lock.lock(ctx->space);
+    QueueState::Entry entry = q->entries.front();
+    if (q->order == Order::Priority) {
+        q->entries.front() = q->entries.back();
+        q->entries.pop_back();
+        if (!q->entries.empty()) siftDown(ctx, env, q->entries, 0);
+    } else {
+        entry = q->entries.back();
+        q->entries.pop_back();
+    }
+    entry.holder->setAttribute(ctx, s_itemName, PROTO_NONE);
+    q->spareHolders.push_back(entry.holder);
+    q->lock.unlock();
+    return entry.item;
+}
+
+void pushItem(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q, const proto::ProtoObject* item) {
+    if (q->order == Order::Fifo) pushFifo(ctx, q, item);
+    else pushLocked(ctx, env, q, item);
+}
+
+const proto::ProtoObject* popItem(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q) {
+    return q->order == Order::Fifo ? popFifo(ctx, q) : popLocked(ctx, env, q);
+}
+
+// --- put / get ---
+
+/** Queue up to count items from items[from...] once a slot is free; returns how many were queued. */
+uint32_t putBatch(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q,
+                  const proto::ProtoList* items, unsigned long from, uint32_t count, int64_t deadline, Wait& w) {
+    w = Wait::Ok;
+    if (q->closed.load(std::memory_order_acquire)) {
+        w = Wait::ShutDown;
+        return 0;
+    }
+    uint32_t n = count;
+    if (q->maxsize) {
+        n = q->slots.tryTakeUpTo(count);
+        if (n == 0) {
+            w = q->slots.take(ctx->space, deadline, q->closed);
+            if (w != Wait::Ok) return 0;
+            n = 1;
+        }
+    }
+    if (q->tracksTasks) q->unfinished.fetch_add(n, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; ++i) pushItem(ctx, env, q, items->getAt(ctx, static_cast<int>(from + i)));
+    q->items.give(n);
+    return n;
+}
+
+/** Take one item, then up to max - 1 more that are already queued, appending them to out. */
+Wait getBatch(proto::ProtoContext* ctx, PythonEnvironment* env, QueueState* q, uint32_t max, int64_t deadline,
+              const proto::ProtoList*& out) {
+    const Wait w = q->items.take(ctx->space, deadline, q->closed);
+    if (w != Wait::Ok) return w;
+    const uint32_t n = 1 + (max > 1 ? q->items.tryTakeUpTo(max - 1) : 0);
+    for (uint32_t i = 0; i < n; ++i) out = out->appendLast(ctx, popItem(ctx, env, q));
+    if (q->maxsize) q->slots.give(n);
+    return Wait::Ok;
+}
+
+const proto::ProtoObject* putOne(proto::ProtoContext* ctx, const proto::ProtoObject* self,
+                                 const proto::ProtoObject* item, int64_t deadline) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    QueueState* q = queueOf(ctx, self);
+    if (!env || !q) return PROTO_NONE;
+    Wait w = Wait::Ok;
+    putBatch(ctx, env, q, ctx->newList()->appendLast(ctx, item), 0, 1, deadline, w);
+    if (w != Wait::Ok) raiseWait(ctx, env, self, w, true);
+    return PROTO_NONE;
+}
+
+const proto::ProtoObject* getOne(proto::ProtoContext* ctx, const proto::ProtoObject* self, int64_t deadline) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    QueueState* q = queueOf(ctx, self);
+    if (!env || !q) return PROTO_NONE;
+    const proto::ProtoList* out = ctx->newList();
+    const Wait w = getBatch(ctx, env, q, 1, deadline, out);
+    if (w != Wait::Ok) {
+        raiseWait(ctx, env, self, w, false);
+        return PROTO_NONE;
+    }
+    return out->getAt(ctx, 0);
+}
+
+const proto::ProtoList* itemsOf(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* iterable) {
+    if (!iterable || iterable == PROTO_NONE) {
+        env->raiseTypeError(ctx, "'NoneType' object is not iterable");
+        return nullptr;
+    }
+    if (const proto::ProtoList* list = iterable->asList(ctx)) return list;
+    const proto::ProtoObject* data = dataAttribute(ctx, iterable);
+    if (data && data->asList(ctx)) return data->asList(ctx);
+    const proto::ProtoList* items = ctx->newList();
+    if (const proto::ProtoTuple* tuple = iterable->asTuple(ctx)) {
+        for (unsigned long i = 0; i < tuple->getSize(ctx); ++i)
+            items = items->appendLast(ctx, tuple->getAt(ctx, static_cast<int>(i)));
+        return items;
+    }
+    const proto::ProtoObject* it = env->iter(iterable);
+    if (!it || env->hasPendingException()) return nullptr;
+    for (;;) {
+        const proto::ProtoObject* item = env->next(it);
+        if (!item) break;
+        items = items->appendLast(ctx, item);
+    }
+    return env->hasPendingException() ? nullptr : items;
+}
+
+const proto::ProtoObject* newQueue(proto::ProtoContext* ctx, const proto::ProtoObject* cls, Order order,
+                                   const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs, bool tracked) {
+    const proto::ProtoObject* maxObj = tracked ? argOrKwarg(ctx, posArgs, kwargs, 0, "maxsize") : nullptr;
+    long long maxsize = maxObj && maxObj->isInteger(ctx) ? maxObj->asLong(ctx) : 0;
+    const uint32_t bound = maxsize <= 0 ? 0 : static_cast<uint32_t>(std::min<long long>(maxsize, UINT32_MAX / 2));
+    QueueState* q = new QueueState(order, bound, tracked);
+    const proto::ProtoObject* obj = cls->newChild(ctx, true);
+    obj = obj->setAttribute(ctx, str(ctx, "__class__"), cls);
+    obj = obj->setAttribute(ctx, s_stateName, ctx->fromExternalPointer(q, queue_state_finalizer));
+    if (tracked) {
+        obj = obj->setAttribute(ctx, str(ctx, "maxsize"), ctx->fromInteger(maxsize));
+        obj = obj->setAttribute(ctx, str(ctx, "is_shutdown"), PROTO_FALSE);
+    }
+    q->owner = obj;
+    if (order == Order::Fifo) {
+        uint64_t capacity = kInitialCapacity;
+        while (bound && capacity < bound && capacity < kInitialCapacity * 8) capacity *= 2;
+        q->ring.store(newRing(ctx, q, capacity), std::memory_order_release);
+    } else {
+        q->holders = ctx->newList();
+    }
+    return obj;
+}
+
+// --- Methods ---
+
+const proto::ProtoObject* py_simple_queue_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    return newQueue(ctx, self, Order::Fifo, posArgs, kwargs, false);
+}
+
+const proto::ProtoObject* py_queue_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    return newQueue(ctx, self, Order::Fifo, posArgs, kwargs, true);
+}
+
+const proto::ProtoObject* py_lifo_queue_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    return newQueue(ctx, self, Order::Lifo, posArgs, kwargs, true);
+}
+
+const proto::ProtoObject* py_priority_queue_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    return newQueue(ctx, self, Order::Priority, posArgs, kwargs, true);
+}
+
+const proto::ProtoObject* py_queue_put(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* item = argOrKwarg(ctx, posArgs, kwargs, 0, "item");
+    if (!env || !item) {
+        if (env) env->raiseTypeError(ctx, "put() missing required argument 'item'");
+        return PROTO_NONE;
+    }
+    int64_t deadline = kForever;
+    if (!deadlineOf(ctx, env, posArgs, kwargs, 1, deadline)) return PROTO_NONE;
+    return putOne(ctx, self, item, deadline);
+}
+
+const proto::ProtoObject* py_queue_put_nowait(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    const proto::ProtoObject* item = argOrKwarg(ctx, posArgs, kwargs, 0, "item");
+    if (!item) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx))
+            env->raiseTypeError(ctx, "put_nowait() missing required argument 'item'");
+        return PROTO_NONE;
+    }
+    return putOne(ctx, self, item, monotonicNs());
+}
+
+const proto::ProtoObject* py_queue_get(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env) return PROTO_NONE;
+    int64_t deadline = kForever;
+    if (!deadlineOf(ctx, env, posArgs, kwargs, 0, deadline)) return PROTO_NONE;
+    return getOne(ctx, self, deadline);
+}
+
+const proto::ProtoObject* py_queue_get_nowait(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return getOne(ctx, self, monotonicNs());
+}
+
+/** put_many(items, block=True, timeout=None): queue every item; Full/ShutDown leave the ones already put. */
+const proto::ProtoObject* py_queue_put_many(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    QueueState* q = queueOf(ctx, self);
+    if (!env || !q) return PROTO_NONE;
+    const proto::ProtoList* items = itemsOf(ctx, env, argOrKwarg(ctx, posArgs, kwargs, 0, "items"));
+    if (!items) return PROTO_NONE;
+    int64_t deadline = kForever;
+    if (!deadlineOf(ctx, env, posArgs, kwargs, 1, deadline)) return PROTO_NONE;
+    const unsigned long total = items->getSize(ctx);
+    unsigned long done = 0;
+    while (done < total) {
+        Wait w = Wait::Ok;
+        const uint32_t chunk = static_cast<uint32_t>(std::min<unsigned long>(total - done, UINT32_MAX / 2));
+        done += putBatch(ctx, env, q, items, done, chunk, deadline, w);
+        if (w != Wait::Ok) {
+            raiseWait(ctx, env, self, w, true);
+            break;
+        }
+    }
+    return PROTO_NONE;
+}
+
+/** get_many(n, block=True, timeout=None): wait for one item, then take up to n - 1 more without waiting. */
+const proto::ProtoObject* py_queue_get_many(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    QueueState* q = queueOf(ctx, self);
+    if (!env || !q) return PROTO_NONE;
+    const proto::ProtoObject* nObj = argOrKwarg(ctx, posArgs, kwargs, 0, "n");
+    if (!nObj || !nObj->isInteger(ctx) || nObj->asLong(ctx) < 1) {
+        env->raiseValueError(ctx, ctx->fromUTF8String("n must be a positive integer"));
+        return PROTO_NONE;
+    }
+    int64_t deadline = kForever;
+    if (!deadlineOf(ctx, env, posArgs, kwargs, 1, deadline)) return PROTO_NONE;
+    const uint32_t max = static_cast<uint32_t>(std::min<long long>(nObj->asLong(ctx), UINT32_MAX / 2));
+    const proto::ProtoList* out = ctx->newList();
+    const Wait w = getBatch(ctx, env, q, max, deadline, out);
+    if (w != Wait::Ok) {
+        raiseWait(ctx, env, self, w, false);
+        return PROTO_NONE;
+    }
+    return out->asObject(ctx);
+}
+
+const proto::ProtoObject* py_queue_qsize(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    QueueState* q = queueOf(ctx, self);
+    return ctx->fromInteger(q ? q->items.count() : 0);
+}
+
+const proto::ProtoObject* py_queue_empty(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    QueueState* q = queueOf(ctx, self);
+    return !q || q->items.count() == 0 ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_queue_full(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    QueueState* q = queueOf(ctx, self);
+    return q && q->maxsize && q->items.count() >= q->maxsize ? PROTO_TRUE : PROTO_FALSE;
+}
+
+const proto::ProtoObject* py_queue_task_done(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    QueueState* q = queueOf(ctx, self);
+    if (!q) return PROTO_NONE;
+    uint32_t u = q->unfinished.load(std::memory_order_relaxed);
+    do {
+        if (u == 0) {
+            if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx))
+                env->raiseValueError(ctx, ctx->fromUTF8String("task_done() called too many times"));
+            return PROTO_NONE;
+        }
+    } while (!q->unfinished.compare_exchange_weak(u, u - 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+    if (u == 1) futexWakeAll(q->unfinished);
+    return PROTO_NONE;
+}
+
+const proto::ProtoObject* py_queue_join(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    QueueState* q = queueOf(ctx, self);
+    if (!q || q->unfinished.load(std::memory_order_acquire) == 0) return PROTO_NONE;
+    BlockingRegion blocking(ctx->space);
+    for (uint32_t u = q->unfinished.load(std::memory_order_acquire); u != 0; u = q->unfinished.load(std::memory_order_acquire))
+        futexWait(q->unfinished, u, kForever);
+    return PROTO_NONE;
+}
+
+/** shutdown(immediate=False): later puts raise ShutDown, and gets once the queue is empty; immediate drops the queued items. */
+const proto::ProtoObject* py_queue_shutdown(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    QueueState* q = queueOf(ctx, self);
+    if (!env || !q) return PROTO_NONE;
+    const proto::ProtoObject* immediateObj = argOrKwarg(ctx, posArgs, kwargs, 0, "immediate");
+    q->closed.store(true, std::memory_order_seq_cst);
+    self->setAttribute(ctx, str(ctx, "is_shutdown"), PROTO_TRUE);
+    if (immediateObj && env->isTrue(immediateObj)) {
+        while (q->items.tryTake()) {
+            popItem(ctx, env, q);
+            if (q->maxsize) q->slots.give(1);
+            uint32_t u = q->unfinished.load(std::memory_order_relaxed);
+            while (u > 0 && !q->unfinished.compare_exchange_weak(u, u - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {}
+        }
+        futexWakeAll(q->unfinished);
+    }
+    q->items.wakeAll();
+    q->slots.wakeAll();
+    return PROTO_NONE;
+}
+
+// --- Empty ---
+
+const proto::ProtoObject* py_empty_new(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
+    const proto::ProtoObject* exc = self->newChild(ctx, true);
+    exc = exc->setAttribute(ctx, str(ctx, "__class__"), self);
+    exc = exc->setAttribute(ctx, str(ctx, "args"),
+        (posArgs ? ctx->newTupleFromList(posArgs) : ctx->newTuple())->asObject(ctx));
+    return exc;
+}
+
+const proto::ProtoObject* makeClass(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* base,
+                                    const char* name, NativeMethod ctor) {
+    const proto::ProtoObject* cls = ctx->newObject(true);
+    if (base) cls = cls->addParent(ctx, base);
+    if (env && env->getTypePrototype()) cls = cls->setAttribute(ctx, str(ctx, "__class__"), env->getTypePrototype());
+    cls = cls->setAttribute(ctx, str(ctx, "__name__"), ctx->fromUTF8String(name));
+    cls = cls->setAttribute(ctx, str(ctx, "__module__"), ctx->fromUTF8String("_queue"));
+    cls = cls->setAttribute(ctx, str(ctx, "__call__"), ctx->fromMethod(nullptr, ctor));
+    return cls;
+}
+
+void ensurePrototypes(proto::ProtoContext* ctx) {
+    std::lock_guard<std::mutex> guard(s_protoMutex);
+    if (protoSpace == ctx->space) return;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    s_stateName = str(ctx, "_state");
+    s_itemName = str(ctx, "_item");
+    s_cellsName = str(ctx, "_cells");
+
+    const proto::ProtoObject* exceptionType = env && env->getBuiltins()
+        ? env->getBuiltins()->getAttribute(ctx, str(ctx, "Exception")) : nullptr;
+    const proto::ProtoObject* e = ctx->newObject(true);
+    if (exceptionType && exceptionType != PROTO_NONE) e = e->addParent(ctx, exceptionType);
+    if (env && env->getTypePrototype()) e = e->setAttribute(ctx, str(ctx, "__class__"), env->getTypePrototype());
+    e = e->setAttribute(ctx, str(ctx, "__name__"), ctx->fromUTF8String("Empty"));
+    e = e->setAttribute(ctx, str(ctx, "__module__"), ctx->fromUTF8String("_queue"));
+    e = e->setAttribute(ctx, str(ctx, "__call__"), ctx->fromMethod(nullptr, py_empty_new));
+
+    const proto::ProtoObject* object = env ? env->getObjectPrototype() : nullptr;
+    const proto::ProtoObject* s = makeClass(ctx, env, object, "SimpleQueue", py_simple_queue_new);
+    s = s->setAttribute(ctx, str(ctx, "_empty_error"), e);
+    s = s->setAttribute(ctx, str(ctx, "put"), ctx->fromMethod(nullptr, py_queue_put));
+    s = s->setAttribute(ctx, str(ctx, "put_nowait"), ctx->fromMethod(nullptr, py_queue_put_nowait));
+    s = s->setAttribute(ctx, str(ctx, "get"), ctx->fromMethod(nullptr, py_queue_get));
+    s = s->setAttribute(ctx, str(ctx, "get_nowait"), ctx->fromMethod(nullptr, py_queue_get_nowait));
+    s = s->setAttribute(ctx, str(ctx, "put_many"), ctx->fromMethod(nullptr, py_queue_put_many));
+    s = s->setAttribute(ctx, str(ctx, "get_many"), ctx->fromMethod(nullptr, py_queue_get_many));
+    s = s->setAttribute(ctx, str(ctx, "qsize"), ctx->fromMethod(nullptr, py_queue_qsize));
+    s = s->setAttribute(ctx, str(ctx, "empty"), ctx->fromMethod(nullptr, py_queue_empty));
+
+    // Queue shares SimpleQueue's methods and adds bounds and task tracking; LifoQueue and
+    // PriorityQueue derive from Queue as in queue.py.
+    const proto::ProtoObject* q = makeClass(ctx, env, s, "Queue", py_queue_new);
+    q = q->setAttribute(ctx, str(ctx, "full"), ctx->fromMethod(nullptr, py_queue_full));
+    q = q->setAttribute(ctx, str(ctx, "task_done"), ctx->fromMethod(nullptr, py_queue_task_done));
+    q = q->setAttribute(ctx, str(ctx, "join"), ctx->fromMethod(nullptr, py_queue_join));
+    q = q->setAttribute(ctx, str(ctx, "shutdown"), ctx->fromMethod(nullptr, py_queue_shutdown));
+    const proto::ProtoObject* l = makeClass(ctx, env, q, "LifoQueue", py_lifo_queue_new);
+    const proto::ProtoObject* p = makeClass(ctx, env, q, "PriorityQueue", py_priority_queue_new);
+
+    emptyError = e;
+    simpleQueueProt = s;
+    queueProt = q;
+    lifoQueueProt = l;
+    priorityQueueProt = p;
+    protoSpace = ctx->space;
+    std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+    auto& roots = ctx->space->moduleRoots;
+    roots.push_back(emptyError);
+    roots.push_back(simpleQueueProt);
+    roots.push_back(queueProt);
+    roots.push_back(lifoQueueProt);
+    roots.push_back(priorityQueueProt);
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_stateName));
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_itemName));
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_cellsName));
+}
+
+} // anonymous namespace
+
+const proto::ProtoObject* initialize(proto::ProtoContext* ctx) {
+    ensurePrototypes(ctx);
+    const proto::ProtoObject* mod = ctx->newObject(true);
+    mod = mod->setAttribute(ctx, str(ctx, "Empty"), emptyError);
+    mod = mod->setAttribute(ctx, str(ctx, "SimpleQueue"), simpleQueueProt);
+    mod = mod->setAttribute(ctx, str(ctx, "Queue"), queueProt);
+    mod = mod->setAttribute(ctx, str(ctx, "LifoQueue"), lifoQueueProt);
+    mod = mod->setAttribute(ctx, str(ctx, "PriorityQueue"), priorityQueueProt);
+    return mod;
+}
+
+} // namespace queue_module
+} // namespace protoPython
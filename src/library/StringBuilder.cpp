@@ -0,0 +1,136 @@
+#include <protoPython/StringBuilder.h>
+#include <protoCore.h>
+#include <algorithm>
+#include <mutex>
+
+namespace protoPython {
+
+namespace {
+
+/** The calling thread's last long concatenation and the builder that produced it. */
+struct StringChain {
+    const proto::ProtoObject* result = nullptr;
+    StringBuilder builder;
+    const proto::ProtoObject* holder = nullptr;  ///< Roots result (in moduleRoots).
+    const proto::ProtoString* resultName = nullptr;
+    proto::ProtoSpace* space = nullptr;
+};
+
+thread_local StringChain s_chain;
+
+const proto::ProtoObject* flatConcat(proto::ProtoContext* ctx, const proto::ProtoString* a, const proto::ProtoString* b) {
+    std::string s1, s2;
+    a->toUTF8String(ctx, s1);
+    b->toUTF8String(ctx, s2);
+    s1 += s2;
+    return ctx->fromUTF8String(s1.c_str());
+}
+
+void rootChainResult(proto::ProtoContext* ctx, StringChain& c) {
+    if (!c.holder) {
+        c.holder = ctx->newObject(true);
+        c.resultName = proto::ProtoString::fromUTF8String(ctx, "__chain_result__");
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        ctx->space->moduleRoots.push_back(c.holder);
+        ctx->space->moduleRoots.push_back(reinterpret_cast<const proto::ProtoObject*>(c.resultName));
+    }
+    c.holder->setAttribute(ctx, c.resultName, c.result);
+}
+
+} // anonymous namespace
+
+// --- StringBuilder ---
+
+void StringBuilder::append(proto::ProtoContext* ctx, const proto::ProtoString* piece) {
+    if (!piece) return;
+    const unsigned long chars = piece->getSize(ctx);
+    if (chars == 0) return;
+    if (chars >= kLeaf) {
+        flush(ctx);
+        push(ctx, piece, chars);
+        size_ += chars;
+        return;
+    }
+    scratch_.clear();
+    piece->toUTF8String(ctx, scratch_);
+    appendUTF8(ctx, scratch_, chars);
+}
+
+void StringBuilder::appendUTF8(proto::ProtoContext* ctx, const std::string& utf8, unsigned long chars) {
+    if (utf8.empty()) return;
+    pending_ += utf8;
+    pendingChars_ += chars;
+    size_ += chars;
+    if (pendingChars_ >= kLeaf) flush(ctx);
+}
+
+void StringBuilder::flush(proto::ProtoContext* ctx) {
+    if (pending_.empty()) return;
+    const unsigned long chars = pendingChars_;
+    const proto::ProtoString* leaf = proto::ProtoString::fromUTF8String(ctx, pending_.c_str());
+    pending_.clear();
+    pendingChars_ = 0;
+    push(ctx, leaf, chars);
+}
+
+void StringBuilder::push(proto::ProtoContext* ctx, const proto::ProtoString* str, unsigned long chars) {
+    parts_.push_back({str, chars});
+    while (parts_.size() >= 2 && parts_[parts_.size() - 2].chars < 2 * parts_.back().chars) {
+        Part right = parts_.back();
+        parts_.pop_back();
+        Part& left = parts_.back();
+        left.str = left.str->appendLast(ctx, right.str);
+        left.chars += right.chars;
+    }
+    folded_ = nullptr;
+}
+
+const proto::ProtoString* StringBuilder::build(proto::ProtoContext* ctx) {
+    if (!folded_ && !parts_.empty()) {
+        folded_ = parts_.back().str;
+        for (size_t i = parts_.size() - 1; i-- > 0;) folded_ = parts_[i].str->appendLast(ctx, folded_);
+    }
+    if (pending_.empty()) return folded_ ? folded_ : proto::ProtoString::fromUTF8String(ctx, "");
+    // The pending tail stays pending: the next short piece extends it instead of adding a node.
+    const proto::ProtoString* tail = proto::ProtoString::fromUTF8String(ctx, pending_.c_str());
+    return folded_ ? folded_->appendLast(ctx, tail) : tail;
+}
+
+// --- Free functions ---
+
+const proto::ProtoObject* concatStrings(proto::ProtoContext* ctx, const proto::ProtoString* a, const proto::ProtoString* b) {
+    const unsigned long na = a->getSize(ctx);
+    const unsigned long nb = b->getSize(ctx);
+    if (nb == 0) return a->asObject(ctx);
+    if (na == 0) return b->asObject(ctx);
+    if (na + nb < StringBuilder::kLeaf) return flatConcat(ctx, a, b);
+
+    StringChain& c = s_chain;
+    if (c.space != ctx->space) {
+        c = StringChain();
+        c.space = ctx->space;
+    }
+    if (!c.result || c.result != a->asObject(ctx)) {
+        c.builder = StringBuilder();
+        c.builder.append(ctx, a);
+    }
+    c.builder.append(ctx, b);
+    c.result = c.builder.build(ctx)->asObject(ctx);
+    rootChainResult(ctx, c);
+    return c.result;
+}
+
+void releaseStringChain(proto::ProtoSpace* space) {
+    StringChain& c = s_chain;
+    if (c.holder && c.space == space) {
+        std::lock_guard<std::mutex> lock(space->moduleRootsMutex);
+        auto& roots = space->moduleRoots;
+        const proto::ProtoObject* name = reinterpret_cast<const proto::ProtoObject*>(c.resultName);
+        roots.erase(std::remove_if(roots.begin(), roots.end(),
+                                   [&](const proto::ProtoObject* r) { return r == c.holder || r == name; }),
+                    roots.end());
+    }
+    c = StringChain();
+}
+
+} // namespace protoPython
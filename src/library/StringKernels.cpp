@@ -0,0 +1,453 @@
+#include <protoPython/StringKernels.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(PROTO_NO_SIMD_STRINGS) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PROTO_SIMD_STRINGS 1
+#include <immintrin.h>
+#define PROTO_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace protoPython {
+
+namespace {
+
+struct Kernels {
+    StringKernelLevel level;
+    /** needle length at least 2 and at most n. */
+    size_t (*findSubstring)(const char* s, size_t n, const char* needle, size_t m);
+    /** Same contract, last match. */
+    size_t (*findLastSubstring)(const char* s, size_t n, const char* needle, size_t m);
+    size_t (*countChar)(const char* s, size_t n, char c);
+    size_t (*findWhitespace)(const char* s, size_t n);
+    size_t (*skipWhitespace)(const char* s, size_t n);
+    size_t (*findLineBreak)(const char* s, size_t n);
+    size_t (*asciiPrefix)(const char* s, size_t n);
+    /** XOR 0x20 into bytes in [first, first + 25]: 'a' for upper, 'A' for lower. */
+    void (*flipCase)(char* s, size_t n, char first);
+};
+
+// --- Scalar ---
+
+bool isSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+size_t scalarFindSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const char last = needle[m - 1];
+    size_t i = 0;
+    while (n - i >= m) {
+        const void* p = std::memchr(s + i, needle[0], n - i - m + 1);
+        if (!p) return kNotFound;
+        i = static_cast<size_t>(static_cast<const char*>(p) - s);
+        if (s[i + m - 1] == last && std::memcmp(s + i + 1, needle + 1, m - 2) == 0) return i;
+        ++i;
+    }
+    return kNotFound;
+}
+
+size_t scalarFindLastSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const char first = needle[0];
+    const char last = needle[m - 1];
+    for (size_t i = n - m + 1; i-- > 0;) {
+        if (s[i + m - 1] == last && s[i] == first && std::memcmp(s + i + 1, needle + 1, m - 2) == 0) return i;
+    }
+    return kNotFound;
+}
+
+size_t scalarCountChar(const char* s, size_t n, char c) {
+    return static_cast<size_t>(std::count(s, s + n, c));
+}
+
+size_t scalarFindWhitespace(const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (isSpace(static_cast<unsigned char>(s[i]))) return i;
+    return kNotFound;
+}
+
+size_t scalarSkipWhitespace(const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (!isSpace(static_cast<unsigned char>(s[i]))) return i;
+    return kNotFound;
+}
+
+size_t scalarFindLineBreak(const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (s[i] == '\n' || s[i] == '\r') return i;
+    return kNotFound;
+}
+
+size_t scalarAsciiPrefix(const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n && static_cast<unsigned char>(s[i]) < 0x80) ++i;
+    return i;
+}
+
+void scalarFlipCase(char* s, size_t n, char first) {
+    for (size_t i = 0; i < n; ++i) {
+        if (static_cast<unsigned char>(s[i] - first) <= 25) s[i] ^= 0x20;
+    }
+}
+
+const Kernels kScalar = {
+    StringKernelLevel::Scalar, scalarFindSubstring, scalarFindLastSubstring, scalarCountChar, scalarFindWhitespace,
+    scalarSkipWhitespace, scalarFindLineBreak, scalarAsciiPrefix, scalarFlipCase,
+};
+
+#if defined(PROTO_SIMD_STRINGS)
+
+// --- SSE2 (baseline on x86-64) ---
+
+size_t offsetFrom(size_t base, size_t found) {
+    return found == kNotFound ? kNotFound : base + found;
+}
+
+inline unsigned firstBit(unsigned mask) {
+    return static_cast<unsigned>(__builtin_ctz(mask));
+}
+
+inline unsigned lastBit(unsigned mask) {
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+}
+
+/** 0xFF in bytes that are ' ' or in [\t, \r]. */
+inline __m128i spaceBytes16(__m128i v) {
+    const __m128i x = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                        _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8('\r' - '\t')), x));
+}
+
+size_t sse2FindSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            const size_t at = i + firstBit(mask);
+            if (std::memcmp(s + at + 1, needle + 1, m - 2) == 0) return at;
+            mask &= mask - 1;
+        }
+    }
+    return offsetFrom(i, scalarFindSubstring(s + i, n - i, needle, m));
+}
+
+/** Candidate positions [0, n - m] are taken 16 at a time from the end; the head goes to the scalar body. */
+size_t sse2FindLastSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t end = n - m + 1;  // One past the last candidate position.
+    for (; end >= 16; end -= 16) {
+        const size_t i = end - 16;
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            const unsigned bit = lastBit(mask);
+            if (std::memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= ~(1u << bit);
+        }
+    }
+    return scalarFindLastSubstring(s, end + m - 1, needle, m);
+}
+
+size_t sse2CountChar(const char* s, size_t n, char c) {
+    const __m128i target = _mm_set1_epi8(c);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, target)))));
+    }
+    return count + scalarCountChar(s + i, n - i, c);
+}
+
+size_t sse2FindWhitespace(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(spaceBytes16(v)));
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, scalarFindWhitespace(s + i, n - i));
+}
+
+size_t sse2SkipWhitespace(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(spaceBytes16(v))) ^ 0xFFFFu;
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, scalarSkipWhitespace(s + i, n - i));
+}
+
+size_t sse2FindLineBreak(const char* s, size_t n) {
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, scalarFindLineBreak(s + i, n - i));
+}
+
+size_t sse2AsciiPrefix(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))));
+        if (mask) return i + firstBit(mask);
+    }
+    return i + scalarAsciiPrefix(s + i, n - i);
+}
+
+void sse2FlipCase(char* s, size_t n, char first) {
+    const __m128i base = _mm_set1_epi8(first);
+    const __m128i span = _mm_set1_epi8(25);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(s + i);
+        const __m128i v = _mm_loadu_si128(p);
+        const __m128i x = _mm_sub_epi8(v, base);
+        const __m128i in = _mm_cmpeq_epi8(_mm_min_epu8(x, span), x);
+        _mm_storeu_si128(p, _mm_xor_si128(v, _mm_and_si128(in, bit)));
+    }
+    scalarFlipCase(s + i, n - i, first);
+}
+
+const Kernels kSSE2 = {
+    StringKernelLevel::SSE2, sse2FindSubstring, sse2FindLastSubstring, sse2CountChar, sse2FindWhitespace,
+    sse2SkipWhitespace, sse2FindLineBreak, sse2AsciiPrefix, sse2FlipCase,
+};
+
+// --- AVX2 ---
+
+PROTO_AVX2 inline __m256i spaceBytes32(__m256i v) {
+    const __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                           _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8('\r' - '\t')), x));
+}
+
+PROTO_AVX2 size_t avx2FindSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            const size_t at = i + firstBit(mask);
+            if (std::memcmp(s + at + 1, needle + 1, m - 2) == 0) return at;
+            mask &= mask - 1;
+        }
+    }
+    return offsetFrom(i, sse2FindSubstring(s + i, n - i, needle, m));
+}
+
+PROTO_AVX2 size_t avx2FindLastSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t end = n - m + 1;
+    for (; end >= 32; end -= 32) {
+        const size_t i = end - 32;
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            const unsigned bit = lastBit(mask);
+            if (std::memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= ~(1u << bit);
+        }
+    }
+    return sse2FindLastSubstring(s, end + m - 1, needle, m);
+}
+
+PROTO_AVX2 size_t avx2CountChar(const char* s, size_t n, char c) {
+    const __m256i target = _mm256_set1_epi8(c);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, target)))));
+    }
+    return count + sse2CountChar(s + i, n - i, c);
+}
+
+PROTO_AVX2 size_t avx2FindWhitespace(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(spaceBytes32(v)));
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, sse2FindWhitespace(s + i, n - i));
+}
+
+PROTO_AVX2 size_t avx2SkipWhitespace(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(spaceBytes32(v)));
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, sse2SkipWhitespace(s + i, n - i));
+}
+
+PROTO_AVX2 size_t avx2FindLineBreak(const char* s, size_t n) {
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr))));
+        if (mask) return i + firstBit(mask);
+    }
+    return offsetFrom(i, sse2FindLineBreak(s + i, n - i));
+}
+
+PROTO_AVX2 size_t avx2AsciiPrefix(const char* s, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i))));
+        if (mask) return i + firstBit(mask);
+    }
+    return i + sse2AsciiPrefix(s + i, n - i);
+}
+
+PROTO_AVX2 void avx2FlipCase(char* s, size_t n, char first) {
+    const __m256i base = _mm256_set1_epi8(first);
+    const __m256i span = _mm256_set1_epi8(25);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(s + i);
+        const __m256i v = _mm256_loadu_si256(p);
+        const __m256i x = _mm256_sub_epi8(v, base);
+        const __m256i in = _mm256_cmpeq_epi8(_mm256_min_epu8(x, span), x);
+        _mm256_storeu_si256(p, _mm256_xor_si256(v, _mm256_and_si256(in, bit)));
+    }
+    sse2FlipCase(s + i, n - i, first);
+}
+
+const Kernels kAVX2 = {
+    StringKernelLevel::AVX2, avx2FindSubstring, avx2FindLastSubstring, avx2CountChar, avx2FindWhitespace,
+    avx2SkipWhitespace, avx2FindLineBreak, avx2AsciiPrefix, avx2FlipCase,
+};
+
+#endif
+
+const Kernels* kernelsFor(StringKernelLevel level) {
+#if defined(PROTO_SIMD_STRINGS)
+    __builtin_cpu_init();
+    if (level >= StringKernelLevel::AVX2 && __builtin_cpu_supports("avx2")) return &kAVX2;
+    if (level >= StringKernelLevel::SSE2) return &kSSE2;
+#else
+    (void)level;
+#endif
+    return &kScalar;
+}
+
+std::atomic<const Kernels*> s_kernels{kernelsFor(StringKernelLevel::AVX2)};
+
+const Kernels& kernels() {
+    return *s_kernels.load(std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+StringKernelLevel stringKernelLevel() {
+    return kernels().level;
+}
+
+StringKernelLevel setStringKernelLevel(StringKernelLevel level) {
+    const Kernels* k = kernelsFor(level);
+    s_kernels.store(k, std::memory_order_relaxed);
+    return k->level;
+}
+
+size_t findChar(const char* s, size_t n, char c) {
+    const void* p = std::memchr(s, c, n);
+    return p ? static_cast<size_t>(static_cast<const char*>(p) - s) : kNotFound;
+}
+
+size_t findLastChar(const char* s, size_t n, char c) {
+#if defined(__GLIBC__)
+    const void* p = memrchr(s, c, n);
+    return p ? static_cast<size_t>(static_cast<const char*>(p) - s) : kNotFound;
+#else
+    for (size_t i = n; i-- > 0;)
+        if (s[i] == c) return i;
+    return kNotFound;
+#endif
+}
+
+size_t findSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    if (m == 0) return 0;
+    if (m > n) return kNotFound;
+    if (m == 1) return findChar(s, n, needle[0]);
+    return kernels().findSubstring(s, n, needle, m);
+}
+
+size_t findLastSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    if (m == 0) return n;
+    if (m > n) return kNotFound;
+    if (m == 1) return findLastChar(s, n, needle[0]);
+    return kernels().findLastSubstring(s, n, needle, m);
+}
+
+size_t countSubstring(const char* s, size_t n, const char* needle, size_t m) {
+    if (m == 0 || m > n) return 0;
+    if (m == 1) return kernels().countChar(s, n, needle[0]);
+    const Kernels& k = kernels();
+    size_t count = 0;
+    size_t pos = 0;
+    while (n - pos >= m) {
+        const size_t found = k.findSubstring(s + pos, n - pos, needle, m);
+        if (found == kNotFound) break;
+        ++count;
+        pos += found + m;
+    }
+    return count;
+}
+
+size_t findWhitespace(const char* s, size_t n) {
+    return kernels().findWhitespace(s, n);
+}
+
+size_t skipWhitespace(const char* s, size_t n) {
+    return kernels().skipWhitespace(s, n);
+}
+
+size_t findLineBreak(const char* s, size_t n) {
+    return kernels().findLineBreak(s, n);
+}
+
+size_t asciiPrefix(const char* s, size_t n) {
+    return kernels().asciiPrefix(s, n);
+}
+
+void asciiUpper(char* s, size_t n) {
+    kernels().flipCase(s, n, 'a');
+}
+
+void asciiLower(char* s, size_t n) {
+    kernels().flipCase(s, n, 'A');
+}
+
+} // namespace protoPython
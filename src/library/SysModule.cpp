@@ -303,7 +303,7 @@ const proto::ProtoObject* initialize(proto::ProtoContext* ctx, PythonEnvironment
         "builtins", "sys", "_io", "_os", "posix", "nt", "time", "_thread", 
         "_signal", "re", "_weakref", "_collections", "logging", "operator", 
         "_operator", "math", "functools", "itertools", "json", "atexit", 
-        "_collections_abc", "exceptions", "_codecs"
+        "_collections_abc", "exceptions", "_codecs", "_eventloop", "_futures", "_queue"
     };
     for (const char* name : builtin_names) {
         builtinsList = builtinsList->appendLast(ctx, ctx->fromUTF8String(name));
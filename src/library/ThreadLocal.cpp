@@ -0,0 +1,244 @@
+#include <protoPython/ThreadLocal.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <proto_internal.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace protoPython {
+
+namespace {
+
+/** Native side of a _local instance (external pointer under _local_state). */
+struct LocalState {
+    uint32_t slot;
+    uint64_t generation;  ///< Unique per instance, so a reused slot never matches a stale entry.
+};
+
+/** The calling thread's storage objects, indexed by slot. */
+struct ThreadSlots {
+    struct Entry {
+        uint64_t generation = 0;
+        const proto::ProtoObject* storage = nullptr;
+    };
+    std::vector<Entry> entries;
+    const proto::ProtoObject* holder = nullptr;  ///< Roots the storage objects (in moduleRoots).
+    proto::ProtoSpace* space = nullptr;
+};
+
+thread_local ThreadSlots s_threadSlots;
+
+std::mutex s_slotMutex;
+std::vector<uint32_t> s_freeSlots;
+uint32_t s_nextSlot = 0;
+std::atomic<uint64_t> s_nextGeneration{1};
+
+const proto::ProtoObject* s_localType = nullptr;
+const proto::ProtoObject* s_marker = nullptr;
+const proto::ProtoString* s_stateName = nullptr;
+const proto::ProtoString* s_argsName = nullptr;
+const proto::ProtoString* s_kwargsName = nullptr;
+const proto::ProtoString* s_storageName = nullptr;
+const proto::ProtoSpace* s_space = nullptr;
+std::mutex s_typeMutex;
+
+const proto::ProtoString* str(proto::ProtoContext* ctx, const char* s) {
+    return proto::ProtoString::fromUTF8String(ctx, s);
+}
+
+uint32_t allocateSlot() {
+    std::lock_guard<std::mutex> lock(s_slotMutex);
+    if (s_freeSlots.empty()) return s_nextSlot++;
+    const uint32_t slot = s_freeSlots.back();
+    s_freeSlots.pop_back();
+    return slot;
+}
+
+void local_state_finalizer(void* ptr) {
+    LocalState* st = static_cast<LocalState*>(ptr);
+    {
+        std::lock_guard<std::mutex> lock(s_slotMutex);
+        s_freeSlots.push_back(st->slot);
+    }
+    delete st;
+}
+
+LocalState* stateOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    const proto::ProtoObject* handle = obj->getAttribute(ctx, s_stateName);
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<LocalState*>(ext->getPointer(ctx)) : nullptr;
+}
+
+/** Call obj's __init__ with the constructor's saved arguments (a thread's first access to a subclass instance). */
+void rerunInit(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* obj) {
+    const proto::ProtoObject* init = env->getAttribute(ctx, obj, env->getInitString());
+    if (!init || init == PROTO_NONE) return;
+    const proto::ProtoObject* argsObj = obj->getAttribute(ctx, s_argsName);
+    const proto::ProtoObject* kwargsObj = obj->getAttribute(ctx, s_kwargsName);
+    const proto::ProtoList* args = argsObj && argsObj->asList(ctx) ? argsObj->asList(ctx) : ctx->newList();
+    const proto::ProtoSparseList* kwargs = kwargsObj && kwargsObj != PROTO_NONE ? kwargsObj->asSparseList(ctx) : nullptr;
+    try {
+        invokePythonCallable(ctx, init, args, kwargs);
+    } catch (const proto::ProtoObject* exc) {
+        env->setPendingException(exc);
+    }
+}
+
+bool hasCustomInit(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoObject* cls) {
+    if (!env) return false;
+    const proto::ProtoObject* init = cls->getAttribute(ctx, env->getInitString());
+    return init && init != PROTO_NONE && init != s_localType->getAttribute(ctx, env->getInitString());
+}
+
+/** Create obj's storage for the calling thread and install it in the slot table. */
+const proto::ProtoObject* createStorage(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const LocalState* st) {
+    ThreadSlots& t = s_threadSlots;
+    if (t.space != ctx->space) {
+        t.entries.clear();
+        t.holder = nullptr;
+        t.space = ctx->space;
+    }
+    if (!t.holder) {
+        t.holder = ctx->newObject(true);
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        ctx->space->moduleRoots.push_back(t.holder);
+    }
+
+    // Lookups fall through from the storage to the class, never to the instance, so a
+    // thread's storage does not keep the _local itself alive.
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoString* classS = env ? env->getClassString() : str(ctx, "__class__");
+    const proto::ProtoObject* cls = obj->getAttribute(ctx, classS);
+    const proto::ProtoObject* storage = cls && cls != PROTO_NONE ? cls->newChild(ctx, true) : ctx->newObject(true);
+    if (cls && cls != PROTO_NONE) storage = storage->setAttribute(ctx, classS, cls);
+
+    const proto::ProtoObject* current = t.holder->getAttribute(ctx, s_storageName);
+    const proto::ProtoSparseList* rooted = current && current != PROTO_NONE && current->asSparseList(ctx)
+        ? current->asSparseList(ctx) : ctx->newSparseList();
+    rooted = rooted->setAt(ctx, st->slot, storage);
+    t.holder->setAttribute(ctx, s_storageName, rooted->asObject(ctx));
+
+    if (t.entries.size() <= st->slot) t.entries.resize(st->slot + 1);
+    t.entries[st->slot] = {st->generation, storage};
+    return storage;
+}
+
+/** __call__ of _local and of classes derived from it. */
+const proto::ProtoObject* py_local_call(
+    proto::ProtoContext* ctx, const proto::ProtoObject* self,
+    const proto::ParentLink*, const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const bool customInit = hasCustomInit(ctx, env, self);
+    const bool hasArgs = (posArgs && posArgs->getSize(ctx) > 0) || (kwargs && kwargs->getSize(ctx) > 0);
+    if (hasArgs && !customInit) {
+        if (env) env->raiseTypeError(ctx, "Initialization arguments are not supported");
+        return PROTO_NONE;
+    }
+
+    LocalState* st = new LocalState{allocateSlot(), s_nextGeneration.fetch_add(1, std::memory_order_relaxed)};
+    const proto::ProtoObject* obj = ctx->newObject(true);
+    obj = obj->addParent(ctx, self);
+    obj = obj->addParent(ctx, s_marker);
+    obj = obj->setAttribute(ctx, env ? env->getClassString() : str(ctx, "__class__"), self);
+    obj = obj->setAttribute(ctx, s_stateName, ctx->fromExternalPointer(st, local_state_finalizer));
+    if (customInit) {
+        obj = obj->setAttribute(ctx, s_argsName, (posArgs ? posArgs : ctx->newList())->asObject(ctx));
+        if (kwargs) obj = obj->setAttribute(ctx, s_kwargsName, kwargs->asObject(ctx));
+    }
+    createStorage(ctx, obj, st);
+    if (customInit) {
+        rerunInit(ctx, env, obj);
+        if (env && env->hasPendingException()) return PROTO_NONE;
+    }
+    return obj;
+}
+
+bool derivesFromLocal(proto::ProtoContext* ctx, const proto::ProtoObject* cls) {
+    std::vector<const proto::ProtoObject*> work{cls};
+    for (size_t i = 0; i < work.size() && i < 64; ++i) {
+        if (work[i] == s_localType) return true;
+        const proto::ProtoList* parents = work[i]->getParents(ctx);
+        for (unsigned long j = 0; parents && j < parents->getSize(ctx); ++j)
+            work.push_back(parents->getAt(ctx, static_cast<int>(j)));
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+const proto::ProtoObject* threadLocalType(proto::ProtoContext* ctx) {
+    std::lock_guard<std::mutex> guard(s_typeMutex);
+    if (s_space == ctx->space) return s_localType;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    s_stateName = str(ctx, "_local_state");
+    s_argsName = str(ctx, "_local_args");
+    s_kwargsName = str(ctx, "_local_kwargs");
+    s_storageName = str(ctx, "_storage");
+
+    const proto::ProtoObject* type = ctx->newObject(true);
+    if (env && env->getObjectPrototype()) type = type->addParent(ctx, env->getObjectPrototype());
+    if (env && env->getTypePrototype()) type = type->setAttribute(ctx, str(ctx, "__class__"), env->getTypePrototype());
+    type = type->setAttribute(ctx, str(ctx, "__name__"), ctx->fromUTF8String("_local"));
+    type = type->setAttribute(ctx, str(ctx, "__module__"), ctx->fromUTF8String("_thread"));
+    type = type->setAttribute(ctx, str(ctx, "__call__"), ctx->fromMethod(nullptr, py_local_call));
+
+    s_marker = ctx->newObject(true);
+    s_localType = type;
+    s_space = ctx->space;
+    std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+    auto& roots = ctx->space->moduleRoots;
+    roots.push_back(s_localType);
+    roots.push_back(s_marker);
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_stateName));
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_argsName));
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_kwargsName));
+    roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_storageName));
+    return s_localType;
+}
+
+bool isThreadLocal(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!s_marker || s_space != ctx->space || !obj || obj == PROTO_NONE) return false;
+    if ((reinterpret_cast<uintptr_t>(obj) & 0x3FUL) == POINTER_TAG_EMBEDDED_VALUE) return false;
+    const proto::ProtoList* parents = obj->getParents(ctx);
+    if (!parents || parents->getSize(ctx) != 2) return false;
+    return parents->getAt(ctx, 0) == s_marker || parents->getAt(ctx, 1) == s_marker;
+}
+
+const proto::ProtoObject* threadLocalStorage(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    if (!isThreadLocal(ctx, obj)) return obj;
+    const LocalState* st = stateOf(ctx, obj);
+    if (!st) return obj;
+    const ThreadSlots& t = s_threadSlots;
+    if (t.space == ctx->space && st->slot < t.entries.size() && t.entries[st->slot].generation == st->generation)
+        return t.entries[st->slot].storage;
+
+    const proto::ProtoObject* storage = createStorage(ctx, obj, st);
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* cls = obj->getAttribute(ctx, env ? env->getClassString() : str(ctx, "__class__"));
+    if (env && cls && hasCustomInit(ctx, env, cls)) rerunInit(ctx, env, obj);
+    return storage;
+}
+
+const proto::ProtoObject* bindThreadLocalClass(proto::ProtoContext* ctx, const proto::ProtoObject* cls) {
+    if (!s_localType || s_space != ctx->space || !cls || !derivesFromLocal(ctx, cls)) return cls;
+    return cls->setAttribute(ctx, str(ctx, "__call__"), ctx->fromMethod(const_cast<proto::ProtoObject*>(cls), py_local_call));
+}
+
+void releaseThreadLocals(proto::ProtoSpace* space) {
+    ThreadSlots& t = s_threadSlots;
+    if (t.holder && t.space == space) {
+        std::lock_guard<std::mutex> lock(space->moduleRootsMutex);
+        auto& roots = space->moduleRoots;
+        roots.erase(std::remove(roots.begin(), roots.end(), t.holder), roots.end());
+    }
+    t.entries.clear();
+    t.holder = nullptr;
+    t.space = nullptr;
+}
+
+} // namespace protoPython
@@ -1,11 +1,18 @@
 #include <protoPython/ThreadModule.h>
+#include <protoPython/BlockingRegion.h>
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/FlatString.h>
+#include <protoPython/FutexSync.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/StringBuilder.h>
+#include <protoPython/ThreadLocal.h>
 #include <protoCore.h>
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <climits>
 #include <cstdlib>
 #include <cstdint>
 
@@ -19,131 +26,827 @@
 namespace protoPython {
 namespace thread_module {
 
-static const proto::ProtoObject* lockProt = nullptr;
-static const proto::ProtoObject* rlockProt = nullptr;
+// --- Synchronization primitives (futex-based, see FutexSync.h) ---
+
+/** Native state behind every _thread synchronization object, stored under _handle. */
+struct SyncHandle {
+    enum class Kind : uint32_t { Lock, RLock, Condition, Semaphore, Event, Barrier };
+    explicit SyncHandle(Kind k) : kind(k) {}
+    virtual ~SyncHandle() = default;
+    const Kind kind;
+};
 
-struct LockData {
-    std::mutex m;
-    std::atomic<bool> held{false};
+struct LockHandle : SyncHandle {
+    LockHandle() : SyncHandle(Kind::Lock) {}
+    FutexMutex mutex;
 };
 
-struct RLockData {
-    std::recursive_mutex m;
-    std::atomic<int> count{0};
+struct RLockHandle : SyncHandle {
+    RLockHandle() : SyncHandle(Kind::RLock) {}
+    FutexRecursiveMutex mutex;
 };
 
-static void mutex_finalizer(void* ptr) {
-    delete static_cast<LockData*>(ptr);
+struct ConditionHandle : SyncHandle {
+    ConditionHandle() : SyncHandle(Kind::Condition) {}
+    FutexCondition cond;
+    SyncHandle* lock{nullptr};   ///< Native Lock/RLock of _lock; nullptr when _lock is a Python lock object.
+};
+
+struct SemaphoreHandle : SyncHandle {
+    SemaphoreHandle(uint32_t value, uint32_t bound) : SyncHandle(Kind::Semaphore), sem(value), limit(bound) {}
+    FutexSemaphore sem;
+    const uint32_t limit;        ///< UINT32_MAX unless bounded.
+};
+
+struct EventHandle : SyncHandle {
+    EventHandle() : SyncHandle(Kind::Event) {}
+    FutexEvent event;
+};
+
+struct BarrierHandle : SyncHandle {
+    explicit BarrierHandle(uint32_t parties) : SyncHandle(Kind::Barrier), barrier(parties) {}
+    FutexBarrier barrier;
+};
+
+static void sync_finalizer(void* ptr) {
+    delete static_cast<SyncHandle*>(ptr);
+}
+
+static const proto::ProtoObject* lockProt = nullptr;
+static const proto::ProtoObject* rlockProt = nullptr;
+static const proto::ProtoObject* conditionProt = nullptr;
+static const proto::ProtoObject* semaphoreProt = nullptr;
+static const proto::ProtoObject* boundedSemaphoreProt = nullptr;
+static const proto::ProtoObject* eventProt = nullptr;
+static const proto::ProtoObject* barrierProt = nullptr;
+/** "_handle", created once per initialize() and rooted, so acquire/release allocate no strings. */
+static const proto::ProtoString* s_handleName = nullptr;
+static const proto::ProtoString* s_lockName = nullptr;
+
+static SyncHandle* handleOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    const proto::ProtoObject* handle = obj ? obj->getAttribute(ctx, s_handleName) : nullptr;
+    if (!handle || handle == PROTO_NONE) return nullptr;
+    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
+    return ext ? static_cast<SyncHandle*>(ext->getPointer(ctx)) : nullptr;
+}
+
+template<typename T>
+static T* handleAs(proto::ProtoContext* ctx, const proto::ProtoObject* obj, SyncHandle::Kind kind) {
+    SyncHandle* h = handleOf(ctx, obj);
+    return h && h->kind == kind ? static_cast<T*>(h) : nullptr;
+}
+
+/**
+ * Handle for a method call: self's _handle, or, for the module-level
+ * _lock_acquire(handle, ...) forms, the external pointer passed first
+ * (argOffset is then 1).
+ */
+template<typename T>
+static T* receiverHandle(proto::ProtoContext* ctx, const proto::ProtoObject* self, const proto::ProtoList* posArgs,
+                         SyncHandle::Kind kind, unsigned long& argOffset) {
+    argOffset = 0;
+    if (T* h = handleAs<T>(ctx, self, kind)) return h;
+    if (!posArgs || posArgs->getSize(ctx) < 1) return nullptr;
+    const proto::ProtoExternalPointer* ext = posArgs->getAt(ctx, 0)->asExternalPointer(ctx);
+    SyncHandle* h = ext ? static_cast<SyncHandle*>(ext->getPointer(ctx)) : nullptr;
+    if (!h || h->kind != kind) return nullptr;
+    argOffset = 1;
+    return static_cast<T*>(h);
+}
+
+static const proto::ProtoObject* kwarg(proto::ProtoContext* ctx, const proto::ProtoSparseList* kwargs, const char* name) {
+    if (!kwargs) return nullptr;
+    const unsigned long key = proto::ProtoString::fromUTF8String(ctx, name)->getHash(ctx);
+    return kwargs->has(ctx, key) ? kwargs->getAt(ctx, key) : nullptr;
+}
+
+static const proto::ProtoObject* argAt(proto::ProtoContext* ctx, const proto::ProtoList* posArgs,
+                                       const proto::ProtoSparseList* kwargs, unsigned long i, const char* name) {
+    if (posArgs && posArgs->getSize(ctx) > i) return posArgs->getAt(ctx, static_cast<int>(i));
+    return kwarg(ctx, kwargs, name);
 }
 
-static void rmutex_finalizer(void* ptr) {
-    delete static_cast<RLockData*>(ptr);
+static bool isNumber(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    return obj && (obj->isInteger(ctx) || obj->isDouble(ctx));
 }
 
+static double numberOf(proto::ProtoContext* ctx, const proto::ProtoObject* obj) {
+    return obj->isDouble(ctx) ? obj->asDouble(ctx) : static_cast<double>(obj->asLong(ctx));
+}
+
+/** Seconds to a FutexSync timeout; beyond ~292 years waits forever. */
+static int64_t secondsToNs(double seconds) {
+    if (seconds <= 0) return 0;
+    if (seconds >= 9.2e9) return -1;
+    return static_cast<int64_t>(seconds * 1e9);
+}
+
+/**
+ * Parse (blocking=True, timeout=...) into a timeout in ns: -1 forever, 0 try
+ * once. noTimeout is the value meaning "no timeout": -1 for locks (None is
+ * also accepted), None for semaphores. Raises ValueError like CPython.
+ */
+static bool parseAcquireArgs(proto::ProtoContext* ctx, PythonEnvironment* env, const proto::ProtoList* posArgs,
+                             const proto::ProtoSparseList* kwargs, unsigned long offset, int64_t& timeoutNs) {
+    const proto::ProtoObject* blockingObj = argAt(ctx, posArgs, kwargs, offset, "blocking");
+    const proto::ProtoObject* timeoutObj = argAt(ctx, posArgs, kwargs, offset + 1, "timeout");
+    const bool blocking = !blockingObj || (env ? env->isTrue(blockingObj) : blockingObj != PROTO_FALSE);
+    const bool hasTimeout = timeoutObj && timeoutObj != PROTO_NONE &&
+        !(isNumber(ctx, timeoutObj) && numberOf(ctx, timeoutObj) == -1);
+    if (!blocking) {
+        if (hasTimeout) {
+            if (env) env->raiseValueError(ctx, ctx->fromUTF8String("can't specify a timeout for a non-blocking call"));
+            return false;
+        }
+        timeoutNs = 0;
+        return true;
+    }
+    if (!hasTimeout) {
+        timeoutNs = -1;
+        return true;
+    }
+    if (!isNumber(ctx, timeoutObj) || numberOf(ctx, timeoutObj) < 0) {
+        if (env) env->raiseValueError(ctx, ctx->fromUTF8String("timeout value must be a non-negative number"));
+        return false;
+    }
+    timeoutNs = secondsToNs(numberOf(ctx, timeoutObj));
+    return true;
+}
+
+static const proto::ProtoObject* newSyncObject(proto::ProtoContext* ctx, const proto::ProtoObject* cls, SyncHandle* handle) {
+    const proto::ProtoObject* obj = cls->newChild(ctx, true);
+    obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__class__"), cls);
+    obj = obj->setAttribute(ctx, s_handleName, ctx->fromExternalPointer(handle, sync_finalizer));
+    return obj;
+}
+
+// Lock
+
 static const proto::ProtoObject* py_lock_acquire(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    unsigned long offset = 0;
+    LockHandle* h = receiverHandle<LockHandle>(ctx, self, posArgs, SyncHandle::Kind::Lock, offset);
+    if (!h) return PROTO_FALSE;
+    if (offset == 0 && (!posArgs || posArgs->getSize(ctx) == 0) && !kwargs && h->mutex.tryLock()) return PROTO_TRUE;
+    int64_t timeoutNs = -1;
+    if (!parseAcquireArgs(ctx, PythonEnvironment::fromContext(ctx), posArgs, kwargs, offset, timeoutNs)) return PROTO_NONE;
+    return h->mutex.lock(ctx->space, timeoutNs) ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_lock_release(
     proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
     const proto::ProtoList* posArgs,
     const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) {
-        if (posArgs && posArgs->getSize(ctx) >= 1) handle = posArgs->getAt(ctx, 0);
-        else return PROTO_FALSE;
+    unsigned long offset = 0;
+    LockHandle* h = receiverHandle<LockHandle>(ctx, self, posArgs, SyncHandle::Kind::Lock, offset);
+    if (h && !h->mutex.unlock()) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx)) env->raiseRuntimeError(ctx, "release unlocked lock");
     }
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_FALSE;
-    LockData* ld = static_cast<LockData*>(ext->getPointer(ctx));
-    if (!ld) return PROTO_FALSE;
-    bool blocking = true;
-    if (posArgs && posArgs->getSize(ctx) >= 1)
-        blocking = posArgs->getAt(ctx, 0) != PROTO_FALSE;
-
-    if (blocking) {
-        ld->m.lock();
-        ld->held = true;
-        return PROTO_TRUE;
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_lock_locked(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    LockHandle* h = handleAs<LockHandle>(ctx, self, SyncHandle::Kind::Lock);
+    return h && h->mutex.isLocked() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_lock_exit(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    py_lock_release(ctx, self, parentLink, ctx->newList(), nullptr);
+    return PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_allocate_lock(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* /*self*/,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    return newSyncObject(ctx, lockProt, new LockHandle());
+}
+
+// RLock
+
+static const proto::ProtoObject* py_rlock_acquire(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    unsigned long offset = 0;
+    RLockHandle* h = receiverHandle<RLockHandle>(ctx, self, posArgs, SyncHandle::Kind::RLock, offset);
+    if (!h) return PROTO_FALSE;
+    if (offset == 0 && (!posArgs || posArgs->getSize(ctx) == 0) && !kwargs && h->mutex.tryLock()) return PROTO_TRUE;
+    int64_t timeoutNs = -1;
+    if (!parseAcquireArgs(ctx, PythonEnvironment::fromContext(ctx), posArgs, kwargs, offset, timeoutNs)) return PROTO_NONE;
+    return h->mutex.lock(ctx->space, timeoutNs) ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_rlock_release(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    unsigned long offset = 0;
+    RLockHandle* h = receiverHandle<RLockHandle>(ctx, self, posArgs, SyncHandle::Kind::RLock, offset);
+    if (h && !h->mutex.unlock()) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx)) env->raiseRuntimeError(ctx, "cannot release un-acquired lock");
     }
-    if (ld->m.try_lock()) {
-        ld->held = true;
-        return PROTO_TRUE;
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_rlock_locked(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    RLockHandle* h = handleAs<RLockHandle>(ctx, self, SyncHandle::Kind::RLock);
+    return h && h->mutex.isLocked() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_rlock_is_owned(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    RLockHandle* h = handleAs<RLockHandle>(ctx, self, SyncHandle::Kind::RLock);
+    return h && h->mutex.isOwned() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+/** _release_save(): release every level for Condition.wait; returns the depth. */
+static const proto::ProtoObject* py_rlock_release_save(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    RLockHandle* h = handleAs<RLockHandle>(ctx, self, SyncHandle::Kind::RLock);
+    if (!h) return PROTO_NONE;
+    const uint32_t depth = h->mutex.releaseAll();
+    if (depth == 0) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx)) env->raiseRuntimeError(ctx, "cannot release un-acquired lock");
+        return PROTO_NONE;
     }
+    return ctx->fromInteger(depth);
+}
+
+static const proto::ProtoObject* py_rlock_acquire_restore(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    RLockHandle* h = handleAs<RLockHandle>(ctx, self, SyncHandle::Kind::RLock);
+    if (!h) return PROTO_NONE;
+    uint32_t depth = 1;
+    if (posArgs && posArgs->getSize(ctx) >= 1) {
+        const proto::ProtoObject* state = posArgs->getAt(ctx, 0);
+        if (const proto::ProtoTuple* t = state->asTuple(ctx)) state = t->getSize(ctx) > 0 ? t->getAt(ctx, 0) : state;
+        if (state->isInteger(ctx) && state->asLong(ctx) > 0) depth = static_cast<uint32_t>(state->asLong(ctx));
+    }
+    h->mutex.restore(ctx->space, depth);
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_rlock_exit(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    py_rlock_release(ctx, self, parentLink, ctx->newList(), nullptr);
     return PROTO_FALSE;
 }
 
-static const proto::ProtoObject* py_lock_release(
+static const proto::ProtoObject* py_allocate_rlock(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* /*self*/,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    return newSyncObject(ctx, rlockProt, new RLockHandle());
+}
+
+// Condition
+
+/** Call obj.name(*args); nullptr with the exception pending on failure. */
+static const proto::ProtoObject* callMethod(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const char* name,
+                                           const proto::ProtoList* args) {
+    const proto::ProtoObject* method = obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, name));
+    if (!method || method == PROTO_NONE) return nullptr;
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* result = nullptr;
+    try {
+        result = invokePythonCallable(ctx, method, args ? args : ctx->newList(), nullptr);
+    } catch (const proto::ProtoObject* exc) {
+        if (env) env->setPendingException(exc);
+        return nullptr;
+    }
+    if (env && env->hasPendingException()) return nullptr;
+    return result ? result : PROTO_NONE;
+}
+
+static bool hasMethod(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const char* name) {
+    const proto::ProtoObject* m = obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, name));
+    return m && m != PROTO_NONE;
+}
+
+static const proto::ProtoObject* conditionLock(proto::ProtoContext* ctx, const proto::ProtoObject* self) {
+    const proto::ProtoObject* lock = self->getAttribute(ctx, s_lockName);
+    return lock && lock != PROTO_NONE ? lock : nullptr;
+}
+
+/** Whether the calling thread may wait on or notify the condition (the lock is held). */
+static bool conditionOwned(proto::ProtoContext* ctx, ConditionHandle* h, const proto::ProtoObject* lock) {
+    if (h->lock && h->lock->kind == SyncHandle::Kind::Lock) return static_cast<LockHandle*>(h->lock)->mutex.isLocked();
+    if (h->lock && h->lock->kind == SyncHandle::Kind::RLock) return static_cast<RLockHandle*>(h->lock)->mutex.isOwned();
+    if (!hasMethod(ctx, lock, "_is_owned")) return true;
+    const proto::ProtoObject* owned = callMethod(ctx, lock, "_is_owned", nullptr);
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    return owned && env && env->isTrue(owned);
+}
+
+/**
+ * Release the lock, sleep until notified or timeout, reacquire. Returns 1 if
+ * notified, 0 on timeout, -1 with an exception pending.
+ */
+static int conditionWait(proto::ProtoContext* ctx, ConditionHandle* h, const proto::ProtoObject* lock, int64_t timeoutNs) {
+    const uint32_t seen = h->cond.prepareWait();
+    if (h->lock && h->lock->kind == SyncHandle::Kind::Lock) {
+        FutexMutex& m = static_cast<LockHandle*>(h->lock)->mutex;
+        m.unlock();
+        const bool notified = h->cond.waitFrom(ctx->space, seen, timeoutNs);
+        m.lock(ctx->space);
+        return notified ? 1 : 0;
+    }
+    if (h->lock && h->lock->kind == SyncHandle::Kind::RLock) {
+        FutexRecursiveMutex& m = static_cast<RLockHandle*>(h->lock)->mutex;
+        const uint32_t depth = m.releaseAll();
+        const bool notified = h->cond.waitFrom(ctx->space, seen, timeoutNs);
+        m.restore(ctx->space, depth);
+        return notified ? 1 : 0;
+    }
+    // A Python lock object: the protocol threading.Condition uses.
+    const bool saves = hasMethod(ctx, lock, "_release_save") && hasMethod(ctx, lock, "_acquire_restore");
+    const proto::ProtoObject* saved = callMethod(ctx, lock, saves ? "_release_save" : "release", nullptr);
+    if (!saved) {
+        h->cond.waitFrom(nullptr, seen, 0);
+        return -1;
+    }
+    const bool notified = h->cond.waitFrom(ctx->space, seen, timeoutNs);
+    const proto::ProtoObject* restored = saves
+        ? callMethod(ctx, lock, "_acquire_restore", ctx->newList()->appendLast(ctx, saved))
+        : callMethod(ctx, lock, "acquire", nullptr);
+    if (!restored) return -1;
+    return notified ? 1 : 0;
+}
+
+static const proto::ProtoObject* py_condition_new(
     proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
     const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    const proto::ProtoObject* lock = argAt(ctx, posArgs, kwargs, 0, "lock");
+    if (!lock || lock == PROTO_NONE) lock = newSyncObject(ctx, rlockProt, new RLockHandle());
+    ConditionHandle* h = new ConditionHandle();
+    SyncHandle* lockHandle = handleOf(ctx, lock);
+    if (lockHandle && (lockHandle->kind == SyncHandle::Kind::Lock || lockHandle->kind == SyncHandle::Kind::RLock))
+        h->lock = lockHandle;
+    const proto::ProtoObject* obj = newSyncObject(ctx, self, h);
+    return obj->setAttribute(ctx, s_lockName, lock);
+}
+
+static const proto::ProtoObject* py_condition_acquire(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    ConditionHandle* h = handleAs<ConditionHandle>(ctx, self, SyncHandle::Kind::Condition);
+    const proto::ProtoObject* lock = conditionLock(ctx, self);
+    if (!h || !lock) return PROTO_FALSE;
+    if (h->lock && h->lock->kind == SyncHandle::Kind::Lock) return py_lock_acquire(ctx, lock, parentLink, posArgs, kwargs);
+    if (h->lock && h->lock->kind == SyncHandle::Kind::RLock) return py_rlock_acquire(ctx, lock, parentLink, posArgs, kwargs);
+    const proto::ProtoObject* result = callMethod(ctx, lock, "acquire", posArgs);
+    return result ? result : PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_condition_release(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
     const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) {
-        if (posArgs && posArgs->getSize(ctx) >= 1) handle = posArgs->getAt(ctx, 0);
-        else return PROTO_NONE;
+    ConditionHandle* h = handleAs<ConditionHandle>(ctx, self, SyncHandle::Kind::Condition);
+    const proto::ProtoObject* lock = conditionLock(ctx, self);
+    if (!h || !lock) return PROTO_NONE;
+    if (h->lock && h->lock->kind == SyncHandle::Kind::Lock) return py_lock_release(ctx, lock, parentLink, ctx->newList(), nullptr);
+    if (h->lock && h->lock->kind == SyncHandle::Kind::RLock) return py_rlock_release(ctx, lock, parentLink, ctx->newList(), nullptr);
+    callMethod(ctx, lock, "release", nullptr);
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_condition_exit(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    py_condition_release(ctx, self, parentLink, ctx->newList(), nullptr);
+    return PROTO_FALSE;
+}
+
+/** A wait(timeout=None) argument in ns: -1 for None, 0 for a non-positive timeout. */
+static int64_t waitTimeoutNs(proto::ProtoContext* ctx, const proto::ProtoObject* timeoutObj) {
+    if (!timeoutObj || timeoutObj == PROTO_NONE || !isNumber(ctx, timeoutObj)) return -1;
+    return secondsToNs(numberOf(ctx, timeoutObj));
+}
+
+static const proto::ProtoObject* py_condition_wait(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    ConditionHandle* h = handleAs<ConditionHandle>(ctx, self, SyncHandle::Kind::Condition);
+    const proto::ProtoObject* lock = conditionLock(ctx, self);
+    if (!h || !lock || !env) return PROTO_FALSE;
+    if (!conditionOwned(ctx, h, lock)) {
+        if (!env->hasPendingException()) env->raiseRuntimeError(ctx, "cannot wait on un-acquired lock");
+        return PROTO_NONE;
     }
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_NONE;
-    LockData* ld = static_cast<LockData*>(ext->getPointer(ctx));
-    if (ld) {
-        ld->held = false;
-        ld->m.unlock();
+    const int64_t timeoutNs = waitTimeoutNs(ctx, argAt(ctx, posArgs, kwargs, 0, "timeout"));
+    const int r = conditionWait(ctx, h, lock, timeoutNs);
+    if (r < 0) return PROTO_NONE;
+    return r ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_condition_wait_for(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    ConditionHandle* h = handleAs<ConditionHandle>(ctx, self, SyncHandle::Kind::Condition);
+    const proto::ProtoObject* lock = conditionLock(ctx, self);
+    const proto::ProtoObject* predicate = argAt(ctx, posArgs, kwargs, 0, "predicate");
+    if (!h || !lock || !env || !predicate) return PROTO_FALSE;
+    if (!conditionOwned(ctx, h, lock)) {
+        if (!env->hasPendingException()) env->raiseRuntimeError(ctx, "cannot wait on un-acquired lock");
+        return PROTO_NONE;
     }
+    const int64_t timeoutNs = waitTimeoutNs(ctx, argAt(ctx, posArgs, kwargs, 1, "timeout"));
+    const int64_t deadline = timeoutNs < 0 ? -1 : monotonicNs() + timeoutNs;
+    const auto check = [&]() -> const proto::ProtoObject* {
+        const proto::ProtoObject* r = nullptr;
+        try {
+            r = invokePythonCallable(ctx, predicate, ctx->newList(), nullptr);
+        } catch (const proto::ProtoObject* exc) {
+            env->setPendingException(exc);
+            return nullptr;
+        }
+        return env->hasPendingException() ? nullptr : (r ? r : PROTO_NONE);
+    };
+    const proto::ProtoObject* result = check();
+    while (result && !env->isTrue(result)) {
+        int64_t left = -1;
+        if (deadline >= 0) {
+            left = deadline - monotonicNs();
+            if (left <= 0) break;
+        }
+        if (conditionWait(ctx, h, lock, left) < 0) return PROTO_NONE;
+        result = check();
+    }
+    return result ? result : PROTO_NONE;
+}
+
+static const proto::ProtoObject* conditionNotify(proto::ProtoContext* ctx, const proto::ProtoObject* self, int n) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    ConditionHandle* h = handleAs<ConditionHandle>(ctx, self, SyncHandle::Kind::Condition);
+    const proto::ProtoObject* lock = conditionLock(ctx, self);
+    if (!h || !lock || !env) return PROTO_NONE;
+    if (!conditionOwned(ctx, h, lock)) {
+        if (!env->hasPendingException()) env->raiseRuntimeError(ctx, "cannot notify on un-acquired lock");
+        return PROTO_NONE;
+    }
+    if (n < 0) h->cond.notifyAll();
+    else h->cond.notify(n);
     return PROTO_NONE;
 }
 
-static const proto::ProtoObject* py_rlock_acquire(
+static const proto::ProtoObject* py_condition_notify(
     proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
     const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    const proto::ProtoObject* nObj = argAt(ctx, posArgs, kwargs, 0, "n");
+    long long n = nObj && nObj->isInteger(ctx) ? nObj->asLong(ctx) : 1;
+    return conditionNotify(ctx, self, static_cast<int>(std::max<long long>(0, std::min<long long>(n, INT_MAX))));
+}
+
+static const proto::ProtoObject* py_condition_notify_all(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
     const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) {
-        if (posArgs && posArgs->getSize(ctx) >= 1) handle = posArgs->getAt(ctx, 0);
-        else return PROTO_FALSE;
+    return conditionNotify(ctx, self, -1);
+}
+
+// Semaphore / BoundedSemaphore
+
+static const proto::ProtoObject* newSemaphore(proto::ProtoContext* ctx, const proto::ProtoObject* cls,
+                                              const proto::ProtoList* posArgs, const proto::ProtoSparseList* kwargs, bool bounded) {
+    const proto::ProtoObject* valueObj = argAt(ctx, posArgs, kwargs, 0, "value");
+    long long value = valueObj && valueObj->isInteger(ctx) ? valueObj->asLong(ctx) : 1;
+    if (value < 0 || value > static_cast<long long>(UINT32_MAX - 1)) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx))
+            env->raiseValueError(ctx, ctx->fromUTF8String("semaphore initial value must be >= 0"));
+        return PROTO_NONE;
     }
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_FALSE;
-    RLockData* ld = static_cast<RLockData*>(ext->getPointer(ctx));
-    if (!ld) return PROTO_FALSE;
-    bool blocking = true;
-    if (posArgs && posArgs->getSize(ctx) >= 1)
-        blocking = posArgs->getAt(ctx, 0) != PROTO_FALSE;
-
-    if (blocking) {
-        ld->m.lock();
-        ld->count++;
-        return PROTO_TRUE;
+    const uint32_t v = static_cast<uint32_t>(value);
+    return newSyncObject(ctx, cls, new SemaphoreHandle(v, bounded ? v : UINT32_MAX));
+}
+
+static const proto::ProtoObject* py_semaphore_new(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    return newSemaphore(ctx, self, posArgs, kwargs, false);
+}
+
+static const proto::ProtoObject* py_bounded_semaphore_new(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    return newSemaphore(ctx, self, posArgs, kwargs, true);
+}
+
+static const proto::ProtoObject* py_semaphore_acquire(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    SemaphoreHandle* h = handleAs<SemaphoreHandle>(ctx, self, SyncHandle::Kind::Semaphore);
+    if (!h) return PROTO_FALSE;
+    if ((!posArgs || posArgs->getSize(ctx) == 0) && !kwargs && h->sem.tryAcquire()) return PROTO_TRUE;
+    int64_t timeoutNs = -1;
+    if (!parseAcquireArgs(ctx, PythonEnvironment::fromContext(ctx), posArgs, kwargs, 0, timeoutNs)) return PROTO_NONE;
+    return h->sem.acquire(ctx->space, timeoutNs) ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_semaphore_release(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    SemaphoreHandle* h = handleAs<SemaphoreHandle>(ctx, self, SyncHandle::Kind::Semaphore);
+    if (!h) return PROTO_NONE;
+    const proto::ProtoObject* nObj = argAt(ctx, posArgs, kwargs, 0, "n");
+    const long long n = nObj && nObj->isInteger(ctx) ? nObj->asLong(ctx) : 1;
+    if (n < 1) {
+        if (env) env->raiseValueError(ctx, ctx->fromUTF8String("n must be one or more"));
+        return PROTO_NONE;
     }
-    if (ld->m.try_lock()) {
-        ld->count++;
-        return PROTO_TRUE;
+    if (!h->sem.release(static_cast<uint32_t>(std::min<long long>(n, UINT32_MAX)), h->limit)) {
+        if (env) env->raiseValueError(ctx, ctx->fromUTF8String("Semaphore released too many times"));
     }
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_semaphore_exit(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    py_semaphore_release(ctx, self, parentLink, ctx->newList(), nullptr);
     return PROTO_FALSE;
 }
 
-static const proto::ProtoObject* py_rlock_release(
+// Event
+
+static const proto::ProtoObject* py_event_new(
     proto::ProtoContext* ctx,
     const proto::ProtoObject* self,
     const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* posArgs,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    return newSyncObject(ctx, self, new EventHandle());
+}
+
+static const proto::ProtoObject* py_event_is_set(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
     const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) {
-        if (posArgs && posArgs->getSize(ctx) >= 1) handle = posArgs->getAt(ctx, 0);
-        else return PROTO_NONE;
+    EventHandle* h = handleAs<EventHandle>(ctx, self, SyncHandle::Kind::Event);
+    return h && h->event.isSet() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_event_set(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (EventHandle* h = handleAs<EventHandle>(ctx, self, SyncHandle::Kind::Event)) h->event.set();
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_event_clear(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (EventHandle* h = handleAs<EventHandle>(ctx, self, SyncHandle::Kind::Event)) h->event.clear();
+    return PROTO_NONE;
+}
+
+static const proto::ProtoObject* py_event_wait(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    EventHandle* h = handleAs<EventHandle>(ctx, self, SyncHandle::Kind::Event);
+    if (!h) return PROTO_FALSE;
+    const int64_t timeoutNs = waitTimeoutNs(ctx, argAt(ctx, posArgs, kwargs, 0, "timeout"));
+    return h->event.wait(ctx->space, timeoutNs) ? PROTO_TRUE : PROTO_FALSE;
+}
+
+// Barrier
+
+/** Raise the class's _broken_error (threading.BrokenBarrierError), else RuntimeError. */
+static void raiseBrokenBarrier(proto::ProtoContext* ctx, const proto::ProtoObject* self) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    if (!env) return;
+    const proto::ProtoObject* cls = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_broken_error"));
+    if (cls && cls != PROTO_NONE) {
+        const proto::ProtoObject* exc = env->callObject(cls, {});
+        if (!env->hasPendingException() && exc && exc != PROTO_NONE) {
+            env->setPendingException(exc);
+            return;
+        }
+        if (env->hasPendingException()) return;
     }
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_NONE;
-    RLockData* ld = static_cast<RLockData*>(ext->getPointer(ctx));
-    if (ld) {
-        ld->count--;
-        ld->m.unlock();
+    env->raiseRuntimeError(ctx, "barrier is broken");
+}
+
+static const proto::ProtoObject* py_barrier_new(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    const proto::ProtoObject* partiesObj = argAt(ctx, posArgs, kwargs, 0, "parties");
+    const long long parties = partiesObj && partiesObj->isInteger(ctx) ? partiesObj->asLong(ctx) : 0;
+    if (parties < 1 || parties > static_cast<long long>(UINT32_MAX / 2)) {
+        if (PythonEnvironment* env = PythonEnvironment::fromContext(ctx))
+            env->raiseValueError(ctx, ctx->fromUTF8String("parties must be >= 1"));
+        return PROTO_NONE;
     }
+    const proto::ProtoObject* action = argAt(ctx, posArgs, kwargs, 1, "action");
+    const proto::ProtoObject* timeout = argAt(ctx, posArgs, kwargs, 2, "timeout");
+    const proto::ProtoObject* obj = newSyncObject(ctx, self, new BarrierHandle(static_cast<uint32_t>(parties)));
+    obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "parties"), ctx->fromInteger(parties));
+    obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_action"), action ? action : PROTO_NONE);
+    obj = obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_timeout"), timeout ? timeout : PROTO_NONE);
+    return obj;
+}
+
+static const proto::ProtoObject* py_barrier_wait(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* kwargs) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    BarrierHandle* h = handleAs<BarrierHandle>(ctx, self, SyncHandle::Kind::Barrier);
+    if (!h || !env) return PROTO_NONE;
+    const proto::ProtoObject* timeoutObj = argAt(ctx, posArgs, kwargs, 0, "timeout");
+    if (!timeoutObj || timeoutObj == PROTO_NONE)
+        timeoutObj = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_timeout"));
+    const int64_t timeoutNs = waitTimeoutNs(ctx, timeoutObj);
+
+    uint32_t index = 0;
+    const FutexBarrier::Result result = h->barrier.arrive(ctx->space, timeoutNs, index);
+    if (result == FutexBarrier::Result::Broken) {
+        raiseBrokenBarrier(ctx, self);
+        return PROTO_NONE;
+    }
+    if (result == FutexBarrier::Result::Last) {
+        const proto::ProtoObject* action = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_action"));
+        bool ok = true;
+        if (action && action != PROTO_NONE) {
+            try {
+                invokePythonCallable(ctx, action, ctx->newList(), nullptr);
+            } catch (const proto::ProtoObject* exc) {
+                env->setPendingException(exc);
+            }
+            ok = !env->hasPendingException();
+        }
+        // A failing action breaks the barrier and its exception propagates from this thread.
+        if (!h->barrier.complete(ok)) {
+            if (ok) raiseBrokenBarrier(ctx, self);
+            return PROTO_NONE;
+        }
+    }
+    return ctx->fromInteger(index);
+}
+
+static const proto::ProtoObject* py_barrier_reset(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (BarrierHandle* h = handleAs<BarrierHandle>(ctx, self, SyncHandle::Kind::Barrier)) h->barrier.reset();
     return PROTO_NONE;
 }
 
+static const proto::ProtoObject* py_barrier_abort(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (BarrierHandle* h = handleAs<BarrierHandle>(ctx, self, SyncHandle::Kind::Barrier)) h->barrier.abort();
+    return PROTO_NONE;
+}
+
+/** n_waiting descriptor: __get__(instance, owner). */
+static const proto::ProtoObject* py_barrier_n_waiting(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* /*self*/,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (!posArgs || posArgs->getSize(ctx) < 1) return PROTO_NONE;
+    BarrierHandle* h = handleAs<BarrierHandle>(ctx, posArgs->getAt(ctx, 0), SyncHandle::Kind::Barrier);
+    return h ? ctx->fromInteger(h->barrier.waiting()) : PROTO_NONE;
+}
+
+/** broken descriptor: __get__(instance, owner). */
+static const proto::ProtoObject* py_barrier_broken(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* /*self*/,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* posArgs,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    if (!posArgs || posArgs->getSize(ctx) < 1) return PROTO_NONE;
+    BarrierHandle* h = handleAs<BarrierHandle>(ctx, posArgs->getAt(ctx, 0), SyncHandle::Kind::Barrier);
+    return h && h->barrier.broken() ? PROTO_TRUE : PROTO_FALSE;
+}
+
+static const proto::ProtoObject* py_sync_enter(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* parentLink,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    SyncHandle* h = handleOf(ctx, self);
+    if (!h) return PROTO_NONE;
+    switch (h->kind) {
+        case SyncHandle::Kind::Lock: return py_lock_acquire(ctx, self, parentLink, ctx->newList(), nullptr);
+        case SyncHandle::Kind::RLock: return py_rlock_acquire(ctx, self, parentLink, ctx->newList(), nullptr);
+        case SyncHandle::Kind::Condition: return py_condition_acquire(ctx, self, parentLink, ctx->newList(), nullptr);
+        case SyncHandle::Kind::Semaphore: return py_semaphore_acquire(ctx, self, parentLink, ctx->newList(), nullptr);
+        default: return self;
+    }
+}
+
 /** Return current OS thread id (TID on Linux, hash of thread::id elsewhere). */
 static long long current_thread_id() {
 #if defined(__linux__)
@@ -162,21 +865,6 @@ static long long current_process_id() {
 #endif
 }
 
-static const proto::ProtoObject* py_rlock_locked(
-    proto::ProtoContext* ctx,
-    const proto::ProtoObject* self,
-    const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* /*posArgs*/,
-    const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) return PROTO_FALSE;
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_FALSE;
-    RLockData* ld = static_cast<RLockData*>(ext->getPointer(ctx));
-    if (!ld) return PROTO_FALSE;
-    return ld->count > 0 ? PROTO_TRUE : PROTO_FALSE;
-}
-
 /** Diagnostic: count distinct OS threads that enter thread_bootstrap (PROTO_THREAD_DIAG=1). Lock-free. */
 static std::atomic<int> s_bootstrapTidCount{0};
 static std::atomic<bool> s_bootstrapFirstLogged{false};
@@ -208,12 +896,17 @@ static const proto::ProtoObject* thread_bootstrap(
     const proto::ProtoObject* result = nullptr;
     {
         protoPython::PythonEnvironment::ContextScope scope(env, context);
-        const proto::ProtoObject* callable = args->getAt(context, static_cast<int>(callableIdx));
-        const proto::ProtoList* argList = context->newList();
-        for (unsigned long i = callableIdx + 1; i < args->getSize(context); ++i)
-            argList = argList->appendLast(context, args->getAt(context, static_cast<int>(i)));
-        result = protoPython::invokePythonCallable(context, callable, argList, nullptr);
+        proto::ProtoContext* threadCtx = scope.context();
+        const proto::ProtoObject* callable = args->getAt(threadCtx, static_cast<int>(callableIdx));
+        const proto::ProtoList* argList = threadCtx->newList();
+        for (unsigned long i = callableIdx + 1; i < args->getSize(threadCtx); ++i)
+            argList = argList->appendLast(threadCtx, args->getAt(threadCtx, static_cast<int>(i)));
+        result = protoPython::invokePythonCallable(threadCtx, callable, argList, nullptr);
+        threadCtx->returnValue = result;  // Promoted to context when the scope ends.
     }
+    protoPython::releaseThreadLocals(context->space);
+    protoPython::releaseStringChain(context->space);
+    protoPython::releaseFlatStrings(context->space);
     return result;
 }
 
@@ -255,47 +948,6 @@ static const proto::ProtoObject* py_log_thread_ident(
     return PROTO_NONE;
 }
 
-static const proto::ProtoObject* py_lock_locked(
-    proto::ProtoContext* ctx,
-    const proto::ProtoObject* self,
-    const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* /*posArgs*/,
-    const proto::ProtoSparseList* /*kwargs*/) {
-    const proto::ProtoObject* handle = self->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"));
-    if (!handle || handle == PROTO_NONE) return PROTO_FALSE;
-    const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
-    if (!ext) return PROTO_FALSE;
-    LockData* ld = static_cast<LockData*>(ext->getPointer(ctx));
-    if (!ld) return PROTO_FALSE;
-    return ld->held ? PROTO_TRUE : PROTO_FALSE;
-}
-
-static const proto::ProtoObject* py_allocate_lock(
-    proto::ProtoContext* ctx,
-    const proto::ProtoObject* /*self*/,
-    const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* /*posArgs*/,
-    const proto::ProtoSparseList* /*kwargs*/) {
-    proto::ProtoObject* obj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
-    if (lockProt) obj = const_cast<proto::ProtoObject*>(obj->addParent(ctx, lockProt));
-    obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"), 
-        ctx->fromExternalPointer(new LockData, mutex_finalizer));
-    return obj;
-}
-
-static const proto::ProtoObject* py_allocate_rlock(
-    proto::ProtoContext* ctx,
-    const proto::ProtoObject* /*self*/,
-    const proto::ParentLink* /*parentLink*/,
-    const proto::ProtoList* /*posArgs*/,
-    const proto::ProtoSparseList* /*kwargs*/) {
-    proto::ProtoObject* obj = const_cast<proto::ProtoObject*>(ctx->newObject(true));
-    if (rlockProt) obj = const_cast<proto::ProtoObject*>(obj->addParent(ctx, rlockProt));
-    obj->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_handle"), 
-        ctx->fromExternalPointer(new RLockData, rmutex_finalizer));
-    return obj;
-}
-
 static const proto::ProtoObject* py_get_ident(
     proto::ProtoContext* ctx,
     const proto::ProtoObject* /*self*/,
@@ -325,7 +977,10 @@ static const proto::ProtoObject* py_join_thread(
     const proto::ProtoExternalPointer* ext = handle->asExternalPointer(ctx);
     if (!ext) return PROTO_NONE;
     proto::ProtoThread* thread = static_cast<proto::ProtoThread*>(ext->getPointer(ctx));
-    if (thread) thread->join(ctx);
+    if (thread) {
+        BlockingRegion waiting(ctx->space);
+        thread->join(ctx);
+    }
     return PROTO_NONE;
 }
 
@@ -350,24 +1005,114 @@ static const proto::ProtoObject* py_is_alive(
     return PROTO_FALSE;
 }
 
+/** A native class: called to construct (ctor), with methods on the prototype. */
+static const proto::ProtoObject* makeSyncClass(proto::ProtoContext* ctx, const char* name, NativeMethod ctor,
+                                               std::initializer_list<std::pair<const char*, NativeMethod>> methods) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* cls = ctx->newObject(true);
+    if (env && env->getObjectPrototype()) cls = cls->addParent(ctx, env->getObjectPrototype());
+    if (env && env->getTypePrototype())
+        cls = cls->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__class__"), env->getTypePrototype());
+    cls = cls->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__name__"), ctx->fromUTF8String(name));
+    cls = cls->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__call__"), ctx->fromMethod(nullptr, ctor));
+    for (const auto& m : methods)
+        cls = cls->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, m.first), ctx->fromMethod(nullptr, m.second));
+    return cls;
+}
+
+/** Read-only attribute computed from the instance's native state. */
+static const proto::ProtoObject* makeView(proto::ProtoContext* ctx, NativeMethod getter) {
+    PythonEnvironment* env = PythonEnvironment::fromContext(ctx);
+    const proto::ProtoObject* desc = ctx->newObject(true);
+    desc->setAttribute(ctx, env ? env->getGetDunderString() : proto::ProtoString::fromUTF8String(ctx, "__get__"),
+        ctx->fromMethod(const_cast<proto::ProtoObject*>(desc), getter));
+    return desc;
+}
+
+static const proto::ProtoObject* py_lock_new(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    return newSyncObject(ctx, self, new LockHandle());
+}
+
+static const proto::ProtoObject* py_rlock_new(
+    proto::ProtoContext* ctx,
+    const proto::ProtoObject* self,
+    const proto::ParentLink* /*parentLink*/,
+    const proto::ProtoList* /*posArgs*/,
+    const proto::ProtoSparseList* /*kwargs*/) {
+    return newSyncObject(ctx, self, new RLockHandle());
+}
+
 const proto::ProtoObject* initialize(proto::ProtoContext* ctx) {
     const proto::ProtoObject* mod = ctx->newObject(true);
-    
-    lockProt = ctx->newObject(true);
-    lockProt = lockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "acquire"), 
-        ctx->fromMethod(nullptr, py_lock_acquire));
-    lockProt = lockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "release"), 
-        ctx->fromMethod(nullptr, py_lock_release));
-    lockProt = lockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "locked"), 
-        ctx->fromMethod(nullptr, py_lock_locked));
-
-    rlockProt = ctx->newObject(true);
-    rlockProt = rlockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "acquire"), 
-        ctx->fromMethod(nullptr, py_rlock_acquire));
-    rlockProt = rlockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "release"), 
-        ctx->fromMethod(nullptr, py_rlock_release));
-    rlockProt = rlockProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "locked"), 
-        ctx->fromMethod(nullptr, py_rlock_locked));
+
+    s_handleName = proto::ProtoString::fromUTF8String(ctx, "_handle");
+    s_lockName = proto::ProtoString::fromUTF8String(ctx, "_lock");
+
+    lockProt = makeSyncClass(ctx, "lock", py_lock_new, {
+        {"acquire", py_lock_acquire}, {"acquire_lock", py_lock_acquire},
+        {"release", py_lock_release}, {"release_lock", py_lock_release},
+        {"locked", py_lock_locked}, {"locked_lock", py_lock_locked},
+        {"__enter__", py_sync_enter}, {"__exit__", py_lock_exit}});
+
+    rlockProt = makeSyncClass(ctx, "RLock", py_rlock_new, {
+        {"acquire", py_rlock_acquire}, {"release", py_rlock_release},
+        {"locked", py_rlock_locked}, {"_is_owned", py_rlock_is_owned},
+        {"_release_save", py_rlock_release_save}, {"_acquire_restore", py_rlock_acquire_restore},
+        {"__enter__", py_sync_enter}, {"__exit__", py_rlock_exit}});
+
+    conditionProt = makeSyncClass(ctx, "Condition", py_condition_new, {
+        {"acquire", py_condition_acquire}, {"release", py_condition_release},
+        {"wait", py_condition_wait}, {"wait_for", py_condition_wait_for},
+        {"notify", py_condition_notify}, {"notify_all", py_condition_notify_all},
+        {"notifyAll", py_condition_notify_all},
+        {"__enter__", py_sync_enter}, {"__exit__", py_condition_exit}});
+
+    const std::initializer_list<std::pair<const char*, NativeMethod>> semaphoreMethods = {
+        {"acquire", py_semaphore_acquire}, {"release", py_semaphore_release},
+        {"__enter__", py_sync_enter}, {"__exit__", py_semaphore_exit}};
+    semaphoreProt = makeSyncClass(ctx, "Semaphore", py_semaphore_new, semaphoreMethods);
+    boundedSemaphoreProt = makeSyncClass(ctx, "BoundedSemaphore", py_bounded_semaphore_new, semaphoreMethods);
+
+    eventProt = makeSyncClass(ctx, "Event", py_event_new, {
+        {"is_set", py_event_is_set}, {"isSet", py_event_is_set},
+        {"set", py_event_set}, {"clear", py_event_clear}, {"wait", py_event_wait}});
+
+    barrierProt = makeSyncClass(ctx, "Barrier", py_barrier_new, {
+        {"wait", py_barrier_wait}, {"reset", py_barrier_reset}, {"abort", py_barrier_abort}});
+    barrierProt = barrierProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "n_waiting"),
+        makeView(ctx, py_barrier_n_waiting));
+    barrierProt = barrierProt->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "broken"),
+        makeView(ctx, py_barrier_broken));
+
+    {
+        std::lock_guard<std::mutex> lock(ctx->space->moduleRootsMutex);
+        auto& roots = ctx->space->moduleRoots;
+        roots.push_back(lockProt);
+        roots.push_back(rlockProt);
+        roots.push_back(conditionProt);
+        roots.push_back(semaphoreProt);
+        roots.push_back(boundedSemaphoreProt);
+        roots.push_back(eventProt);
+        roots.push_back(barrierProt);
+        roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_handleName));
+        roots.push_back(reinterpret_cast<const proto::ProtoObject*>(s_lockName));
+    }
+
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "LockType"), lockProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "lock"), lockProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "RLock"), rlockProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "Condition"), conditionProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "Semaphore"), semaphoreProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "BoundedSemaphore"), boundedSemaphoreProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "Event"), eventProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "Barrier"), barrierProt);
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "TIMEOUT_MAX"), ctx->fromDouble(9.2e9));
+    mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "_local"), threadLocalType(ctx));
 
     mod = mod->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "start_new_thread"),
         ctx->fromMethod(const_cast<proto::ProtoObject*>(mod), py_start_new_thread));
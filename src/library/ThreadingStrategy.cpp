@@ -1,21 +1,301 @@
 /*
  * ThreadingStrategy.cpp
  *
- * No std::mutex or std::atomic_flag. Task execution is inline until protoCore
- * provides a Work-Stealing Scheduler and per-thread LocalHeap. See
- * docs/REARCHITECTURE_PROTOCORE.md.
+ * Work-stealing scheduler: per-worker Chase–Lev deques, lock-free injection
+ * list, futex-backed idle parking that cooperates with stop-the-world GC.
+ * No std::mutex in submit, pop or steal. See docs/REARCHITECTURE_PROTOCORE.md.
  */
 
 #include <protoPython/ThreadingStrategy.h>
+#include <protoPython/BlockingRegion.h>
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/FlatString.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoPython/StringBuilder.h>
+#include <protoPython/ThreadLocal.h>
+#include <protoPython/MemoryManager.hpp>
+#include <protoCore.h>
+#include <proto_internal.h>
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
 
 namespace protoPython {
 
-static int s_workerCount = 0;
+namespace {
+
+constexpr int kMaxWorkers = 256;
+constexpr int kIdleSpins = 64;
+
+std::atomic<int> s_workerCount{-1};
+thread_local WorkStealingScheduler* s_currentScheduler = nullptr;
+thread_local void* s_currentWorkerSlot = nullptr;
+
+void runExecutionTask(proto::ProtoContext* ctx, SchedulerJob* job) {
+    ExecutionTask* task = static_cast<ExecutionTask*>(job);
+    const proto::ProtoObject* result = nullptr;
+    try {
+        result = executeBytecodeRange(ctx, task->constants, task->bytecode, task->names,
+                                      task->frame, task->pcStart, task->pcEnd);
+    } catch (...) {
+        result = nullptr;
+    }
+    promote(ctx, result);  // Outlives the job context: kept by the worker's thread context.
+    task->result = result;
+    task->done.store(1, std::memory_order_release);
+    task->done.notify_all();
+}
+
+} // anonymous namespace
+
+// --- WorkDeque (Chase–Lev, "Correct and Efficient Work-Stealing for Weak Memory Models") ---
+
+struct WorkDeque::Ring {
+    explicit Ring(int64_t capacity) : mask(capacity - 1), slots(new std::atomic<SchedulerJob*>[capacity]) {}
+    int64_t capacity() const { return mask + 1; }
+    SchedulerJob* get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+    void put(int64_t i, SchedulerJob* job) { slots[i & mask].store(job, std::memory_order_relaxed); }
+
+    int64_t mask;
+    std::unique_ptr<std::atomic<SchedulerJob*>[]> slots;
+};
+
+WorkDeque::WorkDeque() {
+    rings_.push_back(std::make_unique<Ring>(256));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+}
+
+WorkDeque::~WorkDeque() = default;
+
+WorkDeque::Ring* WorkDeque::grow(Ring* ring, int64_t top, int64_t bottom) {
+    auto next = std::make_unique<Ring>(ring->capacity() * 2);
+    for (int64_t i = top; i < bottom; ++i) next->put(i, ring->get(i));
+    Ring* raw = next.get();
+    rings_.push_back(std::move(next));
+    ring_.store(raw, std::memory_order_release);
+    return raw;
+}
+
+void WorkDeque::push(SchedulerJob* job) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    if (b - t > ring->capacity() - 1) ring = grow(ring, t, b);
+    ring->put(b, job);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+SchedulerJob* WorkDeque::pop() {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    SchedulerJob* job = ring->get(b);
+    if (t == b) {
+        // Last job: race the thieves for it.
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+SchedulerJob* WorkDeque::steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    Ring* ring = ring_.load(std::memory_order_acquire);
+    SchedulerJob* job = ring->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;  // Lost to the owner or another thief.
+    return job;
+}
+
+bool WorkDeque::empty() const {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+}
+
+// --- WorkStealingScheduler ---
+
+WorkStealingScheduler::WorkStealingScheduler(PythonEnvironment* env, proto::ProtoContext* ctx, int workerCount)
+    : env_(env), ctx_(ctx) {
+    workerCount = std::clamp(workerCount, 0, kMaxWorkers);
+    // Slots exist before any thread starts: thieves index workers_ without synchronization.
+    for (int i = 0; i < workerCount; ++i) {
+        auto slot = std::make_unique<WorkerSlot>();
+        slot->owner = this;
+        slot->index = static_cast<size_t>(i);
+        slot->stealSeed = 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(i + 1);
+        workers_.push_back(std::move(slot));
+    }
+    const proto::ProtoString* name = proto::ProtoString::fromUTF8String(ctx, "proto-worker");
+    for (auto& slot : workers_) {
+        const proto::ProtoList* args = ctx->newList()
+            ->appendLast(ctx, ctx->fromExternalPointer(slot.get(), nullptr));
+        slot->thread = ctx->space->newThread(ctx, name, workerMain, args, nullptr);
+    }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    wakeEpoch_.notify_all();
+    proto::ProtoContext* ctx = PythonEnvironment::getCurrentContext() ? PythonEnvironment::getCurrentContext() : ctx_;
+    BlockingRegion blocking(ctx->space);
+    for (auto& slot : workers_)
+        if (slot->thread) const_cast<proto::ProtoThread*>(slot->thread)->join(ctx);
+}
+
+WorkStealingScheduler* WorkStealingScheduler::current() {
+    return s_currentScheduler;
+}
+
+WorkStealingScheduler::WorkerSlot* WorkStealingScheduler::currentWorker() const {
+    return s_currentScheduler == this ? static_cast<WorkerSlot*>(s_currentWorkerSlot) : nullptr;
+}
+
+const proto::ProtoObject* WorkStealingScheduler::workerMain(
+    proto::ProtoContext* ctx, const proto::ProtoObject*, const proto::ParentLink*,
+    const proto::ProtoList* args, const proto::ProtoSparseList*) {
+    if (!args || args->getSize(ctx) < 1) return PROTO_NONE;
+    const proto::ProtoExternalPointer* ext = args->getAt(ctx, 0)->asExternalPointer(ctx);
+    WorkerSlot* slot = ext ? static_cast<WorkerSlot*>(ext->getPointer(ctx)) : nullptr;
+    if (!slot) return PROTO_NONE;
+    PythonEnvironment::ContextScope scope(slot->owner->env_, ctx);
+    slot->ctx = scope.context();
+    s_currentScheduler = slot->owner;
+    s_currentWorkerSlot = slot;
+    slot->owner->workerLoop(slot);
+    s_currentScheduler = nullptr;
+    s_currentWorkerSlot = nullptr;
+    releaseThreadLocals(ctx->space);
+    releaseStringChain(ctx->space);
+    releaseFlatStrings(ctx->space);
+    return PROTO_NONE;
+}
+
+void WorkStealingScheduler::submit(SchedulerJob* job) {
+    if (!job) return;
+    if (WorkerSlot* self = currentWorker()) {
+        self->deque.push(job);
+    } else {
+        SchedulerJob* head = injected_.load(std::memory_order_relaxed);
+        do {
+            job->next = head;
+        } while (!injected_.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+    }
+    // Pairs with park(): a worker that registered as a sleeper before this bump either
+    // sees the job when it rechecks or is woken here.
+    wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) wakeEpoch_.notify_one();
+}
+
+SchedulerJob* WorkStealingScheduler::takeInjected(WorkerSlot* self) {
+    if (!injected_.load(std::memory_order_relaxed)) return nullptr;
+    SchedulerJob* list = injected_.exchange(nullptr, std::memory_order_acquire);
+    if (!list) return nullptr;
+    // The list is LIFO; reverse it so the oldest job runs first and the rest can be stolen in order.
+    SchedulerJob* fifo = nullptr;
+    while (list) {
+        SchedulerJob* next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+    SchedulerJob* first = fifo;
+    for (SchedulerJob* job = first->next; job; ) {
+        SchedulerJob* next = job->next;
+        job->next = nullptr;
+        self->deque.push(job);
+        job = next;
+    }
+    first->next = nullptr;
+    if (!self->deque.empty() && sleepers_.load(std::memory_order_seq_cst) > 0) {
+        wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+        wakeEpoch_.notify_one();
+    }
+    return first;
+}
+
+SchedulerJob* WorkStealingScheduler::findJob(WorkerSlot* self) {
+    if (SchedulerJob* job = self->deque.pop()) return job;
+    if (SchedulerJob* job = takeInjected(self)) return job;
+    const size_t n = workers_.size();
+    if (n < 2) return nullptr;
+    // xorshift start position spreads thieves across victims.
+    self->stealSeed ^= self->stealSeed << 13;
+    self->stealSeed ^= self->stealSeed >> 7;
+    self->stealSeed ^= self->stealSeed << 17;
+    const size_t start = static_cast<size_t>(self->stealSeed % n);
+    for (size_t i = 0; i < n; ++i) {
+        WorkerSlot* victim = workers_[(start + i) % n].get();
+        if (victim == self) continue;
+        if (SchedulerJob* job = victim->deque.steal()) return job;
+    }
+    return nullptr;
+}
+
+bool WorkStealingScheduler::hasWork() const {
+    if (injected_.load(std::memory_order_seq_cst)) return true;
+    for (const auto& slot : workers_)
+        if (!slot->deque.empty()) return true;
+    return false;
+}
+
+void WorkStealingScheduler::runJob(WorkerSlot* self, SchedulerJob* job) {
+    gcSafepoint(self->ctx);
+    {
+        ContextScope scope(self->ctx->space, self->ctx, nullptr, nullptr, nullptr, nullptr);
+        try {
+            job->run(scope.context(), job);
+        } catch (...) {
+            // A job reports its own failure; the worker must survive it.
+        }
+        if (env_) env_->clearPendingException();
+    }
+}
+
+void WorkStealingScheduler::park(WorkerSlot* self) {
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    const uint32_t epoch = wakeEpoch_.load(std::memory_order_seq_cst);
+    if (!hasWork() && !stopping_.load(std::memory_order_seq_cst)) {
+        BlockingRegion blocking(self->ctx->space);
+        wakeEpoch_.wait(epoch, std::memory_order_seq_cst);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkStealingScheduler::workerLoop(WorkerSlot* self) {
+    int idle = 0;
+    for (;;) {
+        if (SchedulerJob* job = findJob(self)) {
+            runJob(self, job);
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire) && !hasWork()) return;
+        if (++idle < kIdleSpins) {
+            gcSafepoint(self->ctx);
+            std::this_thread::yield();
+            continue;
+        }
+        park(self);
+        idle = 0;
+    }
+}
+
+// --- Task API ---
 
 void runTaskInline(ExecutionTask* task, const proto::ProtoObject** resultOut) {
-    if (!task || !resultOut) return;
-    *resultOut = executeBytecodeRange(
+    if (!task) return;
+    task->result = executeBytecodeRange(
         task->ctx,
         task->constants,
         task->bytecode,
@@ -24,17 +304,55 @@ void runTaskInline(ExecutionTask* task, const proto::ProtoObject** resultOut) {
         task->pcStart,
         task->pcEnd
     );
+    task->done.store(1, std::memory_order_release);
+    task->done.notify_all();
+    if (resultOut) *resultOut = task->result;
 }
 
 void submitTask(ExecutionTask* task) {
     if (!task) return;
-    const proto::ProtoObject* result = nullptr;
-    runTaskInline(task, &result);
-    (void)result;
+    PythonEnvironment* env = task->ctx ? PythonEnvironment::fromContext(task->ctx) : nullptr;
+    WorkStealingScheduler* scheduler = env ? env->getScheduler(task->ctx) : nullptr;
+    if (!scheduler || scheduler->workerCount() == 0) {
+        runTaskInline(task, nullptr);
+        return;
+    }
+    task->done.store(0, std::memory_order_relaxed);
+    task->result = nullptr;
+    task->run = runExecutionTask;
+    task->next = nullptr;
+    scheduler->submit(task);
+}
+
+const proto::ProtoObject* waitTask(ExecutionTask* task) {
+    if (!task) return nullptr;
+    if (task->done.load(std::memory_order_acquire)) return task->result;
+    if (WorkStealingScheduler* scheduler = WorkStealingScheduler::current())
+        scheduler->helpWhile([task] { return !task->done.load(std::memory_order_acquire); });
+    if (!task->done.load(std::memory_order_acquire)) {
+        BlockingRegion blocking(task->ctx ? task->ctx->space : nullptr);
+        while (!task->done.load(std::memory_order_acquire)) task->done.wait(0, std::memory_order_acquire);
+    }
+    return task->result;
 }
 
 int getWorkerCount() {
-    return s_workerCount;
+    int n = s_workerCount.load(std::memory_order_relaxed);
+    if (n >= 0) return n;
+    n = -1;
+    if (const char* env = std::getenv("PROTO_WORKERS")) {
+        char* end = nullptr;
+        const long v = std::strtol(env, &end, 10);
+        if (end != env && *end == '\0' && v >= 0) n = static_cast<int>(std::min<long>(v, kMaxWorkers));
+    }
+    if (n < 0) n = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, kMaxWorkers);
+    int expected = -1;
+    s_workerCount.compare_exchange_strong(expected, n, std::memory_order_relaxed);
+    return s_workerCount.load(std::memory_order_relaxed);
+}
+
+void setWorkerCount(int count) {
+    s_workerCount.store(count < 0 ? -1 : std::min(count, kMaxWorkers), std::memory_order_relaxed);
 }
 
 } // namespace protoPython
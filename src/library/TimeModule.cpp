@@ -1,4 +1,5 @@
 #include <protoPython/TimeModule.h>
+#include <protoPython/BlockingRegion.h>
 #include <chrono>
 #include <thread>
 
@@ -26,8 +27,10 @@ static const proto::ProtoObject* py_sleep(
     const proto::ProtoList* posArgs, const proto::ProtoSparseList*) {
     if (posArgs->getSize(ctx) < 1) return PROTO_NONE;
     double sec = toDouble(ctx, posArgs->getAt(ctx, 0));
-    if (sec > 0)
+    if (sec > 0) {
+        BlockingRegion sleeping(ctx->space);
         std::this_thread::sleep_for(std::chrono::duration<double>(sec));
+    }
     return PROTO_NONE;
 }
 
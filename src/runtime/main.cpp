@@ -3,10 +3,14 @@
  * Creates PythonEnvironment and resolves a module or script path (execution stubbed).
  */
 
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/ExecutionEngine.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadingStrategy.h>
 #include <protoCore.h>
 #include <proto_internal.h>
 #include <algorithm>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -62,6 +66,7 @@ struct CliOptions {
     bool bytecodeOnly{false};
     bool trace{false};
     bool repl{false};
+    int workers{-1};
     std::string moduleName;
     std::string scriptPath;
     std::string commandLine;
@@ -126,6 +131,7 @@ static void printUsage(const char* prog) {
                  "  --dry-run         Validate inputs but skip environment initialization\n"
                  "  --bytecode-only   Stub: validate bytecode loading path (no execution)\n"
                  "  --trace           Enable tracing (stub)\n"
+                 "  --workers <n>     Scheduler worker threads (0 = run tasks inline; default PROTO_WORKERS or CPU count)\n"
                  "  --repl, -i        Interactive REPL\n"
                  "  --help, -h        Show this help message\n";
 }
@@ -164,6 +170,18 @@ static bool parseArgs(int argc, char* argv[], CliOptions& opts, std::string& err
             opts.dryRun = true;
         } else if (arg == "--bytecode-only") {
             opts.bytecodeOnly = true;
+        } else if (arg == "--workers") {
+            if (i + 1 >= argc) {
+                error = "--workers requires a value";
+                return false;
+            }
+            char* end = nullptr;
+            const long n = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || n < 0) {
+                error = "--workers requires a non-negative integer";
+                return false;
+            }
+            opts.workers = static_cast<int>(n);
         } else if (arg == "--trace") {
             opts.trace = true;
         } else if (arg == "--repl" || arg == "-i") {
@@ -215,7 +233,10 @@ int executeModule(protoPython::PythonEnvironment& env, const std::string& module
     auto* space = env.getSpace();
     if (space) {
         int count = 0;
-        while (space->runningThreads.load() > 1 && count < 100) { // Max 5s wait for stress tests
+        // Scheduler workers count as running threads but only exit with the environment.
+        const int workers = static_cast<int>(env.getSchedulerThreadCount());
+        protoPython::BlockingRegion waiting(space);
+        while (space->runningThreads.load() > 1 + workers && count < 100) { // Max 5s wait for stress tests
             usleep(50000);
             count++;
         }
@@ -224,9 +245,19 @@ int executeModule(protoPython::PythonEnvironment& env, const std::string& module
     return EXIT_OK;
 }
 
+static void printInstructionStats() {
+    std::cerr << "[proto-stats] instructions=" << protoPython::getExecutedInstructionCount() << std::endl;
+    for (const auto& s : protoPython::getSpecializationStats()) {
+        if (!s.hits && !s.quickens && !s.deopts) continue;
+        std::cerr << "[proto-stats] " << s.name << " hits=" << s.hits
+                  << " quickens=" << s.quickens << " deopts=" << s.deopts << std::endl;
+    }
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
+    if (std::getenv("PROTO_INSTR_STATS")) std::atexit(printInstructionStats);
     CliOptions options;
     std::string parseError;
     if (!parseArgs(argc, argv, options, parseError)) {
@@ -239,6 +270,7 @@ int main(int argc, char* argv[]) {
         printUsage(argv[0]);
         return EXIT_OK;
     }
+    if (options.workers >= 0) protoPython::setWorkerCount(options.workers);
     std::string exePath = getExecutablePath();
     std::string exeDir = exePath.empty() ? "." : dirName(exePath);
 
@@ -301,7 +333,9 @@ int main(int argc, char* argv[]) {
         auto* space = env.getSpace();
         if (space) {
             int count = 0;
-            while (space->runningThreads.load() > 1 && count < 100) { usleep(50000); count++; }
+            const int workers = static_cast<int>(env.getSchedulerThreadCount());
+            protoPython::BlockingRegion waiting(space);
+            while (space->runningThreads.load() > 1 + workers && count < 100) { usleep(50000); count++; }
         }
         return EXIT_OK;
     }
@@ -321,7 +355,9 @@ int main(int argc, char* argv[]) {
         auto* space = env.getSpace();
         if (space) {
             int count = 0;
-            while (space->runningThreads.load() > 1 && count < 100) { usleep(50000); count++; }
+            const int workers = static_cast<int>(env.getSchedulerThreadCount());
+            protoPython::BlockingRegion waiting(space);
+            while (space->runningThreads.load() > 1 + workers && count < 100) { usleep(50000); count++; }
         }
 
         if (ret == -2) return EXIT_RUNTIME;
@@ -7,6 +7,7 @@
 #include <protoPython/BasicBlockAnalysis.h>
 #include <protoPython/ExecutionEngine.h>
 #include <protoCore.h>
+#include <memory>
 
 TEST(BasicBlockAnalysisTest, EmptyBytecodeReturnsEmpty) {
     proto::ProtoSpace space;
@@ -89,3 +90,44 @@ TEST(BasicBlockAnalysisTest, NullBytecodeReturnsEmpty) {
     auto blocks = protoPython::getBasicBlockBoundaries(&ctx, nullptr);
     EXPECT_TRUE(blocks.empty());
 }
+
+TEST(BasicBlockAnalysisTest, FusedCompareJumpEndsBlock) {
+    proto::ProtoSpace space;
+    proto::ProtoContext ctx(&space);
+    // 0: LOAD_FAST 0, 2: LOAD_FAST 1, 4: COMPARE_OP 2, 6: POP_JUMP_IF_FALSE 12,
+    // 8: LOAD_CONST 0, 10: RETURN_VALUE, 12: LOAD_CONST 1, 14: RETURN_VALUE
+    const proto::ProtoList* bytecode = ctx.newList()
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_FAST))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_FAST))->appendLast(&ctx, ctx.fromInteger(1))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_COMPARE_OP))->appendLast(&ctx, ctx.fromInteger(2))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_POP_JUMP_IF_FALSE))->appendLast(&ctx, ctx.fromInteger(12))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_CONST))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_RETURN_VALUE))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_CONST))->appendLast(&ctx, ctx.fromInteger(1))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_RETURN_VALUE))->appendLast(&ctx, ctx.fromInteger(0));
+    std::unique_ptr<protoPython::DecodedCode> code(protoPython::decodeBytecode(&ctx, nullptr, bytecode, nullptr));
+    EXPECT_EQ(code->instrs[0].fused, protoPython::OP_LOAD_FAST_LOAD_FAST);
+    EXPECT_EQ(code->instrs[2].fused, protoPython::OP_COMPARE_OP_POP_JUMP_IF_FALSE);
+    EXPECT_EQ(code->instrs[2].generic, protoPython::OP_COMPARE_OP);
+
+    auto blocks = protoPython::getBasicBlockBoundaries(*code);
+    ASSERT_EQ(blocks.size(), 2u);
+    EXPECT_EQ(blocks[0].first, 0u);
+    EXPECT_EQ(blocks[0].second, 6u);  /* ends at the covered POP_JUMP_IF_FALSE */
+    EXPECT_EQ(blocks[1].first, 12u);
+    EXPECT_EQ(blocks[1].second, 14u);
+}
+
+TEST(BasicBlockAnalysisTest, NoFusionAcrossJumpTarget) {
+    proto::ProtoSpace space;
+    proto::ProtoContext ctx(&space);
+    // 0: JUMP_ABSOLUTE 4, 2: LOAD_FAST 0, 4: LOAD_FAST 1, 6: RETURN_VALUE
+    const proto::ProtoList* bytecode = ctx.newList()
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_JUMP_ABSOLUTE))->appendLast(&ctx, ctx.fromInteger(4))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_FAST))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_FAST))->appendLast(&ctx, ctx.fromInteger(1))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_RETURN_VALUE))->appendLast(&ctx, ctx.fromInteger(0));
+    std::unique_ptr<protoPython::DecodedCode> code(protoPython::decodeBytecode(&ctx, nullptr, bytecode, nullptr));
+    EXPECT_EQ(code->instrs[1].fused, 0);
+    EXPECT_EQ(code->instrs[1].op, protoPython::OP_LOAD_FAST);
+}
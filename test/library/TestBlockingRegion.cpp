@@ -0,0 +1,125 @@
+/*
+ * Tests for BlockingRegion: nesting, and stop-the-world latency while another
+ * thread is blocked in time.sleep or a lock acquire. The test thread plays the
+ * collector: it raises stwFlag and times how long until every other running
+ * thread is counted as parked.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadingStrategy.h>
+#include <protoCore.h>
+#include <proto_internal.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "TestSupport.h"
+
+using protoPythonTest::runSourceIn;
+
+namespace {
+
+/** Wait (GC-safe) until runningThreads reaches target; false on timeout. */
+bool waitForRunning(proto::ProtoSpace* space, int target) {
+    protoPython::BlockingRegion waiting(space);
+    for (int i = 0; i < 500; ++i) {
+        if (space->runningThreads.load() == target) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+/**
+ * Stop the world the way the collector does and return how long it took for the
+ * threads started since baseline to park. Capped at five seconds.
+ */
+std::chrono::milliseconds stopTheWorld(proto::ProtoSpace* space, int baseline) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
+        space->stwFlag.store(true);
+        space->gcCV.wait_for(lock, std::chrono::seconds(5), [space, baseline] {
+            return space->parkedThreads >= space->runningThreads - baseline;
+        });
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    {
+        std::lock_guard<std::recursive_mutex> lock(proto::ProtoSpace::globalMutex);
+        space->stwFlag.store(false);
+        space->stopTheWorldCV.notify_all();
+    }
+    return elapsed;
+}
+
+} // namespace
+
+TEST(BlockingRegionTest, NestedRegionsParkOnce) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoSpace* space = env.getSpace();
+    const int parked = space->parkedThreads;
+    {
+        protoPython::BlockingRegion outer(space);
+        EXPECT_EQ(space->parkedThreads, parked + 1);
+        {
+            protoPython::BlockingRegion inner(space);
+            EXPECT_EQ(space->parkedThreads, parked + 1);
+        }
+        EXPECT_EQ(space->parkedThreads, parked + 1);
+    }
+    EXPECT_EQ(space->parkedThreads, parked);
+    protoPython::enterBlockingRegion(nullptr);  // No space: no-op.
+    protoPython::leaveBlockingRegion(nullptr);
+}
+
+TEST(BlockingRegionTest, SleepingThreadDoesNotDelayStopTheWorld) {
+    protoPython::setWorkerCount(0);
+    {
+        protoPython::PythonEnvironment env(STDLIB_PATH);
+        proto::ProtoContext* ctx = env.getContext();
+        proto::ProtoSpace* space = env.getSpace();
+        proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+        const int baseline = space->runningThreads.load();
+
+        ASSERT_TRUE(runSourceIn(env, frame,
+            "import _thread, time\n"
+            "_thread.start_new_thread(time.sleep, (2.0,))\n"));
+        ASSERT_TRUE(waitForRunning(space, baseline + 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Let it reach sleep().
+
+        // Before blocking regions this waited out the rest of the two-second sleep.
+        EXPECT_LT(stopTheWorld(space, baseline).count(), 500);
+        EXPECT_TRUE(waitForRunning(space, baseline));
+    }
+    protoPython::setWorkerCount(-1);
+}
+
+TEST(BlockingRegionTest, LockWaiterDoesNotDelayStopTheWorld) {
+    protoPython::setWorkerCount(0);
+    {
+        protoPython::PythonEnvironment env(STDLIB_PATH);
+        proto::ProtoContext* ctx = env.getContext();
+        proto::ProtoSpace* space = env.getSpace();
+        proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+        const int baseline = space->runningThreads.load();
+
+        ASSERT_TRUE(runSourceIn(env, frame,
+            "import _thread\n"
+            "lock = _thread.allocate_lock()\n"
+            "lock.acquire()\n"
+            "def waiter():\n"
+            "    lock.acquire()\n"
+            "    lock.release()\n"
+            "_thread.start_new_thread(waiter, ())\n"));
+        ASSERT_TRUE(waitForRunning(space, baseline + 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Let it block in acquire().
+
+        EXPECT_LT(stopTheWorld(space, baseline).count(), 500);
+        ASSERT_TRUE(runSourceIn(env, frame, "lock.release()\n"));
+        EXPECT_TRUE(waitForRunning(space, baseline));
+    }
+    protoPython::setWorkerCount(-1);
+}
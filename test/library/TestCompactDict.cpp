@@ -0,0 +1,214 @@
+/*
+ * Tests for the compact dict table: insertion order across deletes and
+ * resizes, overwrite and pop, popitem order, the persistent entries
+ * snapshot and cached views, rooting through __dict_entries__ (a
+ * self-referencing dict is collected), the older __keys__/__data__ layout,
+ * and a dict handed to other threads (bias revocation, shared-index reads).
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/CompactDict.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(CompactDictTest, NativeTableKeepsInsertionOrder) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* dict = protoPython::newDict(ctx);
+    ASSERT_NE(protoPython::dictTable(ctx, dict), nullptr);
+
+    // Enough keys to resize the index several times.
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_TRUE(protoPython::dictSet(ctx, dict, ctx->fromInteger(i), ctx->fromInteger(i * 2)));
+    EXPECT_EQ(protoPython::dictSize(ctx, dict), 1000u);
+    for (int i = 0; i < 1000; i += 2)
+        ASSERT_NE(protoPython::dictPop(ctx, dict, ctx->fromInteger(i)), nullptr);
+    EXPECT_EQ(protoPython::dictSize(ctx, dict), 500u);
+    EXPECT_EQ(protoPython::dictGet(ctx, dict, ctx->fromInteger(10)), nullptr);
+    ASSERT_NE(protoPython::dictGet(ctx, dict, ctx->fromInteger(11)), nullptr);
+    EXPECT_EQ(protoPython::dictGet(ctx, dict, ctx->fromInteger(11))->asLong(ctx), 22);
+
+    // Overwriting keeps the position; reinsertion goes to the end.
+    protoPython::dictSet(ctx, dict, ctx->fromInteger(1), ctx->fromInteger(-1));
+    protoPython::dictSet(ctx, dict, ctx->fromInteger(0), ctx->fromInteger(0));
+    const proto::ProtoList* keys = protoPython::dictKeys(ctx, dict);
+    ASSERT_EQ(keys->getSize(ctx), 501u);
+    EXPECT_EQ(keys->getAt(ctx, 0)->asLong(ctx), 1);
+    EXPECT_EQ(keys->getAt(ctx, 1)->asLong(ctx), 3);
+    EXPECT_EQ(keys->getAt(ctx, 500)->asLong(ctx), 0);
+    EXPECT_EQ(protoPython::dictGet(ctx, dict, ctx->fromInteger(1))->asLong(ctx), -1);
+}
+
+TEST(CompactDictTest, EntriesSnapshotIsStable) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* dict = protoPython::newDict(ctx);
+    protoPython::dictSet(ctx, dict, ctx->fromUTF8String("a"), ctx->fromInteger(1));
+    protoPython::dictSet(ctx, dict, ctx->fromUTF8String("b"), ctx->fromInteger(2));
+    const proto::ProtoList* before = protoPython::dictEntries(ctx, dict);
+    protoPython::dictPop(ctx, dict, ctx->fromUTF8String("a"));
+    protoPython::dictSet(ctx, dict, ctx->fromUTF8String("c"), ctx->fromInteger(3));
+    ASSERT_EQ(before->getSize(ctx), 4u);
+    EXPECT_EQ(before->getAt(ctx, 1)->asLong(ctx), 1);
+    const proto::ProtoList* after = protoPython::dictEntries(ctx, dict);
+    ASSERT_EQ(after->getSize(ctx), 4u);
+    EXPECT_EQ(after->getAt(ctx, 1)->asLong(ctx), 2);
+    EXPECT_EQ(after->getAt(ctx, 3)->asLong(ctx), 3);
+}
+
+TEST(CompactDictTest, ViewsAreCachedUntilWrite) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* dict = protoPython::newDict(ctx);
+    for (int i = 0; i < 20; ++i)
+        protoPython::dictSet(ctx, dict, ctx->fromInteger(i), ctx->fromInteger(i));
+    const proto::ProtoList* keys = protoPython::dictKeys(ctx, dict);
+    const proto::ProtoList* entries = protoPython::dictEntries(ctx, dict);
+    const proto::ProtoSparseList* data = protoPython::dictHashData(ctx, dict);
+    EXPECT_EQ(protoPython::dictKeys(ctx, dict), keys);
+    EXPECT_EQ(protoPython::dictEntries(ctx, dict), entries);
+    EXPECT_EQ(protoPython::dictHashData(ctx, dict), data);
+
+    // An overwrite keeps the key order; any write drops the other views.
+    protoPython::dictSet(ctx, dict, ctx->fromInteger(3), ctx->fromInteger(-3));
+    EXPECT_EQ(protoPython::dictKeys(ctx, dict), keys);
+    EXPECT_NE(protoPython::dictEntries(ctx, dict), entries);
+    EXPECT_EQ(protoPython::dictEntries(ctx, dict)->getAt(ctx, 7)->asLong(ctx), -3);
+    EXPECT_EQ(entries->getAt(ctx, 7)->asLong(ctx), 3);
+    protoPython::dictPop(ctx, dict, ctx->fromInteger(0));
+    ASSERT_NE(protoPython::dictKeys(ctx, dict), keys);
+    EXPECT_EQ(protoPython::dictKeys(ctx, dict)->getSize(ctx), 19u);
+    EXPECT_EQ(protoPython::dictHashData(ctx, dict)->getSize(ctx), 19u);
+}
+
+TEST(CompactDictTest, EntriesAreRootedThroughTheDict) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* dict = protoPython::newDict(ctx);
+    for (int i = 0; i < 100; ++i)
+        protoPython::dictSet(ctx, dict, ctx->fromInteger(i), ctx->fromInteger(i * 2));
+    protoPython::dictPop(ctx, dict, ctx->fromInteger(40));
+
+    // One holder per chunk of kChunkEntries entries, each with its [k, v, ...] chunk under __data__.
+    const proto::ProtoObject* roots = attr(ctx, dict, "__dict_entries__");
+    ASSERT_NE(roots, nullptr);
+    ASSERT_NE(roots->asList(ctx), nullptr);
+    const size_t chunks = (100 + protoPython::DictTable::kChunkEntries - 1) / protoPython::DictTable::kChunkEntries;
+    ASSERT_EQ(roots->asList(ctx)->getSize(ctx), chunks);
+    const proto::ProtoObject* second = attr(ctx, roots->asList(ctx)->getAt(ctx, 1), "__data__");
+    ASSERT_NE(second, nullptr);
+    const proto::ProtoList* chunk = second->asList(ctx);
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(chunk->getSize(ctx), 2 * protoPython::DictTable::kChunkEntries);
+    const int hole = 2 * (40 - static_cast<int>(protoPython::DictTable::kChunkEntries));
+    EXPECT_EQ(chunk->getAt(ctx, hole), PROTO_NONE);
+    EXPECT_EQ(chunk->getAt(ctx, hole + 2)->asLong(ctx), 41);
+    EXPECT_EQ(chunk->getAt(ctx, hole + 3)->asLong(ctx), 82);
+}
+
+TEST(CompactDictTest, SelfReferencingDictIsCollected) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    const size_t before = protoPython::DictTable::liveCount();
+    proto::ProtoObject* frame = runSource(env,
+        "def make():\n"
+        "    d = {}\n"
+        "    d['self'] = d\n"
+        "    d['payload'] = [0] * 100\n"
+        "for _ in range(200):\n"
+        "    make()\n");
+    ASSERT_NE(frame, nullptr);
+    ASSERT_FALSE(env.hasPendingException());
+    // Nothing outside the cycles refers to them, so most must go (the collector is conservative).
+    EXPECT_TRUE(protoPythonTest::collectUntil(env, [before] {
+        return protoPython::DictTable::liveCount() <= before + 50;
+    }));
+}
+
+TEST(CompactDictTest, OlderLayoutStillWorks) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* dict = ctx->newObject(true)->addParent(ctx, env.getDictPrototype());
+    dict->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__keys__"), ctx->newList()->asObject(ctx));
+    dict->setAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__data__"), ctx->newSparseList()->asObject(ctx));
+    EXPECT_EQ(protoPython::dictTable(ctx, dict), nullptr);
+    EXPECT_TRUE(protoPython::isDictLike(ctx, dict));
+    protoPython::dictSet(ctx, dict, ctx->fromUTF8String("x"), ctx->fromInteger(7));
+    EXPECT_EQ(protoPython::dictSize(ctx, dict), 1u);
+    EXPECT_EQ(protoPython::dictGet(ctx, dict, ctx->fromUTF8String("x"))->asLong(ctx), 7);
+    EXPECT_EQ(protoPython::dictKeys(ctx, dict)->getSize(ctx), 1u);
+    EXPECT_NE(protoPython::dictPop(ctx, dict, ctx->fromUTF8String("x")), nullptr);
+    EXPECT_EQ(protoPython::dictSize(ctx, dict), 0u);
+}
+
+TEST(CompactDictTest, PythonDictSemantics) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "d = {'a': 1, 'b': 2, 'c': 3}\n"
+        "d['a'] = 10\n"
+        "del d['b']\n"
+        "d['b'] = 20\n"
+        "order_ok = list(d) == ['a', 'c', 'b']\n"
+        "get_ok = d['a'] == 10 and d.get('zz', 5) == 5 and 'c' in d and 'zz' not in d\n"
+        "try:\n"
+        "    d['missing']\n"
+        "    key_error = False\n"
+        "except KeyError:\n"
+        "    key_error = True\n"
+        "popitem_ok = d.popitem() == ('b', 20) and len(d) == 2\n"
+        "squares = {i: i * i for i in range(200)}\n"
+        "comp_ok = len(squares) == 200 and squares[199] == 199 * 199\n"
+        "merged = dict(squares)\n"
+        "merged.update({0: -1})\n"
+        "copy_ok = merged[0] == -1 and squares[0] == 0 and len(merged) == 200\n"
+        "unpacked = {**d, 'z': 0}\n"
+        "unpack_ok = list(unpacked) == ['a', 'c', 'z']\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "order_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "get_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "key_error"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "popitem_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "comp_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "copy_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "unpack_ok"), PROTO_TRUE);
+}
+
+TEST(CompactDictTest, SharedAcrossThreads) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading\n"
+        "shared = {}\n"
+        "lock = threading.Lock()\n"
+        "def worker(base):\n"
+        "    for i in range(500):\n"
+        "        shared[base + i] = i\n"
+        "    with lock:\n"
+        "        shared['done' + str(base)] = True\n"
+        "ts = [threading.Thread(target=worker, args=(n * 1000,)) for n in range(4)]\n"
+        "for t in ts: t.start()\n"
+        "for t in ts: t.join()\n"
+        "size_ok = len(shared) == 4 * 500 + 4\n"
+        "values_ok = all(shared[n * 1000 + 499] == 499 for n in range(4))\n"
+        "seen = []\n"
+        "def reader(base):\n"
+        "    seen.append(all(shared[base + i] == i for i in range(500)) and (base + 500) not in shared)\n"
+        "rs = [threading.Thread(target=reader, args=(n * 1000,)) for n in range(4)]\n"
+        "for t in rs: t.start()\n"
+        "for t in rs: t.join()\n"
+        "del shared[0]\n"
+        "shared[1] = -1\n"
+        "reads_ok = seen == [True] * 4 and 0 not in shared and shared[1] == -1 and shared.get(2) == 2\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "size_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "values_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "reads_ok"), PROTO_TRUE);
+}
@@ -0,0 +1,142 @@
+/*
+ * Tests for EventLoop: ring-buffer ready queue, timer ordering, task joins,
+ * fd readiness and cross-thread posts.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/EventLoop.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(EventLoopTest, RingQueueWrapsAndGrows) {
+    protoPython::RingQueue<int> q;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 50; ++i) q.push(i);
+        for (int i = 0; i < 50; ++i) EXPECT_EQ(q.pop(), i);
+    }
+    // Grow while head is mid-buffer: order must survive the copy.
+    for (int i = 0; i < 40; ++i) q.push(i);
+    for (int i = 0; i < 30; ++i) EXPECT_EQ(q.pop(), i);
+    for (int i = 40; i < 200; ++i) q.push(i);
+    EXPECT_EQ(q.size(), 170u);
+    for (int i = 30; i < 200; ++i) EXPECT_EQ(q.pop(), i);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(EventLoopTest, TasksTimersAndJoins) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "import _eventloop as loop\n"
+        "order = []\n"
+        "async def worker(name, delay):\n"
+        "    await loop.sleep(delay)\n"
+        "    order.append(name)\n"
+        "    return name\n"
+        "async def fails():\n"
+        "    await loop.sleep(0)\n"
+        "    raise ValueError('boom')\n"
+        "async def main():\n"
+        "    slow = loop.create_task(worker('slow', 0.05))\n"
+        "    fast = loop.create_task(worker('fast', 0.01))\n"
+        "    bad = loop.create_task(fails())\n"
+        "    got = await slow\n"
+        "    got += await fast\n"
+        "    try:\n"
+        "        await bad\n"
+        "    except ValueError:\n"
+        "        got += '!'\n"
+        "    return got + str(await loop.sleep(0, 7))\n"
+        "start = loop.time()\n"
+        "r = loop.run(main())\n"
+        "elapsed = loop.time() - start\n"
+        "first = order[0]\n";
+    proto::ProtoObject* frame = runSource(env, source);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+
+    std::string r;
+    const proto::ProtoObject* rObj = attr(ctx, frame, "r");
+    ASSERT_NE(rObj, nullptr);
+    ASSERT_TRUE(rObj->isString(ctx));
+    rObj->asString(ctx)->toUTF8String(ctx, r);
+    EXPECT_EQ(r, "slowfast!7");
+    std::string first;
+    attr(ctx, frame, "first")->asString(ctx)->toUTF8String(ctx, first);
+    EXPECT_EQ(first, "fast");  // Timers fire by deadline, not creation order.
+    const proto::ProtoObject* elapsed = attr(ctx, frame, "elapsed");
+    ASSERT_NE(elapsed, nullptr);
+    EXPECT_GE(elapsed->asDouble(ctx), 0.049);
+}
+
+TEST(EventLoopTest, FdReadinessAndPostWakeTheLoop) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    const std::string source =
+        "import _eventloop as loop\n"
+        "async def reader(fd):\n"
+        "    await loop.wait_readable(fd)\n"
+        "    return 'readable'\n";
+    proto::ProtoObject* frame = runSource(env, source);
+    ASSERT_NE(frame, nullptr);
+    const proto::ProtoObject* reader = attr(ctx, frame, "reader");
+    ASSERT_NE(reader, nullptr);
+    const proto::ProtoObject* coro = env.callObject(reader, {ctx->fromInteger(fds[0])});
+    ASSERT_NE(coro, nullptr);
+
+    protoPython::EventLoop loop(&env, ctx);
+    EXPECT_EQ(protoPython::EventLoop::current(), &loop);
+    bool posted = false;
+    loop.holdForPost();
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop.post([&](proto::ProtoContext*) { posted = true; }, true);
+        const char byte = 'x';
+        ASSERT_EQ(write(fds[1], &byte, 1), 1);
+    });
+    const proto::ProtoObject* result = loop.runUntilComplete(coro);
+    writer.join();
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_NE(result, nullptr);
+    std::string s;
+    result->asString(ctx)->toUTF8String(ctx, s);
+    EXPECT_EQ(s, "readable");
+    EXPECT_TRUE(posted);
+    EXPECT_EQ(loop.timerCount(), 0u);
+}
+
+TEST(EventLoopTest, StalledLoopRaises) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "import _eventloop as loop\n"
+        "async def waits_on(box, i):\n"
+        "    await box[i]\n"
+        "async def main():\n"
+        "    box = []\n"
+        "    box.append(loop.create_task(waits_on(box, 1)))\n"
+        "    box.append(loop.create_task(waits_on(box, 0)))\n"
+        "    await box[0]\n"
+        "try:\n"
+        "    loop.run(main())\n"
+        "    stalled = False\n"
+        "except RuntimeError:\n"
+        "    stalled = True\n";
+    proto::ProtoObject* frame = runSource(env, source);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(attr(ctx, frame, "stalled"), PROTO_TRUE);
+    EXPECT_EQ(protoPython::EventLoop::current(), nullptr);
+}
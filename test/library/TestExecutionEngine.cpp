@@ -1,12 +1,15 @@
 #include <gtest/gtest.h>
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/CompactDict.h>
 #include <protoPython/Compiler.h>
 #include <protoPython/Parser.h>
 #include <protoPython/PythonEnvironment.h>
+#include <protoPython/MemoryManager.hpp>
 #include <protoCore.h>
 #include <array>
 #include <mutex>
 #include <thread>
+#include "TestSupport.h"
 
 static const proto::ProtoObject* callable_returns_42(
     proto::ProtoContext* ctx,
@@ -63,6 +66,41 @@ TEST(ExecutionEngineTest, ExecuteBytecodeRangeFullRangeEqualsExecuteMinimal) {
     EXPECT_EQ(rangeResult->asLong(&ctx), 42);
 }
 
+// --- Pre-decoded instruction stream ---
+TEST(ExecutionEngineTest, MakeCodeObjectAttachesDecodedStream) {
+    proto::ProtoSpace space;
+    proto::ProtoContext ctx(&space);
+    const proto::ProtoList* constants = ctx.newList()
+        ->appendLast(&ctx, ctx.fromInteger(10))
+        ->appendLast(&ctx, ctx.fromInteger(32));
+    const proto::ProtoList* bytecode = ctx.newList()
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_CONST))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_LOAD_CONST))->appendLast(&ctx, ctx.fromInteger(1))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_BINARY_ADD))->appendLast(&ctx, ctx.fromInteger(0))
+        ->appendLast(&ctx, ctx.fromInteger(protoPython::OP_RETURN_VALUE))->appendLast(&ctx, ctx.fromInteger(0));
+    const proto::ProtoObject* code = protoPython::makeCodeObject(&ctx, constants, ctx.newList(), bytecode,
+        nullptr, ctx.newList(), 0, 0, 0, 0, false, nullptr);
+    const protoPython::DecodedCode* decoded = protoPython::getDecodedCode(&ctx, code);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(decoded->codeSize, 8u);
+    ASSERT_EQ(decoded->instrs.size(), 4u);
+    EXPECT_EQ(decoded->instrs[1].op, protoPython::OP_LOAD_CONST);
+    EXPECT_EQ(decoded->instrs[1].arg, 1);
+    EXPECT_EQ(decoded->instrs[3].op, protoPython::OP_RETURN_VALUE);
+    ASSERT_EQ(decoded->consts.size(), 2u);
+    /* Cached: a second lookup returns the same stream. */
+    EXPECT_EQ(protoPython::getDecodedCode(&ctx, code), decoded);
+    /* A racing decode keeps the published stream and discards its own copy. */
+    EXPECT_EQ(protoPython::attachDecodedCode(&ctx, code), decoded);
+    EXPECT_EQ(protoPython::getDecodedCode(&ctx, code), decoded);
+
+    proto::ProtoObject* frame = nullptr;
+    const proto::ProtoObject* result = protoPython::executeDecodedRange(&ctx, decoded, frame, 0, decoded->codeSize);
+    ASSERT_NE(result, nullptr);
+    ASSERT_TRUE(result->isInteger(&ctx));
+    EXPECT_EQ(result->asLong(&ctx), 42);
+}
+
 TEST(ExecutionEngineTest, LoadConstReturnValue) {
     proto::ProtoSpace space;
     proto::ProtoContext ctx(&space);
@@ -389,23 +427,15 @@ TEST(ExecutionEngineTest, BuildMap) {
     const proto::ProtoObject* result = protoPython::executeMinimalBytecode(
         &ctx, constants, bytecode, nullptr, frame);
     ASSERT_NE(result, nullptr);
-    const proto::ProtoObject* data = result->getAttribute(&ctx, proto::ProtoString::fromUTF8String(&ctx, "__data__"));
-    ASSERT_NE(data, nullptr);
-    ASSERT_NE(data->asSparseList(&ctx), nullptr);
-    const proto::ProtoObject* keys = result->getAttribute(&ctx, proto::ProtoString::fromUTF8String(&ctx, "__keys__"));
-    ASSERT_NE(keys, nullptr);
-    ASSERT_NE(keys->asList(&ctx), nullptr);
-    const proto::ProtoList* keysList = keys->asList(&ctx);
-    EXPECT_EQ(keysList->getSize(&ctx), 2u);
-    unsigned long h0 = keysList->getAt(&ctx, 0)->getHash(&ctx);
-    unsigned long h1 = keysList->getAt(&ctx, 1)->getHash(&ctx);
-    const proto::ProtoObject* v0 = data->asSparseList(&ctx)->getAt(&ctx, h0);
-    const proto::ProtoObject* v1 = data->asSparseList(&ctx)->getAt(&ctx, h1);
+    ASSERT_NE(protoPython::dictTable(&ctx, result), nullptr);
+    const proto::ProtoList* keysList = protoPython::dictKeys(&ctx, result);
+    ASSERT_EQ(keysList->getSize(&ctx), 2u);
+    const proto::ProtoObject* v0 = protoPython::dictGet(&ctx, result, keysList->getAt(&ctx, 0));
+    const proto::ProtoObject* v1 = protoPython::dictGet(&ctx, result, keysList->getAt(&ctx, 1));
     ASSERT_NE(v0, nullptr);
     ASSERT_NE(v1, nullptr);
-    long a0 = v0->asLong(&ctx);
-    long a1 = v1->asLong(&ctx);
-    EXPECT_TRUE((a0 == 1 && a1 == 2) || (a0 == 2 && a1 == 1));
+    EXPECT_EQ(v0->asLong(&ctx), 1);
+    EXPECT_EQ(v1->asLong(&ctx), 2);
 }
 
 TEST(ExecutionEngineTest, BuildTuple) {
@@ -1271,3 +1301,598 @@ TEST(ExecutionEngineTest, ConcurrentExecutionTwoThreads) {
     EXPECT_EQ(aVal->asLong(ctx), 1);
     EXPECT_EQ(bVal->asLong(ctx), 2);
 }
+
+// Inline caches: LOAD_ATTR/STORE_ATTR sites in a loop must see a class attribute
+// change (prototype guard) and keep returning fresh instance values.
+TEST(ExecutionEngineTest, AttributeInlineCacheInvalidatesOnClassChange) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "class P:\n"
+        "    k = 1\n"
+        "    def get(self):\n"
+        "        return self.v\n"
+        "p = P()\n"
+        "total = 0\n"
+        "for i in range(20):\n"
+        "    p.v = i\n"
+        "    total = total + p.get() + P.k\n"
+        "    if i == 10:\n"
+        "        P.k = 100\n";
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<inline_cache_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+    const protoPython::DecodedCode* decoded = protoPython::getDecodedCode(ctx, codeObj);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_GT(decoded->attrCacheSites, 0u);
+    EXPECT_NE(decoded->caches, nullptr);
+
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    const proto::ProtoObject* total = frame->getAttribute(ctx,
+        proto::ProtoString::fromUTF8String(ctx, "total"));
+    ASSERT_NE(total, nullptr);
+    ASSERT_TRUE(total->isInteger(ctx));
+    /* sum(range(20)) + 11 * 1 + 9 * 100 */
+    EXPECT_EQ(total->asLong(ctx), 1101);
+}
+
+// Global caches: a builtin cached by a LOAD_NAME site must give way to a module
+// global that shadows it later, without any resolve-cache invalidation.
+TEST(ExecutionEngineTest, GlobalCacheSeesShadowingGlobal) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "def mylen(s):\n"
+        "    return 10\n"
+        "def f():\n"
+        "    return len('abc')\n"
+        "r = 0\n"
+        "for i in range(10):\n"
+        "    r = r + f()\n"
+        "    if i == 4:\n"
+        "        len = mylen\n";
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<global_cache_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+    const protoPython::DecodedCode* decoded = protoPython::getDecodedCode(ctx, codeObj);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_GT(decoded->globalCacheSites, 0u);
+
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    const proto::ProtoObject* r = frame->getAttribute(ctx,
+        proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    /* Five calls see builtins.len, five see the shadowing global. */
+    EXPECT_EQ(r->asLong(ctx), 5 * 3 + 5 * 10);
+}
+
+TEST(ExecutionEngineTest, QuickenedOpcodesDeoptimizeOnTypeChange) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "l = [1, 2, 3]\n"
+        "d = {'a': 100}\n"
+        "r = 0\n"
+        "for i in range(40):\n"
+        "    if i < 20:\n"
+        "        x = i\n"
+        "    else:\n"
+        "        x = 0.5\n"
+        "    r = r + x\n"
+        "    r = r + l[-1] + d['a'] - 100\n";
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<quicken_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+
+    auto quickens = [](const char* name) {
+        for (const auto& s : protoPython::getSpecializationStats())
+            if (std::string(s.name) == name) return s.quickens;
+        return 0ull;
+    };
+    auto deopts = [](const char* name) {
+        for (const auto& s : protoPython::getSpecializationStats())
+            if (std::string(s.name) == name) return s.deopts;
+        return 0ull;
+    };
+    const unsigned long long addQuickens = quickens("BINARY_ADD_INT");
+    const unsigned long long addDeopts = deopts("BINARY_ADD_INT");
+    const unsigned long long listQuickens = quickens("BINARY_SUBSCR_LIST_INT");
+    const unsigned long long dictQuickens = quickens("BINARY_SUBSCR_DICT");
+    const unsigned long long compareQuickens = quickens("COMPARE_OP_INT");
+
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    const proto::ProtoObject* r = frame->getAttribute(ctx,
+        proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isDouble(ctx));
+    /* sum(range(20)) + 20 * 0.5 from x, plus 40 * 3 from the subscripts. */
+    EXPECT_DOUBLE_EQ(r->asDouble(ctx), 190.0 + 10.0 + 120.0);
+
+    EXPECT_GT(quickens("BINARY_ADD_INT"), addQuickens);
+    EXPECT_GT(deopts("BINARY_ADD_INT"), addDeopts);
+    EXPECT_GT(quickens("BINARY_SUBSCR_LIST_INT"), listQuickens);
+    EXPECT_GT(quickens("BINARY_SUBSCR_DICT"), dictQuickens);
+    EXPECT_GT(quickens("COMPARE_OP_INT"), compareQuickens);
+}
+
+TEST(ExecutionEngineTest, SuperinstructionsMatchUnfusedResults) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "def count(limit, step):\n"
+        "    i = 0\n"
+        "    total = 0\n"
+        "    while i < limit:\n"
+        "        i = i + 1\n"
+        "        total = total + step\n"
+        "    return total\n"
+        "def pick(a, b):\n"
+        "    if a < b:\n"
+        "        return 1\n"
+        "    return 2\n"
+        "def bump(x):\n"
+        "    x = x + 1\n"
+        "    return x\n"
+        "r = count(10, 2) * 1000 + pick('a', 'b') * 100 + pick(3, 2) * 10\n"
+        "f = count(3, 0.5) + bump(0.5)\n";
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<superinstruction_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 20 * 1000 + 1 * 100 + 2 * 10);
+    const proto::ProtoObject* f = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "f"));
+    ASSERT_NE(f, nullptr);
+    ASSERT_TRUE(f->isDouble(ctx));
+    EXPECT_DOUBLE_EQ(f->asDouble(ctx), 1.5 + 1.5);
+}
+
+TEST(ExecutionEngineTest, ThreadedDispatchUnwindsAfterRaisingHandler) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    // The add raises and is followed by handlers that never poll: the raise must still
+    // unwind before the store, on every trip round the loop.
+    const std::string source =
+        "def f(n):\n"
+        "    i = 0\n"
+        "    hits = 0\n"
+        "    while i < n:\n"
+        "        i = i + 1\n"
+        "        try:\n"
+        "            x = i + None\n"
+        "            hits = hits + 1000\n"
+        "        except TypeError:\n"
+        "            hits = hits + 1\n"
+        "    return hits\n"
+        "r = f(50)\n";
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<threaded_dispatch_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(),
+        nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
+    ASSERT_NE(codeObj, nullptr);
+
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    EXPECT_FALSE(env.hasPendingException());
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 50);
+}
+
+namespace {
+const proto::ProtoObject* vectorcallProbeList(proto::ProtoContext*, const proto::ProtoObject*,
+    const proto::ParentLink*, const proto::ProtoList*, const proto::ProtoSparseList*) {
+    return PROTO_FALSE;
+}
+const proto::ProtoObject* vectorcallProbe(proto::ProtoContext* ctx, const proto::ProtoObject*,
+    const proto::ProtoObject* const* args, size_t nargs) {
+    return ctx->fromInteger(static_cast<long long>(nargs) * 100 + (nargs ? args[nargs - 1]->asLong(ctx) : 0));
+}
+}
+
+TEST(ExecutionEngineTest, VectorcallReachesOptedInNatives) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    EXPECT_EQ(protoPython::findVectorcall(vectorcallProbeList), nullptr);
+    protoPython::registerVectorcall(vectorcallProbeList, vectorcallProbe);
+    EXPECT_EQ(protoPython::findVectorcall(vectorcallProbeList), vectorcallProbe);
+
+    const std::string source =
+        "def fib(n):\n"
+        "    if n < 2:\n"
+        "        return n\n"
+        "    return fib(n - 1) + fib(n - 2)\n"
+        "def total(*xs):\n"
+        "    return len(xs)\n"
+        "class Acc:\n"
+        "    def __init__(self):\n"
+        "        self.items = []\n"
+        "    def add(self, a, b=10):\n"
+        "        self.items.append(a + b)\n"
+        "        return len(self.items)\n"
+        "acc = Acc()\n"
+        "acc.add(1)\n"
+        "r = fib(12) * 1000 + total(1, 2, 3) * 100 + acc.add(2, 3) * 10\n"
+        "ok = isinstance(acc, Acc)\n"
+        "p = probe(4, 5, 7)\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    frame = const_cast<proto::ProtoObject*>(frame->setAttribute(ctx,
+        proto::ProtoString::fromUTF8String(ctx, "probe"),
+        ctx->fromMethod(nullptr, vectorcallProbeList)));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<vectorcall_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+    protoPython::runCodeObject(ctx, codeObj, frame);
+
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 144 * 1000 + 3 * 100 + 2 * 10);
+    EXPECT_EQ(frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "ok")), PROTO_TRUE);
+    const proto::ProtoObject* p = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "p"));
+    ASSERT_NE(p, nullptr);
+    ASSERT_TRUE(p->isInteger(ctx));
+    EXPECT_EQ(p->asLong(ctx), 3 * 100 + 7);
+}
+
+TEST(ExecutionEngineTest, CodeCallInfoDescribesFunction) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "def f(a, b=2, *rest, c, d=4, **kw):\n"
+        "    return a * 1000 + b * 100 + c * 10 + d + len(rest) * 10000 + len(kw) * 100000\n"
+        "r1 = f(1, c=3)\n"
+        "r2 = f(1, 5, 6, 7, c=8, d=9, x=0)\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<call_info_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+    protoPython::runCodeObject(ctx, codeObj, frame);
+
+    const proto::ProtoObject* r1 = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r1"));
+    ASSERT_NE(r1, nullptr);
+    ASSERT_TRUE(r1->isInteger(ctx));
+    EXPECT_EQ(r1->asLong(ctx), 1234);
+    const proto::ProtoObject* r2 = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r2"));
+    ASSERT_NE(r2, nullptr);
+    ASSERT_TRUE(r2->isInteger(ctx));
+    EXPECT_EQ(r2->asLong(ctx), 100000 + 2 * 10000 + 1589);
+
+    const proto::ProtoObject* f = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "f"));
+    ASSERT_NE(f, nullptr);
+    const proto::ProtoObject* fCode = f->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__code__"));
+    ASSERT_NE(fCode, nullptr);
+    const protoPython::DecodedCode* decoded = protoPython::getDecodedCode(ctx, fCode);
+    ASSERT_NE(decoded, nullptr);
+    const protoPython::CodeCallInfo& call = decoded->call;
+    EXPECT_TRUE(call.valid);
+    EXPECT_EQ(call.nparams, 2);
+    EXPECT_EQ(call.kwonly, 2);
+    EXPECT_NE(call.flags & protoPython::CO_VARARGS, 0);
+    EXPECT_NE(call.flags & protoPython::CO_VARKEYWORDS, 0);
+    EXPECT_FALSE(call.isGenerator);
+    ASSERT_GE(call.varnames.size(), 6u);
+    EXPECT_EQ(call.paramSlots.size(), 4u);
+    const proto::ProtoObject* c = ctx->fromUTF8String("c");
+    auto slot = call.paramSlots.find(c->getHash(ctx));
+    ASSERT_NE(slot, call.paramSlots.end());
+    EXPECT_EQ(slot->second, 2);
+    ASSERT_NE(call.localNames, nullptr);
+    EXPECT_EQ(static_cast<int>(call.localNames->getSize(ctx)), call.automaticCount);
+}
+
+TEST(ExecutionEngineTest, LazyFrameMaterializesOnDemand) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "import sys\n"
+        "def plain(a, b):\n"
+        "    return a + b\n"
+        "def peek():\n"
+        "    return sys._getframe().f_code\n"
+        "def make(k):\n"
+        "    def inner(v):\n"
+        "        return v + k\n"
+        "    return inner\n"
+        "r = plain(2, 3) * 100 + make(4)(5)\n"
+        "same = peek() is peek.__code__\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<lazy_frame_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+    protoPython::runCodeObject(ctx, codeObj, frame);
+
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 509);
+    EXPECT_EQ(frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "same")), PROTO_TRUE);
+
+    auto needsFrame = [&](const char* fn) {
+        const proto::ProtoObject* f = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, fn));
+        const proto::ProtoObject* code = f ? f->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__code__")) : nullptr;
+        const protoPython::DecodedCode* decoded = code ? protoPython::getDecodedCode(ctx, code) : nullptr;
+        return decoded && decoded->call.needsFrame;
+    };
+    EXPECT_FALSE(needsFrame("plain"));
+    EXPECT_FALSE(needsFrame("peek"));
+    EXPECT_TRUE(needsFrame("make"));
+    EXPECT_EQ(protoPython::PythonEnvironment::getCurrentLazyFrame(), nullptr);
+}
+
+TEST(ExecutionEngineTest, ExceptionTableDispatchesHandlers) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "class Mgr:\n"
+        "    def __enter__(self):\n"
+        "        return self\n"
+        "    def __exit__(self, t, v, tb):\n"
+        "        return True\n"
+        "def f(xs):\n"
+        "    n = 0\n"
+        "    for x in xs:\n"
+        "        try:\n"
+        "            try:\n"
+        "                n += 10 // x\n"
+        "            except KeyError:\n"
+        "                n += 1000\n"
+        "        except ZeroDivisionError:\n"
+        "            n += 100\n"
+        "    return n\n"
+        "def g():\n"
+        "    for i in range(3):\n"
+        "        try:\n"
+        "            if i == 1:\n"
+        "                break\n"
+        "        except ValueError:\n"
+        "            pass\n"
+        "    return int('x')\n"
+        "r = f([1, 0, 5])\n"
+        "with Mgr():\n"
+        "    r += 1\n"
+        "    raise ValueError()\n"
+        "try:\n"
+        "    g()\n"
+        "    s = 0\n"
+        "except ValueError:\n"
+        "    s = 1\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<exception_table_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(),
+        nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
+    ASSERT_NE(codeObj, nullptr);
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    EXPECT_FALSE(env.hasPendingException());
+
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 113);
+    const proto::ProtoObject* s = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "s"));
+    ASSERT_NE(s, nullptr);
+    EXPECT_EQ(s->asLong(ctx), 1);
+
+    const protoPython::DecodedCode* top = protoPython::getDecodedCode(ctx, codeObj);
+    ASSERT_NE(top, nullptr);
+    EXPECT_TRUE(top->staticHandlers);
+    ASSERT_EQ(top->exceptionTable.size(), 2u);
+    EXPECT_EQ(top->exceptionTable[0].depth, 1u);  // __exit__ below the with body.
+    EXPECT_EQ(top->exceptionTable[1].depth, 0u);
+
+    const proto::ProtoObject* fn = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "f"));
+    const proto::ProtoObject* fcode = fn ? fn->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__code__")) : nullptr;
+    const protoPython::DecodedCode* decoded = fcode ? protoPython::getDecodedCode(ctx, fcode) : nullptr;
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_TRUE(decoded->staticHandlers);
+    ASSERT_EQ(decoded->exceptionTable.size(), 2u);
+    // Innermost first; both run with the loop iterator on the stack.
+    EXPECT_GT(decoded->exceptionTable[0].start, decoded->exceptionTable[1].start);
+    EXPECT_LT(decoded->exceptionTable[0].end, decoded->exceptionTable[1].end);
+    EXPECT_EQ(decoded->exceptionTable[0].depth, 1u);
+    EXPECT_EQ(decoded->exceptionTable[1].depth, 1u);
+}
+
+TEST(ExecutionEngineTest, ContextArenaReusesFramesLifo) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "def depth(n):\n"
+        "    if n == 0:\n"
+        "        return 0\n"
+        "    return depth(n - 1) + 1\n"
+        "r = depth(200) + depth(50)\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<context_arena_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode());
+    ASSERT_NE(codeObj, nullptr);
+
+    protoPython::ContextArena& contexts = protoPython::ContextArena::forThread();
+    protoPython::ValueStackArena& stacks = protoPython::ValueStackArena::forThread();
+    const size_t contextDepth = contexts.depth();
+    const size_t stackDepth = stacks.depth();
+    protoPython::runCodeObject(ctx, codeObj, frame);
+
+    const proto::ProtoObject* r = frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "r"));
+    ASSERT_NE(r, nullptr);
+    ASSERT_TRUE(r->isInteger(ctx));
+    EXPECT_EQ(r->asLong(ctx), 250);
+    // Every call's context came from the arena and was returned in order.
+    EXPECT_GE(contexts.capacity(), contextDepth + 200);
+    EXPECT_EQ(contexts.depth(), contextDepth);
+    EXPECT_EQ(stacks.depth(), stackDepth);
+
+    // A second run fits in the chunks the first one added.
+    const size_t capacity = contexts.capacity();
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    EXPECT_EQ(contexts.capacity(), capacity);
+    EXPECT_EQ(contexts.depth(), contextDepth);
+}
+
+TEST(ExecutionEngineTest, GeneratorStateResumesNatively) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string source =
+        "def inner():\n"
+        "    yield 10\n"
+        "    yield 20\n"
+        "def gen():\n"
+        "    total = 0\n"
+        "    try:\n"
+        "        for x in range(3):\n"
+        "            got = yield x\n"
+        "            if got:\n"
+        "                total += got\n"
+        "        yield from inner()\n"
+        "    finally:\n"
+        "        total += 1000\n"
+        "    return total\n"
+        "g = gen()\n"
+        "fresh = g.gi_running is False and g.gi_frame is not None\n"
+        "seen = [next(g), g.send(5), next(g), next(g)]\n"
+        "delegating = g.gi_yieldfrom is not None\n"
+        "seen.append(next(g))\n"
+        "try:\n"
+        "    next(g)\n"
+        "    done = -1\n"
+        "except StopIteration as e:\n"
+        "    done = e.value\n"
+        "closed = g.gi_frame is None\n"
+        "h = gen()\n"
+        "first = next(h)\n";
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    ASSERT_TRUE(mod);
+    protoPython::Compiler compiler(ctx, "<generator_state_test>");
+    ASSERT_TRUE(compiler.compileModule(mod.get()));
+    const proto::ProtoObject* codeObj = protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(),
+        nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
+    ASSERT_NE(codeObj, nullptr);
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    EXPECT_FALSE(env.hasPendingException());
+
+    auto get = [&](const char* name) {
+        return frame->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, name));
+    };
+    EXPECT_EQ(get("fresh"), PROTO_TRUE);
+    EXPECT_EQ(get("delegating"), PROTO_TRUE);
+    EXPECT_EQ(get("closed"), PROTO_TRUE);
+    const proto::ProtoObject* seen = get("seen");
+    ASSERT_NE(seen, nullptr);
+    const proto::ProtoList* values = seen->asList(ctx);
+    ASSERT_NE(values, nullptr);
+    ASSERT_EQ(values->getSize(ctx), 5u);
+    const long expected[] = {0, 1, 2, 10, 20};
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(values->getAt(ctx, i)->asLong(ctx), expected[i]);
+    const proto::ProtoObject* done = get("done");
+    ASSERT_NE(done, nullptr);
+    EXPECT_EQ(done->asLong(ctx), 1005);
+
+    // Suspended state lives natively on the generator, not in gi_* attributes.
+    const protoPython::GeneratorState* finished = protoPython::getGeneratorState(ctx, get("g"));
+    ASSERT_NE(finished, nullptr);
+    EXPECT_TRUE(finished->finished());
+    EXPECT_TRUE(finished->stack.empty());
+    const protoPython::GeneratorState* suspended = protoPython::getGeneratorState(ctx, get("h"));
+    ASSERT_NE(suspended, nullptr);
+    EXPECT_FALSE(suspended->finished());
+    EXPECT_FALSE(suspended->running);
+    EXPECT_GT(suspended->pc, 0u);
+    // Its references are rooted through the generator: fixed references, then the saved locals.
+    const proto::ProtoObject* pins = get("h")->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__gi_pins__"));
+    ASSERT_NE(pins, nullptr);
+    ASSERT_NE(suspended->pins, nullptr);
+    EXPECT_EQ(pins->asList(ctx)->getAt(ctx, 0), suspended->code);
+    EXPECT_GT(suspended->locals.size(), 0u);
+    EXPECT_EQ(suspended->pins->getSize(ctx), protoPython::GeneratorState::kFixedPins + suspended->locals.size());
+    // Finishing drops everything but the fixed references.
+    EXPECT_TRUE(finished->locals.empty());
+    ASSERT_NE(finished->pins, nullptr);
+    EXPECT_EQ(finished->pins->getSize(ctx), protoPython::GeneratorState::kFixedPins);
+}
+
+TEST(ExecutionEngineTest, SuspendedGeneratorSurvivesCollection) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    // g lives in the globals its own frame refers to; only the pins keep parts alive.
+    proto::ProtoObject* frame = protoPythonTest::runSource(env,
+        "def gen(n):\n"
+        "    parts = [str(i) * 3 for i in range(n)]\n"
+        "    yield len(parts)\n"
+        "    parts = parts[-3:]\n"
+        "    yield ''.join(parts)\n"
+        "    yield len(parts)\n"
+        "g = gen(2000)\n"
+        "first = next(g)\n");
+    ASSERT_NE(frame, nullptr);
+    ASSERT_FALSE(env.hasPendingException());
+    int rounds = 0;
+    protoPythonTest::collectUntil(env, [&rounds] { return ++rounds > 5; });
+    ASSERT_TRUE(protoPythonTest::runSourceIn(env, frame, "second = next(g)\n"));
+    protoPythonTest::collectUntil(env, [&rounds] { return ++rounds > 10; });
+    ASSERT_TRUE(protoPythonTest::runSourceIn(env, frame,
+        "third = next(g)\n"
+        "ok = (first, second, third) == (2000, '199719971997199819981998199919991999', 3)\n"));
+    EXPECT_EQ(protoPythonTest::attr(ctx, frame, "ok"), PROTO_TRUE);
+}
@@ -0,0 +1,87 @@
+/*
+ * Tests for flat string text: kind detection and character/byte offsets
+ * across stride boundaries, the per-thread cache, and str indexing, slicing
+ * and searching by characters on ASCII and non-ASCII text.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/FlatString.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(FlatStringTest, AsciiOffsetsAreIdentity) {
+    protoPython::FlatTextRef text = protoPython::FlatText::fromUTF8("hello, world");
+    EXPECT_TRUE(text->ascii);
+    EXPECT_EQ(text->length, 12u);
+    EXPECT_TRUE(text->stride.empty());
+    EXPECT_EQ(text->offsetOf(7), 7u);
+    EXPECT_EQ(text->offsetOf(100), 12u);
+    EXPECT_EQ(text->indexOf(7), 7u);
+    EXPECT_EQ(text->charBytes(0), 1u);
+}
+
+TEST(FlatStringTest, Utf8OffsetsAcrossStrides) {
+    // 1-, 2-, 3- and 4-byte characters, long enough for several stride entries.
+    const std::string unit = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";  // a, e-acute, euro sign, emoji
+    std::string utf8;
+    for (int i = 0; i < 100; ++i) utf8 += unit;
+    protoPython::FlatTextRef text = protoPython::FlatText::fromUTF8(utf8);
+    EXPECT_FALSE(text->ascii);
+    EXPECT_EQ(text->length, 400u);
+    EXPECT_EQ(text->stride.size(), (400 + protoPython::FlatText::kStride - 1) / protoPython::FlatText::kStride);
+    for (unsigned long i = 0; i < 400; ++i) {
+        const size_t offset = text->offsetOf(i);
+        EXPECT_EQ(offset, (i / 4) * 10 + std::string("\0\1\3\6", 4)[i % 4]) << i;
+        EXPECT_EQ(text->indexOf(offset), i) << i;
+        EXPECT_EQ(text->charBytes(offset), (i % 4) + 1) << i;
+    }
+    EXPECT_EQ(text->offsetOf(400), utf8.size());
+    EXPECT_EQ(text->indexOf(utf8.size()), 400u);
+}
+
+TEST(FlatStringTest, CacheReturnsTheSameText) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const std::string longText(1000, 'z');
+    const proto::ProtoString* s = proto::ProtoString::fromUTF8String(ctx, longText.c_str());
+    protoPython::FlatTextRef first = protoPython::flatText(ctx, s);
+    protoPython::FlatTextRef second = protoPython::flatText(ctx, s);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(first->utf8, longText);
+
+    const proto::ProtoString* shortStr = proto::ProtoString::fromUTF8String(ctx, "abc");
+    EXPECT_EQ(protoPython::flatText(ctx, shortStr)->utf8, "abc");
+
+    protoPython::releaseFlatStrings(ctx->space);
+    EXPECT_EQ(first->utf8, longText);
+    EXPECT_EQ(protoPython::flatText(ctx, s)->utf8, longText);
+}
+
+TEST(FlatStringTest, CharacterIndexingFromPython) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "line = 'caf\\u00e9 na\\u00efve \\u20ac5 ' * 50\n"
+        "index_ok = line[3] == '\\u00e9' and line[7] == '\\u00ef' and line[-2] == '5' and line[11] == '\\u20ac'\n"
+        "slice_ok = line[0:4] == 'caf\\u00e9' and line[5:10] == 'na\\u00efve' and len(line[16:32]) == 16\n"
+        "find_ok = line.find('\\u20ac') == 11 and line.find('na', 6) == 19 and line.rfind('caf') == 14 * 49\n"
+        "count_ok = line.count('\\u00e9') == 50 and line.count('caf', 14) == 49\n"
+        "ascii = 'x' * 100 + 'needle' + 'y' * 100\n"
+        "ascii_ok = ascii.find('needle') == 100 and ascii[100:106] == 'needle' and ascii[205] == 'y'\n"
+        "parts = line.strip().split(' ')\n"
+        "split_ok = len(parts) == 150 and parts[0] == 'caf\\u00e9' and parts[-1] == '\\u20ac5'\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "index_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "slice_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "find_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "count_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "ascii_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "split_ok"), PROTO_TRUE);
+}
@@ -2297,3 +2297,26 @@ TEST_F(FoundationTest, SubprocessRun) {
     const proto::ProtoObject* fileVal = subMod->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, "__file__"));
     EXPECT_TRUE(fileVal != nullptr && fileVal->isString(ctx));
 }
+
+TEST_F(FoundationTest, PendingExceptionRootSlot) {
+    proto::ProtoContext* context = env.getContext();
+    const proto::ProtoObject* exc = context->fromUTF8String("pending");
+    const size_t roots = env.getSpace()->moduleRoots.size();
+
+    // The main thread's slot is the root context's automatic local; moduleRoots is untouched.
+    EXPECT_EQ(PythonEnvironment::pendingExceptionSlot(), context->getAutomaticLocals());
+    env.setPendingException(exc);
+    EXPECT_EQ(context->getAutomaticLocals()[0], exc);
+    EXPECT_EQ(env.getSpace()->moduleRoots.size(), roots);
+
+    {
+        PythonEnvironment::PendingExceptionRoot nested(context);
+        EXPECT_EQ(PythonEnvironment::pendingExceptionSlot(), nested.context()->getAutomaticLocals());
+        EXPECT_EQ(env.peekPendingException(), exc);
+        EXPECT_EQ(context->getAutomaticLocals()[0], nullptr);
+    }
+    EXPECT_EQ(PythonEnvironment::pendingExceptionSlot(), context->getAutomaticLocals());
+    EXPECT_EQ(env.takePendingException(), exc);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(env.getSpace()->moduleRoots.size(), roots);
+}
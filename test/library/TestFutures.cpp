@@ -0,0 +1,103 @@
+/*
+ * Tests for the _futures module: executor futures, map and parallel_map on the
+ * environment's worker pool, and the inline fallback without workers.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoPython/ThreadingStrategy.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+namespace {
+
+const std::string kScript =
+    "import _futures\n"
+    "def square(x):\n"
+    "    return x * x\n"
+    "def add(a, b):\n"
+    "    return a + b\n"
+    "def fail(x):\n"
+    "    if x == 37:\n"
+    "        raise ValueError('bad item')\n"
+    "    return x\n"
+    "squares = _futures.parallel_map(square, range(1000))\n"
+    "ordered = squares == [i * i for i in range(1000)]\n"
+    "small_chunks = _futures.parallel_map(square, (1, 2, 3), 1)\n"
+    "try:\n"
+    "    _futures.parallel_map(fail, range(100), 8)\n"
+    "    map_raised = False\n"
+    "except ValueError:\n"
+    "    map_raised = True\n"
+    "seen = []\n"
+    "with _futures.ThreadPoolExecutor(max_workers=4) as ex:\n"
+    "    f = ex.submit(add, 40, 2)\n"
+    "    g = ex.submit(fail, 37)\n"
+    "    f.add_done_callback(lambda fut: seen.append(fut.result()))\n"
+    "    value = f.result()\n"
+    "    error = g.exception()\n"
+    "    zipped = ex.map(add, [1, 2, 3], [10, 20, 30, 40])\n"
+    "try:\n"
+    "    ex.submit(square, 2)\n"
+    "    after_shutdown = False\n"
+    "except RuntimeError:\n"
+    "    after_shutdown = True\n"
+    "done = f.done() and not f.cancelled()\n";
+
+void checkScript(protoPython::PythonEnvironment& env) {
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env, kScript);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "ordered"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "map_raised"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "after_shutdown"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "done"), PROTO_TRUE);
+
+    const proto::ProtoObject* value = attr(ctx, frame, "value");
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->asLong(ctx), 42);
+    const proto::ProtoObject* error = attr(ctx, frame, "error");
+    ASSERT_NE(error, nullptr);
+    EXPECT_NE(error, PROTO_NONE);
+
+    const proto::ProtoObject* zipped = attr(ctx, frame, "zipped");
+    ASSERT_NE(zipped, nullptr);
+    const proto::ProtoList* z = zipped->asList(ctx);
+    ASSERT_NE(z, nullptr);
+    ASSERT_EQ(z->getSize(ctx), 3u);
+    EXPECT_EQ(z->getAt(ctx, 0)->asLong(ctx), 11);
+    EXPECT_EQ(z->getAt(ctx, 2)->asLong(ctx), 33);
+
+    const proto::ProtoList* small = attr(ctx, frame, "small_chunks")->asList(ctx);
+    ASSERT_NE(small, nullptr);
+    ASSERT_EQ(small->getSize(ctx), 3u);
+    EXPECT_EQ(small->getAt(ctx, 2)->asLong(ctx), 9);
+}
+
+} // namespace
+
+TEST(FuturesTest, ExecutorAndParallelMapOnWorkers) {
+    protoPython::setWorkerCount(4);
+    {
+        protoPython::PythonEnvironment env(STDLIB_PATH);
+        ASSERT_NE(env.getScheduler(env.getContext()), nullptr);
+        checkScript(env);
+    }
+    protoPython::setWorkerCount(-1);
+}
+
+TEST(FuturesTest, RunsInlineWithoutWorkers) {
+    protoPython::setWorkerCount(0);
+    {
+        protoPython::PythonEnvironment env(STDLIB_PATH);
+        EXPECT_EQ(env.getScheduler(env.getContext()), nullptr);
+        checkScript(env);
+    }
+    protoPython::setWorkerCount(-1);
+}
@@ -0,0 +1,183 @@
+/*
+ * Tests for the list buffer: a list thawing into a buffer on append, reads
+ * and writes on the buffer, promotion back to __data__ by a snapshot reader,
+ * list semantics from Python across the thaw, and a list appended to from
+ * another thread (bias revocation).
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/ListBuffer.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include <vector>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+namespace {
+
+long itemAt(proto::ProtoContext* ctx, const proto::ProtoObject* list, long index) {
+    const proto::ProtoObject* item = nullptr;
+    if (!protoPython::listGetAt(ctx, list, index, &item) || !item) return -1;
+    return static_cast<long>(item->asLong(ctx));
+}
+
+} // namespace
+
+TEST(ListBufferTest, ThawsOnAppend) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* list = protoPython::newListObject(ctx, {});
+    ASSERT_NE(attr(ctx, list, "__data__"), nullptr);
+
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_TRUE(protoPython::listAppend(ctx, list, ctx->fromInteger(i)));
+    ASSERT_NE(protoPython::listBuffer(ctx, list), nullptr);
+    EXPECT_EQ(attr(ctx, list, "__data__"), nullptr);
+
+    unsigned long size = 0;
+    ASSERT_TRUE(protoPython::listSize(ctx, list, &size));
+    EXPECT_EQ(size, 1000u);
+    EXPECT_EQ(itemAt(ctx, list, 0), 0);
+    EXPECT_EQ(itemAt(ctx, list, 999), 999);
+    EXPECT_EQ(itemAt(ctx, list, -2), 998);
+    EXPECT_EQ(itemAt(ctx, list, 1000), -1);
+
+    // The collector mirror has one holder per chunk.
+    const proto::ProtoObject* chunks = attr(ctx, list, "__list_chunks__");
+    ASSERT_NE(chunks, nullptr);
+    ASSERT_NE(chunks->asList(ctx), nullptr);
+    EXPECT_EQ(chunks->asList(ctx)->getSize(ctx), (1000 + protoPython::ListBuffer::kChunk - 1) / protoPython::ListBuffer::kChunk);
+}
+
+TEST(ListBufferTest, WritesStayInTheBuffer) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    std::vector<const proto::ProtoObject*> items;
+    for (int i = 0; i < 100; ++i) items.push_back(ctx->fromInteger(i));
+    const proto::ProtoObject* list = protoPython::newListObject(ctx, items);
+    protoPython::ListBuffer* buffer = protoPython::listBuffer(ctx, list);
+    ASSERT_NE(buffer, nullptr);
+
+    bool inRange = false;
+    ASSERT_TRUE(buffer->setAt(ctx, 70, ctx->fromInteger(-70), &inRange));
+    EXPECT_TRUE(inRange);
+    ASSERT_TRUE(buffer->setAt(ctx, 100, ctx->fromInteger(0), &inRange));
+    EXPECT_FALSE(inRange);
+    EXPECT_EQ(itemAt(ctx, list, 70), -70);
+
+    const proto::ProtoObject* popped = nullptr;
+    ASSERT_TRUE(buffer->popLast(ctx, &popped));
+    ASSERT_NE(popped, nullptr);
+    EXPECT_EQ(popped->asLong(ctx), 99);
+    ASSERT_TRUE(protoPython::listExtend(ctx, list, {ctx->fromInteger(500), ctx->fromInteger(501)}));
+    EXPECT_EQ(itemAt(ctx, list, -1), 501);
+    EXPECT_EQ(itemAt(ctx, list, 99), 500);
+
+    ASSERT_TRUE(buffer->clear(ctx));
+    unsigned long size = 1;
+    ASSERT_TRUE(protoPython::listSize(ctx, list, &size));
+    EXPECT_EQ(size, 0u);
+    ASSERT_TRUE(buffer->popLast(ctx, &popped));
+    EXPECT_EQ(popped, nullptr);
+    EXPECT_EQ(protoPython::listBuffer(ctx, list), buffer);
+}
+
+TEST(ListBufferTest, SnapshotReaderPromotes) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* list = protoPython::newListObject(ctx, {});
+    for (int i = 0; i < 20; ++i) protoPython::listAppend(ctx, list, ctx->fromInteger(i));
+    ASSERT_NE(protoPython::listBuffer(ctx, list), nullptr);
+
+    const proto::ProtoObject* data = protoPython::dataAttribute(ctx, list);
+    ASSERT_NE(data, nullptr);
+    ASSERT_NE(data->asList(ctx), nullptr);
+    EXPECT_EQ(data->asList(ctx)->getSize(ctx), 20u);
+    EXPECT_EQ(protoPython::listBuffer(ctx, list), nullptr);
+    EXPECT_EQ(attr(ctx, list, "__data__"), data);
+
+    // Promotion is one-way: further appends stay on the persistent list.
+    for (int i = 20; i < 40; ++i) protoPython::listAppend(ctx, list, ctx->fromInteger(i));
+    EXPECT_EQ(protoPython::listBuffer(ctx, list), nullptr);
+    const proto::ProtoList* items = protoPython::asListData(ctx, list);
+    ASSERT_NE(items, nullptr);
+    EXPECT_EQ(items->getSize(ctx), 40u);
+    EXPECT_EQ(items->getAt(ctx, 39)->asLong(ctx), 39);
+}
+
+TEST(ListBufferTest, PythonListSemantics) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "xs = []\n"
+        "for i in range(300):\n"
+        "    xs.append(i)\n"
+        "index_ok = len(xs) == 300 and xs[0] == 0 and xs[-1] == 299 and xs[150] == 150\n"
+        "total = 0\n"
+        "for x in xs:\n"
+        "    total += x\n"
+        "iter_ok = total == 299 * 300 // 2\n"
+        "xs[10] = -10\n"
+        "set_ok = xs[10] == -10\n"
+        "popped = xs.pop()\n"
+        "pop_ok = popped == 299 and len(xs) == 299\n"
+        "xs.extend([1000, 1001])\n"
+        "xs += [1002]\n"
+        "extend_ok = xs[-3:] == [1000, 1001, 1002] and len(xs) == 302\n"
+        "ys = xs + [7]\n"
+        "add_ok = len(ys) == 303 and ys[-1] == 7 and len(xs) == 302\n"
+        "zs = list(ys)\n"
+        "zs.append(8)\n"
+        "copy_ok = len(zs) == 304 and len(ys) == 303 and xs.copy() == xs\n"
+        "contains_ok = 1001 in xs and 299 not in xs\n"
+        "squares = [i * i for i in range(50)]\n"
+        "comp_ok = len(squares) == 50 and squares[49] == 49 * 49 and sorted(squares, reverse=True)[0] == 49 * 49\n"
+        "xs.clear()\n"
+        "clear_ok = len(xs) == 0 and not xs\n"
+        "try:\n"
+        "    xs.pop()\n"
+        "    pop_error = False\n"
+        "except IndexError:\n"
+        "    pop_error = True\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "index_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "iter_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "set_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "pop_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "extend_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "add_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "copy_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "contains_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "comp_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "clear_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "pop_error"), PROTO_TRUE);
+}
+
+TEST(ListBufferTest, SharedAcrossThreads) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading\n"
+        "shared = []\n"
+        "for i in range(100):\n"
+        "    shared.append(i)\n"
+        "lock = threading.Lock()\n"
+        "def worker(base):\n"
+        "    for i in range(200):\n"
+        "        with lock:\n"
+        "            shared.append(base + i)\n"
+        "ts = [threading.Thread(target=worker, args=(n * 1000,)) for n in range(4)]\n"
+        "for t in ts: t.start()\n"
+        "for t in ts: t.join()\n"
+        "size_ok = len(shared) == 100 + 4 * 200\n"
+        "values_ok = shared[99] == 99 and all((n * 1000 + 199) in shared for n in range(4))\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "size_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "values_ok"), PROTO_TRUE);
+}
@@ -0,0 +1,158 @@
+/*
+ * Tests for the native _queue module: FIFO/LIFO/priority order, bounded
+ * queues with timeouts, put_many/get_many, task tracking and shutdown, ring
+ * growth, and many producers and consumers sharing one queue.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(QueueModuleTest, OrderAndBatches) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import queue, _queue\n"
+        "native = queue.Queue is _queue.Queue and queue.Empty is _queue.Empty\n"
+        "q = queue.Queue()\n"
+        "for i in range(100):\n"
+        "    q.put(i)\n"
+        "grown = q.qsize() == 100\n"
+        "fifo = [q.get() for _ in range(100)] == list(range(100))\n"
+        "l = queue.LifoQueue()\n"
+        "l.put_many([1, 2, 3])\n"
+        "lifo = [l.get(), l.get(), l.get()] == [3, 2, 1]\n"
+        "p = queue.PriorityQueue()\n"
+        "p.put_many([5, 1, 4, 2, 3])\n"
+        "prio = p.get_many(10) == [1, 2, 3, 4, 5]\n"
+        "s = queue.SimpleQueue()\n"
+        "s.put_many(range(10))\n"
+        "batch = s.get_many(4) == [0, 1, 2, 3] and s.qsize() == 6\n"
+        "try:\n"
+        "    s.get_many(0)\n"
+        "    bad_n = False\n"
+        "except ValueError:\n"
+        "    bad_n = True\n"
+        "try:\n"
+        "    queue.SimpleQueue().get_nowait()\n"
+        "    empty = False\n"
+        "except queue.Empty:\n"
+        "    empty = True\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "native"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "grown"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "fifo"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "lifo"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "prio"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "batch"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bad_n"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "empty"), PROTO_TRUE);
+}
+
+TEST(QueueModuleTest, BoundsTasksAndShutdown) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import queue\n"
+        "q = queue.Queue(2)\n"
+        "q.put(1)\n"
+        "q.put(2)\n"
+        "full = q.full()\n"
+        "try:\n"
+        "    q.put(3, timeout=0.02)\n"
+        "    put_timeout = False\n"
+        "except queue.Full:\n"
+        "    put_timeout = True\n"
+        "try:\n"
+        "    q.put_many([3, 4], block=False)\n"
+        "    partial = False\n"
+        "except queue.Full:\n"
+        "    partial = q.qsize() == 2\n"
+        "try:\n"
+        "    q.get(timeout=-1)\n"
+        "    bad_timeout = False\n"
+        "except ValueError:\n"
+        "    bad_timeout = True\n"
+        "q.get()\n"
+        "q.get()\n"
+        "try:\n"
+        "    q.get(timeout=0.02)\n"
+        "    get_timeout = False\n"
+        "except queue.Empty:\n"
+        "    get_timeout = True\n"
+        "q.task_done()\n"
+        "q.task_done()\n"
+        "q.join()\n"
+        "try:\n"
+        "    q.task_done()\n"
+        "    too_many = False\n"
+        "except ValueError:\n"
+        "    too_many = True\n"
+        "q.put(7)\n"
+        "q.shutdown()\n"
+        "try:\n"
+        "    q.put(8)\n"
+        "    put_closed = False\n"
+        "except queue.ShutDown:\n"
+        "    put_closed = True\n"
+        "drained = q.get() == 7\n"
+        "try:\n"
+        "    q.get()\n"
+        "    get_closed = False\n"
+        "except queue.ShutDown:\n"
+        "    get_closed = q.is_shutdown\n"
+        "r = queue.Queue()\n"
+        "r.put_many([1, 2, 3])\n"
+        "r.shutdown(immediate=True)\n"
+        "r.join()\n"
+        "immediate = r.empty()\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "full"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "put_timeout"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "partial"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bad_timeout"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "get_timeout"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "too_many"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "put_closed"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "drained"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "get_closed"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "immediate"), PROTO_TRUE);
+}
+
+TEST(QueueModuleTest, ManyProducersAndConsumers) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import queue, threading\n"
+        "q = queue.Queue(16)\n"
+        "sums = []\n"
+        "def produce(base):\n"
+        "    for i in range(base, base + 500, 10):\n"
+        "        q.put_many(list(range(i, i + 10)))\n"
+        "def consume():\n"
+        "    total = 0\n"
+        "    while True:\n"
+        "        item = q.get()\n"
+        "        if item is None:\n"
+        "            sums.append(total)\n"
+        "            return\n"
+        "        total += item\n"
+        "ps = [threading.Thread(target=produce, args=(b * 500,)) for b in range(4)]\n"
+        "cs = [threading.Thread(target=consume) for _ in range(4)]\n"
+        "for t in cs + ps: t.start()\n"
+        "for t in ps: t.join()\n"
+        "for _ in cs: q.put(None)\n"
+        "for t in cs: t.join()\n"
+        "mpmc = sum(sums) == sum(range(2000)) and q.empty()\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "mpmc"), PROTO_TRUE);
+}
@@ -0,0 +1,121 @@
+/*
+ * Tests for rope string building: builder output across leaf sizes, long
+ * concatenation loops (the per-thread chain) and forks of a chain, join and
+ * f-strings with long parts, and concatenation on several threads.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/StringBuilder.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+namespace {
+
+std::string utf8(proto::ProtoContext* ctx, const proto::ProtoString* s) {
+    std::string out;
+    s->toUTF8String(ctx, out);
+    return out;
+}
+
+} // namespace
+
+TEST(StringBuilderTest, BuildsAcrossLeafSizes) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    protoPython::StringBuilder builder;
+    std::string expected;
+    const std::string longPiece(3 * protoPython::StringBuilder::kLeaf, 'L');
+    for (int i = 0; i < 2000; ++i) {
+        const std::string piece = i % 97 == 0 ? longPiece : std::to_string(i) + ",";
+        builder.append(ctx, proto::ProtoString::fromUTF8String(ctx, piece.c_str()));
+        expected += piece;
+        if (i % 500 == 0) EXPECT_EQ(utf8(ctx, builder.build(ctx)), expected);
+    }
+    builder.appendAscii(ctx, "end");
+    expected += "end";
+    const proto::ProtoString* built = builder.build(ctx);
+    EXPECT_EQ(builder.size(), expected.size());
+    EXPECT_EQ(built->getSize(ctx), expected.size());
+    EXPECT_EQ(utf8(ctx, built), expected);
+
+    protoPython::StringBuilder empty;
+    EXPECT_EQ(empty.build(ctx)->getSize(ctx), 0u);
+}
+
+TEST(StringBuilderTest, ConcatenationChain) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "s = ''\n"
+        "for i in range(20000):\n"
+        "    s = s + 'ab'\n"
+        "loop_ok = len(s) == 40000 and s[0] == 'a' and s[39999] == 'b' and s[20001] == 'b'\n"
+        "t = ''\n"
+        "for i in range(3000):\n"
+        "    t += str(i % 10)\n"
+        "iadd_ok = len(t) == 3000 and t[-1] == '9' and t[:12] == '012345678901'\n"
+        "base = 'x' * 1000\n"
+        "left = base + 'L'\n"
+        "right = base + 'R'\n"
+        "left2 = left + 'l'\n"
+        "fork_ok = left2.endswith('xLl') and right.endswith('xR') and len(left2) == 1002 and left == base + 'L'\n"
+        "uni = ''\n"
+        "for i in range(700):\n"
+        "    uni = uni + '\\u00e9'\n"
+        "uni_ok = len(uni) == 700 and uni[699] == '\\u00e9'\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "loop_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "iadd_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "fork_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "uni_ok"), PROTO_TRUE);
+}
+
+TEST(StringBuilderTest, JoinAndFormat) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "words = [str(i) for i in range(5000)]\n"
+        "joined = ','.join(words)\n"
+        "join_ok = joined.startswith('0,1,2,') and joined.endswith(',4999') and len(joined.split(',')) == 5000\n"
+        "gen_ok = '-'.join(w for w in ['a', 'b', 'c']) == 'a-b-c' and ''.join([]) == ''\n"
+        "big = 'y' * 2000\n"
+        "f = f'<{big}|{42}|{None}>'\n"
+        "fmt_ok = len(f) == 2000 + 10 and f.startswith('<yy') and f.endswith('|42|None>')\n"
+        "try:\n"
+        "    ','.join(['a', 1])\n"
+        "    join_error = False\n"
+        "except TypeError:\n"
+        "    join_error = True\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(attr(ctx, frame, "join_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "gen_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "fmt_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "join_error"), PROTO_TRUE);
+}
+
+TEST(StringBuilderTest, ConcatenationOnSeveralThreads) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading\n"
+        "results = [None] * 4\n"
+        "def worker(n):\n"
+        "    s = ''\n"
+        "    for i in range(5000):\n"
+        "        s = s + str(n)\n"
+        "    results[n] = s\n"
+        "ts = [threading.Thread(target=worker, args=(n,)) for n in range(4)]\n"
+        "for t in ts: t.start()\n"
+        "for t in ts: t.join()\n"
+        "threads_ok = all(len(results[n]) == 5000 and results[n] == str(n) * 5000 for n in range(4))\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "threads_ok"), PROTO_TRUE);
+}
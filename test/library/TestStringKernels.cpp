@@ -0,0 +1,159 @@
+/*
+ * Tests for the string kernels: every kernel at every level the CPU supports
+ * against a plain byte loop, over lengths and offsets that cover the vector
+ * bodies and their tails, and the str and bytes methods built on them.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/StringKernels.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+namespace {
+
+bool isSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+size_t firstWhere(const std::string& s, bool (*pred)(unsigned char)) {
+    for (size_t i = 0; i < s.size(); ++i)
+        if (pred(static_cast<unsigned char>(s[i]))) return i;
+    return protoPython::kNotFound;
+}
+
+/** Levels to check: every one up to the best the CPU supports. */
+std::vector<protoPython::StringKernelLevel> supportedLevels() {
+    std::vector<protoPython::StringKernelLevel> levels;
+    for (auto level : {protoPython::StringKernelLevel::Scalar, protoPython::StringKernelLevel::SSE2,
+                       protoPython::StringKernelLevel::AVX2}) {
+        if (protoPython::setStringKernelLevel(level) == level) levels.push_back(level);
+    }
+    return levels;
+}
+
+} // namespace
+
+TEST(StringKernelsTest, KernelsMatchByteLoops) {
+    const auto initial = protoPython::stringKernelLevel();
+    const char alphabet[] = "ab \t\n\rAZaz{@\x80\xC3";
+    const size_t alphabetSize = sizeof(alphabet) - 1;
+    uint32_t seed = 12345;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+    for (auto level : supportedLevels()) {
+        protoPython::setStringKernelLevel(level);
+        for (int round = 0; round < 3000; ++round) {
+            const size_t n = next() % 150;
+            std::string s;
+            for (size_t i = 0; i < n; ++i) s += alphabet[next() % alphabetSize];
+            const size_t m = next() % 5;
+            std::string needle;
+            for (size_t i = 0; i < m; ++i) needle += alphabet[next() % 4];
+
+            const size_t expected = s.find(needle);
+            EXPECT_EQ(protoPython::findSubstring(s.data(), n, needle.data(), m),
+                      expected == std::string::npos ? protoPython::kNotFound : expected);
+            const size_t expectedLast = s.rfind(needle);
+            EXPECT_EQ(protoPython::findLastSubstring(s.data(), n, needle.data(), m),
+                      expectedLast == std::string::npos ? protoPython::kNotFound : expectedLast);
+            if (m > 0) {
+                size_t count = 0;
+                for (size_t p = s.find(needle); p != std::string::npos; p = s.find(needle, p + m)) ++count;
+                EXPECT_EQ(protoPython::countSubstring(s.data(), n, needle.data(), m), count);
+            }
+            EXPECT_EQ(protoPython::findWhitespace(s.data(), n), firstWhere(s, [](unsigned char c) { return isSpace(c); }));
+            EXPECT_EQ(protoPython::skipWhitespace(s.data(), n), firstWhere(s, [](unsigned char c) { return !isSpace(c); }));
+            EXPECT_EQ(protoPython::findLineBreak(s.data(), n), firstWhere(s, [](unsigned char c) { return c == '\n' || c == '\r'; }));
+            const size_t nonAscii = firstWhere(s, [](unsigned char c) { return c >= 0x80; });
+            EXPECT_EQ(protoPython::asciiPrefix(s.data(), n), nonAscii == protoPython::kNotFound ? n : nonAscii);
+
+            std::string upper = s, lower = s, upperRef = s, lowerRef = s;
+            protoPython::asciiUpper(&upper[0], n);
+            protoPython::asciiLower(&lower[0], n);
+            for (char& c : upperRef) if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 32);
+            for (char& c : lowerRef) if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+            EXPECT_EQ(upper, upperRef);
+            EXPECT_EQ(lower, lowerRef);
+            if (HasFailure()) {
+                ADD_FAILURE() << "level " << static_cast<int>(level) << " round " << round;
+                protoPython::setStringKernelLevel(initial);
+                return;
+            }
+        }
+    }
+    protoPython::setStringKernelLevel(initial);
+}
+
+TEST(StringKernelsTest, LongNeedlesAndNearMisses) {
+    const auto initial = protoPython::stringKernelLevel();
+    // Many positions match the needle's first and last bytes but not its middle.
+    std::string haystack;
+    for (int i = 0; i < 2000; ++i) haystack += "GET /a?x GET /b";
+    const std::string needle = "GET /index.html";
+    haystack += needle;
+    for (auto level : supportedLevels()) {
+        protoPython::setStringKernelLevel(level);
+        EXPECT_EQ(protoPython::findSubstring(haystack.data(), haystack.size(), needle.data(), needle.size()),
+                  haystack.size() - needle.size());
+        EXPECT_EQ(protoPython::countSubstring(haystack.data(), haystack.size(), "GET /", 5), 4001u);
+        EXPECT_EQ(protoPython::countSubstring(haystack.data(), haystack.size(), "/", 1), 4001u);
+        EXPECT_EQ(protoPython::findSubstring(haystack.data(), haystack.size(), "GET /c", 6), protoPython::kNotFound);
+        const std::string head = needle + haystack;
+        EXPECT_EQ(protoPython::findLastSubstring(head.data(), head.size() - needle.size(), needle.data(), needle.size()), 0u);
+        EXPECT_EQ(protoPython::findLastSubstring(haystack.data(), haystack.size(), "GET /a", 6), haystack.size() - needle.size() - 15);
+        EXPECT_EQ(protoPython::findLastSubstring(haystack.data(), haystack.size(), "GET /c", 6), protoPython::kNotFound);
+    }
+    protoPython::setStringKernelLevel(initial);
+}
+
+TEST(StringKernelsTest, StrAndBytesMethods) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "row = '2024-05-01 12:00:00 INFO  worker-7 GET /api/items?id=42 200 \\u00e9t\\u00e9 1.5ms\\n'\n"
+        "log = row * 2000 + 'tail ERROR disk full\\r\\nlast'\n"
+        "find_ok = log.find('ERROR') == len(row) * 2000 + 5 and log.find('GET', 100) == len(row) + 35 and log.find('absent') == -1\n"
+        "rfind_ok = log.rfind('GET') == len(row) * 1999 + 35 and log.rfind('GET', 0, len(row)) == 35 and log.rfind('absent') == -1\n"
+        "contains_ok = 'disk full' in log and 'disk empty' not in log and log.rpartition('INFO')[2] == log[len(row) * 1999 + 24:]\n"
+        "count_ok = log.count('GET /api') == 2000 and log.count('\\n') == 2001 and log.count('\\u00e9') == 4000\n"
+        "words = log.split()\n"
+        "split_ok = len(words) == 2000 * 9 + 5 and words[0] == '2024-05-01' and words[-1] == 'last' and words[7] == '\\u00e9t\\u00e9'\n"
+        "fields = row.split(' ')\n"
+        "sep_ok = len(fields) == 10 and fields[4] == 'worker-7' and len(log.split('GET', 3)) == 4\n"
+        "lines = log.splitlines()\n"
+        "lines_ok = len(lines) == 2002 and lines[-2] == 'tail ERROR disk full' and lines[-1] == 'last' and lines[5] == row[:-1]\n"
+        "replaced = log.replace('INFO ', 'WARN ')\n"
+        "replace_ok = replaced.count('WARN ') == 2000 and 'INFO' not in replaced and len(replaced) == len(log)\n"
+        "case_ok = row.upper().startswith('2024-05-01 12:00:00 INFO  WORKER-7 GET /API/ITEMS?ID=42') and log.lower().count('error') == 1\n"
+        "data = log.encode()\n"
+        "bytes_ok = data.find('ERROR'.encode()) == len(data) - 21 and data.count('GET'.encode()) == 2000\n"
+        "bytes_rfind_ok = data.rfind('GET'.encode()) == len(row.encode()) * 1999 + 35 and data.rfind('GET'.encode(), 0, 100) == 35\n"
+        "bytes_count_ok = data.count('2'.encode(), 0, 10) == 2 and data.count('x'.encode()) == 0\n"
+        "chunks = data.split('\\n'.encode())\n"
+        "bytes_split_ok = len(chunks) == 2002 and chunks[-2].decode() == 'tail ERROR disk full\\r'\n"
+        "bytes_replace_ok = data.replace('GET'.encode(), 'PUT'.encode()).count('PUT'.encode()) == 2000\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "find_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "rfind_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "contains_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "count_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "split_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "sep_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "lines_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "replace_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "case_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bytes_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bytes_rfind_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bytes_count_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bytes_split_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bytes_replace_ok"), PROTO_TRUE);
+}
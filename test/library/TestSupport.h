@@ -0,0 +1,86 @@
+/*
+ * TestSupport.h
+ *
+ * Shared fixture for the library tests: compile and run a source string in a
+ * fresh module frame, read attributes by name, and push the collector until a
+ * condition holds.
+ */
+
+#ifndef PROTOPYTHON_TEST_SUPPORT_H
+#define PROTOPYTHON_TEST_SUPPORT_H
+
+#include <protoPython/BlockingRegion.h>
+#include <protoPython/Compiler.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/Parser.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace protoPythonTest {
+
+/** Parse and compile source as a module; nullptr on a syntax or compile error. */
+inline const proto::ProtoObject* compileSource(proto::ProtoContext* ctx, const std::string& source) {
+    protoPython::Parser parser(source);
+    std::unique_ptr<protoPython::ModuleNode> mod = parser.parseModule();
+    if (!mod) return nullptr;
+    protoPython::Compiler compiler(ctx, "<test>");
+    if (!compiler.compileModule(mod.get())) return nullptr;
+    return protoPython::makeCodeObject(
+        ctx, compiler.getConstants(), compiler.getNames(), compiler.getBytecode(),
+        nullptr, nullptr, 0, 0, 0, 0, false, nullptr, compiler.getExceptionTable());
+}
+
+/** Run source with frame as its globals; false if it did not compile or left an exception pending. */
+inline bool runSourceIn(protoPython::PythonEnvironment& env, proto::ProtoObject* frame, const std::string& source) {
+    proto::ProtoContext* ctx = env.getContext();
+    const proto::ProtoObject* codeObj = compileSource(ctx, source);
+    if (!codeObj) return false;
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    return !env.hasPendingException();
+}
+
+/** Run source in a fresh module frame and return the frame; nullptr if it did not compile. */
+inline proto::ProtoObject* runSource(protoPython::PythonEnvironment& env, const std::string& source) {
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = const_cast<proto::ProtoObject*>(ctx->newObject(true));
+    const proto::ProtoObject* codeObj = compileSource(ctx, source);
+    if (!codeObj) return nullptr;
+    protoPython::runCodeObject(ctx, codeObj, frame);
+    return frame;
+}
+
+inline const proto::ProtoObject* attr(proto::ProtoContext* ctx, const proto::ProtoObject* obj, const char* name) {
+    return obj->getAttribute(ctx, proto::ProtoString::fromUTF8String(ctx, name));
+}
+
+/**
+ * Best-effort forced collection: churn short-lived garbage, ask the collector
+ * to run and park in a blocking region so it can stop the world, until pred()
+ * holds or the deadline passes. Returns pred().
+ */
+template <typename Pred>
+bool collectUntil(protoPython::PythonEnvironment& env, Pred pred,
+                  std::chrono::milliseconds deadline = std::chrono::seconds(10)) {
+    proto::ProtoContext* ctx = env.getContext();
+    const auto until = std::chrono::steady_clock::now() + deadline;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= until) return pred();
+        {
+            proto::ProtoContext scratch(ctx->space, ctx);
+            for (int i = 0; i < 20000; ++i)
+                scratch.newList()->appendLast(&scratch, scratch.fromInteger(i));
+        }
+        ctx->space->triggerGC();
+        protoPython::BlockingRegion parked(ctx->space);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return true;
+}
+
+} // namespace protoPythonTest
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Tests for the native _thread._local: per-thread attribute isolation,
+ * subclasses rerunning __init__ in each thread, methods and properties on
+ * subclasses, deletion, and threading.local picking up the native type.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <string>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(ThreadLocalTest, AttributesArePerThread) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading, _thread\n"
+        "native = threading.local is _thread._local\n"
+        "data = threading.local()\n"
+        "data.value = 'main'\n"
+        "seen = []\n"
+        "def worker(i):\n"
+        "    seen.append(hasattr(data, 'value'))\n"
+        "    data.value = i\n"
+        "    for _ in range(100):\n"
+        "        data.value = data.value + 1\n"
+        "    seen.append(data.value == i + 100)\n"
+        "ts = [threading.Thread(target=worker, args=(i * 1000,)) for i in range(8)]\n"
+        "for t in ts: t.start()\n"
+        "for t in ts: t.join()\n"
+        "isolated = seen.count(False) == 8 and seen.count(True) == 8\n"
+        "main_kept = data.value == 'main'\n"
+        "del data.value\n"
+        "deleted = not hasattr(data, 'value')\n"
+        "try:\n"
+        "    threading.local(1)\n"
+        "    rejects_args = False\n"
+        "except TypeError:\n"
+        "    rejects_args = True\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "native"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "isolated"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "main_kept"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "deleted"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "rejects_args"), PROTO_TRUE);
+}
+
+TEST(ThreadLocalTest, SubclassInitRunsPerThread) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading\n"
+        "inits = []\n"
+        "class Request(threading.local):\n"
+        "    kind = 'request'\n"
+        "    def __init__(self, user):\n"
+        "        inits.append(user)\n"
+        "        self.user = user\n"
+        "        self.items = []\n"
+        "    def add(self, x):\n"
+        "        self.items.append(x)\n"
+        "        return len(self.items)\n"
+        "req = Request('alice')\n"
+        "req.add(1)\n"
+        "counts = []\n"
+        "def worker():\n"
+        "    counts.append((req.user, req.add(2), req.add(3), req.kind))\n"
+        "t = threading.Thread(target=worker)\n"
+        "t.start()\n"
+        "t.join()\n"
+        "rerun = inits == ['alice', 'alice']\n"
+        "separate = counts == [('alice', 1, 2, 'request')] and req.items == [1]\n"
+        "is_instance = isinstance(req, Request) and isinstance(req, threading.local)\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "rerun"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "separate"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "is_instance"), PROTO_TRUE);
+}
@@ -0,0 +1,198 @@
+/*
+ * Tests for the futex-based _thread primitives: Lock/RLock semantics and
+ * timeouts, Condition, Semaphore/BoundedSemaphore, Event and Barrier across
+ * threads, and threading.py picking up the native classes.
+ */
+
+#include <gtest/gtest.h>
+#include <protoPython/ExecutionEngine.h>
+#include <protoPython/FutexSync.h>
+#include <protoPython/PythonEnvironment.h>
+#include <protoCore.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TestSupport.h"
+
+using protoPythonTest::attr;
+using protoPythonTest::runSource;
+
+TEST(FutexSyncTest, MutexCountsUnderContention) {
+    protoPython::FutexMutex mutex;
+    long counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 20000; ++i) {
+                mutex.lock(nullptr);
+                ++counter;
+                mutex.unlock();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(counter, 80000);
+    EXPECT_FALSE(mutex.isLocked());
+    EXPECT_FALSE(mutex.unlock());
+}
+
+TEST(FutexSyncTest, TimeoutsExpire) {
+    protoPython::FutexMutex mutex;
+    ASSERT_TRUE(mutex.tryLock());
+    EXPECT_FALSE(mutex.lock(nullptr, 20000000));
+    protoPython::FutexSemaphore sem(0);
+    EXPECT_FALSE(sem.acquire(nullptr, 20000000));
+    EXPECT_TRUE(sem.release(1, 1));
+    EXPECT_FALSE(sem.release(1, 1));
+    EXPECT_TRUE(sem.acquire(nullptr, 0));
+    protoPython::FutexEvent event;
+    EXPECT_FALSE(event.wait(nullptr, 20000000));
+    event.set();
+    EXPECT_TRUE(event.wait(nullptr, 0));
+}
+
+TEST(FutexSyncTest, BarrierReleasesEveryPhase) {
+    protoPython::FutexBarrier barrier(3);
+    std::atomic<int> passed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&] {
+            for (int phase = 0; phase < 100; ++phase) {
+                uint32_t index = 0;
+                auto r = barrier.arrive(nullptr, -1, index);
+                if (r == protoPython::FutexBarrier::Result::Last) barrier.complete(true);
+                if (r != protoPython::FutexBarrier::Result::Broken) passed.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(passed.load(), 300);
+    EXPECT_FALSE(barrier.broken());
+}
+
+TEST(ThreadSyncTest, LockAndRLockSemantics) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import _thread\n"
+        "lock = _thread.allocate_lock()\n"
+        "first = lock.acquire()\n"
+        "again = lock.acquire(False)\n"
+        "timed = lock.acquire(True, 0.05)\n"
+        "held = lock.locked()\n"
+        "lock.release()\n"
+        "try:\n"
+        "    lock.release()\n"
+        "    double_release = False\n"
+        "except RuntimeError:\n"
+        "    double_release = True\n"
+        "try:\n"
+        "    lock.acquire(False, 1.0)\n"
+        "    bad_timeout = False\n"
+        "except ValueError:\n"
+        "    bad_timeout = True\n"
+        "with lock:\n"
+        "    in_with = lock.locked()\n"
+        "after_with = lock.locked()\n"
+        "r = _thread.RLock()\n"
+        "r.acquire()\n"
+        "r.acquire()\n"
+        "owned = r._is_owned()\n"
+        "depth = r._release_save()\n"
+        "released_all = not r.locked()\n"
+        "r._acquire_restore(depth)\n"
+        "r.release()\n"
+        "r.release()\n"
+        "try:\n"
+        "    r.release()\n"
+        "    rlock_extra_release = False\n"
+        "except RuntimeError:\n"
+        "    rlock_extra_release = True\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(attr(ctx, frame, "first"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "again"), PROTO_FALSE);
+    EXPECT_EQ(attr(ctx, frame, "timed"), PROTO_FALSE);
+    EXPECT_EQ(attr(ctx, frame, "held"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "double_release"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bad_timeout"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "in_with"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "after_with"), PROTO_FALSE);
+    EXPECT_EQ(attr(ctx, frame, "owned"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "depth")->asLong(ctx), 2);
+    EXPECT_EQ(attr(ctx, frame, "released_all"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "rlock_extra_release"), PROTO_TRUE);
+}
+
+TEST(ThreadSyncTest, PrimitivesAcrossThreads) {
+    protoPython::PythonEnvironment env(STDLIB_PATH);
+    proto::ProtoContext* ctx = env.getContext();
+    proto::ProtoObject* frame = runSource(env,
+        "import threading, _thread\n"
+        "native = threading.Event is _thread.Event and threading.Condition is not threading._PyCondition\n"
+        "cond = threading.Condition()\n"
+        "items = []\n"
+        "def producer():\n"
+        "    for i in range(50):\n"
+        "        with cond:\n"
+        "            items.append(i)\n"
+        "            cond.notify()\n"
+        "t = threading.Thread(target=producer)\n"
+        "t.start()\n"
+        "with cond:\n"
+        "    got_all = cond.wait_for(lambda: len(items) == 50, 10.0)\n"
+        "t.join()\n"
+        "with cond:\n"
+        "    wait_timed_out = cond.wait(0.02) is False\n"
+        "try:\n"
+        "    cond.notify()\n"
+        "    unowned_notify = False\n"
+        "except RuntimeError:\n"
+        "    unowned_notify = True\n"
+        "sem = threading.Semaphore(0)\n"
+        "sem_timeout = sem.acquire(timeout=0.02)\n"
+        "sem.release(2)\n"
+        "sem_two = sem.acquire() and sem.acquire(False)\n"
+        "bsem = threading.BoundedSemaphore(1)\n"
+        "try:\n"
+        "    bsem.release()\n"
+        "    bounded = False\n"
+        "except ValueError:\n"
+        "    bounded = True\n"
+        "ev = threading.Event()\n"
+        "ev_timeout = ev.wait(0.02)\n"
+        "threading.Thread(target=ev.set).start()\n"
+        "ev_set = ev.wait(10.0) and ev.is_set()\n"
+        "indices = []\n"
+        "actions = []\n"
+        "bar = threading.Barrier(3, action=lambda: actions.append(1))\n"
+        "def party():\n"
+        "    indices.append(bar.wait())\n"
+        "ts = [threading.Thread(target=party) for _ in range(2)]\n"
+        "for x in ts: x.start()\n"
+        "party()\n"
+        "for x in ts: x.join()\n"
+        "barrier_ok = sorted(indices) == [0, 1, 2] and actions == [1] and not bar.broken\n"
+        "lonely = threading.Barrier(2)\n"
+        "try:\n"
+        "    lonely.wait(0.02)\n"
+        "    broke = False\n"
+        "except threading.BrokenBarrierError:\n"
+        "    broke = lonely.broken\n"
+        "lonely.reset()\n"
+        "reset_ok = not lonely.broken and lonely.n_waiting == 0\n");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_FALSE(env.hasPendingException());
+    EXPECT_EQ(attr(ctx, frame, "native"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "got_all"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "wait_timed_out"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "unowned_notify"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "sem_timeout"), PROTO_FALSE);
+    EXPECT_EQ(attr(ctx, frame, "sem_two"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "bounded"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "ev_timeout"), PROTO_FALSE);
+    EXPECT_EQ(attr(ctx, frame, "ev_set"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "barrier_ok"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "broke"), PROTO_TRUE);
+    EXPECT_EQ(attr(ctx, frame, "reset_ok"), PROTO_TRUE);
+}
@@ -1,5 +1,6 @@
 /*
- * Tests for ThreadingStrategy: ExecutionTask, runTaskInline, submitTask.
+ * Tests for ThreadingStrategy: ExecutionTask, runTaskInline, submitTask, the
+ * Chase–Lev WorkDeque and the WorkStealingScheduler worker pool.
  * Verifies lock-free task dispatch path and 64-byte alignment for HPC re-architecture.
  * See docs/REARCHITECTURE_PROTOCORE.md.
  */
@@ -7,8 +8,12 @@
 #include <gtest/gtest.h>
 #include <protoPython/ThreadingStrategy.h>
 #include <protoPython/ExecutionEngine.h>
+#include <protoPython/PythonEnvironment.h>
 #include <protoCore.h>
+#include <atomic>
 #include <cstddef>
+#include <thread>
+#include <vector>
 
 TEST(ThreadingStrategyTest, ExecutionTaskAlignment) {
     EXPECT_GE(alignof(protoPython::ExecutionTask), 64u)
@@ -59,6 +64,11 @@ TEST(ThreadingStrategyTest, SubmitTaskRunsInlineWithoutCrash) {
     task.pcEnd = bytecode->getSize(&ctx) - 1;
 
     EXPECT_NO_FATAL_FAILURE(protoPython::submitTask(&task));
+    // No PythonEnvironment on this thread: the task ran inline and is already done.
+    EXPECT_EQ(task.done.load(), 1u);
+    const proto::ProtoObject* result = protoPython::waitTask(&task);
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->asLong(&ctx), 99);
 }
 
 TEST(ThreadingStrategyTest, RunTaskInlineNullTaskNoCrash) {
@@ -82,7 +92,99 @@ TEST(ThreadingStrategyTest, RunTaskInlineNullResultOutNoCrash) {
     EXPECT_NO_FATAL_FAILURE(protoPython::runTaskInline(&task, nullptr));
 }
 
-TEST(ThreadingStrategyTest, GetWorkerCountReturnsZeroBeforeSchedulerIntegration) {
-    int n = protoPython::getWorkerCount();
-    EXPECT_GE(n, 0);
+TEST(ThreadingStrategyTest, WorkerCountIsConfigurable) {
+    EXPECT_GE(protoPython::getWorkerCount(), 0);
+    protoPython::setWorkerCount(3);
+    EXPECT_EQ(protoPython::getWorkerCount(), 3);
+    protoPython::setWorkerCount(0);
+    EXPECT_EQ(protoPython::getWorkerCount(), 0);
+    protoPython::setWorkerCount(-1);
+    EXPECT_GE(protoPython::getWorkerCount(), 0);
+}
+
+namespace {
+
+struct CountingJob : protoPython::SchedulerJob {
+    std::atomic<int>* counter{nullptr};
+    std::atomic<int> runs{0};
+};
+
+void countJob(proto::ProtoContext*, protoPython::SchedulerJob* job) {
+    CountingJob* self = static_cast<CountingJob*>(job);
+    self->runs.fetch_add(1);
+    self->counter->fetch_add(1);
+}
+
+} // namespace
+
+TEST(ThreadingStrategyTest, WorkDequeHandsEachJobOutOnce) {
+    constexpr int kJobs = 20000;  // Forces several ring growths.
+    std::vector<CountingJob> jobs(kJobs);
+    std::atomic<int> taken{0};
+    for (auto& job : jobs) job.counter = &taken;
+
+    protoPython::WorkDeque deque;
+    std::atomic<bool> pushing{true};
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < 3; ++i) {
+        thieves.emplace_back([&]() {
+            while (pushing.load() || !deque.empty())
+                if (protoPython::SchedulerJob* job = deque.steal()) countJob(nullptr, job);
+        });
+    }
+    for (int i = 0; i < kJobs; ++i) {
+        deque.push(&jobs[i]);
+        if (i % 3 == 0)
+            if (protoPython::SchedulerJob* job = deque.pop()) countJob(nullptr, job);
+    }
+    while (protoPython::SchedulerJob* job = deque.pop()) countJob(nullptr, job);
+    pushing.store(false);
+    for (auto& t : thieves) t.join();
+
+    EXPECT_EQ(taken.load(), kJobs);
+    for (const auto& job : jobs) EXPECT_EQ(job.runs.load(), 1);
+}
+
+TEST(ThreadingStrategyTest, SchedulerRunsJobsAndTasksOnWorkers) {
+    protoPython::setWorkerCount(4);
+    {
+        protoPython::PythonEnvironment env(STDLIB_PATH);
+        proto::ProtoContext* ctx = env.getContext();
+        protoPython::WorkStealingScheduler* scheduler = env.getScheduler(ctx);
+        ASSERT_NE(scheduler, nullptr);
+        EXPECT_EQ(scheduler->workerCount(), 4u);
+        EXPECT_EQ(env.getSchedulerThreadCount(), 4u);
+        EXPECT_EQ(protoPython::WorkStealingScheduler::current(), nullptr);
+
+        constexpr int kJobs = 2000;
+        std::vector<CountingJob> jobs(kJobs);
+        std::atomic<int> ran{0};
+        for (auto& job : jobs) {
+            job.counter = &ran;
+            job.run = countJob;
+            scheduler->submit(&job);
+        }
+
+        const proto::ProtoList* constants = ctx->newList()
+            ->appendLast(ctx, ctx->fromInteger(7))
+            ->appendLast(ctx, ctx->fromInteger(5));
+        const proto::ProtoList* bytecode = ctx->newList()
+            ->appendLast(ctx, ctx->fromInteger(protoPython::OP_LOAD_CONST))->appendLast(ctx, ctx->fromInteger(0))
+            ->appendLast(ctx, ctx->fromInteger(protoPython::OP_LOAD_CONST))->appendLast(ctx, ctx->fromInteger(1))
+            ->appendLast(ctx, ctx->fromInteger(protoPython::OP_BINARY_ADD))
+            ->appendLast(ctx, ctx->fromInteger(protoPython::OP_RETURN_VALUE))->appendLast(ctx, ctx->fromInteger(0));
+        protoPython::ExecutionTask task{};
+        task.ctx = ctx;
+        task.constants = constants;
+        task.bytecode = bytecode;
+        task.pcEnd = bytecode->getSize(ctx) - 1;
+        protoPython::submitTask(&task);
+        const proto::ProtoObject* result = protoPython::waitTask(&task);
+        ASSERT_NE(result, nullptr);
+        EXPECT_EQ(result->asLong(ctx), 12);
+
+        while (ran.load() < kJobs) std::this_thread::yield();
+        for (const auto& job : jobs) EXPECT_EQ(job.runs.load(), 1);
+    }
+    protoPython::setWorkerCount(-1);
 }